@@ -53,11 +53,9 @@
 #include <BaseCyclicClientRpc.h>
 
 #include <InterconnectConfigClientRpc.h>
-#include <SessionManager.h>
 #include <DeviceManagerClientRpc.h>
-#include <RouterClient.h>
-#include <TransportClientTcp.h>
-#include <TransportClientUdp.h>
+#include <KortexConnection.h>
+#include <CyclicSequencer.h>
 
 #include <thread>
 #include <iostream>
@@ -86,49 +84,22 @@ public:
     GripperLowLevel(const std::string& ip_address, int port_real_time , int port, const std::string& username = "admin", const std::string& password = "admin"):
     m_ip_address(ip_address), m_port(port), m_port_real_time(port_real_time), m_username(username), m_password(password), m_proportional_gain(0.0)
     {
-        m_router                    = nullptr;
-        m_router_real_time          = nullptr;
-        m_transport                 = nullptr;
-        m_transport_real_time       = nullptr;
-        m_session_manager           = nullptr;
-        m_session_manager_real_time = nullptr;
         m_base                      = nullptr;
         m_base_cyclic               = nullptr;
     }
 
     ~GripperLowLevel()
     {
+        std::cout << "Cyclic frames: " << m_sequencer.GetStatistics().ToString() << std::endl;
+
         // Restore servoing mode.
         if (m_base)
         {
             m_base->SetServoingMode(m_previous_servoing_mode);
         }
         
-        // Close API sessions
-        if (m_session_manager)
-        {
-            m_session_manager->CloseSession();
-        }
-        if (m_session_manager_real_time)
-        {
-            m_session_manager_real_time->CloseSession();
-        }
-
-        // Deactivate the router and cleanly disconnect from the transport object
-        m_router->SetActivationStatus(false);
-        m_transport->disconnect();
-        m_router_real_time->SetActivationStatus(false);
-        m_transport_real_time->disconnect();
-
-        // Destroy the API
-        delete m_base;
-        delete m_base_cyclic;
-        delete m_session_manager;
-        delete m_session_manager_real_time;
-        delete m_router;
-        delete m_router_real_time;
-        delete m_transport;
-        delete m_transport_real_time;
+        // Close API sessions, disconnect and destroy the API
+        m_connection.reset();
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -154,37 +125,23 @@ public:
         // 2 sessions have to be created: 1 for TCP and 1 for UDP
         ///////////////////////////////////////////////////////////////////////////////////////////
 
-        // TCP transport and router
-        m_transport = new k_api::TransportClientTcp();
-        m_transport->connect(m_ip_address, m_port);
-        m_router = new k_api::RouterClient(m_transport, [](k_api::KError err){ std::cout << "_________ callback error _________" << err.toString(); });
-
-        // UDP transport and router
-        m_transport_real_time = new k_api::TransportClientUdp();
-        m_transport_real_time->connect(m_ip_address, m_port_real_time);
-        m_router_real_time = new k_api::RouterClient(m_transport_real_time, [](k_api::KError err){ std::cout << "_________ callback error _________" << err.toString(); });
-
         // Set session data connection information
-        auto createSessionInfo = k_api::Session::CreateSessionInfo();
-        createSessionInfo.set_username(m_username);
-        createSessionInfo.set_password(m_password);
-        createSessionInfo.set_session_inactivity_timeout(60000);   // (milliseconds)
-        createSessionInfo.set_connection_inactivity_timeout(2000); // (milliseconds)
+        tConnectionSettings settings(m_ip_address);
+        settings.port = m_port;
+        settings.portRealTime = m_port_real_time;
+        settings.username = m_username;
+        settings.password = m_password;
 
         std::cout << "Creating sessions for communication" << std::endl;
 
-        // Session manager service wrapper
-        m_session_manager = new k_api::SessionManager(m_router);
-        m_session_manager->CreateSession(createSessionInfo);
-
-        m_session_manager_real_time = new k_api::SessionManager(m_router_real_time);
-        m_session_manager_real_time->CreateSession(createSessionInfo);
-
+        // Both channels and their sessions are brought up concurrently
         // Although TCP can be used, it is best to use UDP router for cyclic
-        m_base_cyclic = new k_api::BaseCyclic::BaseCyclicClient(m_router_real_time);
-
         // Base client can only be operated on a TCP connection
-        m_base = new k_api::Base::BaseClient(m_router);
+        m_connection = KortexConnection::Create(settings, KORTEX_CLIENT_BASE | KORTEX_CLIENT_BASE_CYCLIC);
+        std::cout << m_connection->GetStartupTiming().ToString() << std::endl;
+
+        m_base_cyclic = m_connection->GetBaseCyclic();
+        m_base = m_connection->GetBase();
 
         // Get previous servoing mode
         m_previous_servoing_mode = m_base->GetServoingMode();
@@ -211,18 +168,22 @@ public:
             actuator_command->set_position(actuator.position());
             actuator_command->set_velocity(0.0);
             actuator_command->set_torque_joint(0.0);
-            actuator_command->set_command_id(0);
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Initialize interconnect command to current gripper position.
         ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-        m_base_command.mutable_interconnect()->mutable_command_id()->set_identifier(0);
-
         m_gripper_motor_command = m_base_command.mutable_interconnect()->mutable_gripper_command()->add_motor_cmd();
         m_gripper_motor_command->set_position(gripper_initial_position );
         m_gripper_motor_command->set_velocity(0.0);
         m_gripper_motor_command->set_force(100.0);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // The sequencer stamps the frame and command identifiers (actuators and interconnect) of each command sent,
+        // feedback that is late or duplicated is not used by the position loop.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        m_sequencer.Reset(base_feedback.frame_id());
+        m_sequencer.SetDiscardStaleFeedback(true);
     }
 
 
@@ -264,26 +225,33 @@ public:
                 float actual_position;
 
                 // Refresh cyclic data (send command and get feedback)
+                m_sequencer.Stamp(m_base_command);
                 base_feedback = m_base_cyclic->Refresh(m_base_command);
-                actual_position = base_feedback.interconnect().gripper_feedback().motor()[0].position();
-
-                position_error = target_position - actual_position;
-
-                if (fabs(position_error) < MINIMAL_POSITION_ERROR)
-                {
-                    m_gripper_motor_command->set_velocity(0.0);
-                    m_base_cyclic->Refresh(m_base_command);
-                    break;
-                }
 
-                velocity = m_proportional_gain * fabs(position_error);
-                if (velocity > 100.0)
+                // Stale feedback: the same command is sent again on next cycle
+                if (m_sequencer.Accept(base_feedback.frame_id()))
                 {
-                    velocity = 100.0;
+                    actual_position = base_feedback.interconnect().gripper_feedback().motor()[0].position();
+
+                    position_error = target_position - actual_position;
+
+                    if (fabs(position_error) < MINIMAL_POSITION_ERROR)
+                    {
+                        m_gripper_motor_command->set_velocity(0.0);
+                        m_sequencer.Stamp(m_base_command);
+                        m_base_cyclic->Refresh(m_base_command);
+                        break;
+                    }
+
+                    velocity = m_proportional_gain * fabs(position_error);
+                    if (velocity > 100.0)
+                    {
+                        velocity = 100.0;
+                    }
+
+                    m_gripper_motor_command->set_position(target_position);
+                    m_gripper_motor_command->set_velocity(velocity);
                 }
-                
-                m_gripper_motor_command->set_position(target_position);
-                m_gripper_motor_command->set_velocity(velocity);
             }
             catch(const std::exception& ex)
             {
@@ -297,17 +265,13 @@ public:
     }
 
 private:
-    k_api::TransportClientTcp*            m_transport;
-    k_api::TransportClientUdp*            m_transport_real_time;
-    k_api::RouterClient*                  m_router;
-    k_api::RouterClient*                  m_router_real_time;
-    k_api::SessionManager*                m_session_manager;
-    k_api::SessionManager*                m_session_manager_real_time;
+    std::unique_ptr<KortexConnection>     m_connection;
     k_api::Base::BaseClient*              m_base;
     k_api::BaseCyclic::BaseCyclicClient*  m_base_cyclic;
 
     k_api::BaseCyclic::Command            m_base_command;
     k_api::GripperCyclic::MotorCommand*   m_gripper_motor_command;
+    CyclicSequencer                       m_sequencer;
     std::string                           m_username;
     std::string                           m_password;
     std::string                           m_ip_address;
@@ -52,11 +52,9 @@
 #include <BaseCyclicClientRpc.h>
 #include <ActuatorConfigClientRpc.h>
 #include <SessionClientRpc.h>
-#include <SessionManager.h>
 
-#include <RouterClient.h>
-#include <TransportClientUdp.h>
-#include <TransportClientTcp.h>
+#include <KortexConnection.h>
+#include <CyclicExecutor.h>
 
 #include <google/protobuf/util/json_util.h>
 
@@ -71,9 +69,6 @@ namespace k_api = Kinova::Api;
 
 #define IP_ADDRESS "192.168.1.10"
 
-#define PORT 10000
-#define PORT_REAL_TIME 10001
-
 #define ACTUATOR_COUNT 7
 
 float TIME_DURATION = 30.0f; // Duration of the example (seconds)
@@ -84,23 +79,6 @@ constexpr auto TIMEOUT_PROMISE_DURATION = std::chrono::seconds{20};
 /*****************************
  * Example related function *
  *****************************/
-int64_t GetTickUs()
-{
-#if defined(_MSC_VER)
-    LARGE_INTEGER start, frequency;
-
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&start);
- 
-    return (start.QuadPart * 1000000) / frequency.QuadPart;
-#else
-    struct timespec start;
-    clock_gettime(CLOCK_MONOTONIC, &start);
-
-    return (start.tv_sec * 1000000LLU) + (start.tv_nsec / 1000);
-#endif
-}
-
 // Create an event listener that will set the promise action event to the exit value
 // Will set promise to either END or ABORT
 // Use finish_promise.get_future.get() to wait and get the value
@@ -200,9 +178,23 @@ bool example_cyclic_torque_control(k_api::Base::BaseClient* base, k_api::BaseCyc
 
     auto servoing_mode = k_api::Base::ServoingModeInformation();
 
-    int timer_count = 0;
-    int64_t now = 0;
-    int64_t last = 0;
+    // Cycles run on absolute 1 ms deadlines
+    CyclicExecutor executor(base_cyclic, std::chrono::microseconds{1000});
+
+    // A late or duplicated feedback is not used for the torque command, the previous one is kept instead
+    executor.SetDiscardStaleFeedback(true);
+
+    // The loop goes on after a failed Refresh, with the previous feedback
+    executor.SetRefreshErrorCallback([](k_api::KBasicException &ex)
+    {
+        std::cout << "Kortex exception: " << ex.what() << std::endl;
+
+        k_api::KDetailedException *pDetailed = dynamic_cast<k_api::KDetailedException*>(&ex);
+        if (pDetailed)
+        {
+            std::cout << "Error sub-code: " << k_api::SubErrorCodes_Name(k_api::SubErrorCodes((pDetailed->getErrorInfo().getError().error_sub_code()))) << std::endl;
+        }
+    });
 
     std::cout << "Initializing the arm for torque control example" << std::endl;
     try
@@ -242,58 +234,26 @@ bool example_cyclic_torque_control(k_api::Base::BaseClient* base, k_api::BaseCyc
         std::cout << "Running torque control example for " << TIME_DURATION << " seconds" << std::endl;
 
         // Real-time loop
-        while (timer_count < (TIME_DURATION * 1000))
+        auto tick = [&](k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command)
         {
-            now = GetTickUs();
-
-            if (now - last > 1000)
-            {
-                // Position command to first actuator is set to measured one to avoid following error to trigger
-                // Bonus: When doing this instead of disabling the following error, if communication is lost and first
-                //        actuator continues to move under torque command, resulting position error with command will
-                //        trigger a following error and switch back the actuator in position command to hold its position
-                base_command.mutable_actuators(0)->set_position(base_feedback.actuators(0).position());
-
-                // First actuator torque command is set to last actuator torque measure times an amplification
-                base_command.mutable_actuators(0)->set_torque_joint(init_first_torque + (torque_amplification * (base_feedback.actuators(6).torque() - init_last_torque)));
-
-
-                // First actuator position is sent as a command to last actuator
-                base_command.mutable_actuators(6)->set_position(base_feedback.actuators(0).position() - init_delta_position);
-
-                // Incrementing identifier ensures actuators can reject out of time frames
-                base_command.set_frame_id(base_command.frame_id() + 1);
-                if (base_command.frame_id() > 65535)
-                    base_command.set_frame_id(0);
-
-                for (int idx = 0; idx < ACTUATOR_COUNT; idx++)
-                {
-                    base_command.mutable_actuators(idx)->set_command_id(base_command.frame_id());
-                }
-
-                try
-                {
-                    base_feedback = base_cyclic->Refresh(base_command, 0);
-                }
-                catch (k_api::KDetailedException& ex)
-                {
-                    std::cout << "Kortex exception: " << ex.what() << std::endl;
-
-                    std::cout << "Error sub-code: " << k_api::SubErrorCodes_Name(k_api::SubErrorCodes((ex.getErrorInfo().getError().error_sub_code()))) << std::endl;
-                }
-                catch (std::runtime_error& ex2)
-                {
-                    std::cout << "runtime error: " << ex2.what() << std::endl;
-                }
-                catch(...)
-                {
-                    std::cout << "Unknown error." << std::endl;
-                }
-                
-                timer_count++;
-                last = GetTickUs();
-            }
-        }
+            // Position command to first actuator is set to measured one to avoid following error to trigger
+            // Bonus: When doing this instead of disabling the following error, if communication is lost and first
+            //        actuator continues to move under torque command, resulting position error with command will
+            //        trigger a following error and switch back the actuator in position command to hold its position
+            command.mutable_actuators(0)->set_position(feedback.actuators(0).position());
+
+            // First actuator torque command is set to last actuator torque measure times an amplification
+            command.mutable_actuators(0)->set_torque_joint(init_first_torque + (torque_amplification * (feedback.actuators(6).torque() - init_last_torque)));
+
+            // First actuator position is sent as a command to last actuator
+            command.mutable_actuators(6)->set_position(feedback.actuators(0).position() - init_delta_position);
+
+            // The executor stamps the frame and command identifiers after the tick, actuators reject out of time frames
+            return true;
+        };
+        executor.Run(base_feedback, base_command, tick, uint64_t(TIME_DURATION * 1000));
+
+        std::cout << executor.GetStatistics().ToString() << std::endl;
 
         std::cout << "Torque control example completed" << std::endl;
 
@@ -328,37 +288,15 @@ bool example_cyclic_torque_control(k_api::Base::BaseClient* base, k_api::BaseCyc
 int main(int argc, char **argv)
 {
     // Create API objects
-    auto error_callback = [](k_api::KError err){ cout << "_________ callback error _________" << err.toString(); };
-    
-    std::cout << "Creating transport objects" << std::endl;
-    auto transport = new k_api::TransportClientTcp();
-    auto router = new k_api::RouterClient(transport, error_callback);
-    transport->connect(IP_ADDRESS, PORT);
-
-    std::cout << "Creating transport real time objects" << std::endl;
-    auto transport_real_time = new k_api::TransportClientUdp();
-    auto router_real_time = new k_api::RouterClient(transport_real_time, error_callback);
-    transport_real_time->connect(IP_ADDRESS, PORT_REAL_TIME);
-
-    // Set session data connection information
-    auto create_session_info = k_api::Session::CreateSessionInfo();
-    create_session_info.set_username("admin");
-    create_session_info.set_password("admin");
-    create_session_info.set_session_inactivity_timeout(60000);   // (milliseconds)
-    create_session_info.set_connection_inactivity_timeout(2000); // (milliseconds)
-
-    // Session manager service wrapper
-    std::cout << "Creating sessions for communication" << std::endl;
-    auto session_manager = new k_api::SessionManager(router);
-    session_manager->CreateSession(create_session_info);
-    auto session_manager_real_time = new k_api::SessionManager(router_real_time);
-    session_manager_real_time->CreateSession(create_session_info);
-    std::cout << "Sessions created" << std::endl;
-
-    // Create services
-    auto base = new k_api::Base::BaseClient(router);
-    auto base_cyclic = new k_api::BaseCyclic::BaseCyclicClient(router_real_time);
-    auto actuator_config = new k_api::ActuatorConfig::ActuatorConfigClient(router);
+    // The TCP and UDP channels and their sessions are brought up concurrently
+    std::cout << "Creating transport objects and sessions for communication" << std::endl;
+    auto connection = KortexConnection::Create(tConnectionSettings(IP_ADDRESS),
+                                               KORTEX_CLIENT_BASE | KORTEX_CLIENT_ACTUATOR_CONFIG | KORTEX_CLIENT_BASE_CYCLIC);
+    std::cout << "Sessions created, " << connection->GetStartupTiming().ToString() << std::endl;
+
+    auto base = connection->GetBase();
+    auto base_cyclic = connection->GetBaseCyclic();
+    auto actuator_config = connection->GetActuatorConfig();
 
     // Example core
     example_move_to_home_position(base);
@@ -368,24 +306,6 @@ int main(int argc, char **argv)
         std::cout << "There has been an unexpected error in example_cyclic_torque_control() function." << endl;;
     }
 
-    // Close API session
-    session_manager->CloseSession();
-    session_manager_real_time->CloseSession();
-
-    // Deactivate the router and cleanly disconnect from the transport object
-    router->SetActivationStatus(false);
-    transport->disconnect();
-    router_real_time->SetActivationStatus(false);
-    transport_real_time->disconnect();
-
-    // Destroy the API
-    delete base;
-    delete base_cyclic;
-    delete actuator_config;
-    delete session_manager;
-    delete session_manager_real_time;
-    delete router;
-    delete router_real_time;
-    delete transport;
-    delete transport_real_time;
+    // Close API sessions, disconnect and destroy the API
+    connection.reset();
 }
@@ -20,11 +20,9 @@
 #include <BaseClientRpc.h>
 #include <BaseCyclicClientRpc.h>
 #include <SessionClientRpc.h>
-#include <SessionManager.h>
 
-#include <RouterClient.h>
-#include <TransportClientTcp.h>
-#include <TransportClientUdp.h>
+#include <KortexConnection.h>
+#include <CyclicExecutor.h>
 
 #include <google/protobuf/util/json_util.h>
 
@@ -39,9 +37,6 @@ namespace k_api = Kinova::Api;
 
 #define IP_ADDRESS "192.168.1.10"
 
-#define PORT 10000
-#define PORT_REAL_TIME 10001
-
 #define DURATION 3             // Network timeout (seconds)
 
 float velocity = 10.0f;         // Default velocity of the actuator (degrees per seconds)
@@ -72,26 +67,6 @@ check_for_end_or_abort(bool& finished)
 }
 
 
-/*****************************
- * Example related function *
- *****************************/
-int64_t GetTickUs()
-{
-#if defined(_MSC_VER)
-    LARGE_INTEGER start, frequency;
-
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&start);
-
-    return (start.QuadPart * 1000000)/frequency.QuadPart;
-#else
-    struct timespec start;
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    
-    return (start.tv_sec * 1000000LLU) + (start.tv_nsec / 1000);
-#endif
-}
-
 /**************************
  * Example core functions *
  **************************/
@@ -157,11 +132,8 @@ bool example_actuator_low_level_velocity_control(k_api::Base::BaseClient* base,
 
     auto servoingMode = k_api::Base::ServoingModeInformation();
 
-    int timer_count = 0;
-    int64_t now = 0;
-    int64_t last = 0;
-
-    int timeout = 0;
+    // Cycles run on absolute 1 ms deadlines
+    CyclicExecutor executor(base_cyclic, std::chrono::microseconds{1000});
 
     std::cout << "Initializing the arm for velocity low-level control example" << std::endl;
     try
@@ -180,46 +152,34 @@ bool example_actuator_low_level_velocity_control(k_api::Base::BaseClient* base,
             base_command.add_actuators()->set_position(base_feedback.actuators(i).position());
         }
 
-        // Define the callback function used in Refresh_callback
-        auto lambda_fct_callback = [](const Kinova::Api::Error &err, const k_api::BaseCyclic::Feedback data)
-        {
-            // We are printing the data of the moving actuator just for the example purpose,
-            // avoid this in a real-time loop
-            std::string serialized_data;
-            google::protobuf::util::MessageToJsonString(data.actuators(data.actuators_size() - 1), &serialized_data);
-            std::cout << serialized_data << std::endl << std::endl;
-        };
-
         // Real-time loop
-        while(timer_count < (time_duration * 1000))
+        uint64_t tick_count = 0;
+        auto tick = [&](k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command)
         {
-            now = GetTickUs();
-            if(now - last > 1000)
+            // We are printing the data of the moving actuator just for the example purpose,
+            // only every 100 cycles: printing takes longer than the 1 ms period
+            if (tick_count++ % 100 == 0)
             {
-                for(int i = 0; i < actuator_count; i++)
-                {
-                    // Move only the last actuator to prevent collision
-        		    if(i == actuator_count - 7)
-                    //if( i == 6)
-        		    {
-                        commands[i] += (0.001f * velocity);
-                    	base_command.mutable_actuators(i)->set_position(fmod(commands[i], 360.0f));
-        		    }
-                }
+                std::string serialized_data;
+                google::protobuf::util::MessageToJsonString(feedback.actuators(feedback.actuators_size() - 1), &serialized_data);
+                std::cout << serialized_data << std::endl << std::endl;
+            }
 
-                try
-                {
-                    base_cyclic->Refresh_callback(base_command, lambda_fct_callback, 0);
-                }
-                catch(...)
+            for(int i = 0; i < actuator_count; i++)
+            {
+                // Move only the last actuator to prevent collision
+                if(i == actuator_count - 7)
+                //if( i == 6)
                 {
-                    timeout++;
+                    commands[i] += (0.001f * velocity);
+                    command.mutable_actuators(i)->set_position(fmod(commands[i], 360.0f));
                 }
-                
-                timer_count++;
-                last = GetTickUs();
             }
-        }
+            return true;
+        };
+        executor.Run(base_feedback, base_command, tick, uint64_t(time_duration * 1000));
+
+        std::cout << executor.GetStatistics().ToString() << std::endl;
     }
     catch (k_api::KDetailedException& ex)
     {
@@ -245,34 +205,13 @@ bool example_actuator_low_level_velocity_control(k_api::Base::BaseClient* base,
 int main(int argc, char **argv)
 {
     // Create API objects
-    auto error_callback = [](k_api::KError err){ cout << "_________ callback error _________" << err.toString(); };
-    
-    auto transport = new k_api::TransportClientTcp();
-    auto router = new k_api::RouterClient(transport, error_callback);
-    transport->connect(IP_ADDRESS, PORT);
-
-    auto transport_real_time = new k_api::TransportClientUdp();
-    auto router_real_time = new k_api::RouterClient(transport_real_time, error_callback);
-    transport_real_time->connect(IP_ADDRESS, PORT_REAL_TIME);
-
-    // Set session data connection information
-    auto create_session_info = k_api::Session::CreateSessionInfo();
-    create_session_info.set_username("admin");
-    create_session_info.set_password("admin");
-    create_session_info.set_session_inactivity_timeout(60000);   // (milliseconds)
-    create_session_info.set_connection_inactivity_timeout(2000); // (milliseconds)
-
-    // Session manager service wrapper
+    // The TCP and UDP channels and their sessions are brought up concurrently
     std::cout << "Creating sessions for communication" << std::endl;
-    auto session_manager = new k_api::SessionManager(router);
-    session_manager->CreateSession(create_session_info);
-    auto session_manager_real_time = new k_api::SessionManager(router_real_time);
-    session_manager_real_time->CreateSession(create_session_info);
-    std::cout << "Sessions created" << std::endl;
+    auto connection = KortexConnection::Create(tConnectionSettings(IP_ADDRESS), KORTEX_CLIENT_BASE | KORTEX_CLIENT_BASE_CYCLIC);
+    std::cout << "Sessions created, " << connection->GetStartupTiming().ToString() << std::endl;
 
-    // Create services
-    auto base = new k_api::Base::BaseClient(router);
-    auto base_cyclic = new k_api::BaseCyclic::BaseCyclicClient(router_real_time);
+    auto base = connection->GetBase();
+    auto base_cyclic = connection->GetBaseCyclic();
 
     // Example core
     auto isOk = example_actuator_low_level_velocity_control(base, base_cyclic);
@@ -281,23 +220,6 @@ int main(int argc, char **argv)
         std::cout << "There has been an unexpected error in example_cyclic_armbase() function." << std::endl;
     }
 
-    // Close API session
-    session_manager->CloseSession();
-    session_manager_real_time->CloseSession();
-
-    // Deactivate the router and cleanly disconnect from the transport object
-    router->SetActivationStatus(false);
-    transport->disconnect();
-    router_real_time->SetActivationStatus(false);
-    transport_real_time->disconnect();
-
-    // Destroy the API
-    delete base;
-    delete base_cyclic;
-    delete session_manager;
-    delete session_manager_real_time;
-    delete router;
-    delete router_real_time;
-    delete transport;
-    delete transport_real_time;
+    // Close API sessions, disconnect and destroy the API
+    connection.reset();
 }
@@ -0,0 +1,120 @@
+#ifndef KORTEXAPICPPEXAMPLE_ACTUATORCYCLICCONTROLLER_H
+#define KORTEXAPICPPEXAMPLE_ACTUATORCYCLICCONTROLLER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ActuatorCyclicClientRpc.h>
+
+#include "CyclicSequencer.h"
+
+namespace k_api = Kinova::Api;
+
+//ActuatorCyclic::Command of one actuator, the command id is stamped by the controller
+struct tActuatorCyclicCommand
+{
+    uint32_t flags;
+    float position;
+    float velocity;
+    float torqueJoint;
+    float currentMotor;
+};
+
+struct tActuatorCyclicFeedback
+{
+    uint32_t feedbackId;
+    uint32_t statusFlags;
+    uint32_t jitterComm;
+    float position;
+    float velocity;
+    float torque;
+    float currentMotor;
+    float voltage;
+    float temperatureMotor;
+    float temperatureCore;
+    uint32_t faultBankA;
+    uint32_t faultBankB;
+    uint32_t warningBankA;
+    uint32_t warningBankB;
+};
+
+//Cyclic control of a single actuator through the ActuatorCyclic service: the frames carry this actuator only and go to
+//its device id (1 to 7 on a Gen3 arm, as for ActuatorConfig) instead of the whole arm in a BaseCyclic frame.
+//The command id is sequenced like CyclicSequencer does for BaseCyclic and checked against the feedback id.
+class ActuatorCyclicController
+{
+public:
+    static constexpr uint32_t SERVICE_VERSION = 1;
+
+    ActuatorCyclicController(k_api::IRouterClient *pRouter, uint32_t deviceId);
+
+    uint32_t GetDeviceId() const {return m_nDeviceId;}
+
+    //values sent by the next Refresh
+    tActuatorCyclicCommand& GetCommand() {return m_Command;}
+    //last feedback accepted
+    const tActuatorCyclicFeedback& GetFeedback() const {return m_Feedback;}
+
+    //Same as ActuatorCyclicClient::Refresh. Throws like the generated client: KBasicException on timeout or bad
+    //feedback, KDetailedException on an error reported by the actuator.
+    const tActuatorCyclicFeedback& Refresh(const k_api::RouterClientSendOptions &options = {false, 0, 3000});
+
+    //The two halves of Refresh, so several actuators can have their frame in flight at once. Only the timeout of the
+    //options is used: the frame goes with sendWithCallback, whose callbacks the router expires, where a future of
+    //send() would stay in the router for good once its Receive timed out.
+    void Send(const k_api::RouterClientSendOptions &options = {false, 0, 3000});
+    const tActuatorCyclicFeedback& Receive();
+
+    //feedbacks that came back after their Receive timed out, dropped
+    uint64_t GetLateReplyCount() const;
+
+    //a feedback older than the last one or repeated is then dropped and the previous one kept
+    void SetDiscardStaleFeedback(bool bDiscard) {m_Sequencer.SetDiscardStaleFeedback(bDiscard);}
+    const tSequenceStatistics& GetSequenceStatistics() const {return m_Sequencer.GetStatistics();}
+
+    //size of the last command and feedback payloads sent and received, in bytes
+    size_t GetCommandSize() const {return m_Payload.size();}
+    size_t GetFeedbackSize() const {return m_nFeedbackSize;}
+
+private:
+    k_api::IRouterClient *m_pRouter;
+    uint32_t m_nDeviceId;
+
+    tActuatorCyclicCommand m_Command;
+    tActuatorCyclicFeedback m_Feedback;
+    CyclicSequencer m_Sequencer;
+
+    //kept between cycles, nothing is allocated once the first frame went through
+    k_api::ActuatorCyclic::Command m_CommandMessage;
+    k_api::ActuatorCyclic::Feedback m_FeedbackMessage;
+    std::string m_Payload;
+    size_t m_nFeedbackSize;
+
+    //shared with the callbacks of the router, which can answer after a timeout or after the controller is gone
+    struct tReplySlot;
+    std::shared_ptr<tReplySlot> m_pReply;
+    k_api::Frame m_Frame;
+    bool m_bPending;
+    uint32_t m_nPendingTimeout_ms;
+};
+
+//Several ActuatorCyclicControllers refreshed together: all the commands leave before the first feedback is waited for,
+//so a cycle costs about the slowest round trip instead of the sum of them.
+class ActuatorCyclicGroup
+{
+public:
+    ActuatorCyclicGroup(k_api::IRouterClient *pRouter, const std::vector<uint32_t> &deviceIds);
+
+    int GetCount() const {return int(m_Controllers.size());}
+    ActuatorCyclicController& Get(int index) {return *m_Controllers[index];}
+
+    //Every feedback is waited for even when one fails, then the first failure is thrown again
+    void Refresh(const k_api::RouterClientSendOptions &options = {false, 0, 3000});
+
+private:
+    std::vector<std::unique_ptr<ActuatorCyclicController>> m_Controllers;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef KORTEXAPICPPEXAMPLE_ALIGNEDNEW_H
+#define KORTEXAPICPPEXAMPLE_ALIGNEDNEW_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(_OS_WINDOWS)
+#include <malloc.h>
+#endif
+
+//Before C++17 new ignores alignas() above 16 bytes: a type with cache line aligned members gets its own operator
+//new/delete by deriving from this. It stays trivial, but std::vector & co still use the default allocator.
+template <size_t ALIGNMENT>
+struct tAlignedNew
+{
+    static void* operator new(size_t size) {return Allocate(size);}
+    static void* operator new[](size_t size) {return Allocate(size);}
+    static void operator delete(void *p) {Free(p);}
+    static void operator delete[](void *p) {Free(p);}
+
+private:
+    static void* Allocate(size_t size)
+    {
+#if defined(_OS_WINDOWS)
+        void *p = _aligned_malloc(size, ALIGNMENT);
+#else
+        void *p = nullptr;
+        if (posix_memalign(&p, ALIGNMENT, size) != 0)
+        {
+            p = nullptr;
+        }
+#endif
+        if (!p)
+        {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    static void Free(void *p)
+    {
+#if defined(_OS_WINDOWS)
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef KORTEXAPICPPEXAMPLE_CYCLICEXECUTOR_H
+#define KORTEXAPICPPEXAMPLE_CYCLICEXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <BaseCyclicClientRpc.h>
+#include <KBasicException.h>
+
+#include "CyclicSequencer.h"
+#include "FeedbackMirror.h"
+#include "LatencyHistogram.h"
+#include "RefreshTiming.h"
+
+namespace k_api = Kinova::Api;
+
+struct tCyclicStatistics
+{
+    uint64_t nTicks;
+    uint64_t nDeadlineMisses;   //cycles that completed after the next release
+    uint64_t nSkippedPeriods;   //releases dropped to get back in phase after a miss
+    uint64_t nRefreshErrors;    //Refresh calls that threw, the previous feedback is kept
+
+    LatencyHistogram wakeUpJitter;  //wake-up time minus release time
+    LatencyHistogram cycleTime;     //tick callback + Refresh
+    LatencyHistogram overrun;       //completion minus next release, only for the missed cycles
+
+    //Refresh as round trip (it includes the parsing, not separable there) and tick as callback
+    tRefreshTiming refresh;
+
+    //frame id checks of the feedbacks, with the automatic sequencing on
+    tSequenceStatistics sequence;
+
+    void Reset();
+    std::string ToString() const;
+};
+
+//Runs tick + BaseCyclic::Refresh on absolute release times (release k = start + k * period), so nothing drifts
+//whatever the duration of the cycle. The thread sleeps with clock_nanosleep(TIMER_ABSTIME) until busyWaitMargin
+//before the release and spins for the remaining time, a margin of 0 never spins.
+class CyclicExecutor
+{
+public:
+    static constexpr int REFRESH_TIMEOUT_PERIODS = 5;
+
+    //return false to leave the loop
+    typedef std::function<bool(k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command&)> TickCallback;
+    //a Refresh that threw (a KDetailedException for an error of the robot), on the cyclic thread
+    typedef std::function<void(k_api::KBasicException&)> RefreshErrorCallback;
+
+    CyclicExecutor(k_api::BaseCyclic::BaseCyclicClient *pBaseCyclic,
+                   std::chrono::microseconds period = std::chrono::microseconds{1000},
+                   std::chrono::microseconds busyWaitMargin = std::chrono::microseconds{0});
+
+    //Runs until the callback returns false, Stop() is called or maxTicks cycles were done in this call (0 = no limit).
+    //The callback gets the feedback of the previous cycle and fills the command sent in this one.
+    void Run(k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command, const TickCallback &tick, uint64_t maxTicks = 0);
+    //from any thread, a Stop() before Run() makes it return at once; the request is cleared when Run() returns
+    void Stop() {m_bStopRequested = true;}
+
+    //the loop goes on after a Refresh error with the previous feedback, the error is counted and given to the callback
+    void SetRefreshErrorCallback(const RefreshErrorCallback &callback) {m_OnRefreshError = callback;}
+    //REFRESH_TIMEOUT_PERIODS periods by default, at least 1 ms: a lost UDP datagram only holds the loop that long,
+    //not the 3 s of BaseCyclicClient
+    void SetRefreshTimeout(std::chrono::milliseconds timeout) {m_RefreshOptions.timeout_ms = uint32_t(timeout.count());}
+
+    //On by default: the frame id and command ids of the command are stamped after the tick callback, continuing from
+    //the frame id of the command given to Run(), and the feedback frame ids are checked. See CyclicSequencer.
+    void SetAutoSequencing(bool bEnable) {m_bAutoSequencing = bEnable;}
+    //with the automatic sequencing, a stale or duplicated feedback is dropped and the tick gets the previous one again
+    void SetDiscardStaleFeedback(bool bDiscard) {m_Sequencer.SetDiscardStaleFeedback(bDiscard);}
+
+    //every feedback received is published there for the other threads, nullptr to stop
+    void SetFeedbackMirror(FeedbackMirror *pMirror) {m_pMirror = pMirror;}
+    FeedbackMirror* GetFeedbackMirror() const {return m_pMirror;}
+
+    std::chrono::nanoseconds GetPeriod() const {return m_Period;}
+
+    //Only read them once Run() returned, or from the tick callback. They add up over the Run() calls until
+    //ResetStatistics(), but the sequence statistics, which start again with the sequencing at each Run().
+    const tCyclicStatistics& GetStatistics() const {return m_Statistics;}
+    void ResetStatistics() {m_Statistics.Reset();}
+
+    static void SleepUntil(const std::chrono::steady_clock::time_point &deadline);
+
+private:
+    k_api::BaseCyclic::BaseCyclicClient *m_pBaseCyclic;
+    std::chrono::nanoseconds m_Period;
+    std::chrono::nanoseconds m_BusyWaitMargin;
+    std::atomic<bool> m_bStopRequested;
+    FeedbackMirror *m_pMirror;
+    RefreshErrorCallback m_OnRefreshError;
+    k_api::RouterClientSendOptions m_RefreshOptions;
+
+    bool m_bAutoSequencing;
+    CyclicSequencer m_Sequencer;
+    tCyclicStatistics m_Statistics;
+};
+
+#endif
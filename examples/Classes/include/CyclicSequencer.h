@@ -0,0 +1,92 @@
+#ifndef KORTEXAPICPPEXAMPLE_CYCLICSEQUENCER_H
+#define KORTEXAPICPPEXAMPLE_CYCLICSEQUENCER_H
+
+#include <cstdint>
+#include <string>
+
+#include <ActuatorCyclicClientRpc.h>
+#include <BaseCyclicClientRpc.h>
+
+#include "PreencodedCyclicCommand.h"
+
+namespace k_api = Kinova::Api;
+
+struct tSequenceStatistics
+{
+    uint64_t nStamped;
+    uint64_t nInOrder;
+    uint64_t nDropped;      //frame ids skipped by a newer feedback, less the ones that came back late
+    uint64_t nReordered;    //feedback older than one already accepted
+    uint64_t nDuplicates;   //feedback for the frame id accepted last
+    uint64_t nUnknown;      //feedback for a frame id never sent
+    uint64_t nDiscarded;    //feedbacks not handed over, with the stale discard on
+
+    std::string ToString() const;
+};
+
+//Owns the frame_id / command_id sequence of a cyclic client. Stamp() writes the next id (16 bit wrap, like the
+//robot) in the frame id and in the command id of each actuator and of the interconnect, which carries the gripper.
+//OnFeedback() classifies the frame id the robot echoes in its feedback against the ids sent so far.
+class CyclicSequencer
+{
+public:
+    static constexpr uint32_t FRAME_ID_MASK = 0xFFFF;
+
+    enum eFeedbackOrder
+    {
+        FEEDBACK_IN_ORDER,
+        FEEDBACK_DUPLICATE,
+        FEEDBACK_REORDERED,
+        FEEDBACK_UNKNOWN,
+    };
+
+    CyclicSequencer();
+
+    //the next id stamped is lastFrameId + 1
+    void Reset(uint32_t lastFrameId = 0);
+
+    //when true, the clients keep their previous feedback instead of one that is not FEEDBACK_IN_ORDER
+    void SetDiscardStaleFeedback(bool bDiscard) {m_bDiscardStale = bDiscard;}
+    bool IsDiscardingStaleFeedback() const {return m_bDiscardStale;}
+
+    //advance and write the id in the command, the protobuf one only sets the interconnect id if it has an interconnect
+    uint32_t Stamp(k_api::BaseCyclic::Command &command);
+    uint32_t Stamp(PreencodedCyclicCommand &command);
+    uint32_t Stamp(k_api::ActuatorCyclic::Command &command);
+
+    eFeedbackOrder OnFeedback(uint32_t frameId);
+
+    //OnFeedback plus the stale discard policy: true if the feedback should be used
+    bool Accept(uint32_t frameId)
+    {
+        if (OnFeedback(frameId) == FEEDBACK_IN_ORDER || !m_bDiscardStale)
+        {
+            return true;
+        }
+        m_Statistics.nDiscarded++;
+        return false;
+    }
+
+    uint32_t GetLastSentFrameId() const {return m_nLastSent;}
+    uint32_t GetLastAcceptedFrameId() const {return m_nLastAccepted;}
+    const tSequenceStatistics& GetStatistics() const {return m_Statistics;}
+
+    //signed distance between two 16 bit frame ids, positive if a is newer than b
+    static int FrameIdDistance(uint32_t a, uint32_t b) {return int(int16_t(uint16_t(a - b)));}
+
+private:
+    uint32_t Next()
+    {
+        m_nLastSent = (m_nLastSent + 1) & FRAME_ID_MASK;
+        m_Statistics.nStamped++;
+        return m_nLastSent;
+    }
+
+    bool m_bDiscardStale;
+    uint32_t m_nLastSent;
+    bool m_bHasAccepted;
+    uint32_t m_nLastAccepted;
+    tSequenceStatistics m_Statistics;
+};
+
+#endif
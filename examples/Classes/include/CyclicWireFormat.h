@@ -0,0 +1,250 @@
+#ifndef KORTEXAPICPPEXAMPLE_CYCLICWIREFORMAT_H
+#define KORTEXAPICPPEXAMPLE_CYCLICWIREFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+//Protobuf wire format primitives shared by the hand-written cyclic encoders and decoders.
+//Only what the BaseCyclic, ActuatorCyclic and GripperCyclic messages need: varint, fixed32 and length delimited fields,
+//the other wire types are only skipped.
+namespace CyclicWire
+{
+    //fixed capacity of the flat cyclic buffers, Gen3 arms have 6 or 7 actuators
+    constexpr int MAX_ACTUATORS = 8;
+    constexpr int MAX_GRIPPER_MOTORS = 4;
+
+    enum eWireType
+    {
+        WIRETYPE_VARINT = 0,
+        WIRETYPE_FIXED64 = 1,
+        WIRETYPE_LENGTH_DELIMITED = 2,
+        WIRETYPE_START_GROUP = 3,
+        WIRETYPE_END_GROUP = 4,
+        WIRETYPE_FIXED32 = 5,
+    };
+
+    //nesting limit of the skipped groups, the default recursion limit of protobuf
+    constexpr int MAX_GROUP_DEPTH = 100;
+
+    inline bool ReadVarint(const uint8_t *&p, const uint8_t *end, uint64_t &value)
+    {
+        //tags and small values are a single byte
+        if (p < end && *p < 0x80)
+        {
+            value = *p++;
+            return true;
+        }
+
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7)
+        {
+            uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline uint32_t LoadFixed32(const uint8_t *p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    inline void StoreFixed32(uint8_t *p, uint32_t value)
+    {
+        p[0] = uint8_t(value);
+        p[1] = uint8_t(value >> 8);
+        p[2] = uint8_t(value >> 16);
+        p[3] = uint8_t(value >> 24);
+    }
+
+    inline float LoadFloat(const uint8_t *p)
+    {
+        uint32_t bits = LoadFixed32(p);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    inline void StoreFloat(uint8_t *p, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        StoreFixed32(p, bits);
+    }
+
+    inline int Varint32Size(uint32_t value)
+    {
+        int size = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+
+    inline uint8_t* WriteVarint32(uint8_t *p, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            *p++ = uint8_t(value | 0x80);
+            value >>= 7;
+        }
+        *p++ = uint8_t(value);
+        return p;
+    }
+
+    //field numbers of the cyclic messages are all below 16, their tags fit in one byte
+    inline uint8_t* WriteTag(uint8_t *p, uint32_t fieldNumber, int wireType)
+    {
+        return WriteVarint32(p, (fieldNumber << 3) | uint32_t(wireType));
+    }
+
+    //uint32 fields are accepted as varint or fixed32, whichever the schema uses
+    inline bool ReadUint32(const uint8_t *&p, const uint8_t *end, int wireType, uint32_t &value)
+    {
+        if (wireType == WIRETYPE_FIXED32)
+        {
+            if (end - p < 4)
+            {
+                return false;
+            }
+            value = LoadFixed32(p);
+            p += 4;
+            return true;
+        }
+        if (wireType == WIRETYPE_VARINT)
+        {
+            uint64_t varint;
+            if (!ReadVarint(p, end, varint))
+            {
+                return false;
+            }
+            value = uint32_t(varint);
+            return true;
+        }
+        return false;
+    }
+
+    inline bool ReadFloat(const uint8_t *&p, const uint8_t *end, int wireType, float &value)
+    {
+        if (wireType != WIRETYPE_FIXED32 || end - p < 4)
+        {
+            return false;
+        }
+        value = LoadFloat(p);
+        p += 4;
+        return true;
+    }
+
+    //reads a tag, returns false at the end of the buffer or on a malformed tag
+    inline bool ReadTag(const uint8_t *&p, const uint8_t *end, uint32_t &fieldNumber, int &wireType)
+    {
+        //like protobuf: at most 5 bytes, the bits past 32 of the last one are dropped
+        uint32_t tag = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (p >= end)
+            {
+                return false;
+            }
+            uint8_t byte = *p++;
+            tag |= uint32_t(byte & 0x7F) << shift;
+            if (byte < 0x80)
+            {
+                fieldNumber = tag >> 3;
+                wireType = int(tag & 0x7);
+                return fieldNumber != 0;
+            }
+        }
+        return false;
+    }
+
+    //on success p points at the payload of the sub-message and subEnd right after it
+    inline bool ReadLengthDelimited(const uint8_t *&p, const uint8_t *end, int wireType, const uint8_t *&subEnd)
+    {
+        uint64_t length;
+        if (wireType != WIRETYPE_LENGTH_DELIMITED || !ReadVarint(p, end, length) || length > uint64_t(end - p))
+        {
+            return false;
+        }
+        subEnd = p + length;
+        return true;
+    }
+
+    inline bool SkipField(const uint8_t *&p, const uint8_t *end, uint32_t fieldNumber, int wireType, int depth = 0);
+
+    //a group runs until the end group tag of the same field number, protobuf keeps it as an unknown field
+    inline bool SkipGroup(const uint8_t *&p, const uint8_t *end, uint32_t fieldNumber, int depth)
+    {
+        if (depth >= MAX_GROUP_DEPTH)
+        {
+            return false;
+        }
+        uint32_t nestedField;
+        int nestedWireType;
+        while (ReadTag(p, end, nestedField, nestedWireType))
+        {
+            if (nestedWireType == WIRETYPE_END_GROUP)
+            {
+                return nestedField == fieldNumber;
+            }
+            if (!SkipField(p, end, nestedField, nestedWireType, depth + 1))
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    //an end group tag outside of its group is malformed, like wire types 6 and 7
+    inline bool SkipField(const uint8_t *&p, const uint8_t *end, uint32_t fieldNumber, int wireType, int depth)
+    {
+        switch (wireType)
+        {
+            case WIRETYPE_VARINT:
+            {
+                uint64_t ignored;
+                return ReadVarint(p, end, ignored);
+            }
+            case WIRETYPE_FIXED64:
+            {
+                if (end - p < 8)
+                {
+                    return false;
+                }
+                p += 8;
+                return true;
+            }
+            case WIRETYPE_LENGTH_DELIMITED:
+            {
+                const uint8_t *subEnd;
+                if (!ReadLengthDelimited(p, end, wireType, subEnd))
+                {
+                    return false;
+                }
+                p = subEnd;
+                return true;
+            }
+            case WIRETYPE_START_GROUP:
+                return SkipGroup(p, end, fieldNumber, depth);
+            case WIRETYPE_FIXED32:
+            {
+                if (end - p < 4)
+                {
+                    return false;
+                }
+                p += 4;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef KORTEXAPICPPEXAMPLE_DELAYLINE_H
+#define KORTEXAPICPPEXAMPLE_DELAYLINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Network conditions applied to the frames of one direction of a link
+struct tNetworkProfile
+{
+    uint32_t nLatency_us;       //added to every frame
+    uint32_t nJitter_us;        //uniform in [0, nJitter_us], on top of the latency
+    double reorderRatio;        //datagrams held back by nReorderDelay_us more, so that the next ones overtake them
+    uint32_t nReorderDelay_us;
+    double lossRatio;           //datagrams dropped, stream frames retransmitted (see DelayLine)
+
+    tNetworkProfile(): nLatency_us(0), nJitter_us(0), reorderRatio(0.0), nReorderDelay_us(0), lossRatio(0.0) {}
+
+    bool IsIdeal() const;
+
+    //"ideal", "lan", "wifi" or "congested", returns false for another name
+    static bool FromName(const std::string &name, tNetworkProfile &profile);
+    static std::vector<std::string> GetNames();
+};
+
+//Holds frames back as a link with the given profile would before handing them to the sink.
+//
+//On a stream (TCP) nothing is lost nor reordered: a lost frame comes out after RETRANSMIT_DELAY_US, the minimum
+//retransmission timeout of Linux, and holds back the frames behind it. On datagrams (UDP) a lost frame is dropped and
+//a reordered one is delayed by nReorderDelay_us.
+//
+//The sink is called from the thread of the delay line, one frame at a time, or from the thread calling Push() when
+//the profile is ideal.
+class DelayLine
+{
+public:
+    static constexpr uint32_t RETRANSMIT_DELAY_US = 200000;
+
+    typedef std::function<void (const std::string &bytes)> Sink;
+
+    DelayLine(const tNetworkProfile &profile, bool bStream, uint32_t seed, const Sink &sink);
+    //frames still held back are dropped
+    ~DelayLine();
+
+    //takes the bytes, bytes is left with a buffer of an earlier frame to reuse
+    void Push(std::string &bytes);
+
+    uint64_t GetDroppedCount() const {return m_nDropped;}
+    uint64_t GetReorderedCount() const {return m_nReordered;}
+    uint64_t GetRetransmittedCount() const {return m_nRetransmitted;}
+
+private:
+    DelayLine(const DelayLine&) = delete;
+    DelayLine& operator=(const DelayLine&) = delete;
+
+    struct tItem
+    {
+        std::chrono::steady_clock::time_point due;
+        uint64_t nSequence;     //keeps the order of frames due at the same time
+        std::string bytes;
+
+        bool operator>(const tItem &other) const
+        {
+            return due != other.due ? due > other.due : nSequence > other.nSequence;
+        }
+    };
+
+    void Run();
+
+    const tNetworkProfile m_Profile;
+    const bool m_bStream;
+    const Sink m_Sink;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::vector<tItem> m_Items;     //min heap on the due time
+    std::vector<std::string> m_FreeBuffers;
+    std::mt19937 m_Generator;
+    std::chrono::steady_clock::time_point m_LastDue;
+    uint64_t m_nSequence;
+    bool m_bStop;
+    std::thread m_Worker;
+
+    std::atomic<uint64_t> m_nDropped;
+    std::atomic<uint64_t> m_nReordered;
+    std::atomic<uint64_t> m_nRetransmitted;
+};
+
+#endif
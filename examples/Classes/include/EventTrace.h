@@ -0,0 +1,123 @@
+#ifndef KORTEXAPICPPEXAMPLE_EVENTTRACE_H
+#define KORTEXAPICPPEXAMPLE_EVENTTRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//Timeline of the threads of a process, to see where the time of a cyclic loop went when it stutters: the tick and
+//the Refresh of CyclicExecutor, the frames a TracingTransport hands to the frameHandler of its router (and the
+//NotificationHandler dispatch it does), the keep-alives of KeepAliveService, the workers of NotificationDispatcher...
+//
+//The events are only compiled with KORTEX_TRACE defined (cmake -DKORTEX_TRACE=ON), the macros are empty otherwise:
+//
+//    KORTEX_TRACE_THREAD_NAME("cyclic");
+//    {
+//        KORTEX_TRACE_SCOPE("cyclic", "Refresh");      //category and name, string literals
+//        ...
+//    }
+//
+//Each thread records into a ring of its own, allocated on its first event, without a lock or a system call: an event
+//costs two clock reads and a few stores. The oldest events of a full ring are overwritten. Recording is off unless
+//Enable() is called or KORTEX_EVENT_TRACE is set in the environment to the file written at exit. Dump() writes the
+//events of every thread as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) or as a Perfetto protobuf trace.
+class EventTrace
+{
+public:
+    static constexpr uint64_t INSTANT = uint64_t(-1);
+    static constexpr size_t DEFAULT_RING_EVENTS = 16384;
+
+    struct tEvent
+    {
+        const char *category;
+        const char *name;
+        uint64_t start_ns;          //steady clock
+        uint64_t duration_ns;       //INSTANT for an instant event
+        uint32_t threadId;
+    };
+
+    struct tThread
+    {
+        uint32_t threadId;          //from 1, in the order of their first event
+        std::string name;
+        uint64_t nOverwritten;
+    };
+
+    enum eFormat
+    {
+        CHROME_JSON,
+        PERFETTO
+    };
+
+    //records an event from its construction to its destruction
+    class Scope
+    {
+    public:
+        Scope(const char *category, const char *name) : m_pCategory(category), m_pName(name)
+        {
+            m_nStart = IsEnabled() ? Now() : 0;
+        }
+        ~Scope()
+        {
+            if (m_nStart != 0)
+            {
+                Record(m_pCategory, m_pName, m_nStart, Now() - m_nStart);
+            }
+        }
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        const char *m_pCategory;
+        const char *m_pName;
+        uint64_t m_nStart;
+    };
+
+    static bool IsEnabled() {return s_bEnabled.load(std::memory_order_relaxed);}
+    static void Enable(bool bEnabled = true);
+    //events per ring of the threads recording their first event afterwards
+    static void SetRingEvents(size_t nEvents);
+
+    static uint64_t Now();
+    static void Record(const char *category, const char *name, uint64_t start_ns, uint64_t duration_ns);
+    static void Instant(const char *category, const char *name)
+    {
+        if (IsEnabled())
+        {
+            Record(category, name, Now(), INSTANT);
+        }
+    }
+    //name of the calling thread in the trace, cheap when it does not change
+    static void SetThreadName(const std::string &name);
+
+    //the events still in the rings, of each thread in the order they ended
+    static std::vector<tEvent> GetEvents();
+    static std::vector<tThread> GetThreads();
+    //forgets the events recorded so far
+    static void Clear();
+
+    static void Dump(std::ostream &stream, eFormat format);
+    //Chrome JSON for a path ending in .json, Perfetto otherwise; false on a file error
+    static bool Dump(const std::string &path);
+
+private:
+    static std::atomic<bool> s_bEnabled;
+};
+
+#if defined(KORTEX_TRACE)
+#define KORTEX_TRACE_CONCAT_(a, b) a##b
+#define KORTEX_TRACE_CONCAT(a, b) KORTEX_TRACE_CONCAT_(a, b)
+#define KORTEX_TRACE_SCOPE(category, name) EventTrace::Scope KORTEX_TRACE_CONCAT(kortexTraceScope, __LINE__)(category, name)
+#define KORTEX_TRACE_INSTANT(category, name) EventTrace::Instant(category, name)
+#define KORTEX_TRACE_THREAD_NAME(name) EventTrace::SetThreadName(name)
+#else
+#define KORTEX_TRACE_SCOPE(category, name) static_cast<void>(0)
+#define KORTEX_TRACE_INSTANT(category, name) static_cast<void>(0)
+#define KORTEX_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
+
+#endif
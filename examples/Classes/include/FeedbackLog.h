@@ -0,0 +1,189 @@
+#ifndef KORTEXAPICPPEXAMPLE_FEEDBACKLOG_H
+#define KORTEXAPICPPEXAMPLE_FEEDBACKLOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+
+#include "AlignedNew.h"
+#include "FlatFeedback.h"
+
+namespace k_api = Kinova::Api;
+
+//Ring file of BaseCyclic feedbacks, for the post-incident analysis of a 1 kHz loop: a fixed size per feedback, about
+//the one of the serialized protobuf and a third of the JSON, without serializing on the cyclic thread.
+//
+//    file header   magic "KRTXFLG1", uint32 version, header size, samples per block, block count, block size,
+//                  actuator count, column count, then per column: 40 bytes of name, uint32 type, uint32 offset
+//                  in the block
+//    blocks        uint64 sequence (0 while the block is rewritten), uint32 sample count, uint32 samples dropped
+//                  since the previous block, uint64 first and last time, then the columns, each one an array of
+//                  samples per block values
+//
+//in the byte order of the machine. The columns are the time, the frame id, every field of each actuator and of the
+//base (IMU and tool pose among them), named like their protobuf field, "actuators[2].position", "base.tool_pose_x".
+//The file is preallocated and mapped in memory, the oldest block is overwritten once it is full. The sample count of
+//the block being written is updated after each write: a recording cut by a crash is read up to the last write.
+namespace FeedbackLog
+{
+    enum eType : uint32_t
+    {
+        U32 = 1,
+        F32 = 2,
+        U64 = 3
+    };
+
+    //feedback offset of the time, and of the columns a reader does not know
+    const size_t NO_FIELD = size_t(-1);
+
+    struct tColumn
+    {
+        std::string name;
+        eType type;
+        size_t feedbackOffset;      //of the field in tFlatFeedback
+        size_t blockOffset;         //of the values in a block, from its header
+    };
+
+    //the columns of nActuatorCount actuators, the time and the frame id first
+    std::vector<tColumn> MakeSchema(int nActuatorCount);
+
+    struct tRecorderStatistics
+    {
+        uint64_t nPushed;
+        uint64_t nDropped;      //the queue was full, or the recorder not open
+        uint64_t nWritten;
+        uint64_t nBlocks;       //started since Open()
+    };
+
+    //Records the feedbacks pushed by the cyclic thread: Push() copies them in a queue, wait-free and without a system
+    //call, a thread of the recorder writes them to the file every flushPeriod_ms. A feedback pushed while the queue
+    //is full is dropped and counted. Open() throws k_api::KBasicException on a file error, Close() is called once the
+    //cyclic thread stopped pushing.
+    class Recorder : public tAlignedNew<64>
+    {
+    public:
+        static constexpr uint32_t DEFAULT_BLOCK_SAMPLES = 256;
+
+        Recorder(int nActuatorCount, size_t queueCapacity = 1024, uint32_t flushPeriod_ms = 10);
+        ~Recorder();
+
+        //blockCount blocks of blockSamples samples, truncates an existing file
+        void Open(const std::string &path, uint32_t blockCount, uint32_t blockSamples = DEFAULT_BLOCK_SAMPLES);
+        //writes what is still queued and stops the thread
+        void Close();
+        bool IsOpen() const {return m_bOpen;}
+
+        //cyclic thread only, a single producer
+        void Push(const tFlatFeedback &feedback, uint64_t time_ns);
+        void Push(const k_api::BaseCyclic::Feedback &feedback, uint64_t time_ns);
+
+        tRecorderStatistics GetStatistics() const;
+        const std::vector<tColumn>& GetColumns() const {return m_Columns;}
+
+    private:
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        void Run();
+        //writes the queued feedbacks, false when there were none
+        bool Drain();
+        void StartBlock();
+        void CommitBlock();
+        char* GetBlock(uint64_t sequence) const;
+
+        const int m_nActuatorCount;
+        const size_t m_nQueueCapacity;
+        const uint32_t m_nFlushPeriod_ms;
+        std::vector<tColumn> m_Columns;     //laid out by Open()
+
+        //queue, the cyclic thread moves the head and the writer thread the tail
+        std::unique_ptr<tFlatFeedback[]> m_pQueue;
+        std::unique_ptr<uint64_t[]> m_pQueueTime;
+        alignas(64) std::atomic<uint64_t> m_nHead;
+        alignas(64) std::atomic<uint64_t> m_nTail;
+        alignas(64) std::atomic<uint64_t> m_nDropped;
+        std::atomic<bool> m_bOpen;
+        tFlatFeedback m_Conversion;
+
+        //writer thread
+        int m_nFile;
+        char *m_pMapping;
+        size_t m_nMappingSize;
+        size_t m_nHeaderSize;
+        size_t m_nBlockSize;
+        uint32_t m_nBlockSamples;
+        uint32_t m_nBlockCount;
+        std::atomic<uint64_t> m_nSequence;      //of the block being written, from 1
+        uint32_t m_nBlockFill;
+        uint64_t m_nDroppedWritten;
+        std::atomic<uint64_t> m_nWritten;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_bStop;
+        std::thread m_Thread;
+    };
+
+    //Reads the blocks of a recording, oldest first. Open() throws k_api::KBasicException when the file cannot be read
+    //or is not a feedback log.
+    class Reader
+    {
+    public:
+        struct tBlock
+        {
+            uint64_t sequence;
+            uint32_t sampleCount;
+            uint32_t droppedCount;      //feedbacks dropped by the recorder before this block
+            uint64_t firstTime_ns;
+            uint64_t lastTime_ns;
+            const char *pData;          //into the mapping, valid until the reader is closed
+        };
+
+        Reader();
+        ~Reader();
+
+        void Open(const std::string &path);
+        void Close();
+
+        int GetActuatorCount() const {return m_nActuatorCount;}
+        const std::vector<tColumn>& GetColumns() const {return m_Columns;}
+        //-1 when there is no such column
+        int FindColumn(const std::string &name) const;
+
+        const std::vector<tBlock>& GetBlocks() const {return m_Blocks;}
+        uint64_t GetSampleCount() const {return m_nSampleCount;}
+
+        //values of a column in a block, of its type
+        const uint32_t* GetU32(const tBlock &block, int column) const {return reinterpret_cast<const uint32_t*>(block.pData + m_Columns[column].blockOffset);}
+        const float* GetF32(const tBlock &block, int column) const {return reinterpret_cast<const float*>(block.pData + m_Columns[column].blockOffset);}
+        const uint64_t* GetU64(const tBlock &block, int column) const {return reinterpret_cast<const uint64_t*>(block.pData + m_Columns[column].blockOffset);}
+
+        //sample of a block back into a feedback, actuators and base; false past the samples of the block
+        bool GetSample(const tBlock &block, uint32_t index, tFlatFeedback &feedback, uint64_t &time_ns) const;
+
+        //one row per sample, oldest first; all the columns when none are given
+        void WriteCsv(std::ostream &stream, const std::vector<int> &columns = std::vector<int>()) const;
+
+    private:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const char *m_pMapping;
+        size_t m_nSize;
+        int m_nActuatorCount;
+        std::vector<tColumn> m_Columns;
+        std::vector<tBlock> m_Blocks;
+        uint64_t m_nSampleCount;
+    };
+}
+
+#endif
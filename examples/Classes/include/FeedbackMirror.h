@@ -0,0 +1,46 @@
+#ifndef KORTEXAPICPPEXAMPLE_FEEDBACKMIRROR_H
+#define KORTEXAPICPPEXAMPLE_FEEDBACKMIRROR_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "AlignedNew.h"
+#include "FlatFeedback.h"
+
+//Latest feedback of the cyclic thread, readable from any other thread (UI, logger, safety monitor) without a mutex.
+//Seqlock: the writer bumps the sequence to odd, writes and bumps it back to even. A reader copies the snapshot and
+//retries if the sequence moved in between, so it never sees a torn copy and the cyclic thread never waits for it.
+//There must be a single writer.
+class FeedbackMirror : public tAlignedNew<64>
+{
+public:
+    FeedbackMirror();
+
+    //cyclic thread only, wait-free
+    void Publish(const tFlatFeedback &feedback);
+    void Publish(const k_api::BaseCyclic::Feedback &feedback);
+
+    //Any thread. Retries while a publish is in progress (a copy of a few hundred ns), false until the first publish.
+    //pPublishTime_ns gets the steady_clock time of the publish.
+    bool Read(tFlatFeedback &snapshot, uint64_t *pPublishTime_ns = nullptr) const;
+
+    //single attempt, false if a publish was in progress or nothing was published yet
+    bool TryRead(tFlatFeedback &snapshot, uint64_t *pPublishTime_ns = nullptr) const;
+
+    //number of publishes, a reader polling for new data compares it with the last one it saw
+    uint64_t GetVersion() const {return m_nSequence.load(std::memory_order_acquire) / 2;}
+
+private:
+    //the snapshot is kept as atomic words: concurrent reads and writes of it are then well defined in C++11
+    static constexpr int WORD_COUNT = int((sizeof(tFlatFeedback) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    alignas(64) std::atomic<uint64_t> m_nSequence;
+    alignas(64) std::atomic<uint64_t> m_nPublishTime_ns;
+    std::atomic<uint64_t> m_Words[WORD_COUNT];
+
+    //the writer keeps its own copy of the sequence, it is the only one changing it
+    alignas(64) uint64_t m_nWriterSequence;
+    tFlatFeedback m_Conversion;
+};
+
+#endif
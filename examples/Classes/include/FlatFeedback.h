@@ -0,0 +1,124 @@
+#ifndef KORTEXAPICPPEXAMPLE_FLATFEEDBACK_H
+#define KORTEXAPICPPEXAMPLE_FLATFEEDBACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <BaseCyclicClientRpc.h>
+
+#include "AlignedNew.h"
+#include "CyclicWireFormat.h"
+
+namespace k_api = Kinova::Api;
+
+//Actuator feedback as a structure of arrays: one lane per actuator, 8 lanes so a field is one 256 bit vector.
+//Lanes past nCount stay at zero.
+struct tFlatActuatorFeedback
+{
+    int nCount;
+
+    alignas(32) float position[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float velocity[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float torque[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float currentMotor[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float voltage[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float temperatureMotor[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float temperatureCore[CyclicWire::MAX_ACTUATORS];
+
+    alignas(32) uint32_t commandId[CyclicWire::MAX_ACTUATORS];
+    alignas(32) uint32_t statusFlags[CyclicWire::MAX_ACTUATORS];
+    alignas(32) uint32_t jitterComm[CyclicWire::MAX_ACTUATORS];
+    alignas(32) uint32_t faultBankA[CyclicWire::MAX_ACTUATORS];
+    alignas(32) uint32_t faultBankB[CyclicWire::MAX_ACTUATORS];
+    alignas(32) uint32_t warningBankA[CyclicWire::MAX_ACTUATORS];
+    alignas(32) uint32_t warningBankB[CyclicWire::MAX_ACTUATORS];
+};
+
+//vectors are x, y, z and poses x, y, z, theta_x, theta_y, theta_z like in BaseFeedback
+struct tFlatBaseFeedback
+{
+    bool bPresent;
+    uint32_t activeStateConnectionIdentifier;
+    int32_t activeState;                //Common::ArmState
+    float armVoltage;
+    float armCurrent;
+    float temperatureCpu;
+    float temperatureAmbient;
+    float imuAcceleration[3];
+    float imuAngularVelocity[3];
+    float toolPose[6];
+    float toolTwistLinear[3];
+    float toolTwistAngular[3];
+    float toolExternalWrenchForce[3];
+    float toolExternalWrenchTorque[3];
+    uint32_t faultBankA;
+    uint32_t faultBankB;
+    uint32_t warningBankA;
+    uint32_t warningBankB;
+    float commandedToolPose[6];
+};
+
+struct tFlatGripperFeedback
+{
+    bool bPresent;
+    bool bHasFeedbackId;                //MessageId sub-message, sent even when empty
+    uint32_t feedbackId;
+    uint32_t statusFlags;
+    uint32_t faultBankA;
+    uint32_t faultBankB;
+    uint32_t warningBankA;
+    uint32_t warningBankB;
+
+    int nMotorCount;
+    uint32_t motorId[CyclicWire::MAX_GRIPPER_MOTORS];
+    float position[CyclicWire::MAX_GRIPPER_MOTORS];
+    float velocity[CyclicWire::MAX_GRIPPER_MOTORS];
+    float currentMotor[CyclicWire::MAX_GRIPPER_MOTORS];
+    float voltage[CyclicWire::MAX_GRIPPER_MOTORS];
+    float temperatureMotor[CyclicWire::MAX_GRIPPER_MOTORS];
+};
+
+struct tFlatInterconnectFeedback
+{
+    bool bPresent;
+    bool bHasFeedbackId;
+    uint32_t feedbackId;
+    uint32_t statusFlags;
+    uint32_t jitterComm;
+    float imuAcceleration[3];
+    float imuAngularVelocity[3];
+    float voltage;
+    float temperatureCore;
+    uint32_t faultBankA;
+    uint32_t faultBankB;
+    uint32_t warningBankA;
+    uint32_t warningBankB;
+
+    tFlatGripperFeedback gripper;
+};
+
+//BaseCyclic::Feedback decoded straight from the wire bytes, without building the protobuf tree and without allocating.
+//Plain old data: it can be copied with memcpy and kept on the stack of the cyclic thread.
+struct alignas(64) tFlatFeedback : public tAlignedNew<64>
+{
+    uint32_t frameId;
+    tFlatActuatorFeedback actuators;
+    tFlatBaseFeedback base;
+    tFlatInterconnectFeedback interconnect;
+
+    void Reset();
+
+    //Same result as Feedback::ParseFromString: unknown fields and fields with another wire type than their schema one
+    //(a uint32 sent as fixed32) are skipped, and a sub-message sent twice is merged. Returns false on malformed bytes or on more than MAX_ACTUATORS actuators /
+    //MAX_GRIPPER_MOTORS motors, the content is then undefined.
+    bool Decode(const uint8_t *data, size_t size);
+    bool Decode(const std::string &payload) {return Decode(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());}
+
+    //from and back to protobuf, for code using BaseCyclicClient and for logging. FromFeedback returns false when
+    //there are more actuators or gripper motors than lanes, the extra ones are dropped.
+    bool FromFeedback(const k_api::BaseCyclic::Feedback &feedback);
+    void ToFeedback(k_api::BaseCyclic::Feedback &feedback) const;
+};
+
+#endif
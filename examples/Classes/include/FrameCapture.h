@@ -0,0 +1,97 @@
+#ifndef KORTEXAPICPPEXAMPLE_FRAMECAPTURE_H
+#define KORTEXAPICPPEXAMPLE_FRAMECAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+//Capture file of the buffers a transport sent and received, written by RecordingTransport and read by ReplayTransport.
+//
+//    file header   magic "KRTXCAP1", uint32 version, uint32 max tx buffer size of the recorded transport
+//    records       uint32 size, uint8 direction, 3 bytes of padding, uint64 steady clock time in ns, then the bytes,
+//                  padded to 8
+//
+//in the byte order of the machine. The file is mapped in memory and grows by chunks of zeros: a record is complete once
+//its direction is set, so a capture cut by a crash is read up to its last complete record.
+namespace FrameCapture
+{
+    enum eDirection : uint8_t
+    {
+        NONE = 0,       //end of the records
+        TX = 1,         //sent by the router
+        RX = 2          //received by the router
+    };
+
+    struct tRecord
+    {
+        eDirection direction;
+        uint64_t timestamp_ns;
+        const char *pData;      //into the mapping of the reader, valid until it is closed
+        uint32_t size;
+    };
+
+    //Appends records to a new capture file, from any thread.
+    //Open() and Append() throw k_api::KBasicException on a file error.
+    class Writer
+    {
+    public:
+        static constexpr size_t CHUNK_SIZE = 16 * 1024 * 1024;
+
+        Writer();
+        ~Writer();
+
+        //truncates an existing file
+        void Open(const std::string &path, uint32_t maxTxBufferSize);
+        //the file is cut to its records
+        void Close();
+        bool IsOpen() const {return m_nFile >= 0;}
+
+        void Append(eDirection direction, const char *pData, uint32_t size);
+
+        uint64_t GetRecordCount() const {return m_nRecords;}
+        uint64_t GetSize() const {return m_nSize;}
+
+    private:
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        void Map(size_t capacity);
+
+        std::mutex m_Mutex;
+        int m_nFile;
+        char *m_pMapping;
+        size_t m_nCapacity;
+        size_t m_nSize;
+        uint64_t m_nRecords;
+    };
+
+    //Reads the records of a capture file in order. Open() throws k_api::KBasicException when the file cannot be read
+    //or is not a capture.
+    class Reader
+    {
+    public:
+        Reader();
+        ~Reader();
+
+        void Open(const std::string &path);
+        void Close();
+
+        uint32_t GetMaxTxBufferSize() const {return m_nMaxTxBufferSize;}
+
+        //false past the last record
+        bool Next(tRecord &record);
+        void Rewind();
+
+    private:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const char *m_pMapping;
+        size_t m_nSize;
+        size_t m_nOffset;
+        uint32_t m_nMaxTxBufferSize;
+    };
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef KORTEXAPICPPEXAMPLE_FRAMEHEADER_H
+#define KORTEXAPICPPEXAMPLE_FRAMEHEADER_H
+
+#include <cstdint>
+
+#include <HeaderInfo.h>
+
+namespace k_api = Kinova::Api;
+
+struct tFrameHeader
+{
+    k_api::FrameInfo frame;
+    k_api::MessageInfo message;
+    k_api::ServiceInfo service;
+};
+
+//Reads only the header of a serialized Frame, its first field, the payload is not parsed: for the transports and
+//servers that sort the frames going through them. False on malformed bytes or a header without frame info.
+bool ParseFrameHeader(const char *pData, uint32_t size, tFrameHeader &header);
+
+#endif
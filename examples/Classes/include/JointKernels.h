@@ -0,0 +1,110 @@
+#ifndef KORTEXAPICPPEXAMPLE_JOINTKERNELS_H
+#define KORTEXAPICPPEXAMPLE_JOINTKERNELS_H
+
+#include <BaseCyclicClientRpc.h>
+
+#include "AlignedNew.h"
+#include "CyclicWireFormat.h"
+#include "PreencodedCyclicCommand.h"
+
+namespace k_api = Kinova::Api;
+
+//A joint vector is an array of CyclicWire::MAX_ACTUATORS floats aligned on 32 bytes, one lane per actuator, like the
+//fields of tFlatActuatorFeedback. Lanes past the actuator count are computed too and must hold finite values (zeros).
+
+//per joint gains of a PD law, torque = kp * positionError - kd * velocity + feedforward
+struct tPdGains : public tAlignedNew<32>
+{
+    alignas(32) float kp[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float kd[CyclicWire::MAX_ACTUATORS];
+};
+
+//y += alpha * (x - y), alpha = 1 lets the input through
+struct tFirstOrderFilter : public tAlignedNew<32>
+{
+    alignas(32) float alpha[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float y[CyclicWire::MAX_ACTUATORS];
+
+    //same cutoff on every joint, the output starts at the given joint vector
+    void SetLowPass(float cutoff_hz, float sampleRate_hz, const float *initial);
+};
+
+//Biquad in transposed direct form II: y = b0 x + z1, z1 = b1 x - a1 y + z2, z2 = b2 x - a2 y
+struct tSecondOrderFilter : public tAlignedNew<32>
+{
+    alignas(32) float b0[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float b1[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float b2[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float a1[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float a2[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float z1[CyclicWire::MAX_ACTUATORS];
+    alignas(32) float z2[CyclicWire::MAX_ACTUATORS];
+
+    //Butterworth low pass for q = 0.7071 (RBJ cookbook), same on every joint. The state is set so a constant input
+    //equal to initial gives it back from the first step.
+    void SetLowPass(float cutoff_hz, float sampleRate_hz, float q, const float *initial);
+};
+
+//Control law building blocks over all the joints at once: SSE2 handles a joint vector as two 4 lane halves and AVX2
+//as one 8 lane register, the scalar versions are the reference and the fallback on other processors.
+//
+//The instruction set is picked at run time, the AVX2 kernels are compiled for it whatever the compiler flags of the
+//project. The kernels do the same operations in the same order whatever the instruction set (no fused multiply-add),
+//so they give the same results.
+//
+//Each call handles one cycle of every joint, in and out pointers can be the same joint vector.
+class JointKernels
+{
+public:
+    enum eIsa
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    static bool IsSupported(eIsa isa);
+    static eIsa GetBestIsa();
+    static const char* GetIsaName(eIsa isa);
+
+    //falls back on the best supported instruction set if isa is not
+    JointKernels(eIsa isa = GetBestIsa());
+
+    eIsa GetIsa() const {return m_eIsa;}
+
+    //target - position, wrapped in [-180, 180] since actuator positions are reported in [0, 360[ degrees
+    void PositionError(const float *target, const float *position, float *error) const {m_pPositionError(target, position, error);}
+
+    //kp * positionError - kd * velocity + feedforward
+    void Pd(const tPdGains &gains, const float *positionError, const float *velocity, const float *feedforward, float *out) const
+    {
+        m_pPd(gains, positionError, velocity, feedforward, out);
+    }
+
+    //x clamped to [low, high], in place
+    void Saturate(const float *low, const float *high, float *x) const {m_pSaturate(low, high, x);}
+
+    //x moved at most maxStep (>= 0) away from previous, in place
+    void RateLimit(const float *maxStep, const float *previous, float *x) const {m_pRateLimit(maxStep, previous, x);}
+
+    void Filter(tFirstOrderFilter &filter, const float *in, float *out) const {m_pFirstOrder(filter, in, out);}
+    void Filter(tSecondOrderFilter &filter, const float *in, float *out) const {m_pSecondOrder(filter, in, out);}
+
+    //joint vectors to the actuator fields of a command, the first count lanes
+    static void ToTorqueCommand(const float *torque, int count, PreencodedCyclicCommand &command);
+    static void ToPositionCommand(const float *position, int count, PreencodedCyclicCommand &command);
+    static void ToTorqueCommand(const float *torque, int count, k_api::BaseCyclic::Command &command);
+    static void ToPositionCommand(const float *position, int count, k_api::BaseCyclic::Command &command);
+
+private:
+    eIsa m_eIsa;
+
+    void (*m_pPositionError)(const float*, const float*, float*);
+    void (*m_pPd)(const tPdGains&, const float*, const float*, const float*, float*);
+    void (*m_pSaturate)(const float*, const float*, float*);
+    void (*m_pRateLimit)(const float*, const float*, float*);
+    void (*m_pFirstOrder)(tFirstOrderFilter&, const float*, float*);
+    void (*m_pSecondOrder)(tSecondOrderFilter&, const float*, float*);
+};
+
+#endif
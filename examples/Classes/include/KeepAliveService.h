@@ -0,0 +1,55 @@
+#ifndef KORTEXAPICPPEXAMPLE_KEEPALIVESERVICE_H
+#define KORTEXAPICPPEXAMPLE_KEEPALIVESERVICE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class SharedSessionManager;
+
+//One timer thread shared by every SharedSessionManager of the process.
+//Each session is checked once per window (a third of its connection inactivity timeout). A keepalive is only sent
+//when nothing went out on the session during the window, so a session carrying cyclic traffic never sends heartbeats.
+class KeepAliveService
+{
+public:
+    static KeepAliveService& Instance();
+
+    void Register(SharedSessionManager *pSession, uint32_t window_ms);
+    void Unregister(SharedSessionManager *pSession);
+
+    size_t GetSessionCount();
+    uint64_t GetKeepAliveSentCount() {return m_nKeepAliveSent;}
+    uint64_t GetKeepAliveSuppressedCount() {return m_nKeepAliveSuppressed;}
+
+private:
+    struct tRegistration
+    {
+        SharedSessionManager *pSession;
+        std::chrono::milliseconds window;
+        std::chrono::steady_clock::time_point nextDeadline;
+    };
+
+    KeepAliveService();
+    ~KeepAliveService();
+    KeepAliveService(const KeepAliveService&) = delete;
+    KeepAliveService& operator=(const KeepAliveService&) = delete;
+
+    void ThreadKeepAlive();
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::thread m_thread;
+    bool m_bIsRunning;
+
+    std::vector<tRegistration> m_Registrations;
+
+    std::atomic<uint64_t> m_nKeepAliveSent;
+    std::atomic<uint64_t> m_nKeepAliveSuppressed;
+};
+
+#endif
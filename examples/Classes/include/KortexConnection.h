@@ -0,0 +1,190 @@
+#ifndef KORTEXAPICPPEXAMPLE_KORTEXCONNECTION_H
+#define KORTEXAPICPPEXAMPLE_KORTEXCONNECTION_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+#include <RouterClient.h>
+#include <TransportClientTcp.h>
+#include <TransportClientUdp.h>
+
+#include <ActuatorConfigClientRpc.h>
+#include <ActuatorCyclicClientRpc.h>
+#include <BaseClientRpc.h>
+#include <BaseCyclicClientRpc.h>
+#include <ControlConfigClientRpc.h>
+#include <DeviceConfigClientRpc.h>
+#include <DeviceManagerClientRpc.h>
+#include <GripperCyclicClientRpc.h>
+#include <InterconnectConfigClientRpc.h>
+#include <InterconnectCyclicClientRpc.h>
+
+#include "LoopbackTransport.h"
+#include "MetricsTransport.h"
+#include "SharedSessionManager.h"
+#include "StartupTrace.h"
+#include "TracingTransport.h"
+
+namespace k_api = Kinova::Api;
+
+//service clients that KortexConnection can create, to be or'ed together
+enum eKortexClient
+{
+    KORTEX_CLIENT_BASE                = 1 << 0,
+    KORTEX_CLIENT_DEVICE_CONFIG       = 1 << 1,
+    KORTEX_CLIENT_DEVICE_MANAGER      = 1 << 2,
+    KORTEX_CLIENT_ACTUATOR_CONFIG     = 1 << 3,
+    KORTEX_CLIENT_CONTROL_CONFIG      = 1 << 4,
+    KORTEX_CLIENT_INTERCONNECT_CONFIG = 1 << 5,
+
+    //cyclic clients are created on the real-time (UDP) channel
+    KORTEX_CLIENT_BASE_CYCLIC         = 1 << 8,
+    KORTEX_CLIENT_ACTUATOR_CYCLIC     = 1 << 9,
+    KORTEX_CLIENT_INTERCONNECT_CYCLIC = 1 << 10,
+    KORTEX_CLIENT_GRIPPER_CYCLIC      = 1 << 11,
+};
+
+constexpr uint32_t KORTEX_CYCLIC_CLIENTS = KORTEX_CLIENT_BASE_CYCLIC | KORTEX_CLIENT_ACTUATOR_CYCLIC |
+                                           KORTEX_CLIENT_INTERCONNECT_CYCLIC | KORTEX_CLIENT_GRIPPER_CYCLIC;
+
+//clients of the real-time (UDP) channel
+template <class Client> struct tKortexRealTimeClient {static constexpr bool value = false;};
+template <> struct tKortexRealTimeClient<k_api::BaseCyclic::BaseCyclicClient> {static constexpr bool value = true;};
+template <> struct tKortexRealTimeClient<k_api::ActuatorCyclic::ActuatorCyclicClient> {static constexpr bool value = true;};
+template <> struct tKortexRealTimeClient<k_api::InterconnectCyclic::InterconnectCyclicClient> {static constexpr bool value = true;};
+template <> struct tKortexRealTimeClient<k_api::GripperCyclic::GripperCyclicClient> {static constexpr bool value = true;};
+
+//wall time spent in every phase of the bring-up, the two channels are opened in parallel
+struct tStartupTiming
+{
+    //clients is the construction of those created so far, on first use, and is not part of total
+    std::chrono::microseconds tcpConnect;
+    std::chrono::microseconds tcpSession;
+    std::chrono::microseconds udpConnect;
+    std::chrono::microseconds udpSession;
+    std::chrono::microseconds clients;
+    std::chrono::microseconds total;
+
+    std::string ToString() const;
+};
+
+struct tConnectionSettings
+{
+    std::string IP;
+    uint32_t port;
+    uint32_t portRealTime;
+    std::string username;
+    std::string password;
+    uint32_t sessionInactivityTimeout;     //(milliseconds)
+    uint32_t connectionInactivityTimeout;  //(milliseconds)
+    ILoopbackServer *pLoopbackServer;      //when set, both channels are LoopbackTransports to it instead of sockets
+    bool bRpcMetrics;                      //counts the RPCs of both channels in MetricsTransports, see GetRpcMetrics()
+
+    tConnectionSettings(const std::string &ip = "192.168.1.10"): IP(ip), port(10000), portRealTime(10001),
+        username("admin"), password("admin"), sessionInactivityTimeout(60000), connectionInactivityTimeout(2000),
+        pLoopbackServer(nullptr), bRpcMetrics(false) {};
+};
+
+//Owns the TCP and UDP transports, routers, sessions and service clients of one arm.
+//The two channels (connect + CreateSession) are brought up concurrently, the UDP one only when a cyclic client is requested.
+//Create() throws k_api::KBasicException (or the KDetailedException of the session) when the arm cannot be reached.
+//With tConnectionSettings::pLoopbackServer set (a SimulatedRobot), everything runs in process, without the network.
+//
+//Service clients are created on first use, from any thread, by templates of this header: a tool only links the client
+//stubs and the .pb.cc of the services it gets, and only pays for their static initialization and construction. A tool
+//calling GetDeviceManager() alone does not link Base, by far the largest service. The phases are recorded in the
+//StartupTrace when it is enabled.
+class KortexConnection
+{
+public:
+    static std::unique_ptr<KortexConnection> Create(const tConnectionSettings &settings, uint32_t clients);
+    ~KortexConnection();
+
+    tStartupTiming GetStartupTiming() const;
+
+    k_api::RouterClient* GetRouter() {return m_pRouter;}
+    k_api::RouterClient* GetRouterRealTime() {return m_pRouterRealTime;}
+
+    //counters of the RPCs of both channels, "tcp" and "udp", empty without tConnectionSettings::bRpcMetrics
+    std::vector<tRpcMetrics> GetRpcMetrics();
+
+    //nullptr when the client was not requested
+    k_api::Base::BaseClient* GetBase() {return GetRequested<k_api::Base::BaseClient>(KORTEX_CLIENT_BASE);}
+    k_api::DeviceConfig::DeviceConfigClient* GetDeviceConfig() {return GetRequested<k_api::DeviceConfig::DeviceConfigClient>(KORTEX_CLIENT_DEVICE_CONFIG);}
+    k_api::DeviceManager::DeviceManagerClient* GetDeviceManager() {return GetRequested<k_api::DeviceManager::DeviceManagerClient>(KORTEX_CLIENT_DEVICE_MANAGER);}
+    k_api::ActuatorConfig::ActuatorConfigClient* GetActuatorConfig() {return GetRequested<k_api::ActuatorConfig::ActuatorConfigClient>(KORTEX_CLIENT_ACTUATOR_CONFIG);}
+    k_api::ControlConfig::ControlConfigClient* GetControlConfig() {return GetRequested<k_api::ControlConfig::ControlConfigClient>(KORTEX_CLIENT_CONTROL_CONFIG);}
+    k_api::InterconnectConfig::InterconnectConfigClient* GetInterconnectConfig() {return GetRequested<k_api::InterconnectConfig::InterconnectConfigClient>(KORTEX_CLIENT_INTERCONNECT_CONFIG);}
+    k_api::BaseCyclic::BaseCyclicClient* GetBaseCyclic() {return GetRequested<k_api::BaseCyclic::BaseCyclicClient>(KORTEX_CLIENT_BASE_CYCLIC);}
+    k_api::ActuatorCyclic::ActuatorCyclicClient* GetActuatorCyclic() {return GetRequested<k_api::ActuatorCyclic::ActuatorCyclicClient>(KORTEX_CLIENT_ACTUATOR_CYCLIC);}
+    k_api::InterconnectCyclic::InterconnectCyclicClient* GetInterconnectCyclic() {return GetRequested<k_api::InterconnectCyclic::InterconnectCyclicClient>(KORTEX_CLIENT_INTERCONNECT_CYCLIC);}
+    k_api::GripperCyclic::GripperCyclicClient* GetGripperCyclic() {return GetRequested<k_api::GripperCyclic::GripperCyclicClient>(KORTEX_CLIENT_GRIPPER_CYCLIC);}
+
+    //any service client, Test or VisionConfig for example, on the channel of its service;
+    //nullptr for a cyclic client when no cyclic client was requested
+    template <class Client>
+    Client* GetClient()
+    {
+        k_api::RouterClient *pRouter = tKortexRealTimeClient<Client>::value ? m_pRouterRealTime : m_pRouter;
+        if (pRouter == nullptr)
+        {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(m_ClientMutex);
+        std::shared_ptr<void> &pClient = m_Clients[std::type_index(typeid(Client))];
+        if (!pClient)
+        {
+            auto start = std::chrono::steady_clock::now();
+            pClient = std::make_shared<Client>(pRouter);
+            auto end = std::chrono::steady_clock::now();
+            m_Timing.clients += std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            StartupTrace::Record(std::string("client ") + typeid(Client).name(), start, end);
+        }
+        return static_cast<Client*>(pClient.get());
+    }
+
+private:
+    KortexConnection(const tConnectionSettings &settings);
+    KortexConnection(const KortexConnection&) = delete;
+    KortexConnection& operator=(const KortexConnection&) = delete;
+
+    void Connect(uint32_t clients);
+    //the transport of a router: pTransport under a MetricsTransport with bRpcMetrics, and a TracingTransport with
+    //KORTEX_TRACE
+    k_api::ITransportClient* Decorate(k_api::ITransportClient *pTransport, const std::string &channel,
+                                      MetricsTransport **ppMetrics);
+    void OpenChannel(k_api::ITransportClient *pTransport, k_api::RouterClient *pRouter, uint32_t port,
+                     SharedSessionManager **ppSessionManager,
+                     std::chrono::microseconds &connectTime, std::chrono::microseconds &sessionTime);
+    template <class Client>
+    Client* GetRequested(uint32_t client)
+    {
+        return (m_nClients & client) ? GetClient<Client>() : nullptr;
+    }
+
+    tConnectionSettings m_Settings;
+    uint32_t m_nClients;
+
+    k_api::ITransportClient *m_pTransport;
+    k_api::ITransportClient *m_pTransportRealTime;
+    std::vector<std::unique_ptr<k_api::ITransportClient>> m_Decorators;
+    MetricsTransport *m_pMetrics;
+    MetricsTransport *m_pMetricsRealTime;
+    k_api::RouterClient *m_pRouter;
+    k_api::RouterClient *m_pRouterRealTime;
+    SharedSessionManager *m_pSessionManager;
+    SharedSessionManager *m_pSessionManagerRealTime;
+
+    //the clients created so far and the timing, which their creation updates
+    mutable std::mutex m_ClientMutex;
+    tStartupTiming m_Timing;
+    std::map<std::type_index, std::shared_ptr<void>> m_Clients;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef KORTEXAPICPPEXAMPLE_KORTEXFUNCTIONNAMES_H
+#define KORTEXAPICPPEXAMPLE_KORTEXFUNCTIONNAMES_H
+
+#include <cstdint>
+
+//"Base.GetArmState" for a function UID of the FunctionUids enums of the client stubs (RPCs and notification topics),
+//nullptr for one they do not have. The UID is the 28 low bits of ServiceInfo: service id << 16 | function id.
+const char* GetKortexFunctionName(uint32_t functionUid);
+
+#endif
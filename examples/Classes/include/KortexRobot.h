@@ -1,6 +1,16 @@
 #ifndef KORTEXAPICPPEXAMPLE_KORTEXROBOT_H
 #define KORTEXAPICPPEXAMPLE_KORTEXROBOT_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+
 #include <KDetailedException.h>
 #include <KError.h>
 
@@ -42,9 +52,25 @@ struct tCartesianVector
     }
 };
 
+//completion of an action sent by KortexRobot, driven by its ActionTopic notifications
+struct tActionCompletion
+{
+    std::shared_future<void> started;                       //ACTION_START, or the end of an action that did not start
+    std::shared_future<k_api::Base::ActionEvent> finished;  //ACTION_END or ACTION_ABORT, UNSPECIFIED_ACTION_EVENT when the
+                                                            //action was not sent or the robot was disconnected
+};
+
 class KortexRobot
 {
 public:
+    //the motion of the robot as seen from its ActionTopic notifications
+    enum eMotionState
+    {
+        IDLE,
+        ACTION_SENT,    //until its ACTION_START
+        MOVING,
+        PAUSED
+    };
 
     KortexRobot(const std::string &IP);
     ~KortexRobot();
@@ -56,10 +82,13 @@ public:
     void subscribeToNotification();
     void unsubscribeToNotification();
 
-    //movement
-    bool ExecuteExistingAction(const std::string &actionName, k_api::Base::RequestedActionType &actionType);
-    bool MoveTo(const tCartesianVector &position, const tCartesianVector &orientation, const k_api::Base::CartesianTrajectoryConstraint &constraint);
-    bool SetJointAngles(const std::vector<float> &angles, const k_api::Base::JointTrajectoryConstraint &J_constraint);
+    //Movement, the actions return as soon as they are sent (subscribing to the notifications if not done yet), the next
+    //one can be sent when the finished future of the previous one is ready. The events are matched to the action by its
+    //handle: a paused action replaced by a new one finishes with the ACTION_ABORT the robot sends for it.
+    tActionCompletion ExecuteExistingAction(const std::string &actionName, k_api::Base::RequestedActionType &actionType);
+    tActionCompletion MoveTo(const tCartesianVector &position, const tCartesianVector &orientation, const k_api::Base::CartesianTrajectoryConstraint &constraint);
+    tActionCompletion SetJointAngles(const std::vector<float> &angles, const k_api::Base::JointTrajectoryConstraint &J_constraint);
+    //not an action: no notification, the twist is applied until Stop() or the next command
     bool SendTwistCommand(const tCartesianVector &translation, const tCartesianVector &rotation);
     bool SetTwistReferenceFrame(const k_api::Common::CartesianReferenceFrame &frame);
     bool SetJointSpeeds(std::vector<float> &JointSpeeds);
@@ -70,10 +99,24 @@ public:
     }
 
     bool PlaySequence(const k_api::Base::SequenceHandle &sequenceHandle);
-    bool ExecuteAction(const k_api::Base::Action &action);
+    tActionCompletion ExecuteAction(const k_api::Base::Action &action);
+
+    eMotionState GetMotionState() const {return m_State;}
+    bool IsBusy() const
+    {
+        eMotionState state = m_State;
+        return state == ACTION_SENT || state == MOVING;
+    }
 
     //nessesary for proerly using the above functions
+    //Wait until the robot is not busy anymore, woken by the ACTION_END, ACTION_ABORT or ACTION_PAUSE notification.
+    //False at the deadline, or when not connected. The timeout is in milliseconds.
     bool WaitWhileRobotIsMoving(const int timeout);
+    bool WaitWhileRobotIsMoving(const std::chrono::steady_clock::time_point &deadline);
+    //the index of the first robot of the list not busy, -1 at the deadline
+    static int WaitAny(const std::vector<KortexRobot*> &robots, const std::chrono::steady_clock::time_point &deadline);
+    //true when none of the robots is busy, false at the deadline
+    static bool WaitAll(const std::vector<KortexRobot*> &robots, const std::chrono::steady_clock::time_point &deadline);
     bool Stop();
     
 
@@ -84,12 +127,33 @@ public:
     //void OnActionNotificationCallback(Kinova::Api::Base::ActionNotification &notif);
 
 protected:
+    //an action sent, until its ACTION_END or ACTION_ABORT
+    struct tPendingAction
+    {
+        k_api::Base::ActionHandle handle;   //identifier 0 until its ACTION_START for a new action, the robot gives it one
+        uint64_t nSent;
+        std::promise<void> started;
+        std::promise<k_api::Base::ActionEvent> finished;
+        bool bStarted;
+    };
+
     void OnError(Kinova::Api::KDetailedException &ex);
     void OnActionNotificationCallback(Kinova::Api::Base::ActionNotification &notif);
 
+    //the promises are armed before the RPC, its notifications can come before its response
+    tActionCompletion SendAction(const k_api::Base::ActionHandle &handle, const std::function<void()> &send);
+    //the pending action an event is about, m_ActionMutex is held
+    std::list<tPendingAction>::iterator FindPendingAction(const k_api::Base::ActionHandle &handle);
+    static void CompleteAction(tPendingAction &pending, k_api::Base::ActionEvent event);
+    //completes them all and sets the robot idle, m_ActionMutex is taken
+    void CompletePendingActions(k_api::Base::ActionEvent event);
+    static tActionCompletion RejectedAction();
+    //m_ActionMutex is held, the state follows the pending action
+    void SetMotionState(eMotionState state);
+
 protected:
     int m_NbDOF;
-    bool m_bIsBusy;   //whether the robot is avaliable to receive an action
+    std::atomic<eMotionState> m_State;  //written under s_StateMutex, whether the robot is avaliable to receive an action
     k_api::Base::Action m_Action;  //internal action that being modified to send all the defined actions
     k_api::ControlConfig::ControlConfigClient *m_pControlConfigClient; //contains the information about how the robot behaves in various control modes
 
@@ -99,6 +163,15 @@ protected:
    
     std::vector<Kinova::Api::Common::NotificationHandle> m_NotificationHandleList; //the subcribed lists
 
+    std::mutex m_ActionMutex;   //taken before s_StateMutex
+    std::list<tPendingAction> m_PendingActions;     //the last one sent at the back
+    uint64_t m_nActionsSent;
+    std::deque<uint32_t> m_CompletedActions;    //identifiers of the last actions ended or aborted, the oldest first
+
+    //shared by all the robots so that WaitAny can wait for several of them
+    static std::mutex s_StateMutex;
+    static std::condition_variable s_StateChanged;
+
     //p means pointer
     Kinova::Api::TransportClientTcp *m_pTcpClient;
     Kinova::Api::RouterClient *m_pRouterClient;
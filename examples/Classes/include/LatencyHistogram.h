@@ -0,0 +1,81 @@
+#ifndef KORTEXAPICPPEXAMPLE_LATENCYHISTOGRAM_H
+#define KORTEXAPICPPEXAMPLE_LATENCYHISTOGRAM_H
+
+#include <cstdint>
+#include <string>
+
+//Fixed size log-linear histogram of durations in nanoseconds (HDR style: 16 linear sub-buckets per power of two, ~6% precision).
+//Recording never allocates. It is not thread safe: record from one thread and copy the histogram to read it elsewhere.
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_MAGNITUDE = 40;  //values of 2^41 ns (~37 minutes) and above are clamped in the last bucket
+    static constexpr int BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT;
+
+    LatencyHistogram();
+
+    void Record(uint64_t value_ns)
+    {
+        m_Counts[BucketIndex(value_ns)]++;
+        m_nCount++;
+        m_nSum += value_ns;
+        if (value_ns < m_nMin) m_nMin = value_ns;
+        if (value_ns > m_nMax) m_nMax = value_ns;
+    }
+
+    void Reset();
+    void Add(const LatencyHistogram &other);
+
+    uint64_t GetCount() const {return m_nCount;}
+    uint64_t GetMin() const {return m_nCount ? m_nMin : 0;}
+    uint64_t GetMax() const {return m_nMax;}
+    double GetMean() const {return m_nCount ? double(m_nSum) / m_nCount : 0.0;}
+    uint64_t GetPercentile(double percentile) const;  //percentile in [0, 100], upper bound of the bucket
+
+    uint64_t GetBucketCount(int index) const {return m_Counts[index];}
+    static uint64_t BucketUpperBound(int index);
+
+    //one line summary in microseconds: count, min, mean, p50, p99, p99.9, max
+    std::string ToString() const;
+
+    static int BucketIndex(uint64_t value_ns)
+    {
+        if (value_ns < SUB_BUCKET_COUNT)
+        {
+            return int(value_ns);
+        }
+        int magnitude = 63 - CountLeadingZeros(value_ns);
+        if (magnitude > MAX_MAGNITUDE)
+        {
+            return BUCKET_COUNT - 1;
+        }
+        int subBucket = int(value_ns >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+        return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+    }
+
+private:
+    static int CountLeadingZeros(uint64_t value)
+    {
+#if defined(__GNUC__)
+        return __builtin_clzll(value);
+#else
+        int count = 0;
+        while (!(value & (uint64_t(1) << 63)))
+        {
+            value <<= 1;
+            count++;
+        }
+        return count;
+#endif
+    }
+
+    uint64_t m_Counts[BUCKET_COUNT];
+    uint64_t m_nCount;
+    uint64_t m_nSum;
+    uint64_t m_nMin;
+    uint64_t m_nMax;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef KORTEXAPICPPEXAMPLE_LOOPBACKTRANSPORT_H
+#define KORTEXAPICPPEXAMPLE_LOOPBACKTRANSPORT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Frame.pb.h>
+#include <ITransportClient.h>
+
+namespace k_api = Kinova::Api;
+
+class LoopbackTransport;
+
+//The far end of LoopbackTransports: gets the frames the routers send and answers through LoopbackTransport::Deliver,
+//with any number of frames and from any thread (notifications).
+class ILoopbackServer
+{
+public:
+    virtual ~ILoopbackServer() {}
+
+    //called from the worker thread of pTransport, one frame at a time for a given transport
+    virtual void OnFrame(const k_api::Frame &frame, LoopbackTransport *pTransport) = 0;
+
+    //pTransport is disconnecting, nothing must be delivered to it after this returns
+    virtual void OnDisconnect(LoopbackTransport *pTransport) = 0;
+};
+
+//ITransportClient handing the frames of a RouterClient to an ILoopbackServer in the same process, in place of
+//TransportClientTcp or TransportClientUdp. No socket and no serialization beyond the one of the router: every service
+//client, the routers and the cyclic paths run at full speed against a simulated robot.
+//
+//Like the socket transports, frames are handled and answers are delivered to the router in a thread of the transport,
+//never in the thread calling send(). The host and port given to connect() are only kept for getHostAddress().
+class LoopbackTransport : public k_api::ITransportClient
+{
+public:
+    //same limit as a UDP datagram
+    static constexpr size_t MAX_FRAME_SIZE = 65507;
+
+    LoopbackTransport(ILoopbackServer *pServer);
+    virtual ~LoopbackTransport();
+
+    virtual bool connect(std::string host, uint32_t port) override;
+    virtual void disconnect() override;
+
+    virtual void send(const char *txBuffer, uint32_t txSize) override;
+    virtual void onMessage(std::function<void (const char*, uint32_t)> callback) override;
+
+    virtual char* getTxBuffer(uint32_t const &allocation_size) override;
+    virtual size_t getMaxTxBufferSize() override {return MAX_FRAME_SIZE;}
+
+    virtual void getHostAddress(std::string &host, uint32_t &port) override;
+
+    //server side: the frame is queued for the router, dropped when the transport is not connected
+    void Deliver(const k_api::Frame &frame);
+
+    //frames sent and delivered since connect()
+    uint64_t GetSentCount() const {return m_nSent;}
+    uint64_t GetDeliveredCount() const {return m_nDelivered;}
+
+private:
+    LoopbackTransport(const LoopbackTransport&) = delete;
+    LoopbackTransport& operator=(const LoopbackTransport&) = delete;
+
+    struct tItem
+    {
+        bool bFromRouter;   //a frame to hand to the server, otherwise an answer for the router
+        std::string bytes;
+    };
+
+    std::string TakeBuffer();
+    void Push(bool bFromRouter, std::string &bytes);
+    void Run();
+
+    ILoopbackServer *m_pServer;
+    std::string m_Host;
+    uint32_t m_nPort;
+
+    std::vector<char> m_TxBuffer;
+    std::mutex m_CallbackMutex;
+    std::function<void (const char*, uint32_t)> m_Callback;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::deque<tItem> m_Queue;
+    std::vector<std::string> m_FreeBuffers;    //bytes of handled items, reused so a steady flow does not allocate
+    bool m_bStop;
+    std::thread m_Worker;
+
+    std::atomic<uint64_t> m_nSent;
+    std::atomic<uint64_t> m_nDelivered;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef KORTEXAPICPPEXAMPLE_METRICSTRANSPORT_H
+#define KORTEXAPICPPEXAMPLE_METRICSTRANSPORT_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ITransportClient.h>
+
+#include "LatencyHistogram.h"
+
+namespace k_api = Kinova::Api;
+
+//counters of one function UID on one device, requests and their responses, or notifications of a topic
+struct tRpcMetrics
+{
+    std::string channel;
+    uint32_t functionUid;
+    uint32_t deviceId;
+    std::string name;           //"Base.GetArmState", the UID in hexadecimal when the stubs do not have it
+
+    uint64_t nCalls;
+    uint64_t nResponses;
+    uint64_t nServerErrors;     //responses with an error code
+    uint64_t nTimeouts;         //requests left without a response for the timeout of the transport
+    uint64_t nLateResponses;    //responses to a request already counted as timed out, or to no request
+    uint64_t nNotifications;
+    uint64_t nTxBytes;
+    uint64_t nRxBytes;
+    uint64_t nInFlight;
+    LatencyHistogram latency;   //request sent to response received
+};
+
+//ITransportClient decorator counting the frames of the wrapped transport per function UID and device id: calls,
+//bytes sent and received, latency, server errors, timeouts and requests in flight. It is the transport of a
+//RouterClient, which has no counters of its own:
+//
+//    k_api::TransportClientTcp tcp;
+//    MetricsTransport metrics(&tcp, "tcp");
+//    k_api::RouterClient router(&metrics, errorCallback);
+//    ...
+//    MetricsTransport::WritePrometheusFile("/var/lib/node_exporter/kortex.prom", metrics.GetSnapshot());
+//
+//A response is matched to its request by message id and function UID. The router does not tell the transport the
+//timeout of a call: a request is counted as timed out once it has waited timeout_ms, 3000 by default like the
+//stubs. A call sent andForget that the server does not answer is counted so too. Counting costs the parse of the
+//frame header and a lookup under a mutex shared by both directions.
+class MetricsTransport : public k_api::ITransportClient
+{
+public:
+    MetricsTransport(k_api::ITransportClient *pTransport, const std::string &channel = "tcp", uint32_t timeout_ms = 3000);
+    virtual ~MetricsTransport() {}
+
+    virtual bool connect(std::string host, uint32_t port) override;
+    virtual void disconnect() override;
+
+    virtual void send(const char *txBuffer, uint32_t txSize) override;
+    virtual void onMessage(std::function<void (const char*, uint32_t)> callback) override;
+
+    virtual char* getTxBuffer(uint32_t const &allocation_size) override;
+    virtual size_t getMaxTxBufferSize() override;
+
+    virtual void getHostAddress(std::string &host, uint32_t &port) override;
+
+    //copy of the counters, the largest bytes sent and received first
+    std::vector<tRpcMetrics> GetSnapshot();
+    //frames which are not Kortex frames
+    uint64_t GetMalformedCount();
+    void Reset();
+
+    //Prometheus text exposition format, metrics kortex_rpc_*, labels channel, function, uid and device
+    static std::string ToPrometheus(const std::vector<tRpcMetrics> &metrics);
+    //for the textfile collector of node_exporter: written next to path then renamed, false on a file error
+    static bool WritePrometheusFile(const std::string &path, const std::vector<tRpcMetrics> &metrics);
+
+private:
+    MetricsTransport(const MetricsTransport&) = delete;
+    MetricsTransport& operator=(const MetricsTransport&) = delete;
+
+    struct tPending
+    {
+        tRpcMetrics *pMetrics;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void Count(bool bTx, const char *pData, uint32_t size);
+    tRpcMetrics& GetMetrics(uint32_t functionUid, uint32_t deviceId);
+    //counts the requests which waited longer than the timeout
+    void Expire(std::chrono::steady_clock::time_point now);
+
+    k_api::ITransportClient *m_pTransport;
+    const std::string m_Channel;
+    const std::chrono::milliseconds m_Timeout;
+
+    std::mutex m_Mutex;
+    std::unordered_map<uint64_t, std::unique_ptr<tRpcMetrics>> m_Metrics;     //by function UID and device id
+    std::unordered_map<uint64_t, tPending> m_Pending;                         //by message id and function UID
+    std::chrono::steady_clock::time_point m_LastExpire;
+    uint64_t m_nMalformed;
+};
+
+#endif
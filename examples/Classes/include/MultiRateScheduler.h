@@ -0,0 +1,96 @@
+#ifndef KORTEXAPICPPEXAMPLE_MULTIRATESCHEDULER_H
+#define KORTEXAPICPPEXAMPLE_MULTIRATESCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+
+#include "CyclicExecutor.h"
+#include "FeedbackMirror.h"
+#include "LatencyHistogram.h"
+
+namespace k_api = Kinova::Api;
+
+struct tTaskStatistics
+{
+    std::string name;
+    std::chrono::microseconds period;
+    uint64_t nRuns;
+    uint64_t nSkippedReleases;  //background tasks only, releases missed because a run lasted too long
+    LatencyHistogram duration;
+};
+
+//Rate-monotonic scheduling of several control rates on the single BaseCyclic loop of a CyclicExecutor.
+//
+//Cyclic tasks run in the cyclic thread, every period/base period ticks, faster tasks first. They all fill the same
+//BaseCyclic::Command, so a 100 Hz gripper task writes interconnect().gripper_command() and rides on the 1 kHz arm
+//frames without a round trip of its own; between two of its runs the robot keeps getting its last values. Tasks of
+//the same lower rate are put on different ticks, so they do not pile up on one cycle.
+//
+//Background tasks (telemetry, Get* RPCs on the TCP clients) run in a thread of their own with the latest feedback
+//snapshot, they never delay the cyclic thread and the cyclic router. They are not run before the first feedback.
+class MultiRateScheduler
+{
+public:
+    //return false to leave the loop
+    typedef std::function<bool(const k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command&)> CyclicTask;
+    typedef std::function<void(const tFlatFeedback&)> BackgroundTask;
+
+    MultiRateScheduler(CyclicExecutor *pExecutor);
+
+    //The period must be a multiple of the executor period. Returns the task index for GetTaskStatistics(), -1 if the
+    //period does not fit. Tasks cannot be added while Run() is going.
+    int AddCyclicTask(const std::string &name, std::chrono::microseconds period, const CyclicTask &task);
+    int AddBackgroundTask(const std::string &name, std::chrono::microseconds period, const BackgroundTask &task);
+
+    //CyclicExecutor::Run with the cyclic tasks as tick, the background thread lives for the duration of the call.
+    //maxTicks counts the ticks of this call and the phases start again at tick 0, the task statistics add up.
+    void Run(k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command, uint64_t maxTicks = 0);
+    //any thread or task, same as CyclicExecutor::Stop()
+    void Stop();
+
+    int GetTaskCount() const {return int(m_Tasks.size());}
+    //only read it once Run() returned
+    const tTaskStatistics& GetTaskStatistics(int task) const {return m_Tasks[task]->statistics;}
+
+    //one line per task, in the order they run
+    std::string ToString() const;
+
+private:
+    struct tTask
+    {
+        CyclicTask cyclic;
+        BackgroundTask background;
+        uint64_t nDivider;  //cyclic: runs when tick % nDivider == nPhase
+        uint64_t nPhase;
+        tTaskStatistics statistics;
+    };
+
+    bool Tick(const k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command);
+    void RunBackgroundTasks();
+    void AssignPhases();
+
+    CyclicExecutor *m_pExecutor;
+    std::unique_ptr<FeedbackMirror> m_pMirror;
+    FeedbackMirror *m_pActiveMirror;     //the executor's one during Run(), or m_pMirror if it had none
+                                        //(a new one at each Run, not to give the background tasks an old feedback)
+
+    //in the order added, the two lists below are sorted by period (rate-monotonic order)
+    std::vector<std::unique_ptr<tTask>> m_Tasks;
+    std::vector<tTask*> m_CyclicTasks;
+    std::vector<tTask*> m_BackgroundTasks;
+    uint64_t m_nTick;
+
+    std::mutex m_StopMutex;
+    std::condition_variable m_StopCondition;
+    bool m_bStopBackground;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef KORTEXAPICPPEXAMPLE_NOTIFICATIONDISPATCHER_H
+#define KORTEXAPICPPEXAMPLE_NOTIFICATIONDISPATCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <google/protobuf/message.h>
+
+#include <Common.pb.h>
+#include <Frame.pb.h>
+#include <IRouterClient.h>
+
+namespace k_api = Kinova::Api;
+
+//Dispatches the notifications of one service of a router to typed callbacks, with a choice of threads, in place of the
+//NotificationHandler of the generated clients, which starts a detached thread per notification and callback:
+//
+//    NotificationDispatcher dispatcher(router, k_api::eIdBase, NotificationDispatcher::QUEUE);
+//    auto handle = dispatcher.Subscribe<k_api::Base::ActionNotification>(k_api::Base::eUidActionTopic, options,
+//        [](const k_api::Base::ActionNotification &notification) {...});
+//    ...
+//    base->Unsubscribe(handle);
+//    dispatcher.RemoveCallbacks(k_api::Base::eUidActionTopic);
+//
+//    INLINE   in the receive thread of the router: lowest latency, but a callback must neither block nor wait for an
+//             answer of the same router
+//    QUEUE    one worker thread, in arrival order
+//    SHARDED  nThreads workers, the notifications of a topic always on the same one: in order per topic
+//
+//The router keeps one notification callback per service and the generated clients register theirs when constructed:
+//create the dispatcher after the service client, then subscribe through it, not through the OnNotification*Topic
+//methods of the client. The callbacks of a topic may be changed from
+//any thread, including from a callback.
+class NotificationDispatcher
+{
+public:
+    enum eStrategy
+    {
+        INLINE,
+        QUEUE,
+        SHARDED
+    };
+
+    struct tStatistics
+    {
+        uint64_t nReceived;
+        uint64_t nDispatched;       //to at least one callback
+        uint64_t nDropped;          //no callback for the topic, or the payload could not be decoded
+        size_t nMaxQueueDepth;      //of a worker
+    };
+
+    NotificationDispatcher(k_api::IRouterClient *pRouter, uint32_t serviceId, eStrategy strategy, int nThreads = 1);
+    ~NotificationDispatcher();
+
+    //Adds the callback and subscribes with the topic RPC (the function uid of the OnNotification*Topic method, its
+    //options message). The callback is added first, the robot may notify before the RPC answer is back, and removed
+    //again if the RPC throws: k_api::KDetailedException when it fails and k_api::KBasicException when it times out.
+    template <class Notification>
+    k_api::Common::NotificationHandle Subscribe(uint32_t topicUid, const google::protobuf::Message &options,
+                                                const std::function<void(const Notification&)> &callback,
+                                                uint32_t deviceId = 0, uint32_t timeout_ms = 3000)
+    {
+        std::shared_ptr<const Handler> pHandler = AddHandler(topicUid, MakeHandler<Notification>(callback));
+        try
+        {
+            return SubscribeTopic(topicUid, options, deviceId, timeout_ms);
+        }
+        catch (...)
+        {
+            RemoveHandler(topicUid, pHandler);
+            throw;
+        }
+    }
+
+    //a callback for notifications already subscribed to
+    template <class Notification>
+    void AddCallback(uint32_t topicUid, const std::function<void(const Notification&)> &callback)
+    {
+        AddHandler(topicUid, MakeHandler<Notification>(callback));
+    }
+
+    void RemoveCallbacks(uint32_t topicUid);
+
+    tStatistics GetStatistics() const;
+
+private:
+    NotificationDispatcher(const NotificationDispatcher&) = delete;
+    NotificationDispatcher& operator=(const NotificationDispatcher&) = delete;
+
+    //false when the payload could not be decoded
+    typedef std::function<bool(const k_api::Frame&)> Handler;
+    //by pointer, so one handler can be found again and removed
+    typedef std::vector<std::shared_ptr<const Handler>> HandlerList;
+
+    template <class Notification>
+    static Handler MakeHandler(const std::function<void(const Notification&)> &callback)
+    {
+        return [callback](const k_api::Frame &frame)
+        {
+            Notification notification;
+            if (!notification.ParseFromString(frame.payload()))
+            {
+                return false;
+            }
+            callback(notification);
+            return true;
+        };
+    }
+
+    //shared with the callback registered on the router, which cannot be unregistered
+    struct tLink
+    {
+        std::mutex mutex;
+        NotificationDispatcher *pDispatcher;
+    };
+
+    struct tWorker
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<k_api::Frame> queue;
+        bool bStop;
+        std::thread thread;
+
+        tWorker(): bStop(false) {}
+    };
+
+    k_api::Common::NotificationHandle SubscribeTopic(uint32_t topicUid, const google::protobuf::Message &options,
+                                                     uint32_t deviceId, uint32_t timeout_ms);
+    std::shared_ptr<const Handler> AddHandler(uint32_t topicUid, const Handler &handler);
+    void RemoveHandler(uint32_t topicUid, const std::shared_ptr<const Handler> &pHandler);
+    void OnNotification(k_api::Frame &frame);
+    void Dispatch(const k_api::Frame &frame);
+    void RunWorker(tWorker *pWorker);
+
+    k_api::IRouterClient *m_pRouter;
+    const eStrategy m_eStrategy;
+    std::shared_ptr<tLink> m_pLink;
+
+    //copied on write, a dispatch holds the list it started with
+    mutable std::mutex m_HandlerMutex;
+    std::map<uint32_t, std::shared_ptr<const HandlerList>> m_Handlers;
+
+    std::vector<std::unique_ptr<tWorker>> m_Workers;
+
+    std::atomic<uint64_t> m_nReceived;
+    std::atomic<uint64_t> m_nDispatched;
+    std::atomic<uint64_t> m_nDropped;
+    std::atomic<size_t> m_nMaxQueueDepth;
+};
+
+#endif
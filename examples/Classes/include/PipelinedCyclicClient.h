@@ -0,0 +1,80 @@
+#ifndef KORTEXAPICPPEXAMPLE_PIPELINEDCYCLICCLIENT_H
+#define KORTEXAPICPPEXAMPLE_PIPELINEDCYCLICCLIENT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <BaseCyclicClientRpc.h>
+
+#include "CyclicSequencer.h"
+#include "FlatFeedback.h"
+#include "PreencodedCyclicCommand.h"
+#include "RefreshTiming.h"
+
+namespace k_api = Kinova::Api;
+
+struct tPipelineStatistics
+{
+    uint64_t nSent;
+    uint64_t nSendErrors;       //router refused the frame
+    uint64_t nReceived;         //first feedback of a frame in flight
+    uint64_t nErrorReplies;     //feedback frame with an error in its header
+    uint64_t nLost;             //no feedback before the frame id came around again
+    uint64_t nDecodeErrors;
+    tSequenceStatistics sequence;   //of the decoded feedbacks, only the in order ones are published
+
+    std::string ToString() const;
+};
+
+//BaseCyclic Refresh without waiting for the answer: Send() stamps the next frame and command ids on the pre-encoded
+//command and hands it to the router with a callback, so command N+1 can leave before feedback N is back. The feedbacks
+//are matched back by frame_id in the router thread and the newest one is published in a FeedbackMirror, the control
+//thread picks it up with GetLatestFeedback() and its tick costs compute time only, not the UDP round trip.
+//The ids come from a CyclicSequencer; at most PIPELINE_DEPTH frames are tracked in flight for the loss count and the
+//round trip times.
+class PipelinedCyclicClient
+{
+public:
+    static constexpr int PIPELINE_DEPTH = 16;
+
+    PipelinedCyclicClient(k_api::IRouterClient *pRouter, uint32_t deviceId = 0);
+
+    //layout and first values of the command, see PreencodedCyclicCommand::Init
+    bool Init(const k_api::BaseCyclic::Command &command);
+
+    //control thread only: fill it before Send(), the frame and command ids are set by Send()
+    PreencodedCyclicCommand& GetCommand() {return m_Command;}
+
+    //Sends the command with the next id and returns at once, false if the router refused it
+    bool Send();
+
+    //newest feedback received so far, false until the first one; any thread
+    bool GetLatestFeedback(tFlatFeedback &feedback, uint64_t *pReceiveTime_ns = nullptr) const;
+    uint64_t GetFeedbackVersion() const;
+
+    uint32_t GetLastSentFrameId() const;
+    uint32_t GetLatestReceivedFrameId() const;
+    int GetInFlightCount() const;
+
+    tPipelineStatistics GetStatistics() const;
+
+    //copy of the send to receive, decode and callback times of the matched feedbacks, any thread
+    void GetRefreshTiming(tRefreshTiming &snapshot) const;
+    void ResetRefreshTiming();
+
+private:
+    //Everything the router callbacks touch. They keep it alive with a shared_ptr: a feedback can still come back
+    //after the client is gone.
+    struct tSharedState;
+
+    k_api::IRouterClient *m_pRouter;
+    uint32_t m_nDeviceId;
+
+    //control thread
+    PreencodedCyclicCommand m_Command;
+
+    std::shared_ptr<tSharedState> m_pState;
+};
+
+#endif
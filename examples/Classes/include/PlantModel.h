@@ -0,0 +1,144 @@
+#ifndef KORTEXAPICPPEXAMPLE_PLANTMODEL_H
+#define KORTEXAPICPPEXAMPLE_PLANTMODEL_H
+
+#include <cstdint>
+#include <vector>
+
+#include <ActuatorCyclicClientRpc.h>
+#include <BaseCyclicClientRpc.h>
+
+#include "CyclicWireFormat.h"
+#include "FlatFeedback.h"
+
+namespace k_api = Kinova::Api;
+
+//Dynamics of one joint, angles in degrees like on the wire
+struct tJointDynamics
+{
+    float inertia;              //kg.m2 seen at the output
+    float damping;              //N.m per rad/s
+    float bandwidth_hz;         //of the position loop, critically damped
+    float velocityTimeConstant_s;   //of the velocity loop
+    float maxVelocity;          //deg/s
+    float maxAcceleration;      //deg/s2
+    float maxTorque;            //N.m
+    bool bContinuous;           //otherwise the position stays in [minPosition, maxPosition], both in [-180, 180]
+    float minPosition;
+    float maxPosition;
+    float torqueConstant;       //N.m at the output per A of motor current
+    float thermalTimeConstant_s;
+    float temperatureRise;      //degrees C per A2, at steady state
+
+    //Gen3 big (joints 1 to 4) and small (joints 5 to 7) actuators, continuous
+    static tJointDynamics BigActuator();
+    static tJointDynamics SmallActuator();
+};
+
+//Robotiq 2F-85 behind the interconnect, position and velocity in percent like MotorCommand
+struct tGripperDynamics
+{
+    float maxSpeed;             //percent of the stroke per second at a velocity of 100
+    float maxCurrent;           //A, drawn when squeezing at a force of 100
+    float idleCurrent;          //A, when moving or holding without an object
+    float objectPosition;       //where the fingers close on an object, 100 or more for none
+
+    tGripperDynamics(): maxSpeed(150.0f), maxCurrent(0.6f), idleCurrent(0.05f), objectPosition(100.0f) {}
+};
+
+struct tPlantSettings
+{
+    float period_s;             //advanced by each Step()
+    int nSubsteps;              //of the integration within a period
+    int nDelayTicks;            //periods between a command and its effect
+    float ambientTemperature;
+    tJointDynamics joints[CyclicWire::MAX_ACTUATORS];
+    tGripperDynamics gripper;
+
+    //a 7 DoF Gen3 at 1 kHz, with the position limits of joints 2, 4 and 6
+    tPlantSettings();
+};
+
+//Kinematic and first order dynamic model of the actuators and of the gripper motor, for closed loop tests of the low
+//level examples and benchmarks without an arm.
+//
+//Each actuator follows its command in its control mode:
+//    POSITION: critically damped position loop, the default as on the arm
+//    VELOCITY: first order velocity loop
+//    TORQUE:   torque_joint against the inertia and the viscous damping
+//then the acceleration, velocity, torque and position limits are applied. The measured torque is the one that moved
+//the joint, the motor current follows through the torque constant and warms the motor up.
+//The gripper motor goes to the commanded position at the commanded velocity and stops on an object, drawing a current
+//proportional to the commanded force.
+//
+//Time only advances with Step(): one period per call, as fast as it is called, and always the same result for the
+//same commands.
+class PlantModel
+{
+public:
+    enum eControlMode
+    {
+        POSITION,
+        VELOCITY,
+        TORQUE
+    };
+
+    PlantModel(int nActuatorCount, bool bGripper, const tPlantSettings &settings = tPlantSettings());
+
+    int GetActuatorCount() const {return m_nActuatorCount;}
+    const tPlantSettings &GetSettings() const {return m_Settings;}
+
+    //a switch to POSITION or VELOCITY starts from the current position and velocity, without a jump
+    void SetControlMode(int actuator, eControlMode mode);
+    eControlMode GetControlMode(int actuator) const {return m_eModes[actuator];}
+
+    //commands taking effect nDelayTicks periods later; the fields of the other modes are kept too
+    void SetCommand(const k_api::BaseCyclic::Command &command);
+    void SetActuatorCommand(int actuator, const k_api::ActuatorCyclic::Command &command);
+    //commands the current positions, zero velocity and torque: what the base does out of low level servoing
+    void Hold();
+
+    //moves the model without dynamics, to where the feedback says it is (a high level action, SetState)
+    void SetFromFeedback(const tFlatFeedback &state);
+
+    void Step();
+    uint64_t GetTickCount() const {return m_nTicks;}
+
+    //writes the fields of the model: positions, velocities, torques, motor currents and temperatures, gripper motor
+    void ToFeedback(tFlatFeedback &state) const;
+
+private:
+    struct tCommand
+    {
+        float position[CyclicWire::MAX_ACTUATORS];
+        float velocity[CyclicWire::MAX_ACTUATORS];
+        float torque[CyclicWire::MAX_ACTUATORS];
+        float gripperPosition;
+        float gripperVelocity;
+        float gripperForce;
+    };
+
+    void StepJoints(const tCommand &command, float dt);
+    void StepGripper(const tCommand &command, float dt);
+
+    const tPlantSettings m_Settings;
+    const int m_nActuatorCount;
+    const bool m_bGripper;
+    uint64_t m_nTicks;
+
+    eControlMode m_eModes[CyclicWire::MAX_ACTUATORS];
+    tCommand m_Pending;
+    std::vector<tCommand> m_Delayed;    //ring of the last nDelayTicks commands
+    size_t m_nDelayedIndex;
+
+    //joint state, positions in [-180, 180)
+    float m_Position[CyclicWire::MAX_ACTUATORS];
+    float m_Velocity[CyclicWire::MAX_ACTUATORS];
+    float m_Torque[CyclicWire::MAX_ACTUATORS];
+    float m_Temperature[CyclicWire::MAX_ACTUATORS];
+
+    float m_GripperPosition;
+    float m_GripperVelocity;
+    float m_GripperCurrent;
+};
+
+#endif
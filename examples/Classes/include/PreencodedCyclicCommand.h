@@ -0,0 +1,197 @@
+#ifndef KORTEXAPICPPEXAMPLE_PREENCODEDCYCLICCOMMAND_H
+#define KORTEXAPICPPEXAMPLE_PREENCODEDCYCLICCOMMAND_H
+
+#include <cstdint>
+#include <string>
+
+#include <BaseCyclicClientRpc.h>
+
+#include "CyclicWireFormat.h"
+
+namespace k_api = Kinova::Api;
+
+//BaseCyclic::Command kept serialized between ticks. The setters overwrite the encoded value in place, so a tick costs
+//a few stores instead of a full SerializeToString. The bytes are always the ones protobuf would produce for the same
+//values: proto3 drops zero fields and writes uint32 as varints, so when a value becomes zero (or leaves zero) or its
+//varint changes length the command is re-encoded once, which happens only every 128/16384 frame ids in a normal loop.
+//The actuators, interconnect and gripper motors present are fixed by the command given to Init().
+class PreencodedCyclicCommand
+{
+public:
+    static constexpr int MAX_PAYLOAD_SIZE = 512;
+    static constexpr uint32_t SERVICE_VERSION = 1;
+
+    PreencodedCyclicCommand();
+
+    //Takes the layout and the initial values, returns false if the command does not fit (more than
+    //CyclicWire::MAX_ACTUATORS actuators, unknown fields...) or if the encoding does not match protobuf's
+    bool Init(const k_api::BaseCyclic::Command &command);
+
+    void SetFrameId(uint32_t frameId) {PatchUint32(m_nFrameId, m_FrameIdOffset, frameId);}
+
+    //Frame id plus the command id of every actuator and of the interconnect, the ids the robot uses to reject out
+    //of time frames. Adds the interconnect command id if the command had an interconnect without one.
+    void SetSequenceId(uint32_t id);
+
+    void SetCommandId(int actuator, uint32_t commandId) {PatchUint32(m_Actuators[actuator].commandId, m_ActuatorOffsets[actuator].commandId, commandId);}
+    void SetFlags(int actuator, uint32_t flags) {PatchUint32(m_Actuators[actuator].flags, m_ActuatorOffsets[actuator].flags, flags);}
+    void SetPosition(int actuator, float position) {PatchFloat(m_Actuators[actuator].position, m_ActuatorOffsets[actuator].position, position);}
+    void SetVelocity(int actuator, float velocity) {PatchFloat(m_Actuators[actuator].velocity, m_ActuatorOffsets[actuator].velocity, velocity);}
+    void SetTorqueJoint(int actuator, float torque) {PatchFloat(m_Actuators[actuator].torqueJoint, m_ActuatorOffsets[actuator].torqueJoint, torque);}
+    void SetCurrentMotor(int actuator, float current) {PatchFloat(m_Actuators[actuator].currentMotor, m_ActuatorOffsets[actuator].currentMotor, current);}
+
+    //only when the command given to Init() had an interconnect command, with a gripper command for the motor setters
+    void SetInterconnectCommandId(uint32_t commandId) {PatchUint32(m_Interconnect.commandId, m_InterconnectOffsets.commandId, commandId);}
+    void SetGripperMotorPosition(int motor, float position) {PatchFloat(m_GripperMotors[motor].position, m_GripperMotorOffsets[motor].position, position);}
+    void SetGripperMotorVelocity(int motor, float velocity) {PatchFloat(m_GripperMotors[motor].velocity, m_GripperMotorOffsets[motor].velocity, velocity);}
+    void SetGripperMotorForce(int motor, float force) {PatchFloat(m_GripperMotors[motor].force, m_GripperMotorOffsets[motor].force, force);}
+
+    uint32_t GetFrameId() const {return m_nFrameId;}
+    int GetActuatorCount() const {return m_nActuatorCount;}
+    int GetGripperMotorCount() const {return m_nGripperMotorCount;}
+
+    //same bytes as SerializeToString() of the equivalent command
+    const std::string& GetPayload()
+    {
+        if (m_bLayoutChanged)
+        {
+            Encode();
+        }
+        return m_Payload;
+    }
+
+    //how many times the command had to be fully re-encoded since Init()
+    uint64_t GetReencodeCount() const {return m_nReencodeCount;}
+
+    //equivalent protobuf command, for logging and checks
+    void ToCommand(k_api::BaseCyclic::Command &command) const;
+
+    //Same as BaseCyclicClient::Refresh but the payload goes to the router as it is. Throws like the generated client:
+    //KBasicException on timeout or bad feedback, KDetailedException on an error reported by the robot.
+    void Refresh(k_api::IRouterClient *pRouter, k_api::BaseCyclic::Feedback &feedback, uint32_t deviceId = 0,
+                 const k_api::RouterClientSendOptions &options = {false, 0, 3000});
+
+private:
+    struct tActuatorValues
+    {
+        uint32_t commandId;
+        uint32_t flags;
+        float position;
+        float velocity;
+        float torqueJoint;
+        float currentMotor;
+    };
+
+    //offsets of the encoded values in m_Payload, -1 when the field is not on the wire (zero)
+    struct tActuatorOffsets
+    {
+        int32_t commandId;
+        int32_t flags;
+        int32_t position;
+        int32_t velocity;
+        int32_t torqueJoint;
+        int32_t currentMotor;
+    };
+
+    struct tInterconnectValues
+    {
+        bool bHasCommandId;             //MessageId sub-message, sent even when empty
+        uint32_t commandId;
+        uint32_t flags;
+        bool bHasGripperCommand;
+        bool bHasGripperCommandId;
+        uint32_t gripperCommandId;
+        uint32_t gripperFlags;
+    };
+
+    struct tInterconnectOffsets
+    {
+        int32_t commandId;
+        int32_t flags;
+        int32_t gripperCommandId;
+        int32_t gripperFlags;
+    };
+
+    struct tGripperMotorValues
+    {
+        uint32_t motorId;
+        float position;
+        float velocity;
+        float force;
+    };
+
+    struct tGripperMotorOffsets
+    {
+        int32_t motorId;
+        int32_t position;
+        int32_t velocity;
+        int32_t force;
+    };
+
+    void PatchFloat(float &current, int32_t offset, float value)
+    {
+        if (!m_bLayoutChanged)
+        {
+            //proto3 leaves zero out of the wire
+            if ((current != 0) != (value != 0))
+            {
+                m_bLayoutChanged = true;
+            }
+            else if (offset >= 0)
+            {
+                CyclicWire::StoreFloat(Data() + offset, value);
+            }
+        }
+        current = value;
+    }
+
+    void PatchUint32(uint32_t &current, int32_t offset, uint32_t value)
+    {
+        if (!m_bLayoutChanged)
+        {
+            if ((current != 0) != (value != 0) || CyclicWire::Varint32Size(current) != CyclicWire::Varint32Size(value))
+            {
+                m_bLayoutChanged = true;
+            }
+            else if (offset >= 0)
+            {
+                CyclicWire::WriteVarint32(Data() + offset, value);
+            }
+        }
+        current = value;
+    }
+
+    uint8_t* Data() {return reinterpret_cast<uint8_t*>(&m_Payload[0]);}
+
+    void Encode();
+    uint8_t* EncodeActuator(uint8_t *p, int actuator);
+    uint8_t* EncodeInterconnect(uint8_t *p);
+    uint8_t* EncodeGripperMotor(uint8_t *p, int motor);
+    uint8_t* EncodeUint32(uint8_t *p, uint32_t fieldNumber, uint32_t value, int32_t &offset);
+    uint8_t* EncodeFloat(uint8_t *p, uint32_t fieldNumber, float value, int32_t &offset);
+    int ActuatorSize(int actuator) const;
+    int GripperCommandSize() const;
+    int GripperMotorSize(int motor) const;
+    int InterconnectSize() const;
+
+    std::string m_Payload;
+    bool m_bLayoutChanged;
+    uint64_t m_nReencodeCount;
+
+    uint32_t m_nFrameId;
+    int32_t m_FrameIdOffset;
+
+    int m_nActuatorCount;
+    tActuatorValues m_Actuators[CyclicWire::MAX_ACTUATORS];
+    tActuatorOffsets m_ActuatorOffsets[CyclicWire::MAX_ACTUATORS];
+
+    bool m_bHasInterconnect;
+    tInterconnectValues m_Interconnect;
+    tInterconnectOffsets m_InterconnectOffsets;
+
+    int m_nGripperMotorCount;
+    tGripperMotorValues m_GripperMotors[CyclicWire::MAX_GRIPPER_MOTORS];
+    tGripperMotorOffsets m_GripperMotorOffsets[CyclicWire::MAX_GRIPPER_MOTORS];
+};
+
+#endif
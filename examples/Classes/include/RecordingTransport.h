@@ -0,0 +1,56 @@
+#ifndef KORTEXAPICPPEXAMPLE_RECORDINGTRANSPORT_H
+#define KORTEXAPICPPEXAMPLE_RECORDINGTRANSPORT_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <ITransportClient.h>
+
+#include "FrameCapture.h"
+
+namespace k_api = Kinova::Api;
+
+//ITransportClient decorator writing every buffer sent and received by the wrapped transport to a FrameCapture file,
+//to be played back later with ReplayTransport:
+//
+//    k_api::TransportClientUdp udp;
+//    RecordingTransport recording(&udp, "field.kcap");
+//    k_api::RouterClient router(&recording, errorCallback);
+//
+//Recording costs a copy into the mapped file per buffer, under a mutex shared by both directions. The capture is
+//created by the constructor (k_api::KBasicException when it cannot be) and closed by disconnect(); a failure to write
+//afterwards loses the record, not the frame.
+class RecordingTransport : public k_api::ITransportClient
+{
+public:
+    RecordingTransport(k_api::ITransportClient *pTransport, const std::string &path);
+    virtual ~RecordingTransport();
+
+    virtual bool connect(std::string host, uint32_t port) override;
+    virtual void disconnect() override;
+
+    virtual void send(const char *txBuffer, uint32_t txSize) override;
+    virtual void onMessage(std::function<void (const char*, uint32_t)> callback) override;
+
+    virtual char* getTxBuffer(uint32_t const &allocation_size) override;
+    virtual size_t getMaxTxBufferSize() override;
+
+    virtual void getHostAddress(std::string &host, uint32_t &port) override;
+
+    uint64_t GetRecordCount() const {return m_Writer.GetRecordCount();}
+    uint64_t GetLostCount() const {return m_nLost;}
+
+private:
+    RecordingTransport(const RecordingTransport&) = delete;
+    RecordingTransport& operator=(const RecordingTransport&) = delete;
+
+    void Record(FrameCapture::eDirection direction, const char *pData, uint32_t size);
+
+    k_api::ITransportClient *m_pTransport;
+    FrameCapture::Writer m_Writer;
+    std::atomic<uint64_t> m_nLost;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef KORTEXAPICPPEXAMPLE_REFRESHTIMING_H
+#define KORTEXAPICPPEXAMPLE_REFRESHTIMING_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include <BaseCyclicClientRpc.h>
+
+#include "FlatFeedback.h"
+#include "LatencyHistogram.h"
+
+namespace k_api = Kinova::Api;
+
+//Online Pearson correlation of two series (Welford updates, no catastrophic cancellation on large nanosecond values)
+struct tCorrelation
+{
+    uint64_t nCount;
+    double meanX;
+    double meanY;
+    double m2X;
+    double m2Y;
+    double coMoment;
+
+    void Reset();
+    void Add(double x, double y)
+    {
+        nCount++;
+        double dx = x - meanX;
+        double dy = y - meanY;
+        meanX += dx / double(nCount);
+        meanY += dy / double(nCount);
+        m2X += dx * (x - meanX);
+        m2Y += dy * (y - meanY);
+        coMoment += dx * (y - meanY);
+    }
+    void Merge(const tCorrelation &other);
+
+    //in [-1, 1], 0 while one of the series is constant or has less than 2 values
+    double Get() const;
+};
+
+//Timing of the BaseCyclic Refresh round trips of one client: send to receive, feedback parsing and the handling of
+//the feedback (tick or publish). Each of them is also correlated with the jitter_comm the actuators report, to tell
+//the delays of the robot side from the ones of this host. Recording never allocates; record from one thread and
+//copy the struct to read it elsewhere.
+struct tRefreshTiming
+{
+    static constexpr uint64_t NOT_MEASURED = std::numeric_limits<uint64_t>::max();
+
+    LatencyHistogram roundTrip;
+    LatencyHistogram parse;
+    LatencyHistogram callback;
+    LatencyHistogram jitterComm;    //reported in microseconds, recorded in ns like the others
+
+    tCorrelation roundTripJitter;
+    tCorrelation parseJitter;
+    tCorrelation callbackJitter;
+
+    tRefreshTiming() {Reset();}
+
+    //one feedback, a duration can be NOT_MEASURED when the client cannot separate it
+    void Record(uint64_t roundTrip_ns, uint64_t parse_ns, uint64_t callback_ns, uint32_t jitterComm_us);
+
+    void Reset();
+    void Add(const tRefreshTiming &other);
+
+    //text: one line per histogram with its correlation to jitter_comm
+    std::string ToString() const;
+    //CSV: a header line then one row per histogram, times in microseconds
+    std::string ToCsv() const;
+
+    //worst jitter_comm of the actuators and interconnect of a feedback, in microseconds
+    static uint32_t GetMaxJitterComm(const k_api::BaseCyclic::Feedback &feedback);
+    static uint32_t GetMaxJitterComm(const tFlatFeedback &feedback);
+};
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef KORTEXAPICPPEXAMPLE_REPLAYTRANSPORT_H
+#define KORTEXAPICPPEXAMPLE_REPLAYTRANSPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ITransportClient.h>
+
+#include "FrameCapture.h"
+
+namespace k_api = Kinova::Api;
+
+//ITransportClient playing the received buffers of a FrameCapture back to a RouterClient, so that the real FrameHandler,
+//NotificationHandler and service clients run on the traffic of a capture, without the robot:
+//
+//    ReplayTransport replay("field.kcap", ReplayTransport::ORIGINAL_TIMING);
+//    k_api::RouterClient router(&replay, errorCallback);
+//    replay.connect("replay", 10001);
+//    ... the calls made during the capture ...
+//    replay.WaitForEnd(std::chrono::seconds(5));
+//
+//When following the sends, a received buffer is only played once the router has sent as many buffers as had been sent
+//before it in the capture, so the answers come after their requests and the same code gets the same answers. The
+//sends are compared with the captured ones, a difference (a codec change, another call) is counted, not refused.
+//Otherwise everything is played from connect(), in order.
+//
+//AS_FAST_AS_POSSIBLE plays each buffer as soon as it may. ORIGINAL_TIMING plays it no earlier than its captured time
+//from connect(), nor than its captured delay after the send it follows: a client running faster than the capture is
+//paced by its answers, one running slower still sees the original response times. Buffers are played from a thread of
+//the transport.
+//The constructor throws k_api::KBasicException when the capture cannot be read.
+class ReplayTransport : public k_api::ITransportClient
+{
+public:
+    enum eTiming
+    {
+        AS_FAST_AS_POSSIBLE,
+        ORIGINAL_TIMING
+    };
+
+    ReplayTransport(const std::string &path, eTiming timing = AS_FAST_AS_POSSIBLE, bool bFollowSends = true);
+    virtual ~ReplayTransport();
+
+    //plays the capture from its beginning
+    virtual bool connect(std::string host, uint32_t port) override;
+    virtual void disconnect() override;
+
+    virtual void send(const char *txBuffer, uint32_t txSize) override;
+    virtual void onMessage(std::function<void (const char*, uint32_t)> callback) override;
+
+    virtual char* getTxBuffer(uint32_t const &allocation_size) override;
+    virtual size_t getMaxTxBufferSize() override;
+
+    virtual void getHostAddress(std::string &host, uint32_t &port) override;
+
+    //true once every received buffer of the capture was played
+    bool WaitForEnd(std::chrono::milliseconds timeout);
+
+    size_t GetCapturedSendCount() const {return m_Tx.size();}
+    size_t GetCapturedReceiveCount() const {return m_Rx.size();}
+    uint64_t GetPlayedCount() const {return m_nPlayed;}
+    uint64_t GetSentCount() const {return m_nSent;}
+    //sends different from the captured ones, or past their end
+    uint64_t GetMismatchCount() const {return m_nMismatches;}
+
+private:
+    ReplayTransport(const ReplayTransport&) = delete;
+    ReplayTransport& operator=(const ReplayTransport&) = delete;
+
+    struct tTx
+    {
+        const char *pData;
+        uint32_t size;
+        uint64_t offset_ns;     //from the first record
+    };
+
+    struct tRx
+    {
+        const char *pData;
+        uint32_t size;
+        uint64_t offset_ns;     //from the first record
+        size_t nTxBefore;       //sends captured before it
+        uint64_t delay_ns;      //after the last of them, or from the first record when there is none
+    };
+
+    void Run();
+
+    const eTiming m_eTiming;
+    const bool m_bFollowSends;
+    FrameCapture::Reader m_Reader;
+    std::vector<tTx> m_Tx;
+    std::vector<tRx> m_Rx;
+
+    std::string m_Host;
+    uint32_t m_nPort;
+    std::vector<char> m_TxBuffer;
+
+    std::mutex m_CallbackMutex;
+    std::function<void (const char*, uint32_t)> m_Callback;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_bStop;
+    std::chrono::steady_clock::time_point m_Start;
+    std::vector<std::chrono::steady_clock::time_point> m_SendTimes;
+    std::thread m_Worker;
+
+    std::atomic<uint64_t> m_nPlayed;
+    std::atomic<uint64_t> m_nSent;
+    std::atomic<uint64_t> m_nMismatches;
+};
+
+#endif
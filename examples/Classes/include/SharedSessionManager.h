@@ -0,0 +1,44 @@
+#ifndef KORTEXAPICPPEXAMPLE_SHAREDSESSIONMANAGER_H
+#define KORTEXAPICPPEXAMPLE_SHAREDSESSIONMANAGER_H
+
+#include <atomic>
+#include <functional>
+
+#include <IRouterClient.h>
+#include <SessionClientRpc.h>
+
+namespace k_api = Kinova::Api;
+
+class KeepAliveService;
+
+//Drop-in replacement of k_api::SessionManager that does not start its own validation thread.
+//The session registers with the process wide KeepAliveService, which watches every session from a single timer thread.
+class SharedSessionManager : public k_api::Session::SessionClient
+{
+public:
+    explicit SharedSessionManager(k_api::IRouterClient* router, std::function<void()> connectionTimeoutCallback = nullptr);
+    virtual ~SharedSessionManager();
+
+    void CreateSession(const k_api::Session::CreateSessionInfo &info);
+    void CloseSession();
+
+    bool IsSessionOpen() {return m_bIsRegistered;}
+
+private:
+    friend class KeepAliveService;
+
+    void Hit(k_api::FrameTypes hitType);
+
+    //called by the service once per keepalive window, returns true when the connection is considered lost
+    bool CheckWindow(bool &bKeepAliveSent);
+
+    std::function<void()> m_connectionTimeoutCallback;
+    k_api::Session::CreateSessionInfo m_sessionInfo;
+
+    std::atomic<bool> m_bHasBeenSent;      //a request went out during the current window
+    std::atomic<bool> m_bHasBeenReceived;  //a response or a notification came back during the current window
+    bool m_bIsRegistered;
+    int m_nSilentWindows;                  //consecutive windows without anything received
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef KORTEXAPICPPEXAMPLE_SIMULATEDROBOT_H
+#define KORTEXAPICPPEXAMPLE_SIMULATEDROBOT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <google/protobuf/message.h>
+
+#include <ActuatorConfigClientRpc.h>
+#include <ActuatorCyclicClientRpc.h>
+#include <BaseClientRpc.h>
+#include <BaseCyclicClientRpc.h>
+#include <DeviceManagerClientRpc.h>
+#include <SessionClientRpc.h>
+#include <TestClientRpc.h>
+
+#include "FlatFeedback.h"
+#include "LoopbackTransport.h"
+#include "PlantModel.h"
+
+namespace k_api = Kinova::Api;
+
+struct tSimulatedRobotSettings
+{
+    std::string username;
+    std::string password;
+    int nActuatorCount;         //the first 4 are big actuators, the others small ones, like on a 7 DoF Gen3
+    bool bGripper;              //a Robotiq 2F-85 behind the interconnect
+    bool bIdealTracking;        //the feedback echoes the low level commands, instead of the plant model following them
+    tPlantSettings plant;
+
+    tSimulatedRobotSettings(): username("admin"), password("admin"), nActuatorCount(7), bGripper(true), bIdealTracking(false) {}
+};
+
+//Robot answering the Session, Base, BaseCyclic, ActuatorCyclic, DeviceManager and Test RPCs of the clients connected
+//to it through LoopbackTransports, one per channel:
+//
+//    SimulatedRobot robot;
+//    LoopbackTransport transport(&robot);
+//    k_api::RouterClient router(&transport, errorCallback);
+//    transport.connect("simulated", 10000);
+//
+//In low level servoing the actuators and the gripper follow the BaseCyclic or ActuatorCyclic commands through a
+//PlantModel, in the control mode set with ActuatorConfig::SetControlMode. The model advances one period with each
+//BaseCyclic Refresh or RefreshCommand, and with each ActuatorCyclic command to an actuator already commanded in the
+//period: a loop runs as fast as it can and always sees the same feedback. With bIdealTracking the feedback is the
+//command instead. A reach joint angles action lands on its target at once (with ACTION_START then ACTION_END on the
+//ActionTopic). The Test service echoes TestParamAndReturn, answers TestAsync and Wait after their delay, never answers
+//TestTimeout and Forget, and TestTriggerNotif notifies the TestNotif subscribers: what load generators need. Other
+//services and methods answer ERROR_DEVICE/UNSUPPORTED_SERVICE or UNSUPPORTED_METHOD unless a handler was added for them.
+//
+//Credentials are checked by CreateSession, the session itself is not checked by the other RPCs.
+class SimulatedRobot : public ILoopbackServer
+{
+public:
+    //Fills the response payload, or returns the sub error code sent back with ERROR_DEVICE.
+    //Called from the worker thread of the transport, without any lock of the robot held.
+    typedef std::function<k_api::SubErrorCodes(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response)> RpcHandler;
+
+    //returned by a handler to send no answer now: none at all, or one from ReplyLater()
+    static constexpr k_api::SubErrorCodes NO_REPLY = k_api::SubErrorCodes(0xfff);
+
+    SimulatedRobot(const tSimulatedRobotSettings &settings = tSimulatedRobotSettings());
+    virtual ~SimulatedRobot();
+
+    //adds or replaces the handler of a function uid (service id << 16 | function id, the eUid of the client stubs)
+    void SetHandler(uint32_t functionUid, const RpcHandler &handler);
+    //the function is then answered with UNSUPPORTED_METHOD, or UNSUPPORTED_SERVICE if it was the last one of its service
+    void RemoveHandler(uint32_t functionUid);
+    std::vector<uint32_t> GetFunctionUids() const;
+
+    //Subscriptions are then accepted for this topic uid (the OnNotification*Topic RPC and the notifications share it),
+    //ActionTopic and ArmStateTopic are there from the start
+    void AddTopic(uint32_t topicUid);
+    //sends a notification to every subscriber of the topic, returns how many there were
+    int Notify(uint32_t topicUid, const google::protobuf::Message &notification);
+
+    //the state returned by the next BaseCyclic feedback, the plant model is moved to it
+    tFlatFeedback GetState() const;
+    void SetState(const tFlatFeedback &state);
+
+    uint64_t GetRequestCount() const;
+
+    //answers the request after the delay, from a thread of the robot; dropped if the transport disconnects before
+    void ReplyLater(const k_api::Frame &request, LoopbackTransport *pTransport, std::chrono::milliseconds delay,
+                    k_api::SubErrorCodes subError, const std::string &payload);
+
+    virtual void OnFrame(const k_api::Frame &frame, LoopbackTransport *pTransport) override;
+    virtual void OnDisconnect(LoopbackTransport *pTransport) override;
+
+private:
+    SimulatedRobot(const SimulatedRobot&) = delete;
+    SimulatedRobot& operator=(const SimulatedRobot&) = delete;
+
+    struct tSubscription
+    {
+        LoopbackTransport *pTransport;
+        uint32_t topicUid;
+        uint32_t handle;
+    };
+
+    struct tDeferredReply
+    {
+        k_api::Frame request;       //header only
+        LoopbackTransport *pTransport;
+        k_api::SubErrorCodes subError;
+        std::string payload;
+    };
+
+    void AddBuiltInHandlers();
+    void AddTestHandlers();
+    void RunDeferredReplies();
+    void Reply(const k_api::Frame &request, LoopbackTransport *pTransport, k_api::ErrorCodes error,
+               k_api::SubErrorCodes subError, const std::string &payload);
+
+    //handlers of the built-in services, the state mutex is taken inside
+    k_api::SubErrorCodes CreateSession(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response);
+    k_api::SubErrorCodes CloseSession(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response);
+    k_api::SubErrorCodes Subscribe(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response);
+    k_api::SubErrorCodes Unsubscribe(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response);
+    k_api::SubErrorCodes SetServoingMode(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response);
+    k_api::SubErrorCodes ReadAllActions(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response);
+    k_api::SubErrorCodes ReadAction(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response);
+    k_api::SubErrorCodes ExecuteAction(const k_api::Base::Action &action);
+    k_api::SubErrorCodes BaseCyclicRefresh(const k_api::Frame &request, bool bCommand, bool bFeedback, std::string &response);
+    k_api::SubErrorCodes ActuatorCyclicRefresh(const k_api::Frame &request, bool bCommand, bool bFeedback, std::string &response);
+    k_api::SubErrorCodes ReadAllDevices(std::string &response);
+    k_api::SubErrorCodes SetControlMode(const k_api::Frame &request, std::string &response);
+    k_api::SubErrorCodes GetControlMode(const k_api::Frame &request, std::string &response);
+    k_api::SubErrorCodes TestParamAndReturn(const k_api::Frame &request, std::string &response);
+
+    //arm state change, with its notification; the state mutex is held
+    void SetArmState(k_api::Common::ArmState state);
+    //one period of the plant model, into the state; the state mutex is held
+    void StepPlant();
+    int NotifyLocked(uint32_t topicUid, const google::protobuf::Message &notification);
+
+    const tSimulatedRobotSettings m_Settings;
+
+    mutable std::mutex m_HandlerMutex;
+    std::map<uint32_t, RpcHandler> m_Handlers;
+    uint64_t m_nRequests;
+
+    mutable std::mutex m_StateMutex;
+    std::unique_ptr<tFlatFeedback> m_pState;
+    std::unique_ptr<PlantModel> m_pPlant;
+    uint32_t m_nActuatorsCommanded;     //bit per actuator commanded through ActuatorCyclic since the last step
+    k_api::Base::ServoingMode m_eServoingMode;
+    std::vector<k_api::Base::Action> m_Actions;
+    std::map<LoopbackTransport*, uint32_t> m_Sessions;
+    uint32_t m_nLastSessionId;
+    std::vector<tSubscription> m_Subscriptions;
+    uint32_t m_nLastSubscriptionHandle;
+
+    //kept between cyclic frames, used with the state mutex held
+    k_api::BaseCyclic::Command m_CyclicCommand;
+    k_api::BaseCyclic::Feedback m_CyclicFeedback;
+    k_api::ActuatorCyclic::Command m_ActuatorCommand;
+    k_api::ActuatorCyclic::Feedback m_ActuatorFeedback;
+    k_api::Frame m_Notification;
+
+    //replies of ReplyLater(), by due time; delivered with the mutex held, so none once OnDisconnect() returned
+    std::mutex m_DeferredMutex;
+    std::condition_variable m_DeferredCondition;
+    std::multimap<std::chrono::steady_clock::time_point, tDeferredReply> m_DeferredReplies;
+    std::thread m_DeferredWorker;   //started by the first ReplyLater()
+    bool m_bStopDeferred;
+};
+
+#endif
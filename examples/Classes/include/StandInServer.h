@@ -0,0 +1,110 @@
+#ifndef KORTEXAPICPPEXAMPLE_STANDINSERVER_H
+#define KORTEXAPICPPEXAMPLE_STANDINSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DelayLine.h"
+#include "LoopbackTransport.h"
+
+struct tStandInSettings
+{
+    std::string address;
+    uint32_t nTcpPort;
+    uint32_t nUdpPort;
+    tNetworkProfile profile;    //applied both ways, on each connection and UDP peer
+    uint32_t nSeed;             //of the profile draws, the same seed gives the same drops for the same traffic
+    uint32_t nUdpPeerTimeout_ms;    //a UDP peer without datagram for that long is removed, 0 = never
+
+    tStandInSettings(): address("127.0.0.1"), nTcpPort(10000), nUdpPort(10001), nSeed(1), nUdpPeerTimeout_ms(10000) {}
+};
+
+struct tStandInStatistics
+{
+    uint64_t nTcpConnections;   //accepted since Start()
+    uint64_t nUdpPeers;         //current ones, they expire
+    uint64_t nFramesIn;         //received from the clients
+    uint64_t nFramesOut;        //sent to the clients
+    uint64_t nDropped;
+    uint64_t nReordered;
+    uint64_t nRetransmitted;
+};
+
+//Serves an ILoopbackServer (a SimulatedRobot) on the ports and with the wire format of a real arm: KINOVA_MAGIC_STRING
+//framed Frames on TCP, one Frame per datagram on UDP. Stand-in for an arm in load and soak tests of the transports, the
+//router and the cyclic loops on one machine, with the network conditions of a tNetworkProfile.
+//
+//Each TCP connection and each UDP peer (address and port) gets its own LoopbackTransport to the server, so its own
+//session, and its own pair of DelayLines. A datagram carries no end of connection: a UDP peer is removed, with its
+//session, nUdpPeerTimeout_ms after its last datagram, or a second after its CloseSession request.
+//
+//POSIX sockets only: Start() throws k_api::KBasicException on other platforms and when a port cannot be bound.
+class StandInServer
+{
+public:
+    StandInServer(ILoopbackServer *pServer, const tStandInSettings &settings = tStandInSettings());
+    ~StandInServer();
+
+    void Start();
+    void Stop();
+
+    tStandInStatistics GetStatistics() const;
+
+private:
+    StandInServer(const StandInServer&) = delete;
+    StandInServer& operator=(const StandInServer&) = delete;
+
+    struct tPeer
+    {
+        int nSocket;                    //the connection, or the UDP socket shared by every peer
+        std::vector<uint8_t> address;   //UDP: sockaddr of the peer
+        std::unique_ptr<LoopbackTransport> pTransport;
+        std::unique_ptr<DelayLine> pUplink;     //client to server
+        std::unique_ptr<DelayLine> pDownlink;   //server to client
+        std::string answer;             //used by the transport callback only
+        std::string txBuffer;           //used by the downlink only
+        std::thread reader;             //TCP only
+        std::chrono::steady_clock::time_point expiry;   //UDP only, used by the UDP reader only
+        std::atomic<bool> bClosed;
+    };
+
+    tPeer* AddPeer(int nSocket, const std::vector<uint8_t> &address);
+    void SendToPeer(tPeer *pPeer, const std::string &bytes);
+    //the closed peers of the list, or all of them; the TCP peers from the acceptor, the UDP ones from the UDP reader
+    void ReapPeers(std::vector<std::unique_ptr<tPeer>> &peers, bool bAll);
+    //closes the UDP peers past their expiry, UDP reader only
+    void ExpireUdpPeers();
+    void AcceptConnections();
+    void ReadConnection(tPeer *pPeer);
+    void ReadDatagrams();
+
+    ILoopbackServer *m_pServer;
+    const tStandInSettings m_Settings;
+
+    int m_nTcpSocket;
+    int m_nUdpSocket;
+    std::atomic<bool> m_bStop;
+    std::thread m_TcpAcceptor;
+    std::thread m_UdpReader;
+
+    mutable std::mutex m_PeerMutex;
+    std::vector<std::unique_ptr<tPeer>> m_TcpPeers;
+    std::vector<std::unique_ptr<tPeer>> m_UdpPeers;     //only the UDP reader adds to it and removes from it
+    uint32_t m_nPeerCount;      //seeds the delay lines of the next peer
+
+    std::atomic<uint64_t> m_nTcpConnections;
+    std::atomic<uint64_t> m_nFramesIn;
+    std::atomic<uint64_t> m_nFramesOut;
+    //of the peers already reaped
+    std::atomic<uint64_t> m_nDropped;
+    std::atomic<uint64_t> m_nReordered;
+    std::atomic<uint64_t> m_nRetransmitted;
+};
+
+#endif
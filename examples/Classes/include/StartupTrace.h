@@ -0,0 +1,65 @@
+#ifndef KORTEXAPICPPEXAMPLE_STARTUPTRACE_H
+#define KORTEXAPICPPEXAMPLE_STARTUPTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+//Process-wide trace of the phases a tool goes through before its first useful RPC: static initialization (the default
+//instances of every linked .pb.cc), connect, CreateSession, the construction of each service client...
+//
+//Off unless KORTEX_STARTUP_TRACE is set in the environment, then printed to stderr at exit, or unless Enable() is called.
+//A phase of a disabled trace costs one atomic load:
+//
+//    StartupTrace::Mark("main");
+//    {
+//        StartupTrace::Scope scope("read devices");
+//        ...
+//    }
+//
+//Times are from the start of static initialization with GCC and Clang, from the first use of the trace otherwise.
+class StartupTrace
+{
+public:
+    struct tPhase
+    {
+        std::string name;
+        std::chrono::microseconds start;
+        std::chrono::microseconds duration;
+        bool bMark;
+    };
+
+    //records the phase from its construction to its destruction
+    class Scope
+    {
+    public:
+        Scope(const std::string &name);
+        ~Scope();
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        bool m_bEnabled;
+        std::string m_Name;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    static bool IsEnabled() {return s_bEnabled.load(std::memory_order_relaxed);}
+    static void Enable(bool bPrintAtExit = false);
+
+    static void Record(const std::string &name, std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end);
+    //a point in time, without a duration
+    static void Mark(const std::string &name);
+
+    static std::vector<tPhase> GetPhases();
+    //one line per phase, in the order they started
+    static std::string ToString();
+
+private:
+    static std::atomic<bool> s_bEnabled;
+};
+
+#endif
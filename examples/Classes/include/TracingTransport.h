@@ -0,0 +1,42 @@
+#ifndef KORTEXAPICPPEXAMPLE_TRACINGTRANSPORT_H
+#define KORTEXAPICPPEXAMPLE_TRACINGTRANSPORT_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <ITransportClient.h>
+
+namespace k_api = Kinova::Api;
+
+//ITransportClient decorator recording EventTrace events of the wrapped transport: the sends of the callers, and on
+//its receive thread, the frameHandler of the router each received frame is handed to (the response to a caller, or
+//a notification to its NotificationHandler). The receive thread spends the rest of its time in the transport. The
+//events are only compiled with KORTEX_TRACE, KortexConnection then puts one under each of its routers.
+class TracingTransport : public k_api::ITransportClient
+{
+public:
+    //channel names the receive thread, "tcp" gives "tcp rx"
+    TracingTransport(k_api::ITransportClient *pTransport, const std::string &channel);
+    virtual ~TracingTransport() {}
+
+    virtual bool connect(std::string host, uint32_t port) override;
+    virtual void disconnect() override;
+
+    virtual void send(const char *txBuffer, uint32_t txSize) override;
+    virtual void onMessage(std::function<void (const char*, uint32_t)> callback) override;
+
+    virtual char* getTxBuffer(uint32_t const &allocation_size) override;
+    virtual size_t getMaxTxBufferSize() override;
+
+    virtual void getHostAddress(std::string &host, uint32_t &port) override;
+
+private:
+    TracingTransport(const TracingTransport&) = delete;
+    TracingTransport& operator=(const TracingTransport&) = delete;
+
+    k_api::ITransportClient *m_pTransport;
+    const std::string m_RxThreadName;
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include "Classes/include/ActuatorCyclicController.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+#include <HeaderInfo.h>
+#include <KDetailedException.h>
+
+namespace k_api = Kinova::Api;
+
+constexpr uint32_t ActuatorCyclicController::SERVICE_VERSION;
+
+struct ActuatorCyclicController::tReplySlot
+{
+    std::mutex mutex;
+    std::condition_variable arrived;
+    uint64_t nAwaited;      //number of the Send waited for, moved on when its Receive times out
+    bool bArrived;
+    k_api::Frame frame;
+    uint64_t nLateReplies;
+
+    tReplySlot(): nAwaited(0), bArrived(false), nLateReplies(0) {}
+
+    void OnReply(uint64_t nSend, const k_api::Frame &reply)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (nSend != nAwaited)
+            {
+                nLateReplies++;
+                return;
+            }
+            frame = reply;
+            bArrived = true;
+        }
+        arrived.notify_all();
+    }
+};
+
+ActuatorCyclicController::ActuatorCyclicController(k_api::IRouterClient *pRouter, uint32_t deviceId)
+{
+    m_pRouter = pRouter;
+    m_nDeviceId = deviceId;
+    m_Command = tActuatorCyclicCommand();
+    m_Feedback = tActuatorCyclicFeedback();
+    m_nFeedbackSize = 0;
+    m_pReply = std::make_shared<tReplySlot>();
+    m_bPending = false;
+    m_nPendingTimeout_ms = 0;
+}
+
+void ActuatorCyclicController::Send(const k_api::RouterClientSendOptions &options)
+{
+    m_Sequencer.Stamp(m_CommandMessage);
+    m_CommandMessage.set_flags(m_Command.flags);
+    m_CommandMessage.set_position(m_Command.position);
+    m_CommandMessage.set_velocity(m_Command.velocity);
+    m_CommandMessage.set_torque_joint(m_Command.torqueJoint);
+    m_CommandMessage.set_current_motor(m_Command.currentMotor);
+    m_CommandMessage.SerializeToString(&m_Payload);
+
+    uint64_t nSend;
+    {
+        std::lock_guard<std::mutex> lock(m_pReply->mutex);
+        nSend = ++m_pReply->nAwaited;
+        m_pReply->bArrived = false;
+    }
+    std::shared_ptr<tReplySlot> pReply = m_pReply;
+    k_api::Error error = m_pRouter->sendWithCallback(m_Payload, SERVICE_VERSION, k_api::ActuatorCyclic::eUidRefresh, m_nDeviceId,
+                                                     [pReply, nSend](const k_api::Frame &frame) {pReply->OnReply(nSend, frame);});
+    if (error.error_code() != k_api::ERROR_NONE)
+    {
+        m_bPending = false;
+        throw k_api::KDetailedException(k_api::KError(error));
+    }
+    m_bPending = true;
+    m_nPendingTimeout_ms = options.timeout_ms;
+}
+
+const tActuatorCyclicFeedback& ActuatorCyclicController::Receive()
+{
+    if (!m_bPending)
+    {
+        throw k_api::KBasicException("ActuatorCyclic Receive without a Send");
+    }
+    m_bPending = false;
+    {
+        std::unique_lock<std::mutex> lock(m_pReply->mutex);
+        if (!m_pReply->arrived.wait_for(lock, std::chrono::milliseconds(m_nPendingTimeout_ms), [this]() {return m_pReply->bArrived;}))
+        {
+            //its feedback, if it still comes, is counted late and dropped
+            m_pReply->nAwaited++;
+            throw k_api::KBasicException("ActuatorCyclic Refresh timed out");
+        }
+        m_Frame.Swap(&m_pReply->frame);
+    }
+    const k_api::Frame &frame = m_Frame;
+
+    k_api::HeaderInfo header(frame.header());
+    if (header.m_frameInfo.errorCode != k_api::ERROR_NONE)
+    {
+        throw k_api::KDetailedException(k_api::KError(header, k_api::ErrorCodes(header.m_frameInfo.errorCode),
+                                                      k_api::SubErrorCodes(header.m_frameInfo.errorSubCode),
+                                                      "ActuatorCyclic Refresh failed"));
+    }
+
+    if (!m_FeedbackMessage.ParseFromString(frame.payload()))
+    {
+        throw k_api::KBasicException("Cannot parse the ActuatorCyclic feedback");
+    }
+    m_nFeedbackSize = frame.payload().size();
+
+    if (!m_Sequencer.Accept(m_FeedbackMessage.feedback_id().identifier()))
+    {
+        return m_Feedback;
+    }
+    m_Feedback.feedbackId = m_FeedbackMessage.feedback_id().identifier();
+    m_Feedback.statusFlags = m_FeedbackMessage.status_flags();
+    m_Feedback.jitterComm = m_FeedbackMessage.jitter_comm();
+    m_Feedback.position = m_FeedbackMessage.position();
+    m_Feedback.velocity = m_FeedbackMessage.velocity();
+    m_Feedback.torque = m_FeedbackMessage.torque();
+    m_Feedback.currentMotor = m_FeedbackMessage.current_motor();
+    m_Feedback.voltage = m_FeedbackMessage.voltage();
+    m_Feedback.temperatureMotor = m_FeedbackMessage.temperature_motor();
+    m_Feedback.temperatureCore = m_FeedbackMessage.temperature_core();
+    m_Feedback.faultBankA = m_FeedbackMessage.fault_bank_a();
+    m_Feedback.faultBankB = m_FeedbackMessage.fault_bank_b();
+    m_Feedback.warningBankA = m_FeedbackMessage.warning_bank_a();
+    m_Feedback.warningBankB = m_FeedbackMessage.warning_bank_b();
+    return m_Feedback;
+}
+
+uint64_t ActuatorCyclicController::GetLateReplyCount() const
+{
+    std::lock_guard<std::mutex> lock(m_pReply->mutex);
+    return m_pReply->nLateReplies;
+}
+
+const tActuatorCyclicFeedback& ActuatorCyclicController::Refresh(const k_api::RouterClientSendOptions &options)
+{
+    Send(options);
+    return Receive();
+}
+
+ActuatorCyclicGroup::ActuatorCyclicGroup(k_api::IRouterClient *pRouter, const std::vector<uint32_t> &deviceIds)
+{
+    for (auto deviceId : deviceIds)
+    {
+        m_Controllers.push_back(std::unique_ptr<ActuatorCyclicController>(new ActuatorCyclicController(pRouter, deviceId)));
+    }
+}
+
+void ActuatorCyclicGroup::Refresh(const k_api::RouterClientSendOptions &options)
+{
+    for (auto &pController : m_Controllers)
+    {
+        pController->Send(options);
+    }
+
+    std::exception_ptr firstError;
+    for (auto &pController : m_Controllers)
+    {
+        try
+        {
+            pController->Receive();
+        }
+        catch (...)
+        {
+            if (!firstError)
+            {
+                firstError = std::current_exception();
+            }
+        }
+    }
+    if (firstError)
+    {
+        std::rethrow_exception(firstError);
+    }
+}
@@ -0,0 +1,171 @@
+#include "Classes/include/CyclicExecutor.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+#if defined(_OS_UNIX)
+#include <cerrno>
+#include <time.h>
+#endif
+
+#include <KDetailedException.h>
+
+#include "Classes/include/EventTrace.h"
+
+namespace k_api = Kinova::Api;
+
+using std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+
+constexpr int CyclicExecutor::REFRESH_TIMEOUT_PERIODS;
+
+void tCyclicStatistics::Reset()
+{
+    nTicks = 0;
+    nDeadlineMisses = 0;
+    nSkippedPeriods = 0;
+    nRefreshErrors = 0;
+    wakeUpJitter.Reset();
+    cycleTime.Reset();
+    overrun.Reset();
+    refresh.Reset();
+    sequence = tSequenceStatistics();
+}
+
+std::string tCyclicStatistics::ToString() const
+{
+    std::ostringstream stream;
+    stream << "ticks " << nTicks << ", deadline misses " << nDeadlineMisses
+           << ", skipped periods " << nSkippedPeriods << ", refresh errors " << nRefreshErrors << std::endl
+           << "  wake-up jitter: " << wakeUpJitter.ToString() << std::endl
+           << "  cycle time:     " << cycleTime.ToString() << std::endl
+           << "  overrun:        " << overrun.ToString() << std::endl
+           << "refresh:" << std::endl
+           << refresh.ToString() << std::endl
+           << "sequence: " << sequence.ToString();
+    return stream.str();
+}
+
+CyclicExecutor::CyclicExecutor(k_api::BaseCyclic::BaseCyclicClient *pBaseCyclic, std::chrono::microseconds period, std::chrono::microseconds busyWaitMargin)
+{
+    m_pBaseCyclic = pBaseCyclic;
+    m_Period = period;
+    m_BusyWaitMargin = busyWaitMargin;
+    m_bStopRequested = false;
+    m_pMirror = nullptr;
+    m_bAutoSequencing = true;
+    //in whole milliseconds, rounded up
+    auto timeout_us = std::chrono::duration_cast<std::chrono::microseconds>(period * REFRESH_TIMEOUT_PERIODS).count();
+    m_RefreshOptions = {false, 0, uint32_t(std::max<int64_t>(1, (timeout_us + 999) / 1000))};
+    m_Statistics.Reset();
+}
+
+void CyclicExecutor::SleepUntil(const steady_clock::time_point &deadline)
+{
+#if defined(_OS_UNIX)
+    //steady_clock is CLOCK_MONOTONIC on Linux, its time points can be given as they are to clock_nanosleep
+    auto sinceEpoch = std::chrono::duration_cast<nanoseconds>(deadline.time_since_epoch()).count();
+    struct timespec request;
+    request.tv_sec = time_t(sinceEpoch / 1000000000);
+    request.tv_nsec = long(sinceEpoch % 1000000000);
+
+    //restart after a signal, the deadline is absolute
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &request, nullptr) == EINTR)
+    {
+    }
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+
+void CyclicExecutor::Run(k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command, const TickCallback &tick, uint64_t maxTicks)
+{
+    KORTEX_TRACE_THREAD_NAME("cyclic");
+    m_Sequencer.Reset(command.frame_id());
+    auto release = steady_clock::now();
+
+    for (uint64_t nTicks = 0; !m_bStopRequested && (maxTicks == 0 || nTicks < maxTicks); nTicks++)
+    {
+        //sleep for the bulk of the wait, then spin on the clock for the last margin
+        if (m_BusyWaitMargin.count() > 0)
+        {
+            SleepUntil(release - m_BusyWaitMargin);
+            while (steady_clock::now() < release)
+            {
+            }
+        }
+        else
+        {
+            SleepUntil(release);
+        }
+
+        auto wakeUp = steady_clock::now();
+        m_Statistics.wakeUpJitter.Record(uint64_t(std::chrono::duration_cast<nanoseconds>(wakeUp - release).count()));
+
+        {
+            KORTEX_TRACE_SCOPE("cyclic", "tick");
+            if (!tick(feedback, command))
+            {
+                break;
+            }
+        }
+        if (m_bAutoSequencing)
+        {
+            m_Sequencer.Stamp(command);
+        }
+        auto sent = steady_clock::now();
+
+        try
+        {
+            KORTEX_TRACE_SCOPE("cyclic", "Refresh");
+            k_api::BaseCyclic::Feedback received = m_pBaseCyclic->Refresh(command, 0, m_RefreshOptions);
+            auto receivedTime = steady_clock::now();
+            m_Statistics.refresh.Record(uint64_t(std::chrono::duration_cast<nanoseconds>(receivedTime - sent).count()), tRefreshTiming::NOT_MEASURED,
+                                        uint64_t(std::chrono::duration_cast<nanoseconds>(sent - wakeUp).count()),
+                                        tRefreshTiming::GetMaxJitterComm(received));
+
+            bool bAccepted = true;
+            if (m_bAutoSequencing)
+            {
+                bAccepted = m_Sequencer.Accept(received.frame_id());
+                m_Statistics.sequence = m_Sequencer.GetStatistics();
+            }
+            if (bAccepted)
+            {
+                feedback.Swap(&received);
+                if (m_pMirror)
+                {
+                    m_pMirror->Publish(feedback);
+                }
+            }
+        }
+        catch (k_api::KBasicException &ex)
+        {
+            m_Statistics.nRefreshErrors++;
+            if (m_OnRefreshError)
+            {
+                m_OnRefreshError(ex);
+            }
+        }
+        m_Statistics.nTicks++;
+
+        auto completion = steady_clock::now();
+        m_Statistics.cycleTime.Record(uint64_t(std::chrono::duration_cast<nanoseconds>(completion - wakeUp).count()));
+
+        release += m_Period;
+        if (completion > release)
+        {
+            //missed: record by how much, then drop the releases already in the past to stay in phase
+            m_Statistics.nDeadlineMisses++;
+            KORTEX_TRACE_INSTANT("cyclic", "deadline miss");
+            m_Statistics.overrun.Record(uint64_t(std::chrono::duration_cast<nanoseconds>(completion - release).count()));
+            while (release < completion)
+            {
+                release += m_Period;
+                m_Statistics.nSkippedPeriods++;
+            }
+        }
+    }
+    m_bStopRequested = false;
+}
@@ -0,0 +1,101 @@
+#include "Classes/include/CyclicSequencer.h"
+
+#include <sstream>
+
+namespace k_api = Kinova::Api;
+
+constexpr uint32_t CyclicSequencer::FRAME_ID_MASK;
+
+std::string tSequenceStatistics::ToString() const
+{
+    std::ostringstream stream;
+    stream << "stamped " << nStamped << ", in order " << nInOrder << ", dropped " << nDropped
+           << ", reordered " << nReordered << ", duplicates " << nDuplicates << ", unknown " << nUnknown
+           << ", discarded " << nDiscarded;
+    return stream.str();
+}
+
+CyclicSequencer::CyclicSequencer()
+{
+    m_bDiscardStale = false;
+    Reset();
+}
+
+void CyclicSequencer::Reset(uint32_t lastFrameId)
+{
+    m_nLastSent = lastFrameId & FRAME_ID_MASK;
+    m_bHasAccepted = false;
+    m_nLastAccepted = 0;
+    m_Statistics = tSequenceStatistics();
+}
+
+uint32_t CyclicSequencer::Stamp(k_api::BaseCyclic::Command &command)
+{
+    uint32_t id = Next();
+    command.set_frame_id(id);
+    for (int i = 0; i < command.actuators_size(); i++)
+    {
+        command.mutable_actuators(i)->set_command_id(id);
+    }
+    if (command.has_interconnect())
+    {
+        command.mutable_interconnect()->mutable_command_id()->set_identifier(id);
+    }
+    return id;
+}
+
+uint32_t CyclicSequencer::Stamp(PreencodedCyclicCommand &command)
+{
+    uint32_t id = Next();
+    command.SetSequenceId(id);
+    return id;
+}
+
+uint32_t CyclicSequencer::Stamp(k_api::ActuatorCyclic::Command &command)
+{
+    uint32_t id = Next();
+    command.mutable_command_id()->set_identifier(id);
+    return id;
+}
+
+CyclicSequencer::eFeedbackOrder CyclicSequencer::OnFeedback(uint32_t frameId)
+{
+    frameId &= FRAME_ID_MASK;
+
+    //newer than the last id sent, or nothing sent yet
+    if (m_Statistics.nStamped == 0 || FrameIdDistance(frameId, m_nLastSent) > 0)
+    {
+        m_Statistics.nUnknown++;
+        return FEEDBACK_UNKNOWN;
+    }
+
+    if (!m_bHasAccepted)
+    {
+        m_bHasAccepted = true;
+        m_nLastAccepted = frameId;
+        m_Statistics.nInOrder++;
+        return FEEDBACK_IN_ORDER;
+    }
+
+    int distance = FrameIdDistance(frameId, m_nLastAccepted);
+    if (distance > 0)
+    {
+        //the ids in between are counted as dropped until they show up
+        m_Statistics.nDropped += uint64_t(distance - 1);
+        m_nLastAccepted = frameId;
+        m_Statistics.nInOrder++;
+        return FEEDBACK_IN_ORDER;
+    }
+    if (distance == 0)
+    {
+        m_Statistics.nDuplicates++;
+        return FEEDBACK_DUPLICATE;
+    }
+
+    m_Statistics.nReordered++;
+    if (m_Statistics.nDropped > 0)
+    {
+        m_Statistics.nDropped--;
+    }
+    return FEEDBACK_REORDERED;
+}
@@ -0,0 +1,162 @@
+#include "Classes/include/DelayLine.h"
+
+#include <algorithm>
+#include <functional>
+
+using std::chrono::steady_clock;
+using std::chrono::microseconds;
+
+constexpr uint32_t DelayLine::RETRANSMIT_DELAY_US;
+
+bool tNetworkProfile::IsIdeal() const
+{
+    return nLatency_us == 0 && nJitter_us == 0 && reorderRatio <= 0.0 && lossRatio <= 0.0;
+}
+
+bool tNetworkProfile::FromName(const std::string &name, tNetworkProfile &profile)
+{
+    profile = tNetworkProfile();
+    if (name == "ideal")
+    {
+        return true;
+    }
+    if (name == "lan")
+    {
+        //a switch or two between the arm and the computer
+        profile.nLatency_us = 100;
+        profile.nJitter_us = 50;
+        return true;
+    }
+    if (name == "wifi")
+    {
+        profile.nLatency_us = 1500;
+        profile.nJitter_us = 3000;
+        profile.reorderRatio = 0.01;
+        profile.nReorderDelay_us = 2000;
+        profile.lossRatio = 0.005;
+        return true;
+    }
+    if (name == "congested")
+    {
+        profile.nLatency_us = 5000;
+        profile.nJitter_us = 10000;
+        profile.reorderRatio = 0.05;
+        profile.nReorderDelay_us = 5000;
+        profile.lossRatio = 0.02;
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::string> tNetworkProfile::GetNames()
+{
+    return {"ideal", "lan", "wifi", "congested"};
+}
+
+DelayLine::DelayLine(const tNetworkProfile &profile, bool bStream, uint32_t seed, const Sink &sink) :
+    m_Profile(profile), m_bStream(bStream), m_Sink(sink), m_Generator(seed)
+{
+    m_nSequence = 0;
+    m_bStop = false;
+    m_nDropped = 0;
+    m_nReordered = 0;
+    m_nRetransmitted = 0;
+    if (!m_Profile.IsIdeal())
+    {
+        m_Worker = std::thread(&DelayLine::Run, this);
+    }
+}
+
+DelayLine::~DelayLine()
+{
+    if (m_Worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bStop = true;
+        }
+        m_Condition.notify_one();
+        m_Worker.join();
+    }
+}
+
+void DelayLine::Push(std::string &bytes)
+{
+    if (!m_Worker.joinable())
+    {
+        m_Sink(bytes);
+        return;
+    }
+
+    auto now = steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        auto due = now + microseconds(m_Profile.nLatency_us + uint32_t(uniform(m_Generator) * m_Profile.nJitter_us));
+        bool bLost = uniform(m_Generator) < m_Profile.lossRatio;
+        if (m_bStream)
+        {
+            //in order, a retransmission holds back everything sent after it
+            if (bLost)
+            {
+                due += microseconds(RETRANSMIT_DELAY_US);
+                m_nRetransmitted++;
+            }
+            due = std::max(due, m_LastDue);
+            m_LastDue = due;
+        }
+        else if (bLost)
+        {
+            m_nDropped++;
+            return;
+        }
+        else if (uniform(m_Generator) < m_Profile.reorderRatio)
+        {
+            due += microseconds(m_Profile.nReorderDelay_us);
+            m_nReordered++;
+        }
+
+        m_Items.push_back(tItem());
+        m_Items.back().due = due;
+        m_Items.back().nSequence = m_nSequence++;
+        m_Items.back().bytes.swap(bytes);
+        std::push_heap(m_Items.begin(), m_Items.end(), std::greater<tItem>());
+        if (!m_FreeBuffers.empty())
+        {
+            bytes.swap(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+    }
+    m_Condition.notify_one();
+}
+
+void DelayLine::Run()
+{
+    std::string bytes;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (!m_bStop)
+    {
+        if (m_Items.empty())
+        {
+            m_Condition.wait(lock);
+            continue;
+        }
+        if (steady_clock::now() < m_Items.front().due)
+        {
+            //woken up early when an earlier frame is pushed
+            m_Condition.wait_until(lock, m_Items.front().due);
+            continue;
+        }
+
+        std::pop_heap(m_Items.begin(), m_Items.end(), std::greater<tItem>());
+        bytes.swap(m_Items.back().bytes);
+        m_Items.pop_back();
+        lock.unlock();
+
+        m_Sink(bytes);
+
+        lock.lock();
+        m_FreeBuffers.push_back(std::string());
+        m_FreeBuffers.back().swap(bytes);
+    }
+}
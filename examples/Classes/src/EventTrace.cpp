@@ -0,0 +1,447 @@
+#include "Classes/include/EventTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "Classes/include/CyclicWireFormat.h"
+
+namespace
+{
+    //seqlock per slot: sequence is 0 while the slot is written, the index of its event + 1 once written
+    struct tSlot
+    {
+        std::atomic<uint64_t> sequence;
+        std::atomic<const char*> category;
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> start_ns;
+        std::atomic<uint64_t> duration_ns;
+    };
+
+    struct tRing
+    {
+        tRing(size_t nEvents, uint32_t threadId) : pSlots(new tSlot[nEvents]), nEvents(nEvents), nThreadId(threadId)
+        {
+            for (size_t i = 0; i < nEvents; i++)
+            {
+                pSlots[i].sequence.store(0, std::memory_order_relaxed);
+            }
+            nHead.store(0, std::memory_order_relaxed);
+            nFirst.store(0, std::memory_order_relaxed);
+        }
+
+        std::unique_ptr<tSlot[]> pSlots;
+        const size_t nEvents;
+        const uint32_t nThreadId;
+        std::atomic<uint64_t> nHead;        //events written, by the thread of the ring only
+        std::atomic<uint64_t> nFirst;       //first event kept by Clear()
+
+        std::mutex nameMutex;
+        std::string name;
+    };
+
+    //the rings outlive their thread, the events of a thread which ended are dumped too
+    struct tRegistry
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<tRing>> rings;
+        size_t nRingEvents = EventTrace::DEFAULT_RING_EVENTS;
+    };
+
+    tRegistry& GetRegistry()
+    {
+        static tRegistry registry;
+        return registry;
+    }
+
+    thread_local std::shared_ptr<tRing> t_pRing;
+    thread_local std::string t_ThreadName;
+
+    tRing& GetRing()
+    {
+        if (!t_pRing)
+        {
+            tRegistry &registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            t_pRing = std::make_shared<tRing>(registry.nRingEvents, uint32_t(registry.rings.size() + 1));
+            t_pRing->name = t_ThreadName;
+            registry.rings.push_back(t_pRing);
+        }
+        return *t_pRing;
+    }
+
+    void DumpAtExit()
+    {
+        const char *path = getenv("KORTEX_EVENT_TRACE");
+        if (path != nullptr && !EventTrace::Dump(path))
+        {
+            std::cerr << "Cannot write the event trace to " << path << std::endl;
+        }
+    }
+
+    struct tEnvironment
+    {
+        tEnvironment()
+        {
+            if (getenv("KORTEX_EVENT_TRACE") != nullptr)
+            {
+                //constructed before the handler is registered, destroyed after it ran
+                GetRegistry();
+                EventTrace::Enable();
+                atexit(DumpAtExit);
+            }
+        }
+    };
+    tEnvironment s_Environment;
+
+    void WriteJsonString(std::ostream &stream, const std::string &value)
+    {
+        stream << '"';
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if (uint8_t(c) < 0x20)
+            {
+                stream << ' ';
+            }
+            else
+            {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+
+    void WriteChromeJson(std::ostream &stream, const std::vector<EventTrace::tThread> &threads,
+                         const std::vector<EventTrace::tEvent> &events, uint64_t origin_ns)
+    {
+        stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool bFirst = true;
+        for (const EventTrace::tThread &thread : threads)
+        {
+            stream << (bFirst ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread.threadId
+                   << ",\"args\":{\"name\":";
+            WriteJsonString(stream, thread.name.empty() ? "thread " + std::to_string(thread.threadId) : thread.name);
+            stream << "}}";
+            bFirst = false;
+        }
+        //microseconds with the nanoseconds as decimals
+        auto writeTime = [&stream](uint64_t value_ns)
+        {
+            stream << value_ns / 1000 << '.' << char('0' + value_ns / 100 % 10) << char('0' + value_ns / 10 % 10)
+                   << char('0' + value_ns % 10);
+        };
+        for (const EventTrace::tEvent &event : events)
+        {
+            stream << (bFirst ? "" : ",\n") << "{\"ph\":\"" << (event.duration_ns == EventTrace::INSTANT ? "i\",\"s\":\"t" : "X")
+                   << "\",\"cat\":";
+            WriteJsonString(stream, event.category);
+            stream << ",\"name\":";
+            WriteJsonString(stream, event.name);
+            stream << ",\"pid\":1,\"tid\":" << event.threadId << ",\"ts\":";
+            writeTime(event.start_ns - origin_ns);
+            if (event.duration_ns != EventTrace::INSTANT)
+            {
+                stream << ",\"dur\":";
+                writeTime(event.duration_ns);
+            }
+            stream << "}";
+            bFirst = false;
+        }
+        stream << "\n]}\n";
+    }
+
+    //Perfetto protobuf, the fields of perfetto/trace/trace_packet.proto and track_event/*.proto written by hand
+    class tProtoWriter
+    {
+    public:
+        void Varint(uint32_t field, uint64_t value)
+        {
+            Tag(field, CyclicWire::WIRETYPE_VARINT);
+            Raw(value);
+        }
+        void String(uint32_t field, const std::string &value)
+        {
+            Tag(field, CyclicWire::WIRETYPE_LENGTH_DELIMITED);
+            Raw(value.size());
+            m_Bytes += value;
+        }
+        void Message(uint32_t field, const tProtoWriter &message)
+        {
+            String(field, message.m_Bytes);
+        }
+        const std::string& GetBytes() const {return m_Bytes;}
+
+    private:
+        void Tag(uint32_t field, int wireType)
+        {
+            Raw((uint64_t(field) << 3) | uint64_t(wireType));
+        }
+        void Raw(uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                m_Bytes += char(uint8_t(value) | 0x80);
+                value >>= 7;
+            }
+            m_Bytes += char(value);
+        }
+
+        std::string m_Bytes;
+    };
+
+    enum
+    {
+        TRACE_PACKET = 1,
+
+        PACKET_TIMESTAMP = 8,
+        PACKET_SEQUENCE_ID = 10,
+        PACKET_TRACK_EVENT = 11,
+        PACKET_SEQUENCE_FLAGS = 13,
+        PACKET_TRACK_DESCRIPTOR = 60,
+
+        TRACK_EVENT_TYPE = 9,
+        TRACK_EVENT_TRACK_UUID = 11,
+        TRACK_EVENT_CATEGORIES = 22,
+        TRACK_EVENT_NAME = 23,
+
+        TRACK_DESCRIPTOR_UUID = 1,
+        TRACK_DESCRIPTOR_THREAD = 4,
+        THREAD_PID = 1,
+        THREAD_TID = 2,
+        THREAD_NAME = 5,
+
+        TYPE_SLICE_BEGIN = 1,
+        TYPE_SLICE_END = 2,
+        TYPE_INSTANT = 3,
+
+        SEQ_INCREMENTAL_STATE_CLEARED = 1,
+        SEQUENCE_ID = 1
+    };
+
+    void WritePerfetto(std::ostream &stream, const std::vector<EventTrace::tThread> &threads,
+                       const std::vector<EventTrace::tEvent> &events)
+    {
+        tProtoWriter trace;
+        bool bFirst = true;
+        for (const EventTrace::tThread &thread : threads)
+        {
+            tProtoWriter threadDescriptor;
+            threadDescriptor.Varint(THREAD_PID, 1);
+            threadDescriptor.Varint(THREAD_TID, thread.threadId);
+            threadDescriptor.String(THREAD_NAME, thread.name.empty() ? "thread " + std::to_string(thread.threadId) : thread.name);
+            tProtoWriter descriptor;
+            descriptor.Varint(TRACK_DESCRIPTOR_UUID, thread.threadId);
+            descriptor.Message(TRACK_DESCRIPTOR_THREAD, threadDescriptor);
+            tProtoWriter packet;
+            packet.Varint(PACKET_SEQUENCE_ID, SEQUENCE_ID);
+            if (bFirst)
+            {
+                packet.Varint(PACKET_SEQUENCE_FLAGS, SEQ_INCREMENTAL_STATE_CLEARED);
+                bFirst = false;
+            }
+            packet.Message(PACKET_TRACK_DESCRIPTOR, descriptor);
+            trace.Message(TRACE_PACKET, packet);
+        }
+
+        //a complete event is a begin and an end, sorted so that the slices of a thread nest
+        struct tEdge
+        {
+            uint64_t time_ns;
+            int order;              //ends before begins at the same time
+            uint64_t duration_ns;
+            const EventTrace::tEvent *pEvent;
+        };
+        std::vector<tEdge> edges;
+        edges.reserve(events.size() * 2);
+        for (const EventTrace::tEvent &event : events)
+        {
+            if (event.duration_ns == EventTrace::INSTANT)
+            {
+                edges.push_back(tEdge{event.start_ns, 1, 0, &event});
+            }
+            else
+            {
+                edges.push_back(tEdge{event.start_ns, 1, event.duration_ns, &event});
+                edges.push_back(tEdge{event.start_ns + event.duration_ns, 0, event.duration_ns, &event});
+            }
+        }
+        std::sort(edges.begin(), edges.end(), [](const tEdge &a, const tEdge &b)
+        {
+            if (a.time_ns != b.time_ns) return a.time_ns < b.time_ns;
+            if (a.order != b.order) return a.order < b.order;
+            //the inner slice ends first and begins last
+            return a.order == 0 ? a.duration_ns < b.duration_ns : a.duration_ns > b.duration_ns;
+        });
+
+        for (const tEdge &edge : edges)
+        {
+            const EventTrace::tEvent &event = *edge.pEvent;
+            tProtoWriter trackEvent;
+            trackEvent.Varint(TRACK_EVENT_TYPE, event.duration_ns == EventTrace::INSTANT ? TYPE_INSTANT
+                                                : edge.order == 0 ? TYPE_SLICE_END : TYPE_SLICE_BEGIN);
+            trackEvent.Varint(TRACK_EVENT_TRACK_UUID, event.threadId);
+            if (edge.order == 1)
+            {
+                trackEvent.String(TRACK_EVENT_CATEGORIES, event.category);
+                trackEvent.String(TRACK_EVENT_NAME, event.name);
+            }
+            tProtoWriter packet;
+            packet.Varint(PACKET_TIMESTAMP, edge.time_ns);
+            packet.Varint(PACKET_SEQUENCE_ID, SEQUENCE_ID);
+            packet.Message(PACKET_TRACK_EVENT, trackEvent);
+            trace.Message(TRACE_PACKET, packet);
+        }
+        stream.write(trace.GetBytes().data(), std::streamsize(trace.GetBytes().size()));
+    }
+}
+
+constexpr uint64_t EventTrace::INSTANT;
+constexpr size_t EventTrace::DEFAULT_RING_EVENTS;
+std::atomic<bool> EventTrace::s_bEnabled(false);
+
+void EventTrace::Enable(bool bEnabled)
+{
+    s_bEnabled.store(bEnabled);
+}
+
+void EventTrace::SetRingEvents(size_t nEvents)
+{
+    tRegistry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.nRingEvents = std::max<size_t>(nEvents, 1);
+}
+
+uint64_t EventTrace::Now()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void EventTrace::Record(const char *category, const char *name, uint64_t start_ns, uint64_t duration_ns)
+{
+    tRing &ring = GetRing();
+    const uint64_t index = ring.nHead.load(std::memory_order_relaxed);
+    tSlot &slot = ring.pSlots[index % ring.nEvents];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.duration_ns.store(duration_ns, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+    ring.nHead.store(index + 1, std::memory_order_release);
+}
+
+void EventTrace::SetThreadName(const std::string &name)
+{
+    if (name == t_ThreadName)
+    {
+        return;
+    }
+    t_ThreadName = name;
+    if (t_pRing)
+    {
+        std::lock_guard<std::mutex> lock(t_pRing->nameMutex);
+        t_pRing->name = name;
+    }
+}
+
+std::vector<EventTrace::tEvent> EventTrace::GetEvents()
+{
+    std::vector<std::shared_ptr<tRing>> rings;
+    {
+        tRegistry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        rings = registry.rings;
+    }
+
+    std::vector<tEvent> events;
+    for (const auto &pRing : rings)
+    {
+        const uint64_t head = pRing->nHead.load(std::memory_order_acquire);
+        uint64_t first = std::max(pRing->nFirst.load(std::memory_order_relaxed), head > pRing->nEvents ? head - pRing->nEvents : 0);
+        for (uint64_t index = first; index < head; index++)
+        {
+            const tSlot &slot = pRing->pSlots[index % pRing->nEvents];
+            const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            tEvent event;
+            event.category = slot.category.load(std::memory_order_relaxed);
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+            event.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+            event.threadId = pRing->nThreadId;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            //overwritten by the thread while it was read
+            if (before == index + 1 && slot.sequence.load(std::memory_order_relaxed) == before)
+            {
+                events.push_back(event);
+            }
+        }
+    }
+    return events;
+}
+
+std::vector<EventTrace::tThread> EventTrace::GetThreads()
+{
+    tRegistry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<tThread> threads;
+    for (const auto &pRing : registry.rings)
+    {
+        const uint64_t head = pRing->nHead.load(std::memory_order_acquire);
+        const uint64_t first = pRing->nFirst.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> nameLock(pRing->nameMutex);
+        threads.push_back(tThread{pRing->nThreadId, pRing->name,
+                                  head - first > pRing->nEvents ? head - first - pRing->nEvents : 0});
+    }
+    return threads;
+}
+
+void EventTrace::Clear()
+{
+    tRegistry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto &pRing : registry.rings)
+    {
+        pRing->nFirst.store(pRing->nHead.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+void EventTrace::Dump(std::ostream &stream, eFormat format)
+{
+    std::vector<tThread> threads = GetThreads();
+    std::vector<tEvent> events = GetEvents();
+    if (format == CHROME_JSON)
+    {
+        uint64_t origin_ns = 0;
+        if (!events.empty())
+        {
+            origin_ns = std::min_element(events.begin(), events.end(), [](const tEvent &a, const tEvent &b)
+            {
+                return a.start_ns < b.start_ns;
+            })->start_ns;
+        }
+        WriteChromeJson(stream, threads, events, origin_ns);
+    }
+    else
+    {
+        WritePerfetto(stream, threads, events);
+    }
+}
+
+bool EventTrace::Dump(const std::string &path)
+{
+    const std::string extension = ".json";
+    const bool bJson = path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    std::ofstream file(path, std::ios::binary);
+    Dump(file, bJson ? CHROME_JSON : PERFETTO);
+    file.close();
+    return bool(file);
+}
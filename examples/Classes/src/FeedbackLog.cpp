@@ -0,0 +1,664 @@
+#include "Classes/include/FeedbackLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+
+#if defined(_OS_UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <KBasicException.h>
+
+#include "Classes/include/EventTrace.h"
+
+namespace k_api = Kinova::Api;
+
+namespace FeedbackLog
+{
+    namespace
+    {
+        const char MAGIC[8] = {'K', 'R', 'T', 'X', 'F', 'L', 'G', '1'};
+        const uint32_t VERSION = 1;
+        const size_t PAGE_SIZE = 4096;
+        const size_t NAME_SIZE = 40;
+
+        struct tFileHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t headerSize;
+            uint32_t blockSamples;
+            uint32_t blockCount;
+            uint64_t blockSize;
+            uint32_t actuatorCount;
+            uint32_t columnCount;
+        };
+
+        struct tColumnEntry
+        {
+            char name[NAME_SIZE];
+            uint32_t type;
+            uint32_t blockOffset;
+        };
+
+        struct tBlockHeader
+        {
+            uint64_t sequence;
+            uint32_t sampleCount;
+            uint32_t droppedCount;
+            uint64_t firstTime_ns;
+            uint64_t lastTime_ns;
+        };
+
+        size_t RoundUp(size_t size, size_t multiple)
+        {
+            return (size + multiple - 1) / multiple * multiple;
+        }
+
+        size_t TypeSize(eType type)
+        {
+            return type == U64 ? 8 : 4;
+        }
+
+        //the block offsets of the columns, returns the size of a block
+        size_t Layout(std::vector<tColumn> &columns, uint32_t blockSamples)
+        {
+            size_t offset = sizeof(tBlockHeader);
+            for (tColumn &column : columns)
+            {
+                column.blockOffset = offset;
+                offset += RoundUp(TypeSize(column.type) * blockSamples, 8);
+            }
+            return RoundUp(offset, 64);
+        }
+
+        std::string Error(const std::string &what, const std::string &path)
+        {
+            return what + " " + path + ": " + strerror(errno);
+        }
+
+        void WriteValue(std::ostream &stream, eType type, const char *pValue)
+        {
+            if (type == F32)
+            {
+                float value;
+                memcpy(&value, pValue, sizeof(value));
+                stream << value;
+            }
+            else if (type == U32)
+            {
+                uint32_t value;
+                memcpy(&value, pValue, sizeof(value));
+                stream << value;
+            }
+            else
+            {
+                uint64_t value;
+                memcpy(&value, pValue, sizeof(value));
+                stream << value;
+            }
+        }
+    }
+
+    std::vector<tColumn> MakeSchema(int nActuatorCount)
+    {
+        //offsets taken on an instance: tFlatFeedback is not standard layout for offsetof
+        std::unique_ptr<tFlatFeedback> pFeedback(new tFlatFeedback);
+        const char *pBase = reinterpret_cast<const char*>(pFeedback.get());
+        std::vector<tColumn> columns;
+        auto add = [&](const std::string &name, eType type, const void *pField)
+        {
+            tColumn column = {name, type, size_t(static_cast<const char*>(pField) - pBase), 0};
+            columns.push_back(column);
+        };
+
+        add("time_ns", U64, pBase);
+        columns.back().feedbackOffset = NO_FIELD;
+        add("frame_id", U32, &pFeedback->frameId);
+
+        const tFlatActuatorFeedback &actuators = pFeedback->actuators;
+        for (int i = 0; i < std::min(nActuatorCount, int(CyclicWire::MAX_ACTUATORS)); i++)
+        {
+            const std::string prefix = "actuators[" + std::to_string(i) + "].";
+            add(prefix + "command_id", U32, &actuators.commandId[i]);
+            add(prefix + "status_flags", U32, &actuators.statusFlags[i]);
+            add(prefix + "jitter_comm", U32, &actuators.jitterComm[i]);
+            add(prefix + "position", F32, &actuators.position[i]);
+            add(prefix + "velocity", F32, &actuators.velocity[i]);
+            add(prefix + "torque", F32, &actuators.torque[i]);
+            add(prefix + "current_motor", F32, &actuators.currentMotor[i]);
+            add(prefix + "voltage", F32, &actuators.voltage[i]);
+            add(prefix + "temperature_motor", F32, &actuators.temperatureMotor[i]);
+            add(prefix + "temperature_core", F32, &actuators.temperatureCore[i]);
+            add(prefix + "fault_bank_a", U32, &actuators.faultBankA[i]);
+            add(prefix + "fault_bank_b", U32, &actuators.faultBankB[i]);
+            add(prefix + "warning_bank_a", U32, &actuators.warningBankA[i]);
+            add(prefix + "warning_bank_b", U32, &actuators.warningBankB[i]);
+        }
+
+        const tFlatBaseFeedback &base = pFeedback->base;
+        const char *axes[] = {"x", "y", "z"};
+        const char *poseAxes[] = {"x", "y", "z", "theta_x", "theta_y", "theta_z"};
+        add("base.active_state_connection_identifier", U32, &base.activeStateConnectionIdentifier);
+        add("base.active_state", U32, &base.activeState);
+        add("base.arm_voltage", F32, &base.armVoltage);
+        add("base.arm_current", F32, &base.armCurrent);
+        add("base.temperature_cpu", F32, &base.temperatureCpu);
+        add("base.temperature_ambient", F32, &base.temperatureAmbient);
+        for (int i = 0; i < 3; i++)
+        {
+            add(std::string("base.imu_acceleration_") + axes[i], F32, &base.imuAcceleration[i]);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            add(std::string("base.imu_angular_velocity_") + axes[i], F32, &base.imuAngularVelocity[i]);
+        }
+        for (int i = 0; i < 6; i++)
+        {
+            add(std::string("base.tool_pose_") + poseAxes[i], F32, &base.toolPose[i]);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            add(std::string("base.tool_twist_linear_") + axes[i], F32, &base.toolTwistLinear[i]);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            add(std::string("base.tool_twist_angular_") + axes[i], F32, &base.toolTwistAngular[i]);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            add(std::string("base.tool_external_wrench_force_") + axes[i], F32, &base.toolExternalWrenchForce[i]);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            add(std::string("base.tool_external_wrench_torque_") + axes[i], F32, &base.toolExternalWrenchTorque[i]);
+        }
+        add("base.fault_bank_a", U32, &base.faultBankA);
+        add("base.fault_bank_b", U32, &base.faultBankB);
+        add("base.warning_bank_a", U32, &base.warningBankA);
+        add("base.warning_bank_b", U32, &base.warningBankB);
+        for (int i = 0; i < 6; i++)
+        {
+            add(std::string("base.commanded_tool_pose_") + poseAxes[i], F32, &base.commandedToolPose[i]);
+        }
+        return columns;
+    }
+
+    constexpr uint32_t Recorder::DEFAULT_BLOCK_SAMPLES;
+
+    Recorder::Recorder(int nActuatorCount, size_t queueCapacity, uint32_t flushPeriod_ms) :
+        m_nActuatorCount(std::min(nActuatorCount, int(CyclicWire::MAX_ACTUATORS))),
+        m_nQueueCapacity(std::max(queueCapacity, size_t(1))),
+        m_nFlushPeriod_ms(flushPeriod_ms),
+        m_Columns(MakeSchema(nActuatorCount))
+    {
+        m_pQueue.reset(new tFlatFeedback[m_nQueueCapacity]);
+        m_pQueueTime.reset(new uint64_t[m_nQueueCapacity]);
+        m_nHead = 0;
+        m_nTail = 0;
+        m_nDropped = 0;
+        m_bOpen = false;
+
+        m_nFile = -1;
+        m_pMapping = nullptr;
+        m_nMappingSize = 0;
+        m_nHeaderSize = 0;
+        m_nBlockSize = 0;
+        m_nBlockSamples = 0;
+        m_nBlockCount = 0;
+        m_nSequence = 0;
+        m_nBlockFill = 0;
+        m_nDroppedWritten = 0;
+        m_nWritten = 0;
+        m_bStop = false;
+    }
+
+    Recorder::~Recorder()
+    {
+        Close();
+    }
+
+    void Recorder::Push(const tFlatFeedback &feedback, uint64_t time_ns)
+    {
+        uint64_t head = m_nHead.load(std::memory_order_relaxed);
+        if (!m_bOpen.load(std::memory_order_relaxed) || head - m_nTail.load(std::memory_order_acquire) >= m_nQueueCapacity)
+        {
+            m_nDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t slot = size_t(head % m_nQueueCapacity);
+        memcpy(&m_pQueue[slot], &feedback, sizeof(tFlatFeedback));
+        m_pQueueTime[slot] = time_ns;
+        m_nHead.store(head + 1, std::memory_order_release);
+    }
+
+    void Recorder::Push(const k_api::BaseCyclic::Feedback &feedback, uint64_t time_ns)
+    {
+        m_Conversion.FromFeedback(feedback);
+        Push(m_Conversion, time_ns);
+    }
+
+    tRecorderStatistics Recorder::GetStatistics() const
+    {
+        tRecorderStatistics statistics;
+        statistics.nPushed = m_nHead.load(std::memory_order_acquire);
+        statistics.nDropped = m_nDropped.load(std::memory_order_relaxed);
+        statistics.nWritten = m_nWritten.load(std::memory_order_relaxed);
+        statistics.nBlocks = m_nSequence;
+        return statistics;
+    }
+
+#if defined(_OS_UNIX)
+
+    void Recorder::Open(const std::string &path, uint32_t blockCount, uint32_t blockSamples)
+    {
+        if (m_bOpen)
+        {
+            throw k_api::KBasicException("Feedback log already open");
+        }
+        if (blockCount < 2 || blockSamples == 0)
+        {
+            throw k_api::KBasicException("A feedback log needs 2 blocks or more of 1 sample or more");
+        }
+
+        m_nBlockSamples = blockSamples;
+        m_nBlockCount = blockCount;
+        m_nBlockSize = Layout(m_Columns, blockSamples);
+        m_nHeaderSize = RoundUp(sizeof(tFileHeader) + m_Columns.size() * sizeof(tColumnEntry), PAGE_SIZE);
+        m_nMappingSize = m_nHeaderSize + m_nBlockSize * blockCount;
+
+        m_nFile = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (m_nFile < 0)
+        {
+            throw k_api::KBasicException(Error("Cannot create", path));
+        }
+        //allocated now, the disk cannot fill up under the writer
+        int result = posix_fallocate(m_nFile, 0, off_t(m_nMappingSize));
+        if (result != 0)
+        {
+            errno = result;
+            std::string error = Error("Cannot allocate", path);
+            close(m_nFile);
+            m_nFile = -1;
+            throw k_api::KBasicException(error);
+        }
+        void *pMapping = mmap(nullptr, m_nMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_nFile, 0);
+        if (pMapping == MAP_FAILED)
+        {
+            std::string error = Error("Cannot map", path);
+            close(m_nFile);
+            m_nFile = -1;
+            throw k_api::KBasicException(error);
+        }
+        m_pMapping = static_cast<char*>(pMapping);
+
+        tFileHeader header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.headerSize = uint32_t(m_nHeaderSize);
+        header.blockSamples = blockSamples;
+        header.blockCount = blockCount;
+        header.blockSize = m_nBlockSize;
+        header.actuatorCount = uint32_t(m_nActuatorCount);
+        header.columnCount = uint32_t(m_Columns.size());
+        memcpy(m_pMapping, &header, sizeof(header));
+        for (size_t i = 0; i < m_Columns.size(); i++)
+        {
+            tColumnEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            strncpy(entry.name, m_Columns[i].name.c_str(), NAME_SIZE - 1);
+            entry.type = m_Columns[i].type;
+            entry.blockOffset = uint32_t(m_Columns[i].blockOffset);
+            memcpy(m_pMapping + sizeof(header) + i * sizeof(entry), &entry, sizeof(entry));
+        }
+
+        m_nSequence = 0;
+        m_nBlockFill = blockSamples;    //a block is started with the first sample
+        m_nDroppedWritten = m_nDropped;
+        m_nWritten = 0;
+        m_nTail = m_nHead.load();
+        m_bStop = false;
+        m_Thread = std::thread(&Recorder::Run, this);
+        m_bOpen = true;
+    }
+
+    void Recorder::Close()
+    {
+        if (!m_bOpen)
+        {
+            return;
+        }
+        m_bOpen = false;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bStop = true;
+        }
+        m_Condition.notify_one();
+        m_Thread.join();
+
+        munmap(m_pMapping, m_nMappingSize);
+        close(m_nFile);
+        m_pMapping = nullptr;
+        m_nFile = -1;
+    }
+
+#else
+
+    void Recorder::Open(const std::string&, uint32_t, uint32_t)
+    {
+        throw k_api::KBasicException("Feedback logs need mmap");
+    }
+
+    void Recorder::Close()
+    {
+    }
+
+#endif
+
+    void Recorder::Run()
+    {
+        KORTEX_TRACE_THREAD_NAME("feedback log");
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (true)
+        {
+            bool bStop = m_Condition.wait_for(lock, std::chrono::milliseconds(m_nFlushPeriod_ms), [this]() {return m_bStop;});
+            lock.unlock();
+            {
+                KORTEX_TRACE_SCOPE("feedback log", "drain");
+                while (Drain())
+                {
+                }
+            }
+            lock.lock();
+            if (bStop)
+            {
+                return;
+            }
+        }
+    }
+
+    char* Recorder::GetBlock(uint64_t sequence) const
+    {
+        return m_pMapping + m_nHeaderSize + size_t((sequence - 1) % m_nBlockCount) * m_nBlockSize;
+    }
+
+    void Recorder::StartBlock()
+    {
+        m_nSequence++;
+        m_nBlockFill = 0;
+
+        //invalid while it is rewritten
+        tBlockHeader header;
+        memset(&header, 0, sizeof(header));
+        char *pBlock = GetBlock(m_nSequence);
+        memcpy(pBlock, &header, sizeof(header));
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void Recorder::CommitBlock()
+    {
+        char *pBlock = GetBlock(m_nSequence);
+        tBlockHeader header;
+        memcpy(&header, pBlock, sizeof(header));
+        if (header.sequence == 0)
+        {
+            uint64_t dropped = m_nDropped.load(std::memory_order_relaxed);
+            header.droppedCount = uint32_t(std::min<uint64_t>(dropped - m_nDroppedWritten, std::numeric_limits<uint32_t>::max()));
+            m_nDroppedWritten = dropped;
+        }
+        const uint64_t *pTimes = reinterpret_cast<const uint64_t*>(pBlock + m_Columns[0].blockOffset);
+        header.sampleCount = m_nBlockFill;
+        header.firstTime_ns = pTimes[0];
+        header.lastTime_ns = pTimes[m_nBlockFill - 1];
+
+        //the values before the count, the count before the sequence
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(pBlock + offsetof(tBlockHeader, sampleCount), &header.sampleCount, sizeof(tBlockHeader) - offsetof(tBlockHeader, sampleCount));
+        std::atomic_thread_fence(std::memory_order_release);
+        header.sequence = m_nSequence;
+        memcpy(pBlock, &header.sequence, sizeof(header.sequence));
+    }
+
+    bool Recorder::Drain()
+    {
+        uint64_t tail = m_nTail.load(std::memory_order_relaxed);
+        uint64_t head = m_nHead.load(std::memory_order_acquire);
+        if (head == tail)
+        {
+            return false;
+        }
+
+        if (m_nBlockFill == m_nBlockSamples)
+        {
+            StartBlock();
+        }
+        //up to the end of the block and of the queue, column by column
+        uint32_t count = uint32_t(std::min<uint64_t>(head - tail, m_nBlockSamples - m_nBlockFill));
+        char *pBlock = GetBlock(m_nSequence);
+        for (const tColumn &column : m_Columns)
+        {
+            const size_t size = TypeSize(column.type);
+            char *pValues = pBlock + column.blockOffset + size * m_nBlockFill;
+            if (&column == &m_Columns[0])
+            {
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    memcpy(pValues + i * size, &m_pQueueTime[size_t((tail + i) % m_nQueueCapacity)], size);
+                }
+                continue;
+            }
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const char *pFeedback = reinterpret_cast<const char*>(&m_pQueue[size_t((tail + i) % m_nQueueCapacity)]);
+                memcpy(pValues + i * size, pFeedback + column.feedbackOffset, size);
+            }
+        }
+        m_nTail.store(tail + count, std::memory_order_release);
+        m_nBlockFill += count;
+        m_nWritten.fetch_add(count, std::memory_order_relaxed);
+        CommitBlock();
+        return true;
+    }
+
+    Reader::Reader()
+    {
+        m_pMapping = nullptr;
+        m_nSize = 0;
+        m_nActuatorCount = 0;
+        m_nSampleCount = 0;
+    }
+
+    Reader::~Reader()
+    {
+        Close();
+    }
+
+#if defined(_OS_UNIX)
+
+    void Reader::Open(const std::string &path)
+    {
+        Close();
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            throw k_api::KBasicException(Error("Cannot open", path));
+        }
+        struct stat status;
+        if (fstat(file, &status) != 0 || size_t(status.st_size) < sizeof(tFileHeader))
+        {
+            close(file);
+            throw k_api::KBasicException("Not a feedback log: " + path);
+        }
+        void *pMapping = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (pMapping == MAP_FAILED)
+        {
+            throw k_api::KBasicException(Error("Cannot map", path));
+        }
+        m_pMapping = static_cast<const char*>(pMapping);
+        m_nSize = size_t(status.st_size);
+
+        tFileHeader header;
+        memcpy(&header, m_pMapping, sizeof(header));
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+            || sizeof(header) + size_t(header.columnCount) * sizeof(tColumnEntry) > header.headerSize
+            || header.headerSize + header.blockSize * header.blockCount > m_nSize)
+        {
+            Close();
+            throw k_api::KBasicException("Not a feedback log: " + path);
+        }
+        m_nActuatorCount = int(header.actuatorCount);
+
+        //the offsets in a feedback are the ones of this build, the names tell which field a column is
+        std::vector<tColumn> schema = MakeSchema(m_nActuatorCount);
+        for (uint32_t i = 0; i < header.columnCount; i++)
+        {
+            tColumnEntry entry;
+            memcpy(&entry, m_pMapping + sizeof(header) + i * sizeof(entry), sizeof(entry));
+            tColumn column;
+            column.name = std::string(entry.name, strnlen(entry.name, NAME_SIZE));
+            column.type = eType(entry.type);
+            column.blockOffset = entry.blockOffset;
+            column.feedbackOffset = NO_FIELD;
+            for (const tColumn &known : schema)
+            {
+                if (known.name == column.name && known.type == column.type)
+                {
+                    column.feedbackOffset = known.feedbackOffset;
+                }
+            }
+            if (column.blockOffset + TypeSize(column.type) * header.blockSamples > header.blockSize)
+            {
+                Close();
+                throw k_api::KBasicException("Corrupted feedback log: " + path);
+            }
+            m_Columns.push_back(column);
+        }
+
+        for (uint32_t i = 0; i < header.blockCount; i++)
+        {
+            const char *pBlock = m_pMapping + header.headerSize + size_t(i) * header.blockSize;
+            tBlockHeader blockHeader;
+            memcpy(&blockHeader, pBlock, sizeof(blockHeader));
+            if (blockHeader.sequence == 0 || blockHeader.sampleCount == 0 || blockHeader.sampleCount > header.blockSamples)
+            {
+                continue;
+            }
+            tBlock block = {blockHeader.sequence, blockHeader.sampleCount, blockHeader.droppedCount,
+                            blockHeader.firstTime_ns, blockHeader.lastTime_ns, pBlock};
+            m_Blocks.push_back(block);
+            m_nSampleCount += blockHeader.sampleCount;
+        }
+        std::sort(m_Blocks.begin(), m_Blocks.end(), [](const tBlock &a, const tBlock &b) {return a.sequence < b.sequence;});
+    }
+
+    void Reader::Close()
+    {
+        if (m_pMapping)
+        {
+            munmap(const_cast<char*>(m_pMapping), m_nSize);
+            m_pMapping = nullptr;
+        }
+        m_nSize = 0;
+        m_nActuatorCount = 0;
+        m_Columns.clear();
+        m_Blocks.clear();
+        m_nSampleCount = 0;
+    }
+
+#else
+
+    void Reader::Open(const std::string&)
+    {
+        throw k_api::KBasicException("Feedback logs need mmap");
+    }
+
+    void Reader::Close()
+    {
+    }
+
+#endif
+
+    int Reader::FindColumn(const std::string &name) const
+    {
+        for (size_t i = 0; i < m_Columns.size(); i++)
+        {
+            if (m_Columns[i].name == name)
+            {
+                return int(i);
+            }
+        }
+        return -1;
+    }
+
+    bool Reader::GetSample(const tBlock &block, uint32_t index, tFlatFeedback &feedback, uint64_t &time_ns) const
+    {
+        if (index >= block.sampleCount)
+        {
+            return false;
+        }
+        feedback.Reset();
+        feedback.actuators.nCount = m_nActuatorCount;
+        feedback.base.bPresent = true;
+        char *pFeedback = reinterpret_cast<char*>(&feedback);
+        for (size_t i = 0; i < m_Columns.size(); i++)
+        {
+            const tColumn &column = m_Columns[i];
+            const size_t size = TypeSize(column.type);
+            const char *pValue = block.pData + column.blockOffset + size * index;
+            if (i == 0)
+            {
+                memcpy(&time_ns, pValue, sizeof(time_ns));
+            }
+            else if (column.feedbackOffset != NO_FIELD)
+            {
+                memcpy(pFeedback + column.feedbackOffset, pValue, size);
+            }
+        }
+        return true;
+    }
+
+    void Reader::WriteCsv(std::ostream &stream, const std::vector<int> &columns) const
+    {
+        std::vector<int> selected = columns;
+        if (selected.empty())
+        {
+            for (size_t i = 0; i < m_Columns.size(); i++)
+            {
+                selected.push_back(int(i));
+            }
+        }
+
+        for (size_t i = 0; i < selected.size(); i++)
+        {
+            stream << (i ? "," : "") << m_Columns[selected[i]].name;
+        }
+        stream << "\n";
+
+        const std::streamsize precision = stream.precision(std::numeric_limits<float>::max_digits10);
+        for (const tBlock &block : m_Blocks)
+        {
+            for (uint32_t sample = 0; sample < block.sampleCount; sample++)
+            {
+                for (size_t i = 0; i < selected.size(); i++)
+                {
+                    const tColumn &column = m_Columns[selected[i]];
+                    if (i)
+                    {
+                        stream << ",";
+                    }
+                    WriteValue(stream, column.type, block.pData + column.blockOffset + TypeSize(column.type) * sample);
+                }
+                stream << "\n";
+            }
+        }
+        stream.precision(precision);
+    }
+}
@@ -0,0 +1,98 @@
+#include "Classes/include/FeedbackMirror.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+constexpr int FeedbackMirror::WORD_COUNT;
+
+static_assert(sizeof(tFlatFeedback) % sizeof(uint64_t) == 0, "tFlatFeedback is copied as whole 64 bit words");
+
+FeedbackMirror::FeedbackMirror()
+{
+    m_nSequence = 0;
+    m_nPublishTime_ns = 0;
+    for (int i = 0; i < WORD_COUNT; i++)
+    {
+        m_Words[i].store(0, std::memory_order_relaxed);
+    }
+    m_nWriterSequence = 0;
+}
+
+void FeedbackMirror::Publish(const tFlatFeedback &feedback)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&feedback);
+    uint64_t now = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+
+    //odd: write in progress, the fence keeps the data stores after it
+    m_nWriterSequence++;
+    m_nSequence.store(m_nWriterSequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < WORD_COUNT; i++)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+        m_Words[i].store(word, std::memory_order_relaxed);
+    }
+    m_nPublishTime_ns.store(now, std::memory_order_relaxed);
+
+    m_nWriterSequence++;
+    m_nSequence.store(m_nWriterSequence, std::memory_order_release);
+}
+
+void FeedbackMirror::Publish(const k_api::BaseCyclic::Feedback &feedback)
+{
+    m_Conversion.FromFeedback(feedback);
+    Publish(m_Conversion);
+}
+
+bool FeedbackMirror::TryRead(tFlatFeedback &snapshot, uint64_t *pPublishTime_ns) const
+{
+    uint64_t begin = m_nSequence.load(std::memory_order_acquire);
+    if (begin == 0 || (begin & 1))
+    {
+        return false;
+    }
+
+    unsigned char *bytes = reinterpret_cast<unsigned char*>(&snapshot);
+    for (int i = 0; i < WORD_COUNT; i++)
+    {
+        uint64_t word = m_Words[i].load(std::memory_order_relaxed);
+        memcpy(bytes + i * sizeof(word), &word, sizeof(word));
+    }
+    uint64_t publishTime = m_nPublishTime_ns.load(std::memory_order_relaxed);
+
+    //the loads above cannot move after the check of the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_nSequence.load(std::memory_order_relaxed) != begin)
+    {
+        return false;
+    }
+
+    if (pPublishTime_ns)
+    {
+        *pPublishTime_ns = publishTime;
+    }
+    return true;
+}
+
+bool FeedbackMirror::Read(tFlatFeedback &snapshot, uint64_t *pPublishTime_ns) const
+{
+    for (int attempt = 0; ; attempt++)
+    {
+        if (TryRead(snapshot, pPublishTime_ns))
+        {
+            return true;
+        }
+        if (m_nSequence.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+        //the writer may have been preempted in the middle of a publish
+        if (attempt >= 16)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,698 @@
+#include "Classes/include/FlatFeedback.h"
+
+#include <cstring>
+
+namespace k_api = Kinova::Api;
+
+using namespace CyclicWire;
+
+namespace
+{
+    typedef k_api::BaseCyclic::Feedback Feedback;
+    typedef k_api::BaseCyclic::ActuatorFeedback ActuatorFeedback;
+    typedef k_api::BaseCyclic::BaseFeedback BaseFeedback;
+    typedef k_api::InterconnectCyclic::Feedback InterconnectFeedback;
+    typedef k_api::GripperCyclic::Feedback GripperFeedback;
+    typedef k_api::GripperCyclic::MotorFeedback MotorFeedback;
+
+    //a field with another wire type than expected is skipped, like protobuf keeps it as an unknown field.
+    //Kept out of the Read*Field helpers so they stay small enough to be inlined in the decoding loops.
+    bool SkipUnexpectedField(const uint8_t *&p, const uint8_t *end, uint32_t field, int wireType)
+    {
+        return SkipField(p, end, field, wireType);
+    }
+
+    inline bool ReadUint32Field(const uint8_t *&p, const uint8_t *end, uint32_t field, int wireType, uint32_t &value)
+    {
+        if (wireType == WIRETYPE_VARINT && p < end && *p < 0x80)
+        {
+            value = *p++;
+            return true;
+        }
+        //only varint: protobuf keeps a uint32 sent as fixed32 as an unknown field, it does not read its value
+        if (wireType == WIRETYPE_VARINT)
+        {
+            uint64_t varint;
+            if (!ReadVarint(p, end, varint))
+            {
+                return false;
+            }
+            value = uint32_t(varint);
+            return true;
+        }
+        return SkipUnexpectedField(p, end, field, wireType);
+    }
+
+    inline bool ReadFloatField(const uint8_t *&p, const uint8_t *end, uint32_t field, int wireType, float &value)
+    {
+        if (wireType == WIRETYPE_FIXED32 && end - p >= 4)
+        {
+            value = LoadFloat(p);
+            p += 4;
+            return true;
+        }
+        return SkipUnexpectedField(p, end, field, wireType);
+    }
+
+    bool ReadEnumField(const uint8_t *&p, const uint8_t *end, uint32_t field, int wireType, int32_t &value)
+    {
+        if (wireType != WIRETYPE_VARINT)
+        {
+            return SkipField(p, end, field, wireType);
+        }
+        uint64_t varint;
+        if (!ReadVarint(p, end, varint))
+        {
+            return false;
+        }
+        value = int32_t(uint32_t(varint));
+        return true;
+    }
+
+    //MessageId { uint32 identifier = 1; }, the same in InterconnectCyclic and GripperCyclic
+    bool DecodeMessageId(const uint8_t *p, const uint8_t *end, uint32_t &identifier)
+    {
+        uint32_t field;
+        int wireType;
+        while (p < end)
+        {
+            if (!ReadTag(p, end, field, wireType))
+            {
+                return false;
+            }
+            bool bSuccess = (field == k_api::InterconnectCyclic::MessageId::kIdentifierFieldNumber)
+                          ? ReadUint32Field(p, end, field, wireType, identifier)
+                          : SkipField(p, end, field, wireType);
+            if (!bSuccess)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DecodeActuator(const uint8_t *p, const uint8_t *end, tFlatActuatorFeedback &actuators, int i)
+    {
+        uint32_t field;
+        int wireType;
+        while (p < end)
+        {
+            if (!ReadTag(p, end, field, wireType))
+            {
+                return false;
+            }
+
+            bool bSuccess;
+            switch (field)
+            {
+                case ActuatorFeedback::kCommandIdFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, actuators.commandId[i]); break;
+                case ActuatorFeedback::kStatusFlagsFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, actuators.statusFlags[i]); break;
+                case ActuatorFeedback::kJitterCommFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, actuators.jitterComm[i]); break;
+                case ActuatorFeedback::kPositionFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, actuators.position[i]); break;
+                case ActuatorFeedback::kVelocityFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, actuators.velocity[i]); break;
+                case ActuatorFeedback::kTorqueFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, actuators.torque[i]); break;
+                case ActuatorFeedback::kCurrentMotorFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, actuators.currentMotor[i]); break;
+                case ActuatorFeedback::kVoltageFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, actuators.voltage[i]); break;
+                case ActuatorFeedback::kTemperatureMotorFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, actuators.temperatureMotor[i]); break;
+                case ActuatorFeedback::kTemperatureCoreFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, actuators.temperatureCore[i]); break;
+                case ActuatorFeedback::kFaultBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, actuators.faultBankA[i]); break;
+                case ActuatorFeedback::kFaultBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, actuators.faultBankB[i]); break;
+                case ActuatorFeedback::kWarningBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, actuators.warningBankA[i]); break;
+                case ActuatorFeedback::kWarningBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, actuators.warningBankB[i]); break;
+                default: bSuccess = SkipField(p, end, field, wireType); break;
+            }
+            if (!bSuccess)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DecodeBase(const uint8_t *p, const uint8_t *end, tFlatBaseFeedback &base)
+    {
+        uint32_t field;
+        int wireType;
+        while (p < end)
+        {
+            if (!ReadTag(p, end, field, wireType))
+            {
+                return false;
+            }
+
+            bool bSuccess;
+            switch (field)
+            {
+                case BaseFeedback::kActiveStateConnectionIdentifierFieldNumber:
+                    bSuccess = ReadUint32Field(p, end, field, wireType, base.activeStateConnectionIdentifier);
+                    break;
+                case BaseFeedback::kActiveStateFieldNumber: bSuccess = ReadEnumField(p, end, field, wireType, base.activeState); break;
+                case BaseFeedback::kArmVoltageFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, base.armVoltage); break;
+                case BaseFeedback::kArmCurrentFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, base.armCurrent); break;
+                case BaseFeedback::kTemperatureCpuFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, base.temperatureCpu); break;
+                case BaseFeedback::kTemperatureAmbientFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, base.temperatureAmbient); break;
+
+                case BaseFeedback::kImuAccelerationXFieldNumber:
+                case BaseFeedback::kImuAccelerationYFieldNumber:
+                case BaseFeedback::kImuAccelerationZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.imuAcceleration[field - BaseFeedback::kImuAccelerationXFieldNumber]);
+                    break;
+                case BaseFeedback::kImuAngularVelocityXFieldNumber:
+                case BaseFeedback::kImuAngularVelocityYFieldNumber:
+                case BaseFeedback::kImuAngularVelocityZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.imuAngularVelocity[field - BaseFeedback::kImuAngularVelocityXFieldNumber]);
+                    break;
+                case BaseFeedback::kToolPoseXFieldNumber:
+                case BaseFeedback::kToolPoseYFieldNumber:
+                case BaseFeedback::kToolPoseZFieldNumber:
+                case BaseFeedback::kToolPoseThetaXFieldNumber:
+                case BaseFeedback::kToolPoseThetaYFieldNumber:
+                case BaseFeedback::kToolPoseThetaZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.toolPose[field - BaseFeedback::kToolPoseXFieldNumber]);
+                    break;
+                case BaseFeedback::kToolTwistLinearXFieldNumber:
+                case BaseFeedback::kToolTwistLinearYFieldNumber:
+                case BaseFeedback::kToolTwistLinearZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.toolTwistLinear[field - BaseFeedback::kToolTwistLinearXFieldNumber]);
+                    break;
+                case BaseFeedback::kToolTwistAngularXFieldNumber:
+                case BaseFeedback::kToolTwistAngularYFieldNumber:
+                case BaseFeedback::kToolTwistAngularZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.toolTwistAngular[field - BaseFeedback::kToolTwistAngularXFieldNumber]);
+                    break;
+                case BaseFeedback::kToolExternalWrenchForceXFieldNumber:
+                case BaseFeedback::kToolExternalWrenchForceYFieldNumber:
+                case BaseFeedback::kToolExternalWrenchForceZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.toolExternalWrenchForce[field - BaseFeedback::kToolExternalWrenchForceXFieldNumber]);
+                    break;
+                case BaseFeedback::kToolExternalWrenchTorqueXFieldNumber:
+                case BaseFeedback::kToolExternalWrenchTorqueYFieldNumber:
+                case BaseFeedback::kToolExternalWrenchTorqueZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.toolExternalWrenchTorque[field - BaseFeedback::kToolExternalWrenchTorqueXFieldNumber]);
+                    break;
+
+                case BaseFeedback::kFaultBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, base.faultBankA); break;
+                case BaseFeedback::kFaultBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, base.faultBankB); break;
+                case BaseFeedback::kWarningBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, base.warningBankA); break;
+                case BaseFeedback::kWarningBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, base.warningBankB); break;
+
+                case BaseFeedback::kCommandedToolPoseXFieldNumber:
+                case BaseFeedback::kCommandedToolPoseYFieldNumber:
+                case BaseFeedback::kCommandedToolPoseZFieldNumber:
+                case BaseFeedback::kCommandedToolPoseThetaXFieldNumber:
+                case BaseFeedback::kCommandedToolPoseThetaYFieldNumber:
+                case BaseFeedback::kCommandedToolPoseThetaZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, base.commandedToolPose[field - BaseFeedback::kCommandedToolPoseXFieldNumber]);
+                    break;
+
+                default: bSuccess = SkipField(p, end, field, wireType); break;
+            }
+            if (!bSuccess)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DecodeGripperMotor(const uint8_t *p, const uint8_t *end, tFlatGripperFeedback &gripper, int i)
+    {
+        uint32_t field;
+        int wireType;
+        while (p < end)
+        {
+            if (!ReadTag(p, end, field, wireType))
+            {
+                return false;
+            }
+
+            bool bSuccess;
+            switch (field)
+            {
+                case MotorFeedback::kMotorIdFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, gripper.motorId[i]); break;
+                case MotorFeedback::kPositionFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, gripper.position[i]); break;
+                case MotorFeedback::kVelocityFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, gripper.velocity[i]); break;
+                case MotorFeedback::kCurrentMotorFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, gripper.currentMotor[i]); break;
+                case MotorFeedback::kVoltageFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, gripper.voltage[i]); break;
+                case MotorFeedback::kTemperatureMotorFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, gripper.temperatureMotor[i]); break;
+                default: bSuccess = SkipField(p, end, field, wireType); break;
+            }
+            if (!bSuccess)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DecodeGripper(const uint8_t *p, const uint8_t *end, tFlatGripperFeedback &gripper)
+    {
+        uint32_t field;
+        int wireType;
+        const uint8_t *subEnd;
+        while (p < end)
+        {
+            if (!ReadTag(p, end, field, wireType))
+            {
+                return false;
+            }
+
+            bool bSuccess;
+            switch (field)
+            {
+                case GripperFeedback::kFeedbackIdFieldNumber:
+                    if (wireType != WIRETYPE_LENGTH_DELIMITED)
+                    {
+                        bSuccess = SkipField(p, end, field, wireType);
+                        break;
+                    }
+                    if (!ReadLengthDelimited(p, end, wireType, subEnd))
+                    {
+                        return false;
+                    }
+                    bSuccess = DecodeMessageId(p, subEnd, gripper.feedbackId);
+                    gripper.bHasFeedbackId = true;
+                    p = subEnd;
+                    break;
+                case GripperFeedback::kStatusFlagsFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, gripper.statusFlags); break;
+                case GripperFeedback::kFaultBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, gripper.faultBankA); break;
+                case GripperFeedback::kFaultBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, gripper.faultBankB); break;
+                case GripperFeedback::kWarningBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, gripper.warningBankA); break;
+                case GripperFeedback::kWarningBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, gripper.warningBankB); break;
+                case GripperFeedback::kMotorFieldNumber:
+                    if (wireType != WIRETYPE_LENGTH_DELIMITED)
+                    {
+                        bSuccess = SkipField(p, end, field, wireType);
+                        break;
+                    }
+                    if (gripper.nMotorCount == MAX_GRIPPER_MOTORS)
+                    {
+                        return false;
+                    }
+                    if (!ReadLengthDelimited(p, end, wireType, subEnd))
+                    {
+                        return false;
+                    }
+                    bSuccess = DecodeGripperMotor(p, subEnd, gripper, gripper.nMotorCount);
+                    gripper.nMotorCount++;
+                    p = subEnd;
+                    break;
+                default: bSuccess = SkipField(p, end, field, wireType); break;
+            }
+            if (!bSuccess)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DecodeInterconnect(const uint8_t *p, const uint8_t *end, tFlatInterconnectFeedback &interconnect)
+    {
+        uint32_t field;
+        int wireType;
+        const uint8_t *subEnd;
+        while (p < end)
+        {
+            if (!ReadTag(p, end, field, wireType))
+            {
+                return false;
+            }
+
+            bool bSuccess;
+            switch (field)
+            {
+                case InterconnectFeedback::kFeedbackIdFieldNumber:
+                    if (wireType != WIRETYPE_LENGTH_DELIMITED)
+                    {
+                        bSuccess = SkipField(p, end, field, wireType);
+                        break;
+                    }
+                    if (!ReadLengthDelimited(p, end, wireType, subEnd))
+                    {
+                        return false;
+                    }
+                    bSuccess = DecodeMessageId(p, subEnd, interconnect.feedbackId);
+                    interconnect.bHasFeedbackId = true;
+                    p = subEnd;
+                    break;
+                case InterconnectFeedback::kStatusFlagsFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, interconnect.statusFlags); break;
+                case InterconnectFeedback::kJitterCommFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, interconnect.jitterComm); break;
+                case InterconnectFeedback::kImuAccelerationXFieldNumber:
+                case InterconnectFeedback::kImuAccelerationYFieldNumber:
+                case InterconnectFeedback::kImuAccelerationZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, interconnect.imuAcceleration[field - InterconnectFeedback::kImuAccelerationXFieldNumber]);
+                    break;
+                case InterconnectFeedback::kImuAngularVelocityXFieldNumber:
+                case InterconnectFeedback::kImuAngularVelocityYFieldNumber:
+                case InterconnectFeedback::kImuAngularVelocityZFieldNumber:
+                    bSuccess = ReadFloatField(p, end, field, wireType, interconnect.imuAngularVelocity[field - InterconnectFeedback::kImuAngularVelocityXFieldNumber]);
+                    break;
+                case InterconnectFeedback::kVoltageFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, interconnect.voltage); break;
+                case InterconnectFeedback::kTemperatureCoreFieldNumber: bSuccess = ReadFloatField(p, end, field, wireType, interconnect.temperatureCore); break;
+                case InterconnectFeedback::kFaultBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, interconnect.faultBankA); break;
+                case InterconnectFeedback::kFaultBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, interconnect.faultBankB); break;
+                case InterconnectFeedback::kWarningBankAFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, interconnect.warningBankA); break;
+                case InterconnectFeedback::kWarningBankBFieldNumber: bSuccess = ReadUint32Field(p, end, field, wireType, interconnect.warningBankB); break;
+                case InterconnectFeedback::kGripperFeedbackFieldNumber:
+                    if (wireType != WIRETYPE_LENGTH_DELIMITED)
+                    {
+                        bSuccess = SkipField(p, end, field, wireType);
+                        break;
+                    }
+                    if (!ReadLengthDelimited(p, end, wireType, subEnd))
+                    {
+                        return false;
+                    }
+                    bSuccess = DecodeGripper(p, subEnd, interconnect.gripper);
+                    interconnect.gripper.bPresent = true;
+                    p = subEnd;
+                    break;
+                default: bSuccess = SkipField(p, end, field, wireType); break;
+            }
+            if (!bSuccess)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void tFlatFeedback::Reset()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+bool tFlatFeedback::Decode(const uint8_t *data, size_t size)
+{
+    Reset();
+
+    const uint8_t *p = data;
+    const uint8_t *end = data + size;
+    const uint8_t *subEnd;
+    uint32_t field;
+    int wireType;
+    while (p < end)
+    {
+        if (!ReadTag(p, end, field, wireType))
+        {
+            return false;
+        }
+
+        bool bSuccess;
+        if (field == Feedback::kFrameIdFieldNumber)
+        {
+            bSuccess = ReadUint32Field(p, end, field, wireType, frameId);
+        }
+        else if (wireType != WIRETYPE_LENGTH_DELIMITED || (field != Feedback::kBaseFieldNumber && field != Feedback::kActuatorsFieldNumber && field != Feedback::kInterconnectFieldNumber))
+        {
+            bSuccess = SkipField(p, end, field, wireType);
+        }
+        else if (!ReadLengthDelimited(p, end, wireType, subEnd))
+        {
+            return false;
+        }
+        else
+        {
+            switch (field)
+            {
+                case Feedback::kBaseFieldNumber:
+                    bSuccess = DecodeBase(p, subEnd, base);
+                    base.bPresent = true;
+                    break;
+                case Feedback::kActuatorsFieldNumber:
+                    if (actuators.nCount == MAX_ACTUATORS)
+                    {
+                        return false;
+                    }
+                    bSuccess = DecodeActuator(p, subEnd, actuators, actuators.nCount);
+                    actuators.nCount++;
+                    break;
+                default:
+                    bSuccess = DecodeInterconnect(p, subEnd, interconnect);
+                    interconnect.bPresent = true;
+                    break;
+            }
+            p = subEnd;
+        }
+        if (!bSuccess)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool tFlatFeedback::FromFeedback(const k_api::BaseCyclic::Feedback &feedback)
+{
+    Reset();
+    bool bComplete = true;
+    frameId = feedback.frame_id();
+
+    base.bPresent = feedback.has_base();
+    if (base.bPresent)
+    {
+        const auto &source = feedback.base();
+        base.activeStateConnectionIdentifier = source.active_state_connection_identifier();
+        base.activeState = int32_t(source.active_state());
+        base.armVoltage = source.arm_voltage();
+        base.armCurrent = source.arm_current();
+        base.temperatureCpu = source.temperature_cpu();
+        base.temperatureAmbient = source.temperature_ambient();
+        base.imuAcceleration[0] = source.imu_acceleration_x();
+        base.imuAcceleration[1] = source.imu_acceleration_y();
+        base.imuAcceleration[2] = source.imu_acceleration_z();
+        base.imuAngularVelocity[0] = source.imu_angular_velocity_x();
+        base.imuAngularVelocity[1] = source.imu_angular_velocity_y();
+        base.imuAngularVelocity[2] = source.imu_angular_velocity_z();
+        base.toolPose[0] = source.tool_pose_x();
+        base.toolPose[1] = source.tool_pose_y();
+        base.toolPose[2] = source.tool_pose_z();
+        base.toolPose[3] = source.tool_pose_theta_x();
+        base.toolPose[4] = source.tool_pose_theta_y();
+        base.toolPose[5] = source.tool_pose_theta_z();
+        base.toolTwistLinear[0] = source.tool_twist_linear_x();
+        base.toolTwistLinear[1] = source.tool_twist_linear_y();
+        base.toolTwistLinear[2] = source.tool_twist_linear_z();
+        base.toolTwistAngular[0] = source.tool_twist_angular_x();
+        base.toolTwistAngular[1] = source.tool_twist_angular_y();
+        base.toolTwistAngular[2] = source.tool_twist_angular_z();
+        base.toolExternalWrenchForce[0] = source.tool_external_wrench_force_x();
+        base.toolExternalWrenchForce[1] = source.tool_external_wrench_force_y();
+        base.toolExternalWrenchForce[2] = source.tool_external_wrench_force_z();
+        base.toolExternalWrenchTorque[0] = source.tool_external_wrench_torque_x();
+        base.toolExternalWrenchTorque[1] = source.tool_external_wrench_torque_y();
+        base.toolExternalWrenchTorque[2] = source.tool_external_wrench_torque_z();
+        base.faultBankA = source.fault_bank_a();
+        base.faultBankB = source.fault_bank_b();
+        base.warningBankA = source.warning_bank_a();
+        base.warningBankB = source.warning_bank_b();
+        base.commandedToolPose[0] = source.commanded_tool_pose_x();
+        base.commandedToolPose[1] = source.commanded_tool_pose_y();
+        base.commandedToolPose[2] = source.commanded_tool_pose_z();
+        base.commandedToolPose[3] = source.commanded_tool_pose_theta_x();
+        base.commandedToolPose[4] = source.commanded_tool_pose_theta_y();
+        base.commandedToolPose[5] = source.commanded_tool_pose_theta_z();
+    }
+
+    actuators.nCount = feedback.actuators_size();
+    if (actuators.nCount > MAX_ACTUATORS)
+    {
+        actuators.nCount = MAX_ACTUATORS;
+        bComplete = false;
+    }
+    for (int i = 0; i < actuators.nCount; i++)
+    {
+        const auto &source = feedback.actuators(i);
+        actuators.commandId[i] = source.command_id();
+        actuators.statusFlags[i] = source.status_flags();
+        actuators.jitterComm[i] = source.jitter_comm();
+        actuators.position[i] = source.position();
+        actuators.velocity[i] = source.velocity();
+        actuators.torque[i] = source.torque();
+        actuators.currentMotor[i] = source.current_motor();
+        actuators.voltage[i] = source.voltage();
+        actuators.temperatureMotor[i] = source.temperature_motor();
+        actuators.temperatureCore[i] = source.temperature_core();
+        actuators.faultBankA[i] = source.fault_bank_a();
+        actuators.faultBankB[i] = source.fault_bank_b();
+        actuators.warningBankA[i] = source.warning_bank_a();
+        actuators.warningBankB[i] = source.warning_bank_b();
+    }
+
+    interconnect.bPresent = feedback.has_interconnect();
+    if (!interconnect.bPresent)
+    {
+        return bComplete;
+    }
+    const auto &source = feedback.interconnect();
+    interconnect.bHasFeedbackId = source.has_feedback_id();
+    interconnect.feedbackId = source.feedback_id().identifier();
+    interconnect.statusFlags = source.status_flags();
+    interconnect.jitterComm = source.jitter_comm();
+    interconnect.imuAcceleration[0] = source.imu_acceleration_x();
+    interconnect.imuAcceleration[1] = source.imu_acceleration_y();
+    interconnect.imuAcceleration[2] = source.imu_acceleration_z();
+    interconnect.imuAngularVelocity[0] = source.imu_angular_velocity_x();
+    interconnect.imuAngularVelocity[1] = source.imu_angular_velocity_y();
+    interconnect.imuAngularVelocity[2] = source.imu_angular_velocity_z();
+    interconnect.voltage = source.voltage();
+    interconnect.temperatureCore = source.temperature_core();
+    interconnect.faultBankA = source.fault_bank_a();
+    interconnect.faultBankB = source.fault_bank_b();
+    interconnect.warningBankA = source.warning_bank_a();
+    interconnect.warningBankB = source.warning_bank_b();
+
+    tFlatGripperFeedback &gripper = interconnect.gripper;
+    gripper.bPresent = source.has_gripper_feedback();
+    if (!gripper.bPresent)
+    {
+        return bComplete;
+    }
+    const auto &sourceGripper = source.gripper_feedback();
+    gripper.bHasFeedbackId = sourceGripper.has_feedback_id();
+    gripper.feedbackId = sourceGripper.feedback_id().identifier();
+    gripper.statusFlags = sourceGripper.status_flags();
+    gripper.faultBankA = sourceGripper.fault_bank_a();
+    gripper.faultBankB = sourceGripper.fault_bank_b();
+    gripper.warningBankA = sourceGripper.warning_bank_a();
+    gripper.warningBankB = sourceGripper.warning_bank_b();
+    gripper.nMotorCount = sourceGripper.motor_size();
+    if (gripper.nMotorCount > MAX_GRIPPER_MOTORS)
+    {
+        gripper.nMotorCount = MAX_GRIPPER_MOTORS;
+        bComplete = false;
+    }
+    for (int i = 0; i < gripper.nMotorCount; i++)
+    {
+        const auto &motor = sourceGripper.motor(i);
+        gripper.motorId[i] = motor.motor_id();
+        gripper.position[i] = motor.position();
+        gripper.velocity[i] = motor.velocity();
+        gripper.currentMotor[i] = motor.current_motor();
+        gripper.voltage[i] = motor.voltage();
+        gripper.temperatureMotor[i] = motor.temperature_motor();
+    }
+    return bComplete;
+}
+
+void tFlatFeedback::ToFeedback(k_api::BaseCyclic::Feedback &feedback) const
+{
+    feedback.Clear();
+    feedback.set_frame_id(frameId);
+
+    if (base.bPresent)
+    {
+        auto pBase = feedback.mutable_base();
+        pBase->set_active_state_connection_identifier(base.activeStateConnectionIdentifier);
+        pBase->set_active_state(k_api::Common::ArmState(base.activeState));
+        pBase->set_arm_voltage(base.armVoltage);
+        pBase->set_arm_current(base.armCurrent);
+        pBase->set_temperature_cpu(base.temperatureCpu);
+        pBase->set_temperature_ambient(base.temperatureAmbient);
+        pBase->set_imu_acceleration_x(base.imuAcceleration[0]);
+        pBase->set_imu_acceleration_y(base.imuAcceleration[1]);
+        pBase->set_imu_acceleration_z(base.imuAcceleration[2]);
+        pBase->set_imu_angular_velocity_x(base.imuAngularVelocity[0]);
+        pBase->set_imu_angular_velocity_y(base.imuAngularVelocity[1]);
+        pBase->set_imu_angular_velocity_z(base.imuAngularVelocity[2]);
+        pBase->set_tool_pose_x(base.toolPose[0]);
+        pBase->set_tool_pose_y(base.toolPose[1]);
+        pBase->set_tool_pose_z(base.toolPose[2]);
+        pBase->set_tool_pose_theta_x(base.toolPose[3]);
+        pBase->set_tool_pose_theta_y(base.toolPose[4]);
+        pBase->set_tool_pose_theta_z(base.toolPose[5]);
+        pBase->set_tool_twist_linear_x(base.toolTwistLinear[0]);
+        pBase->set_tool_twist_linear_y(base.toolTwistLinear[1]);
+        pBase->set_tool_twist_linear_z(base.toolTwistLinear[2]);
+        pBase->set_tool_twist_angular_x(base.toolTwistAngular[0]);
+        pBase->set_tool_twist_angular_y(base.toolTwistAngular[1]);
+        pBase->set_tool_twist_angular_z(base.toolTwistAngular[2]);
+        pBase->set_tool_external_wrench_force_x(base.toolExternalWrenchForce[0]);
+        pBase->set_tool_external_wrench_force_y(base.toolExternalWrenchForce[1]);
+        pBase->set_tool_external_wrench_force_z(base.toolExternalWrenchForce[2]);
+        pBase->set_tool_external_wrench_torque_x(base.toolExternalWrenchTorque[0]);
+        pBase->set_tool_external_wrench_torque_y(base.toolExternalWrenchTorque[1]);
+        pBase->set_tool_external_wrench_torque_z(base.toolExternalWrenchTorque[2]);
+        pBase->set_fault_bank_a(base.faultBankA);
+        pBase->set_fault_bank_b(base.faultBankB);
+        pBase->set_warning_bank_a(base.warningBankA);
+        pBase->set_warning_bank_b(base.warningBankB);
+        pBase->set_commanded_tool_pose_x(base.commandedToolPose[0]);
+        pBase->set_commanded_tool_pose_y(base.commandedToolPose[1]);
+        pBase->set_commanded_tool_pose_z(base.commandedToolPose[2]);
+        pBase->set_commanded_tool_pose_theta_x(base.commandedToolPose[3]);
+        pBase->set_commanded_tool_pose_theta_y(base.commandedToolPose[4]);
+        pBase->set_commanded_tool_pose_theta_z(base.commandedToolPose[5]);
+    }
+
+    for (int i = 0; i < actuators.nCount; i++)
+    {
+        auto pActuator = feedback.add_actuators();
+        pActuator->set_command_id(actuators.commandId[i]);
+        pActuator->set_status_flags(actuators.statusFlags[i]);
+        pActuator->set_jitter_comm(actuators.jitterComm[i]);
+        pActuator->set_position(actuators.position[i]);
+        pActuator->set_velocity(actuators.velocity[i]);
+        pActuator->set_torque(actuators.torque[i]);
+        pActuator->set_current_motor(actuators.currentMotor[i]);
+        pActuator->set_voltage(actuators.voltage[i]);
+        pActuator->set_temperature_motor(actuators.temperatureMotor[i]);
+        pActuator->set_temperature_core(actuators.temperatureCore[i]);
+        pActuator->set_fault_bank_a(actuators.faultBankA[i]);
+        pActuator->set_fault_bank_b(actuators.faultBankB[i]);
+        pActuator->set_warning_bank_a(actuators.warningBankA[i]);
+        pActuator->set_warning_bank_b(actuators.warningBankB[i]);
+    }
+
+    if (!interconnect.bPresent)
+    {
+        return;
+    }
+    auto pInterconnect = feedback.mutable_interconnect();
+    if (interconnect.bHasFeedbackId)
+    {
+        pInterconnect->mutable_feedback_id()->set_identifier(interconnect.feedbackId);
+    }
+    pInterconnect->set_status_flags(interconnect.statusFlags);
+    pInterconnect->set_jitter_comm(interconnect.jitterComm);
+    pInterconnect->set_imu_acceleration_x(interconnect.imuAcceleration[0]);
+    pInterconnect->set_imu_acceleration_y(interconnect.imuAcceleration[1]);
+    pInterconnect->set_imu_acceleration_z(interconnect.imuAcceleration[2]);
+    pInterconnect->set_imu_angular_velocity_x(interconnect.imuAngularVelocity[0]);
+    pInterconnect->set_imu_angular_velocity_y(interconnect.imuAngularVelocity[1]);
+    pInterconnect->set_imu_angular_velocity_z(interconnect.imuAngularVelocity[2]);
+    pInterconnect->set_voltage(interconnect.voltage);
+    pInterconnect->set_temperature_core(interconnect.temperatureCore);
+    pInterconnect->set_fault_bank_a(interconnect.faultBankA);
+    pInterconnect->set_fault_bank_b(interconnect.faultBankB);
+    pInterconnect->set_warning_bank_a(interconnect.warningBankA);
+    pInterconnect->set_warning_bank_b(interconnect.warningBankB);
+
+    const tFlatGripperFeedback &gripper = interconnect.gripper;
+    if (!gripper.bPresent)
+    {
+        return;
+    }
+    auto pGripper = pInterconnect->mutable_gripper_feedback();
+    if (gripper.bHasFeedbackId)
+    {
+        pGripper->mutable_feedback_id()->set_identifier(gripper.feedbackId);
+    }
+    pGripper->set_status_flags(gripper.statusFlags);
+    pGripper->set_fault_bank_a(gripper.faultBankA);
+    pGripper->set_fault_bank_b(gripper.faultBankB);
+    pGripper->set_warning_bank_a(gripper.warningBankA);
+    pGripper->set_warning_bank_b(gripper.warningBankB);
+    for (int i = 0; i < gripper.nMotorCount; i++)
+    {
+        auto pMotor = pGripper->add_motor();
+        pMotor->set_motor_id(gripper.motorId[i]);
+        pMotor->set_position(gripper.position[i]);
+        pMotor->set_velocity(gripper.velocity[i]);
+        pMotor->set_current_motor(gripper.currentMotor[i]);
+        pMotor->set_voltage(gripper.voltage[i]);
+        pMotor->set_temperature_motor(gripper.temperatureMotor[i]);
+    }
+}
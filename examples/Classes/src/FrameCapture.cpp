@@ -0,0 +1,268 @@
+#include "Classes/include/FrameCapture.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#if defined(_OS_UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <KBasicException.h>
+
+namespace k_api = Kinova::Api;
+
+namespace FrameCapture
+{
+    namespace
+    {
+        const char MAGIC[8] = {'K', 'R', 'T', 'X', 'C', 'A', 'P', '1'};
+        const uint32_t VERSION = 1;
+
+        struct tFileHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t maxTxBufferSize;
+        };
+
+        struct tRecordHeader
+        {
+            uint32_t size;
+            uint8_t direction;
+            uint8_t padding[3];
+            uint64_t timestamp_ns;
+        };
+
+        size_t Padded(size_t size)
+        {
+            return (size + 7) & ~size_t(7);
+        }
+
+        std::string Error(const std::string &what, const std::string &path)
+        {
+            return what + " " + path + ": " + strerror(errno);
+        }
+    }
+
+    constexpr size_t Writer::CHUNK_SIZE;
+
+    Writer::Writer()
+    {
+        m_nFile = -1;
+        m_pMapping = nullptr;
+        m_nCapacity = 0;
+        m_nSize = 0;
+        m_nRecords = 0;
+    }
+
+    Writer::~Writer()
+    {
+        Close();
+    }
+
+#if defined(_OS_UNIX)
+
+    void Writer::Open(const std::string &path, uint32_t maxTxBufferSize)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_nFile >= 0)
+        {
+            throw k_api::KBasicException("Capture already open");
+        }
+        m_nFile = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (m_nFile < 0)
+        {
+            throw k_api::KBasicException(Error("Cannot create", path));
+        }
+        m_nRecords = 0;
+        Map(CHUNK_SIZE);
+
+        tFileHeader header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.maxTxBufferSize = maxTxBufferSize;
+        memcpy(m_pMapping, &header, sizeof(header));
+        m_nSize = sizeof(header);
+    }
+
+    void Writer::Close()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_nFile < 0)
+        {
+            return;
+        }
+        if (m_pMapping)
+        {
+            munmap(m_pMapping, m_nCapacity);
+        }
+        //if this fails the records stay readable, followed by the zeros of the last chunk
+        int result = ftruncate(m_nFile, off_t(m_nSize));
+        (void)result;
+        close(m_nFile);
+        m_nFile = -1;
+        m_pMapping = nullptr;
+        m_nCapacity = 0;
+    }
+
+    void Writer::Map(size_t capacity)
+    {
+        if (m_pMapping)
+        {
+            munmap(m_pMapping, m_nCapacity);
+            m_pMapping = nullptr;
+        }
+        if (ftruncate(m_nFile, off_t(capacity)) != 0)
+        {
+            throw k_api::KBasicException(Error("Cannot grow", "the capture"));
+        }
+        void *pMapping = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_nFile, 0);
+        if (pMapping == MAP_FAILED)
+        {
+            throw k_api::KBasicException(Error("Cannot map", "the capture"));
+        }
+        m_pMapping = static_cast<char*>(pMapping);
+        m_nCapacity = capacity;
+    }
+
+    void Writer::Append(eDirection direction, const char *pData, uint32_t size)
+    {
+        tRecordHeader header;
+        header.size = size;
+        header.direction = direction;
+        memset(header.padding, 0, sizeof(header.padding));
+        header.timestamp_ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_nFile < 0 || !m_pMapping)
+        {
+            return;
+        }
+        size_t recordSize = sizeof(header) + Padded(size);
+        if (m_nSize + recordSize > m_nCapacity)
+        {
+            Map(((m_nSize + recordSize) / CHUNK_SIZE + 1) * CHUNK_SIZE);
+        }
+
+        //the bytes first: the record only counts once its direction is there
+        char *pRecord = m_pMapping + m_nSize;
+        memcpy(pRecord + sizeof(header), pData, size);
+        memcpy(pRecord, &header, sizeof(header));
+        m_nSize += recordSize;
+        m_nRecords++;
+    }
+
+    Reader::Reader()
+    {
+        m_pMapping = nullptr;
+        m_nSize = 0;
+        m_nOffset = 0;
+        m_nMaxTxBufferSize = 0;
+    }
+
+    Reader::~Reader()
+    {
+        Close();
+    }
+
+    void Reader::Open(const std::string &path)
+    {
+        Close();
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            throw k_api::KBasicException(Error("Cannot open", path));
+        }
+        struct stat status;
+        if (fstat(file, &status) != 0 || size_t(status.st_size) < sizeof(tFileHeader))
+        {
+            close(file);
+            throw k_api::KBasicException("Not a capture: " + path);
+        }
+        void *pMapping = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (pMapping == MAP_FAILED)
+        {
+            throw k_api::KBasicException(Error("Cannot map", path));
+        }
+
+        tFileHeader header;
+        memcpy(&header, pMapping, sizeof(header));
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+        {
+            munmap(pMapping, size_t(status.st_size));
+            throw k_api::KBasicException("Not a capture: " + path);
+        }
+        m_pMapping = static_cast<const char*>(pMapping);
+        m_nSize = size_t(status.st_size);
+        m_nMaxTxBufferSize = header.maxTxBufferSize;
+        Rewind();
+    }
+
+    void Reader::Close()
+    {
+        if (m_pMapping)
+        {
+            munmap(const_cast<char*>(m_pMapping), m_nSize);
+            m_pMapping = nullptr;
+        }
+        m_nSize = 0;
+        m_nOffset = 0;
+    }
+
+#else
+
+    void Writer::Open(const std::string&, uint32_t)
+    {
+        throw k_api::KBasicException("Frame captures need mmap");
+    }
+
+    void Writer::Close()
+    {
+    }
+
+    void Writer::Append(eDirection, const char*, uint32_t)
+    {
+    }
+
+    void Reader::Open(const std::string&)
+    {
+        throw k_api::KBasicException("Frame captures need mmap");
+    }
+
+    void Reader::Close()
+    {
+    }
+
+#endif
+
+    void Reader::Rewind()
+    {
+        m_nOffset = sizeof(tFileHeader);
+    }
+
+    bool Reader::Next(tRecord &record)
+    {
+        tRecordHeader header;
+        if (m_nOffset + sizeof(header) > m_nSize)
+        {
+            return false;
+        }
+        memcpy(&header, m_pMapping + m_nOffset, sizeof(header));
+        if (header.direction == NONE || m_nOffset + sizeof(header) + header.size > m_nSize)
+        {
+            return false;
+        }
+        record.direction = eDirection(header.direction);
+        record.timestamp_ns = header.timestamp_ns;
+        record.pData = m_pMapping + m_nOffset + sizeof(header);
+        record.size = header.size;
+        m_nOffset += sizeof(header) + Padded(header.size);
+        return true;
+    }
+}
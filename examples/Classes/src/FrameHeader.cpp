@@ -0,0 +1,49 @@
+#include "Classes/include/FrameHeader.h"
+
+#include "Classes/include/CyclicWireFormat.h"
+
+bool ParseFrameHeader(const char *pData, uint32_t size, tFrameHeader &header)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t*>(pData);
+    const uint8_t *end = p + size;
+    uint32_t fieldNumber;
+    int wireType;
+    while (CyclicWire::ReadTag(p, end, fieldNumber, wireType))
+    {
+        if (fieldNumber != 1)
+        {
+            if (!CyclicWire::SkipField(p, end, fieldNumber, wireType))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const uint8_t *headerEnd;
+        if (!CyclicWire::ReadLengthDelimited(p, end, wireType, headerEnd))
+        {
+            return false;
+        }
+        header.frame.frame_info = 0;
+        header.message.message_info = 0;
+        header.service.service_info = 0;
+        bool bFrameInfo = false;
+        while (CyclicWire::ReadTag(p, headerEnd, fieldNumber, wireType))
+        {
+            uint32_t value;
+            if (!CyclicWire::ReadUint32(p, headerEnd, wireType, value))
+            {
+                return false;
+            }
+            switch (fieldNumber)
+            {
+            case 1: header.frame.frame_info = value; bFrameInfo = true; break;
+            case 2: header.message.message_info = value; break;
+            case 3: header.service.service_info = value; break;
+            default: break;
+            }
+        }
+        return bFrameInfo;
+    }
+    return false;
+}
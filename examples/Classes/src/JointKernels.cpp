@@ -0,0 +1,373 @@
+#include "Classes/include/JointKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JOINT_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+//MSVC emits any intrinsic whatever the /arch option
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace k_api = Kinova::Api;
+
+using CyclicWire::MAX_ACTUATORS;
+
+namespace
+{
+    const float TURN = 360.0f;
+    const float TURN_INVERSE = 1.0f / 360.0f;
+    const float PI = 3.14159265358979f;
+
+    namespace Scalar
+    {
+        void PositionError(const float *target, const float *position, float *error)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i++)
+            {
+                float e = target[i] - position[i];
+                //nearest integer with ties to even, as the vector conversions do
+                float turns = std::nearbyint(e * TURN_INVERSE);
+                error[i] = e - TURN * turns;
+            }
+        }
+
+        void Pd(const tPdGains &gains, const float *positionError, const float *velocity, const float *feedforward, float *out)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i++)
+            {
+                out[i] = gains.kp[i] * positionError[i] - gains.kd[i] * velocity[i] + feedforward[i];
+            }
+        }
+
+        void Saturate(const float *low, const float *high, float *x)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i++)
+            {
+                x[i] = std::min(std::max(x[i], low[i]), high[i]);
+            }
+        }
+
+        void RateLimit(const float *maxStep, const float *previous, float *x)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i++)
+            {
+                float step = std::min(std::max(x[i] - previous[i], -maxStep[i]), maxStep[i]);
+                x[i] = previous[i] + step;
+            }
+        }
+
+        void FirstOrder(tFirstOrderFilter &filter, const float *in, float *out)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i++)
+            {
+                filter.y[i] = filter.y[i] + filter.alpha[i] * (in[i] - filter.y[i]);
+                out[i] = filter.y[i];
+            }
+        }
+
+        void SecondOrder(tSecondOrderFilter &filter, const float *in, float *out)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i++)
+            {
+                float x = in[i];
+                float y = filter.b0[i] * x + filter.z1[i];
+                filter.z1[i] = filter.b1[i] * x - filter.a1[i] * y + filter.z2[i];
+                filter.z2[i] = filter.b2[i] * x - filter.a2[i] * y;
+                out[i] = y;
+            }
+        }
+    }
+
+#if defined(JOINT_KERNELS_X86)
+    //SSE2 is part of x86-64, no check needed
+    namespace Sse2
+    {
+        void PositionError(const float *target, const float *position, float *error)
+        {
+            const __m128 turn = _mm_set1_ps(TURN);
+            const __m128 inverse = _mm_set1_ps(TURN_INVERSE);
+            for (int i = 0; i < MAX_ACTUATORS; i += 4)
+            {
+                __m128 e = _mm_sub_ps(_mm_loadu_ps(target + i), _mm_loadu_ps(position + i));
+                //no rounding instruction before SSE4.1, the conversion rounds to nearest even by default
+                __m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(e, inverse)));
+                _mm_storeu_ps(error + i, _mm_sub_ps(e, _mm_mul_ps(turn, turns)));
+            }
+        }
+
+        void Pd(const tPdGains &gains, const float *positionError, const float *velocity, const float *feedforward, float *out)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i += 4)
+            {
+                __m128 p = _mm_mul_ps(_mm_loadu_ps(gains.kp + i), _mm_loadu_ps(positionError + i));
+                __m128 d = _mm_mul_ps(_mm_loadu_ps(gains.kd + i), _mm_loadu_ps(velocity + i));
+                _mm_storeu_ps(out + i, _mm_add_ps(_mm_sub_ps(p, d), _mm_loadu_ps(feedforward + i)));
+            }
+        }
+
+        void Saturate(const float *low, const float *high, float *x)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i += 4)
+            {
+                __m128 value = _mm_max_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(low + i));
+                _mm_storeu_ps(x + i, _mm_min_ps(value, _mm_loadu_ps(high + i)));
+            }
+        }
+
+        void RateLimit(const float *maxStep, const float *previous, float *x)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i += 4)
+            {
+                __m128 last = _mm_loadu_ps(previous + i);
+                __m128 limit = _mm_loadu_ps(maxStep + i);
+                __m128 step = _mm_sub_ps(_mm_loadu_ps(x + i), last);
+                step = _mm_min_ps(_mm_max_ps(step, _mm_sub_ps(_mm_setzero_ps(), limit)), limit);
+                _mm_storeu_ps(x + i, _mm_add_ps(last, step));
+            }
+        }
+
+        void FirstOrder(tFirstOrderFilter &filter, const float *in, float *out)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i += 4)
+            {
+                __m128 y = _mm_loadu_ps(filter.y + i);
+                y = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(filter.alpha + i), _mm_sub_ps(_mm_loadu_ps(in + i), y)));
+                _mm_storeu_ps(filter.y + i, y);
+                _mm_storeu_ps(out + i, y);
+            }
+        }
+
+        void SecondOrder(tSecondOrderFilter &filter, const float *in, float *out)
+        {
+            for (int i = 0; i < MAX_ACTUATORS; i += 4)
+            {
+                __m128 x = _mm_loadu_ps(in + i);
+                __m128 y = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(filter.b0 + i), x), _mm_loadu_ps(filter.z1 + i));
+                __m128 z1 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(filter.b1 + i), x), _mm_mul_ps(_mm_loadu_ps(filter.a1 + i), y));
+                _mm_storeu_ps(filter.z1 + i, _mm_add_ps(z1, _mm_loadu_ps(filter.z2 + i)));
+                _mm_storeu_ps(filter.z2 + i, _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(filter.b2 + i), x), _mm_mul_ps(_mm_loadu_ps(filter.a2 + i), y)));
+                _mm_storeu_ps(out + i, y);
+            }
+        }
+    }
+
+    //one register holds the 8 lanes, so no loop
+    namespace Avx2
+    {
+        AVX2_TARGET void PositionError(const float *target, const float *position, float *error)
+        {
+            __m256 e = _mm256_sub_ps(_mm256_loadu_ps(target), _mm256_loadu_ps(position));
+            __m256 turns = _mm256_round_ps(_mm256_mul_ps(e, _mm256_set1_ps(TURN_INVERSE)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            _mm256_storeu_ps(error, _mm256_sub_ps(e, _mm256_mul_ps(_mm256_set1_ps(TURN), turns)));
+        }
+
+        AVX2_TARGET void Pd(const tPdGains &gains, const float *positionError, const float *velocity, const float *feedforward, float *out)
+        {
+            __m256 p = _mm256_mul_ps(_mm256_loadu_ps(gains.kp), _mm256_loadu_ps(positionError));
+            __m256 d = _mm256_mul_ps(_mm256_loadu_ps(gains.kd), _mm256_loadu_ps(velocity));
+            _mm256_storeu_ps(out, _mm256_add_ps(_mm256_sub_ps(p, d), _mm256_loadu_ps(feedforward)));
+        }
+
+        AVX2_TARGET void Saturate(const float *low, const float *high, float *x)
+        {
+            __m256 value = _mm256_max_ps(_mm256_loadu_ps(x), _mm256_loadu_ps(low));
+            _mm256_storeu_ps(x, _mm256_min_ps(value, _mm256_loadu_ps(high)));
+        }
+
+        AVX2_TARGET void RateLimit(const float *maxStep, const float *previous, float *x)
+        {
+            __m256 last = _mm256_loadu_ps(previous);
+            __m256 limit = _mm256_loadu_ps(maxStep);
+            __m256 step = _mm256_sub_ps(_mm256_loadu_ps(x), last);
+            step = _mm256_min_ps(_mm256_max_ps(step, _mm256_sub_ps(_mm256_setzero_ps(), limit)), limit);
+            _mm256_storeu_ps(x, _mm256_add_ps(last, step));
+        }
+
+        AVX2_TARGET void FirstOrder(tFirstOrderFilter &filter, const float *in, float *out)
+        {
+            __m256 y = _mm256_loadu_ps(filter.y);
+            y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_loadu_ps(filter.alpha), _mm256_sub_ps(_mm256_loadu_ps(in), y)));
+            _mm256_storeu_ps(filter.y, y);
+            _mm256_storeu_ps(out, y);
+        }
+
+        AVX2_TARGET void SecondOrder(tSecondOrderFilter &filter, const float *in, float *out)
+        {
+            __m256 x = _mm256_loadu_ps(in);
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(filter.b0), x), _mm256_loadu_ps(filter.z1));
+            __m256 z1 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(filter.b1), x), _mm256_mul_ps(_mm256_loadu_ps(filter.a1), y));
+            _mm256_storeu_ps(filter.z1, _mm256_add_ps(z1, _mm256_loadu_ps(filter.z2)));
+            _mm256_storeu_ps(filter.z2, _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(filter.b2), x), _mm256_mul_ps(_mm256_loadu_ps(filter.a2), y)));
+            _mm256_storeu_ps(out, y);
+        }
+    }
+
+    bool CpuHasAvx2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool bOsSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(info, 7, 0);
+        return bOsSavesYmm && (info[1] & (1 << 5));
+#else
+        //also checks that the OS saves the ymm registers
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+}
+
+void tFirstOrderFilter::SetLowPass(float cutoff_hz, float sampleRate_hz, const float *initial)
+{
+    float value = 1.0f - std::exp(-2.0f * PI * cutoff_hz / sampleRate_hz);
+    for (int i = 0; i < MAX_ACTUATORS; i++)
+    {
+        alpha[i] = value;
+        y[i] = initial[i];
+    }
+}
+
+void tSecondOrderFilter::SetLowPass(float cutoff_hz, float sampleRate_hz, float q, const float *initial)
+{
+    double w0 = 2.0 * PI * cutoff_hz / sampleRate_hz;
+    double alpha = std::sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+    double cosW0 = std::cos(w0);
+    for (int i = 0; i < MAX_ACTUATORS; i++)
+    {
+        b0[i] = float((1.0 - cosW0) / 2.0 / a0);
+        b1[i] = float((1.0 - cosW0) / a0);
+        b2[i] = b0[i];
+        a1[i] = float(-2.0 * cosW0 / a0);
+        a2[i] = float((1.0 - alpha) / a0);
+        //steady state for a constant input, the gain is 1 at DC
+        z1[i] = initial[i] - b0[i] * initial[i];
+        z2[i] = b2[i] * initial[i] - a2[i] * initial[i];
+    }
+}
+
+bool JointKernels::IsSupported(eIsa isa)
+{
+    switch (isa)
+    {
+    case SCALAR:
+        return true;
+#if defined(JOINT_KERNELS_X86)
+    case SSE2:
+        return true;
+    case AVX2:
+    {
+        static const bool bAvx2 = CpuHasAvx2();
+        return bAvx2;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+JointKernels::eIsa JointKernels::GetBestIsa()
+{
+    if (IsSupported(AVX2))
+    {
+        return AVX2;
+    }
+    if (IsSupported(SSE2))
+    {
+        return SSE2;
+    }
+    return SCALAR;
+}
+
+const char* JointKernels::GetIsaName(eIsa isa)
+{
+    switch (isa)
+    {
+    case SCALAR:
+        return "scalar";
+    case SSE2:
+        return "SSE2";
+    case AVX2:
+        return "AVX2";
+    default:
+        return "unknown";
+    }
+}
+
+JointKernels::JointKernels(eIsa isa)
+{
+    m_eIsa = IsSupported(isa) ? isa : GetBestIsa();
+
+    m_pPositionError = &Scalar::PositionError;
+    m_pPd = &Scalar::Pd;
+    m_pSaturate = &Scalar::Saturate;
+    m_pRateLimit = &Scalar::RateLimit;
+    m_pFirstOrder = &Scalar::FirstOrder;
+    m_pSecondOrder = &Scalar::SecondOrder;
+
+#if defined(JOINT_KERNELS_X86)
+    if (m_eIsa == SSE2)
+    {
+        m_pPositionError = &Sse2::PositionError;
+        m_pPd = &Sse2::Pd;
+        m_pSaturate = &Sse2::Saturate;
+        m_pRateLimit = &Sse2::RateLimit;
+        m_pFirstOrder = &Sse2::FirstOrder;
+        m_pSecondOrder = &Sse2::SecondOrder;
+    }
+    else if (m_eIsa == AVX2)
+    {
+        m_pPositionError = &Avx2::PositionError;
+        m_pPd = &Avx2::Pd;
+        m_pSaturate = &Avx2::Saturate;
+        m_pRateLimit = &Avx2::RateLimit;
+        m_pFirstOrder = &Avx2::FirstOrder;
+        m_pSecondOrder = &Avx2::SecondOrder;
+    }
+#endif
+}
+
+void JointKernels::ToTorqueCommand(const float *torque, int count, PreencodedCyclicCommand &command)
+{
+    for (int i = 0; i < count; i++)
+    {
+        command.SetTorqueJoint(i, torque[i]);
+    }
+}
+
+void JointKernels::ToPositionCommand(const float *position, int count, PreencodedCyclicCommand &command)
+{
+    for (int i = 0; i < count; i++)
+    {
+        command.SetPosition(i, position[i]);
+    }
+}
+
+void JointKernels::ToTorqueCommand(const float *torque, int count, k_api::BaseCyclic::Command &command)
+{
+    for (int i = 0; i < count; i++)
+    {
+        command.mutable_actuators(i)->set_torque_joint(torque[i]);
+    }
+}
+
+void JointKernels::ToPositionCommand(const float *position, int count, k_api::BaseCyclic::Command &command)
+{
+    for (int i = 0; i < count; i++)
+    {
+        command.mutable_actuators(i)->set_position(position[i]);
+    }
+}
@@ -0,0 +1,152 @@
+#include "Classes/include/KeepAliveService.h"
+#include "Classes/include/SharedSessionManager.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "Classes/include/EventTrace.h"
+
+using std::chrono::steady_clock;
+
+//a session created without inactivity timeout is still checked, at the rate the examples use (2000 ms / 3)
+constexpr auto DEFAULT_KEEPALIVE_WINDOW = std::chrono::milliseconds{666};
+
+KeepAliveService& KeepAliveService::Instance()
+{
+    static KeepAliveService service;
+    return service;
+}
+
+KeepAliveService::KeepAliveService()
+{
+    m_bIsRunning = false;
+    m_nKeepAliveSent = 0;
+    m_nKeepAliveSuppressed = 0;
+}
+
+KeepAliveService::~KeepAliveService()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bIsRunning = false;
+    }
+    m_wakeUp.notify_all();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void KeepAliveService::Register(SharedSessionManager *pSession, uint32_t window_ms)
+{
+    tRegistration registration;
+    registration.pSession = pSession;
+    registration.window = (window_ms > 0) ? std::chrono::milliseconds(window_ms) : DEFAULT_KEEPALIVE_WINDOW;
+    registration.nextDeadline = steady_clock::now() + registration.window;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_Registrations.push_back(registration);
+
+        //the thread is started with the first session and lives as long as the process
+        if (!m_bIsRunning)
+        {
+            m_bIsRunning = true;
+            m_thread = std::thread(&KeepAliveService::ThreadKeepAlive, this);
+        }
+    }
+    m_wakeUp.notify_all();
+}
+
+void KeepAliveService::Unregister(SharedSessionManager *pSession)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_Registrations.erase(std::remove_if(m_Registrations.begin(), m_Registrations.end(),
+                                             [pSession](const tRegistration &reg){ return reg.pSession == pSession; }),
+                              m_Registrations.end());
+    }
+    m_wakeUp.notify_all();
+}
+
+size_t KeepAliveService::GetSessionCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_Registrations.size();
+}
+
+void KeepAliveService::ThreadKeepAlive()
+{
+    KORTEX_TRACE_THREAD_NAME("keepalive");
+    std::vector<std::function<void()>> timeoutCallbacks;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_bIsRunning)
+    {
+        if (m_Registrations.empty())
+        {
+            m_wakeUp.wait(lock);
+            continue;
+        }
+
+        auto nextDeadline = m_Registrations.front().nextDeadline;
+        for (auto &reg : m_Registrations)
+        {
+            nextDeadline = std::min(nextDeadline, reg.nextDeadline);
+        }
+
+        //woken up early on register/unregister/stop, the deadlines are simply re-evaluated
+        m_wakeUp.wait_until(lock, nextDeadline);
+        if (!m_bIsRunning)
+        {
+            break;
+        }
+
+        auto now = steady_clock::now();
+        for (auto &reg : m_Registrations)
+        {
+            if (reg.nextDeadline > now)
+            {
+                continue;
+            }
+
+            bool bKeepAliveSent = false;
+            {
+                KORTEX_TRACE_SCOPE("session", "keepalive");
+                if (reg.pSession->CheckWindow(bKeepAliveSent) && reg.pSession->m_connectionTimeoutCallback)
+                {
+                    timeoutCallbacks.push_back(reg.pSession->m_connectionTimeoutCallback);
+                }
+            }
+
+            if (bKeepAliveSent)
+            {
+                m_nKeepAliveSent++;
+            }
+            else
+            {
+                m_nKeepAliveSuppressed++;
+            }
+
+            //absolute deadlines so the windows do not drift, but do not try to catch up after a long stall
+            reg.nextDeadline += reg.window;
+            if (reg.nextDeadline <= now)
+            {
+                reg.nextDeadline = now + reg.window;
+            }
+        }
+
+        //user callbacks may close or destroy their session, they are called without the lock
+        if (!timeoutCallbacks.empty())
+        {
+            lock.unlock();
+            for (auto &callback : timeoutCallbacks)
+            {
+                callback();
+            }
+            timeoutCallbacks.clear();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,232 @@
+#include "Classes/include/KortexConnection.h"
+
+#include <future>
+#include <sstream>
+
+#include <KBasicException.h>
+
+namespace k_api = Kinova::Api;
+
+using std::chrono::steady_clock;
+using std::chrono::microseconds;
+
+static microseconds ElapsedSince(const steady_clock::time_point &start)
+{
+    return std::chrono::duration_cast<microseconds>(steady_clock::now() - start);
+}
+
+std::string tStartupTiming::ToString() const
+{
+    std::ostringstream stream;
+    stream << "startup timing (us):"
+           << " tcp connect " << tcpConnect.count()
+           << ", tcp session " << tcpSession.count()
+           << ", udp connect " << udpConnect.count()
+           << ", udp session " << udpSession.count()
+           << ", clients " << clients.count()
+           << ", total " << total.count();
+    return stream.str();
+}
+
+KortexConnection::KortexConnection(const tConnectionSettings &settings)
+{
+    m_Settings = settings;
+    m_nClients = 0;
+    m_Timing = tStartupTiming{microseconds(0), microseconds(0), microseconds(0), microseconds(0), microseconds(0), microseconds(0)};
+
+    m_pTransport = nullptr;
+    m_pTransportRealTime = nullptr;
+    m_pMetrics = nullptr;
+    m_pMetricsRealTime = nullptr;
+    m_pRouter = nullptr;
+    m_pRouterRealTime = nullptr;
+    m_pSessionManager = nullptr;
+    m_pSessionManagerRealTime = nullptr;
+}
+
+KortexConnection::~KortexConnection()
+{
+    // Destroy the clients first, they all hold a pointer to a router
+    m_Clients.clear();
+
+    // Close API sessions
+    try
+    {
+        if (m_pSessionManager != nullptr && m_pSessionManager->IsSessionOpen())
+        {
+            m_pSessionManager->CloseSession();
+        }
+        if (m_pSessionManagerRealTime != nullptr && m_pSessionManagerRealTime->IsSessionOpen())
+        {
+            m_pSessionManagerRealTime->CloseSession();
+        }
+    }
+    catch (k_api::KBasicException &ex)
+    {
+        std::cout << "Unable to close the sessions: " << ex.what() << std::endl;
+    }
+
+    // Deactivate the routers and cleanly disconnect from the transport objects
+    if (m_pRouter != nullptr)
+    {
+        m_pRouter->SetActivationStatus(false);
+        m_pTransport->disconnect();
+    }
+    if (m_pRouterRealTime != nullptr)
+    {
+        m_pRouterRealTime->SetActivationStatus(false);
+        m_pTransportRealTime->disconnect();
+    }
+
+    delete m_pSessionManager;
+    delete m_pSessionManagerRealTime;
+    delete m_pRouter;
+    delete m_pRouterRealTime;
+    m_Decorators.clear();
+    delete m_pTransport;
+    delete m_pTransportRealTime;
+}
+
+std::unique_ptr<KortexConnection> KortexConnection::Create(const tConnectionSettings &settings, uint32_t clients)
+{
+    //a failed bring-up destroys whatever was already opened
+    std::unique_ptr<KortexConnection> connection(new KortexConnection(settings));
+    connection->Connect(clients);
+    return connection;
+}
+
+void KortexConnection::Connect(uint32_t clients)
+{
+    auto start = steady_clock::now();
+    auto error_callback = [](k_api::KError err){ cout << "_________ callback error _________" << err.toString(); };
+
+    if (m_Settings.pLoopbackServer != nullptr)
+    {
+        m_pTransport = new LoopbackTransport(m_Settings.pLoopbackServer);
+    }
+    else
+    {
+        m_pTransport = new k_api::TransportClientTcp();
+    }
+    k_api::ITransportClient *pChannel = Decorate(m_pTransport, "tcp", &m_pMetrics);
+    m_pRouter = new k_api::RouterClient(pChannel, error_callback);
+
+    std::future<void> realTimeChannel;
+    if (clients & KORTEX_CYCLIC_CLIENTS)
+    {
+        if (m_Settings.pLoopbackServer != nullptr)
+        {
+            m_pTransportRealTime = new LoopbackTransport(m_Settings.pLoopbackServer);
+        }
+        else
+        {
+            m_pTransportRealTime = new k_api::TransportClientUdp();
+        }
+        k_api::ITransportClient *pChannelRealTime = Decorate(m_pTransportRealTime, "udp", &m_pMetricsRealTime);
+        m_pRouterRealTime = new k_api::RouterClient(pChannelRealTime, error_callback);
+
+        realTimeChannel = std::async(std::launch::async, &KortexConnection::OpenChannel, this,
+                                     pChannelRealTime, m_pRouterRealTime, m_Settings.portRealTime, &m_pSessionManagerRealTime,
+                                     std::ref(m_Timing.udpConnect), std::ref(m_Timing.udpSession));
+    }
+
+    //the TCP channel is opened by the calling thread while the UDP one is handshaking
+    std::exception_ptr error;
+    try
+    {
+        OpenChannel(pChannel, m_pRouter, m_Settings.port, &m_pSessionManager, m_Timing.tcpConnect, m_Timing.tcpSession);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    //always wait for the other channel, it writes into this object
+    if (realTimeChannel.valid())
+    {
+        try
+        {
+            realTimeChannel.get();
+        }
+        catch (...)
+        {
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    //the clients are created on first use
+    m_nClients = clients;
+    m_Timing.total = ElapsedSince(start);
+    StartupTrace::Record("connection", start, start + m_Timing.total);
+}
+
+tStartupTiming KortexConnection::GetStartupTiming() const
+{
+    std::lock_guard<std::mutex> lock(m_ClientMutex);
+    return m_Timing;
+}
+
+k_api::ITransportClient* KortexConnection::Decorate(k_api::ITransportClient *pTransport, const std::string &channel,
+                                                   MetricsTransport **ppMetrics)
+{
+    if (m_Settings.bRpcMetrics)
+    {
+        *ppMetrics = new MetricsTransport(pTransport, channel);
+        m_Decorators.emplace_back(*ppMetrics);
+        pTransport = *ppMetrics;
+    }
+#if defined(KORTEX_TRACE)
+    m_Decorators.emplace_back(new TracingTransport(pTransport, channel));
+    pTransport = m_Decorators.back().get();
+#endif
+    return pTransport;
+}
+
+std::vector<tRpcMetrics> KortexConnection::GetRpcMetrics()
+{
+    std::vector<tRpcMetrics> metrics;
+    for (MetricsTransport *pMetrics : {m_pMetrics, m_pMetricsRealTime})
+    {
+        if (pMetrics != nullptr)
+        {
+            std::vector<tRpcMetrics> channel = pMetrics->GetSnapshot();
+            metrics.insert(metrics.end(), channel.begin(), channel.end());
+        }
+    }
+    return metrics;
+}
+
+void KortexConnection::OpenChannel(k_api::ITransportClient *pTransport, k_api::RouterClient *pRouter, uint32_t port,
+                                   SharedSessionManager **ppSessionManager,
+                                   std::chrono::microseconds &connectTime, std::chrono::microseconds &sessionTime)
+{
+    const std::string channel = pRouter == m_pRouter ? "tcp" : "udp";
+    auto start = steady_clock::now();
+    if (!pTransport->connect(m_Settings.IP, port))
+    {
+        throw k_api::KBasicException("Unable to connect to " + m_Settings.IP + ":" + std::to_string(port));
+    }
+    connectTime = ElapsedSince(start);
+    StartupTrace::Record(channel + " connect", start, start + connectTime);
+
+    // Set session data connection information
+    auto create_session_info = k_api::Session::CreateSessionInfo();
+    create_session_info.set_username(m_Settings.username);
+    create_session_info.set_password(m_Settings.password);
+    create_session_info.set_session_inactivity_timeout(m_Settings.sessionInactivityTimeout);
+    create_session_info.set_connection_inactivity_timeout(m_Settings.connectionInactivityTimeout);
+
+    start = steady_clock::now();
+    *ppSessionManager = new SharedSessionManager(pRouter);
+    (*ppSessionManager)->CreateSession(create_session_info);
+    sessionTime = ElapsedSince(start);
+    StartupTrace::Record(channel + " session", start, start + sessionTime);
+}
@@ -0,0 +1,387 @@
+#include "Classes/include/KortexFunctionNames.h"
+
+#include <unordered_map>
+
+#include <ActuatorConfigClientRpc.h>
+#include <ActuatorCyclicClientRpc.h>
+#include <BaseClientRpc.h>
+#include <BaseCyclicClientRpc.h>
+#include <ControlConfigClientRpc.h>
+#include <DeviceConfigClientRpc.h>
+#include <DeviceManagerClientRpc.h>
+#include <GripperCyclicClientRpc.h>
+#include <InterconnectConfigClientRpc.h>
+#include <InterconnectCyclicClientRpc.h>
+#include <SessionClientRpc.h>
+#include <TestClientRpc.h>
+#include <VisionConfigClientRpc.h>
+
+namespace k_api = Kinova::Api;
+
+namespace
+{
+    struct tFunctionName
+    {
+        uint32_t functionUid;
+        const char *name;
+    };
+
+    //from the enums, a function renamed or removed by a new version of the stubs does not compile
+#define KORTEX_FUNCTION(service, function) {k_api::service::eUid##function, #service "." #function}
+
+    const tFunctionName FUNCTION_NAMES[] =
+    {
+        //ActuatorConfig
+        KORTEX_FUNCTION(ActuatorConfig, GetAxisOffsets),
+        KORTEX_FUNCTION(ActuatorConfig, SetAxisOffsets),
+        KORTEX_FUNCTION(ActuatorConfig, ReadTorqueCalibration),
+        KORTEX_FUNCTION(ActuatorConfig, WriteTorqueCalibration),
+        KORTEX_FUNCTION(ActuatorConfig, SetTorqueOffset),
+        KORTEX_FUNCTION(ActuatorConfig, GetControlMode),
+        KORTEX_FUNCTION(ActuatorConfig, SetControlMode),
+        KORTEX_FUNCTION(ActuatorConfig, GetActivatedControlLoop),
+        KORTEX_FUNCTION(ActuatorConfig, SetActivatedControlLoop),
+        KORTEX_FUNCTION(ActuatorConfig, GetVectorDriveParameters),
+        KORTEX_FUNCTION(ActuatorConfig, SetVectorDriveParameters),
+        KORTEX_FUNCTION(ActuatorConfig, GetEncoderDerivativeParameters),
+        KORTEX_FUNCTION(ActuatorConfig, SetEncoderDerivativeParameters),
+        KORTEX_FUNCTION(ActuatorConfig, GetControlLoopParameters),
+        KORTEX_FUNCTION(ActuatorConfig, SetControlLoopParameters),
+        KORTEX_FUNCTION(ActuatorConfig, StartFrequencyResponse),
+        KORTEX_FUNCTION(ActuatorConfig, StopFrequencyResponse),
+        KORTEX_FUNCTION(ActuatorConfig, StartStepResponse),
+        KORTEX_FUNCTION(ActuatorConfig, StopStepResponse),
+        KORTEX_FUNCTION(ActuatorConfig, StartRampResponse),
+        KORTEX_FUNCTION(ActuatorConfig, StopRampResponse),
+        KORTEX_FUNCTION(ActuatorConfig, SelectCustomData),
+        KORTEX_FUNCTION(ActuatorConfig, GetSelectedCustomData),
+        KORTEX_FUNCTION(ActuatorConfig, SetCommandMode),
+        KORTEX_FUNCTION(ActuatorConfig, ClearFaults),
+        KORTEX_FUNCTION(ActuatorConfig, SetServoing),
+        KORTEX_FUNCTION(ActuatorConfig, MoveToPosition),
+        KORTEX_FUNCTION(ActuatorConfig, GetCommandMode),
+        KORTEX_FUNCTION(ActuatorConfig, GetServoing),
+        KORTEX_FUNCTION(ActuatorConfig, GetTorqueOffset),
+        KORTEX_FUNCTION(ActuatorConfig, SetCoggingFeedforwardMode),
+        KORTEX_FUNCTION(ActuatorConfig, GetCoggingFeedforwardMode),
+
+        //ActuatorCyclic
+        KORTEX_FUNCTION(ActuatorCyclic, Refresh),
+        KORTEX_FUNCTION(ActuatorCyclic, RefreshCommand),
+        KORTEX_FUNCTION(ActuatorCyclic, RefreshFeedback),
+        KORTEX_FUNCTION(ActuatorCyclic, RefreshCustomData),
+
+        //Base
+        KORTEX_FUNCTION(Base, CreateUserProfile),
+        KORTEX_FUNCTION(Base, UpdateUserProfile),
+        KORTEX_FUNCTION(Base, ReadUserProfile),
+        KORTEX_FUNCTION(Base, DeleteUserProfile),
+        KORTEX_FUNCTION(Base, ReadAllUserProfiles),
+        KORTEX_FUNCTION(Base, ReadAllUsers),
+        KORTEX_FUNCTION(Base, ChangePassword),
+        KORTEX_FUNCTION(Base, CreateSequence),
+        KORTEX_FUNCTION(Base, UpdateSequence),
+        KORTEX_FUNCTION(Base, ReadSequence),
+        KORTEX_FUNCTION(Base, DeleteSequence),
+        KORTEX_FUNCTION(Base, ReadAllSequences),
+        KORTEX_FUNCTION(Base, PlaySequence),
+        KORTEX_FUNCTION(Base, PlayAdvancedSequence),
+        KORTEX_FUNCTION(Base, StopSequence),
+        KORTEX_FUNCTION(Base, PauseSequence),
+        KORTEX_FUNCTION(Base, ResumeSequence),
+        KORTEX_FUNCTION(Base, CreateProtectionZone),
+        KORTEX_FUNCTION(Base, UpdateProtectionZone),
+        KORTEX_FUNCTION(Base, ReadProtectionZone),
+        KORTEX_FUNCTION(Base, DeleteProtectionZone),
+        KORTEX_FUNCTION(Base, ReadAllProtectionZones),
+        KORTEX_FUNCTION(Base, CreateMapping),
+        KORTEX_FUNCTION(Base, ReadMapping),
+        KORTEX_FUNCTION(Base, UpdateMapping),
+        KORTEX_FUNCTION(Base, DeleteMapping),
+        KORTEX_FUNCTION(Base, ReadAllMappings),
+        KORTEX_FUNCTION(Base, CreateMap),
+        KORTEX_FUNCTION(Base, ReadMap),
+        KORTEX_FUNCTION(Base, UpdateMap),
+        KORTEX_FUNCTION(Base, DeleteMap),
+        KORTEX_FUNCTION(Base, ReadAllMaps),
+        KORTEX_FUNCTION(Base, ActivateMap),
+        KORTEX_FUNCTION(Base, CreateAction),
+        KORTEX_FUNCTION(Base, ReadAction),
+        KORTEX_FUNCTION(Base, ReadAllActions),
+        KORTEX_FUNCTION(Base, DeleteAction),
+        KORTEX_FUNCTION(Base, UpdateAction),
+        KORTEX_FUNCTION(Base, ExecuteActionFromReference),
+        KORTEX_FUNCTION(Base, ExecuteAction),
+        KORTEX_FUNCTION(Base, PauseAction),
+        KORTEX_FUNCTION(Base, StopAction),
+        KORTEX_FUNCTION(Base, ResumeAction),
+        KORTEX_FUNCTION(Base, GetIPv4Configuration),
+        KORTEX_FUNCTION(Base, SetIPv4Configuration),
+        KORTEX_FUNCTION(Base, SetCommunicationInterfaceEnable),
+        KORTEX_FUNCTION(Base, IsCommunicationInterfaceEnable),
+        KORTEX_FUNCTION(Base, GetAvailableWifi),
+        KORTEX_FUNCTION(Base, GetWifiInformation),
+        KORTEX_FUNCTION(Base, AddWifiConfiguration),
+        KORTEX_FUNCTION(Base, DeleteWifiConfiguration),
+        KORTEX_FUNCTION(Base, GetAllConfiguredWifis),
+        KORTEX_FUNCTION(Base, ConnectWifi),
+        KORTEX_FUNCTION(Base, DisconnectWifi),
+        KORTEX_FUNCTION(Base, GetConnectedWifiInformation),
+        KORTEX_FUNCTION(Base, Unsubscribe),
+        KORTEX_FUNCTION(Base, ConfigurationChangeTopic),
+        KORTEX_FUNCTION(Base, MappingInfoTopic),
+        KORTEX_FUNCTION(Base, ControlModeTopic),
+        KORTEX_FUNCTION(Base, OperatingModeTopic),
+        KORTEX_FUNCTION(Base, SequenceInfoTopic),
+        KORTEX_FUNCTION(Base, ProtectionZoneTopic),
+        KORTEX_FUNCTION(Base, UserTopic),
+        KORTEX_FUNCTION(Base, ControllerTopic),
+        KORTEX_FUNCTION(Base, ActionTopic),
+        KORTEX_FUNCTION(Base, RobotEventTopic),
+        KORTEX_FUNCTION(Base, PlayCartesianTrajectory),
+        KORTEX_FUNCTION(Base, PlayCartesianTrajectoryPosition),
+        KORTEX_FUNCTION(Base, PlayCartesianTrajectoryOrientation),
+        KORTEX_FUNCTION(Base, Stop),
+        KORTEX_FUNCTION(Base, GetMeasuredCartesianPose),
+        KORTEX_FUNCTION(Base, SendWrenchCommand),
+        KORTEX_FUNCTION(Base, SendWrenchJoystickCommand),
+        KORTEX_FUNCTION(Base, SendTwistJoystickCommand),
+        KORTEX_FUNCTION(Base, SendTwistCommand),
+        KORTEX_FUNCTION(Base, PlayJointTrajectory),
+        KORTEX_FUNCTION(Base, PlaySelectedJointTrajectory),
+        KORTEX_FUNCTION(Base, GetMeasuredJointAngles),
+        KORTEX_FUNCTION(Base, SendJointSpeedsCommand),
+        KORTEX_FUNCTION(Base, SendSelectedJointSpeedCommand),
+        KORTEX_FUNCTION(Base, SendGripperCommand),
+        KORTEX_FUNCTION(Base, GetMeasuredGripperMovement),
+        KORTEX_FUNCTION(Base, SetAdmittance),
+        KORTEX_FUNCTION(Base, SetOperatingMode),
+        KORTEX_FUNCTION(Base, ApplyEmergencyStop),
+        KORTEX_FUNCTION(Base, ClearFaults),
+        KORTEX_FUNCTION(Base, GetControlMode),
+        KORTEX_FUNCTION(Base, GetOperatingMode),
+        KORTEX_FUNCTION(Base, SetServoingMode),
+        KORTEX_FUNCTION(Base, GetServoingMode),
+        KORTEX_FUNCTION(Base, ServoingModeTopic),
+        KORTEX_FUNCTION(Base, RestoreFactorySettings),
+        KORTEX_FUNCTION(Base, Reboot),
+        KORTEX_FUNCTION(Base, FactoryTopic),
+        KORTEX_FUNCTION(Base, GetAllConnectedControllers),
+        KORTEX_FUNCTION(Base, GetControllerState),
+        KORTEX_FUNCTION(Base, GetActuatorCount),
+        KORTEX_FUNCTION(Base, StartWifiScan),
+        KORTEX_FUNCTION(Base, GetConfiguredWifi),
+        KORTEX_FUNCTION(Base, NetworkTopic),
+        KORTEX_FUNCTION(Base, GetArmState),
+        KORTEX_FUNCTION(Base, ArmStateTopic),
+        KORTEX_FUNCTION(Base, GetIPv4Information),
+        KORTEX_FUNCTION(Base, SetWifiCountryCode),
+        KORTEX_FUNCTION(Base, GetWifiCountryCode),
+        KORTEX_FUNCTION(Base, SetCapSenseConfig),
+        KORTEX_FUNCTION(Base, GetCapSenseConfig),
+        KORTEX_FUNCTION(Base, GetAllJointsSpeedHardLimitation),
+        KORTEX_FUNCTION(Base, GetAllJointsTorqueHardLimitation),
+        KORTEX_FUNCTION(Base, GetTwistHardLimitation),
+        KORTEX_FUNCTION(Base, GetWrenchHardLimitation),
+        KORTEX_FUNCTION(Base, SendJointSpeedsJoystickCommand),
+        KORTEX_FUNCTION(Base, SendSelectedJointSpeedJoystickCommand),
+        KORTEX_FUNCTION(Base, EnableBridge),
+        KORTEX_FUNCTION(Base, DisableBridge),
+        KORTEX_FUNCTION(Base, GetBridgeList),
+        KORTEX_FUNCTION(Base, GetBridgeConfig),
+        KORTEX_FUNCTION(Base, PlayPreComputedJointTrajectory),
+        KORTEX_FUNCTION(Base, GetProductConfiguration),
+        KORTEX_FUNCTION(Base, UpdateEndEffectorTypeConfiguration),
+        KORTEX_FUNCTION(Base, RestoreFactoryProductConfiguration),
+        KORTEX_FUNCTION(Base, GetTrajectoryErrorReport),
+        KORTEX_FUNCTION(Base, GetAllJointsSpeedSoftLimitation),
+        KORTEX_FUNCTION(Base, GetAllJointsTorqueSoftLimitation),
+        KORTEX_FUNCTION(Base, GetTwistSoftLimitation),
+        KORTEX_FUNCTION(Base, GetWrenchSoftLimitation),
+        KORTEX_FUNCTION(Base, SetControllerConfigurationMode),
+        KORTEX_FUNCTION(Base, GetControllerConfigurationMode),
+        KORTEX_FUNCTION(Base, StartTeaching),
+        KORTEX_FUNCTION(Base, StopTeaching),
+        KORTEX_FUNCTION(Base, AddSequenceTasks),
+        KORTEX_FUNCTION(Base, UpdateSequenceTask),
+        KORTEX_FUNCTION(Base, SwapSequenceTasks),
+        KORTEX_FUNCTION(Base, ReadSequenceTask),
+        KORTEX_FUNCTION(Base, ReadAllSequenceTasks),
+        KORTEX_FUNCTION(Base, DeleteSequenceTask),
+        KORTEX_FUNCTION(Base, DeleteAllSequenceTasks),
+        KORTEX_FUNCTION(Base, TakeSnapshot),
+        KORTEX_FUNCTION(Base, GetFirmwareBundleVersions),
+        KORTEX_FUNCTION(Base, MoveSequenceTask),
+        KORTEX_FUNCTION(Base, DuplicateMapping),
+        KORTEX_FUNCTION(Base, DuplicateMap),
+        KORTEX_FUNCTION(Base, SetControllerConfiguration),
+        KORTEX_FUNCTION(Base, GetControllerConfiguration),
+        KORTEX_FUNCTION(Base, GetAllControllerConfigurations),
+
+        //BaseCyclic
+        KORTEX_FUNCTION(BaseCyclic, Refresh),
+        KORTEX_FUNCTION(BaseCyclic, RefreshCommand),
+        KORTEX_FUNCTION(BaseCyclic, RefreshFeedback),
+        KORTEX_FUNCTION(BaseCyclic, RefreshCustomData),
+
+        //ControlConfig
+        KORTEX_FUNCTION(ControlConfig, SetGravityVector),
+        KORTEX_FUNCTION(ControlConfig, GetGravityVector),
+        KORTEX_FUNCTION(ControlConfig, SetPayloadInformation),
+        KORTEX_FUNCTION(ControlConfig, GetPayloadInformation),
+        KORTEX_FUNCTION(ControlConfig, SetToolConfiguration),
+        KORTEX_FUNCTION(ControlConfig, GetToolConfiguration),
+        KORTEX_FUNCTION(ControlConfig, ControlConfigurationTopic),
+        KORTEX_FUNCTION(ControlConfig, Unsubscribe),
+        KORTEX_FUNCTION(ControlConfig, SetCartesianReferenceFrame),
+        KORTEX_FUNCTION(ControlConfig, GetCartesianReferenceFrame),
+        KORTEX_FUNCTION(ControlConfig, GetControlMode),
+        KORTEX_FUNCTION(ControlConfig, SetJointSpeedSoftLimits),
+        KORTEX_FUNCTION(ControlConfig, SetTwistLinearSoftLimit),
+        KORTEX_FUNCTION(ControlConfig, SetTwistAngularSoftLimit),
+        KORTEX_FUNCTION(ControlConfig, SetJointAccelerationSoftLimits),
+        KORTEX_FUNCTION(ControlConfig, GetKinematicHardLimits),
+        KORTEX_FUNCTION(ControlConfig, GetKinematicSoftLimits),
+        KORTEX_FUNCTION(ControlConfig, GetAllKinematicSoftLimits),
+        KORTEX_FUNCTION(ControlConfig, SetDesiredLinearTwist),
+        KORTEX_FUNCTION(ControlConfig, SetDesiredAngularTwist),
+        KORTEX_FUNCTION(ControlConfig, SetDesiredJointSpeeds),
+        KORTEX_FUNCTION(ControlConfig, GetDesiredSpeeds),
+        KORTEX_FUNCTION(ControlConfig, ResetGravityVector),
+        KORTEX_FUNCTION(ControlConfig, ResetPayloadInformation),
+        KORTEX_FUNCTION(ControlConfig, ResetToolConfiguration),
+        KORTEX_FUNCTION(ControlConfig, ResetJointSpeedSoftLimits),
+        KORTEX_FUNCTION(ControlConfig, ResetTwistLinearSoftLimit),
+        KORTEX_FUNCTION(ControlConfig, ResetTwistAngularSoftLimit),
+        KORTEX_FUNCTION(ControlConfig, ResetJointAccelerationSoftLimits),
+
+        //DeviceConfig
+        KORTEX_FUNCTION(DeviceConfig, GetRunMode),
+        KORTEX_FUNCTION(DeviceConfig, SetRunMode),
+        KORTEX_FUNCTION(DeviceConfig, GetDeviceType),
+        KORTEX_FUNCTION(DeviceConfig, GetFirmwareVersion),
+        KORTEX_FUNCTION(DeviceConfig, GetBootloaderVersion),
+        KORTEX_FUNCTION(DeviceConfig, GetModelNumber),
+        KORTEX_FUNCTION(DeviceConfig, GetPartNumber),
+        KORTEX_FUNCTION(DeviceConfig, GetSerialNumber),
+        KORTEX_FUNCTION(DeviceConfig, GetMACAddress),
+        KORTEX_FUNCTION(DeviceConfig, GetIPv4Settings),
+        KORTEX_FUNCTION(DeviceConfig, SetIPv4Settings),
+        KORTEX_FUNCTION(DeviceConfig, GetPartNumberRevision),
+        KORTEX_FUNCTION(DeviceConfig, RebootRequest),
+        KORTEX_FUNCTION(DeviceConfig, SetSafetyEnable),
+        KORTEX_FUNCTION(DeviceConfig, SetSafetyErrorThreshold),
+        KORTEX_FUNCTION(DeviceConfig, SetSafetyWarningThreshold),
+        KORTEX_FUNCTION(DeviceConfig, SetSafetyConfiguration),
+        KORTEX_FUNCTION(DeviceConfig, GetSafetyConfiguration),
+        KORTEX_FUNCTION(DeviceConfig, GetSafetyInformation),
+        KORTEX_FUNCTION(DeviceConfig, GetSafetyEnable),
+        KORTEX_FUNCTION(DeviceConfig, GetSafetyStatus),
+        KORTEX_FUNCTION(DeviceConfig, ClearAllSafetyStatus),
+        KORTEX_FUNCTION(DeviceConfig, ClearSafetyStatus),
+        KORTEX_FUNCTION(DeviceConfig, GetAllSafetyConfiguration),
+        KORTEX_FUNCTION(DeviceConfig, GetAllSafetyInformation),
+        KORTEX_FUNCTION(DeviceConfig, ResetSafetyDefaults),
+        KORTEX_FUNCTION(DeviceConfig, SafetyTopic),
+        KORTEX_FUNCTION(DeviceConfig, ExecuteCalibration),
+        KORTEX_FUNCTION(DeviceConfig, GetCalibrationResult),
+        KORTEX_FUNCTION(DeviceConfig, StopCalibration),
+        KORTEX_FUNCTION(DeviceConfig, SetCapSenseConfig),
+        KORTEX_FUNCTION(DeviceConfig, GetCapSenseConfig),
+        KORTEX_FUNCTION(DeviceConfig, ReadCapSenseRegister),
+        KORTEX_FUNCTION(DeviceConfig, WriteCapSenseRegister),
+
+        //DeviceManager
+        KORTEX_FUNCTION(DeviceManager, ReadAllDevices),
+
+        //GripperCyclic
+        KORTEX_FUNCTION(GripperCyclic, Refresh),
+        KORTEX_FUNCTION(GripperCyclic, RefreshCommand),
+        KORTEX_FUNCTION(GripperCyclic, RefreshFeedback),
+        KORTEX_FUNCTION(GripperCyclic, RefreshCustomData),
+
+        //InterconnectConfig
+        KORTEX_FUNCTION(InterconnectConfig, GetUARTConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, SetUARTConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, GetEthernetConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, SetEthernetConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, GetGPIOConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, SetGPIOConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, GetGPIOState),
+        KORTEX_FUNCTION(InterconnectConfig, SetGPIOState),
+        KORTEX_FUNCTION(InterconnectConfig, GetI2CConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, SetI2CConfiguration),
+        KORTEX_FUNCTION(InterconnectConfig, I2CRead),
+        KORTEX_FUNCTION(InterconnectConfig, I2CReadRegister),
+        KORTEX_FUNCTION(InterconnectConfig, I2CWrite),
+        KORTEX_FUNCTION(InterconnectConfig, I2CWriteRegister),
+
+        //InterconnectCyclic
+        KORTEX_FUNCTION(InterconnectCyclic, Refresh),
+        KORTEX_FUNCTION(InterconnectCyclic, RefreshCommand),
+        KORTEX_FUNCTION(InterconnectCyclic, RefreshFeedback),
+        KORTEX_FUNCTION(InterconnectCyclic, RefreshCustomData),
+
+        //Session
+        KORTEX_FUNCTION(Session, CreateSession),
+        KORTEX_FUNCTION(Session, CloseSession),
+        KORTEX_FUNCTION(Session, KeepAlive),
+        KORTEX_FUNCTION(Session, GetConnections),
+
+        //Test
+        KORTEX_FUNCTION(Test, SetMockValidationStruct),
+        KORTEX_FUNCTION(Test, TestParamAndReturn),
+        KORTEX_FUNCTION(Test, TestParamOnly),
+        KORTEX_FUNCTION(Test, TestReturnOnly),
+        KORTEX_FUNCTION(Test, TestTimeout),
+        KORTEX_FUNCTION(Test, TestNotif),
+        KORTEX_FUNCTION(Test, TestNotifUnsubscribe),
+        KORTEX_FUNCTION(Test, TestAsync),
+        KORTEX_FUNCTION(Test, TestConcurrence),
+        KORTEX_FUNCTION(Test, TestTriggerNotif),
+        KORTEX_FUNCTION(Test, TestNotImplemented),
+        KORTEX_FUNCTION(Test, ServerError),
+        KORTEX_FUNCTION(Test, Unsubscribe),
+        KORTEX_FUNCTION(Test, SomethingChangeTopic),
+        KORTEX_FUNCTION(Test, TriggerSomethingChangeTopic),
+        KORTEX_FUNCTION(Test, Wait),
+        KORTEX_FUNCTION(Test, Throw),
+        KORTEX_FUNCTION(Test, Disconnect),
+        KORTEX_FUNCTION(Test, Forget),
+        KORTEX_FUNCTION(Test, NotImplemented),
+        KORTEX_FUNCTION(Test, Deprecated),
+        KORTEX_FUNCTION(Test, DeprecatedWithMessage),
+
+        //VisionConfig
+        KORTEX_FUNCTION(VisionConfig, SetSensorSettings),
+        KORTEX_FUNCTION(VisionConfig, GetSensorSettings),
+        KORTEX_FUNCTION(VisionConfig, GetOptionValue),
+        KORTEX_FUNCTION(VisionConfig, SetOptionValue),
+        KORTEX_FUNCTION(VisionConfig, GetOptionInformation),
+        KORTEX_FUNCTION(VisionConfig, VisionTopic),
+        KORTEX_FUNCTION(VisionConfig, DoSensorFocusAction),
+        KORTEX_FUNCTION(VisionConfig, GetIntrinsicParameters),
+        KORTEX_FUNCTION(VisionConfig, GetIntrinsicParametersProfile),
+        KORTEX_FUNCTION(VisionConfig, SetIntrinsicParameters),
+        KORTEX_FUNCTION(VisionConfig, GetExtrinsicParameters),
+        KORTEX_FUNCTION(VisionConfig, SetExtrinsicParameters),
+    };
+
+#undef KORTEX_FUNCTION
+}
+
+const char* GetKortexFunctionName(uint32_t functionUid)
+{
+    static const std::unordered_map<uint32_t, const char*> names = []()
+    {
+        std::unordered_map<uint32_t, const char*> map;
+        for (const tFunctionName &function : FUNCTION_NAMES)
+        {
+            map[function.functionUid] = function.name;
+        }
+        return map;
+    }();
+
+    auto name = names.find(functionUid & 0x0FFFFFFF);
+    return name != names.end() ? name->second : nullptr;
+}
@@ -1,17 +1,25 @@
 #include "Classes/include/KortexRobot.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include<stdio.h>
 
 #include<stdlib.h>
 
 namespace k_api = Kinova::Api;
 constexpr auto TIMEOUT_DURATION = std::chrono::seconds{20};
+constexpr size_t COMPLETED_ACTIONS_KEPT = 16;
+
+std::mutex KortexRobot::s_StateMutex;
+std::condition_variable KortexRobot::s_StateChanged;
 
 KortexRobot::KortexRobot(const std::string &IP)
 {
     m_sIP = IP;
     m_bIsConnected = false;
-    m_bIsBusy = false;
+    m_State = IDLE;
+    m_nActionsSent = 0;
     Init(); //initialize the robot as soon as create the object, just make the main function clean
 }
 
@@ -25,9 +33,9 @@ KortexRobot:: ~KortexRobot()
         // Deactivate the router and cleanly disconnect from the transport object
         m_pRouterClient->SetActivationStatus(false);
         m_pTcpClient->disconnect();
+        CompletePendingActions(k_api::Base::UNSPECIFIED_ACTION_EVENT);
 
         m_bIsConnected = false;
-        m_bIsBusy = false;
 
         // Destroy the API, all are pointers
         if (m_pControlConfigClient != nullptr)
@@ -82,7 +90,7 @@ bool KortexRobot::Init()
         m_pBase->SetServoingMode(servoingMode);
     }
 
-    catch(k_api::KDetailedException ex)
+    catch(k_api::KDetailedException &ex)
     {
         OnError(ex);
     }
@@ -93,38 +101,208 @@ bool KortexRobot::Init()
 
 void KortexRobot::OnActionNotificationCallback(k_api::Base::ActionNotification &notif)
 {
+    //The state and the pending action change in one step: the callers woken by the state find the action gone, those
+    //woken by its future find the robot idle. Only the events of the action sent last move the state, those of an
+    //earlier one (paused, then replaced) only complete it. With none of ours pending, the actions of the other clients
+    //(web app, joystick) move it.
+    std::lock_guard<std::mutex> lock(m_ActionMutex);
+
+    //each notification has its own thread in the NotificationHandler: the ACTION_START or ACTION_PAUSE of an action
+    //can come after its ACTION_END, it would leave the robot busy for good
+    uint32_t identifier = notif.handle().identifier();
+    if ((notif.action_event() == k_api::Base::ACTION_START || notif.action_event() == k_api::Base::ACTION_PAUSE)
+        && std::find(m_CompletedActions.begin(), m_CompletedActions.end(), identifier) != m_CompletedActions.end())
+    {
+        std::cout << "The action: " << identifier << " has already completed, event ignored" << std::endl;
+        return;
+    }
+
+    auto pending = FindPendingAction(notif.handle());
+    bool bCurrent = m_PendingActions.empty() || (pending != m_PendingActions.end() && std::next(pending) == m_PendingActions.end());
+
     switch (notif.action_event())
     {
         case k_api::Base::ACTION_START:
         {
-            m_bIsBusy = true;
+            if (bCurrent)
+            {
+                SetMotionState(MOVING);
+            }
+            if (pending != m_PendingActions.end())
+            {
+                if (pending->handle.identifier() == 0)
+                {
+                    pending->handle.set_identifier(notif.handle().identifier());
+                }
+                if (!pending->bStarted)
+                {
+                    pending->bStarted = true;
+                    pending->started.set_value();
+                }
+            }
             std::cout << "The action: " << notif.handle().identifier() << "has started" << std::endl;
             break;
         }
 
         case k_api::Base::ACTION_END:
-        {
-            m_bIsBusy = false;
-            std::cout << "The action: " << notif.handle().identifier()	 << "has ended" << std::endl;
-            break;
-        }
-
         case k_api::Base::ACTION_ABORT:
         {
-            m_bIsBusy = false;
-            std::cout << "The action: " << notif.handle().identifier()	<< "has aborted" << std::endl;
+            if (identifier != 0)
+            {
+                m_CompletedActions.push_back(identifier);
+                if (m_CompletedActions.size() > COMPLETED_ACTIONS_KEPT)
+                {
+                    m_CompletedActions.pop_front();
+                }
+            }
+            if (bCurrent)
+            {
+                SetMotionState(IDLE);
+            }
+            if (pending != m_PendingActions.end())
+            {
+                CompleteAction(*pending, notif.action_event());
+                m_PendingActions.erase(pending);
+            }
+            std::cout << "The action: " << notif.handle().identifier()	 << (notif.action_event() == k_api::Base::ACTION_END ? "has ended" : "has aborted") << std::endl;
             break;
         }
 
         case k_api::Base::ACTION_PAUSE:
         {
-            m_bIsBusy = false;
+            if (bCurrent)
+            {
+                SetMotionState(PAUSED);
+            }
             std::cout << "The action: " << notif.handle().identifier()	<< "has paused" << std::endl;
             break;
         }
+
+        default:
+            break;
     }    
 }
 
+tActionCompletion KortexRobot::SendAction(const k_api::Base::ActionHandle &handle, const std::function<void()> &send)
+{
+    if (m_NotificationHandleList.empty())
+    {
+        subscribeToNotification();
+    }
+
+    tActionCompletion completion;
+    uint64_t nSent;
+    {
+        //an action still pending (paused) stays so until its own ACTION_ABORT, sent when this one replaces it
+        std::lock_guard<std::mutex> lock(m_ActionMutex);
+        m_PendingActions.emplace_back();
+        tPendingAction &pending = m_PendingActions.back();
+        pending.handle = handle;
+        pending.nSent = nSent = ++m_nActionsSent;
+        pending.bStarted = false;
+        completion.started = pending.started.get_future().share();
+        completion.finished = pending.finished.get_future().share();
+        SetMotionState(ACTION_SENT);  //WaitWhileRobotIsMoving does not return before its start
+    }
+
+    try
+    {
+        send();
+    }
+    //KBasicException: a timed out RPC throws the base class, the action has to be rolled back as well
+    catch(k_api::KBasicException &ex)
+    {
+        auto pDetailed = dynamic_cast<k_api::KDetailedException*>(&ex);
+        if (pDetailed != nullptr)
+        {
+            OnError(*pDetailed);
+        }
+        else
+        {
+            std::cout << "KBasicException detected what:  " << ex.what() << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(m_ActionMutex);
+        auto pending = std::find_if(m_PendingActions.begin(), m_PendingActions.end(), [nSent](const tPendingAction &action)
+        {
+            return action.nSent == nSent;
+        });
+        if (pending != m_PendingActions.end())
+        {
+            if (std::next(pending) == m_PendingActions.end())
+            {
+                SetMotionState(IDLE);
+            }
+            CompleteAction(*pending, k_api::Base::UNSPECIFIED_ACTION_EVENT);
+            m_PendingActions.erase(pending);
+        }
+    }
+    return completion;
+}
+
+std::list<KortexRobot::tPendingAction>::iterator KortexRobot::FindPendingAction(const k_api::Base::ActionHandle &handle)
+{
+    //the action of the identifier, else the first one sent of its type whose identifier is not known yet
+    auto found = m_PendingActions.end();
+    for (auto pending = m_PendingActions.begin(); pending != m_PendingActions.end(); ++pending)
+    {
+        if (pending->handle.identifier() != 0)
+        {
+            if (pending->handle.identifier() == handle.identifier())
+            {
+                return pending;
+            }
+        }
+        else if (found == m_PendingActions.end() && (pending->handle.action_type() == k_api::Base::UNSPECIFIED_ACTION
+                                                     || pending->handle.action_type() == handle.action_type()))
+        {
+            found = pending;
+        }
+    }
+    return found;
+}
+
+void KortexRobot::CompleteAction(tPendingAction &pending, k_api::Base::ActionEvent event)
+{
+    if (!pending.bStarted)
+    {
+        pending.started.set_value();
+    }
+    pending.finished.set_value(event);
+}
+
+void KortexRobot::CompletePendingActions(k_api::Base::ActionEvent event)
+{
+    std::lock_guard<std::mutex> lock(m_ActionMutex);
+    SetMotionState(IDLE);
+    for (tPendingAction &pending : m_PendingActions)
+    {
+        CompleteAction(pending, event);
+    }
+    m_PendingActions.clear();
+}
+
+void KortexRobot::SetMotionState(eMotionState state)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_StateMutex);
+        m_State = state;
+    }
+    s_StateChanged.notify_all();
+}
+
+tActionCompletion KortexRobot::RejectedAction()
+{
+    std::promise<void> started;
+    std::promise<k_api::Base::ActionEvent> finished;
+    started.set_value();
+    finished.set_value(k_api::Base::UNSPECIFIED_ACTION_EVENT);
+
+    tActionCompletion completion;
+    completion.started = started.get_future().share();
+    completion.finished = finished.get_future().share();
+    return completion;
+}
+
 void KortexRobot::subscribeToNotification()
 {
    if(!m_bIsConnected){
@@ -158,6 +336,7 @@ void KortexRobot::unsubscribeToNotification()
     {
         m_pBase->Unsubscribe(handle);
     }
+    m_NotificationHandleList.clear();
 
 }
 
@@ -177,50 +356,46 @@ void KortexRobot::OnError(k_api::KDetailedException &ex)
         std::cout << "Error sub-code string equivalent: " << k_api::SubErrorCodes_Name(k_api::SubErrorCodes(error_info.error_sub_code())) << std::endl;
 }
 
-bool KortexRobot::ExecuteExistingAction(const std::string &actionName, k_api::Base::RequestedActionType &actionType)
+tActionCompletion KortexRobot::ExecuteExistingAction(const std::string &actionName, k_api::Base::RequestedActionType &actionType)
 {
-    if(!m_bIsConnected || m_bIsBusy)
+    if(!m_bIsConnected || IsBusy())
     {
-        return false;
+        return RejectedAction();
     }
 
+    auto action_handle = k_api::Base::ActionHandle();  //this is the Reference to a specific action
     try
     {
         // searching the expected action
         auto action_list = m_pBase->ReadAllActions(actionType); 
-        auto action_handle = k_api::Base::ActionHandle();  //this is the Reference to a specific action
         action_handle.set_identifier(0);  //set the action identifier to be 0
 
         for (auto action : action_list.action_list())   //looping through all the action list inside the base
         {
-            if (action.name() == "Home") 
+            if (action.name() == actionName) 
             {
                 action_handle = action.handle();  //Returns the current value of handle, Reference to the action (useful when updating an existing action)
             }
         }
-        if(action_handle.identifier() == 0)
-        {
-            return false;
-        }
-        else
-        {
-            m_pBase->ExecuteActionFromReference(action_handle);
-        }
-        
     }
     catch(k_api::KDetailedException &ex)
     {
         OnError(ex);
+        return RejectedAction();
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(550));  //to avoid the confliction between next action
-    return true;
+    if(action_handle.identifier() == 0)
+    {
+        return RejectedAction();
+    }
+
+    return SendAction(action_handle, [this, &action_handle]() {m_pBase->ExecuteActionFromReference(action_handle);});
 }
 
-bool KortexRobot::MoveTo(const tCartesianVector &position, const tCartesianVector &orientation, const k_api::Base::CartesianTrajectoryConstraint &constraint)
+tActionCompletion KortexRobot::MoveTo(const tCartesianVector &position, const tCartesianVector &orientation, const k_api::Base::CartesianTrajectoryConstraint &constraint)
 {
-    if(!m_bIsConnected || m_bIsBusy)
+    if(!m_bIsConnected || IsBusy())
     {
-        return false;
+        return RejectedAction();
     }
     m_Action.mutable_handle()->set_action_type(k_api::Base::REACH_POSE);  //action type
     //m_Action.set_name("Move to a position to any Cartesian frame");
@@ -239,38 +414,37 @@ bool KortexRobot::MoveTo(const tCartesianVector &position, const tCartesianVecto
         case k_api::Base::CartesianTrajectoryConstraint::TypeCase::kDuration:
         {
             m_Action.mutable_reach_pose()->mutable_constraint()->set_duration(constraint.duration());
+            break;
         }
         
         case k_api::Base::CartesianTrajectoryConstraint::TypeCase::kSpeed:
         {
             m_Action.mutable_reach_pose()->mutable_constraint()->mutable_speed()->set_translation(constraint.speed().translation());
             m_Action.mutable_reach_pose()->mutable_constraint()->mutable_speed()->set_orientation(constraint.speed().orientation());
+            break;
         }
-    }
 
-    try
-    {
-        m_pBase->ExecuteAction(m_Action);
-    }
-    catch(k_api::KDetailedException &ex)
-    {
-        OnError(ex);
+        default:
+        {
+            m_Action.mutable_reach_pose()->clear_constraint();  //no constraint of a previous MoveTo
+            break;
+        }
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(550));  //to avoid the confliction between next action
-    return true;
+
+    return SendAction(m_Action.handle(), [this]() {m_pBase->ExecuteAction(m_Action);});
 }
 
 
-bool KortexRobot::SetJointAngles(const std::vector<float> &angles, const k_api::Base::JointTrajectoryConstraint &J_constraint)
+tActionCompletion KortexRobot::SetJointAngles(const std::vector<float> &angles, const k_api::Base::JointTrajectoryConstraint &J_constraint)
 {
-    if(!m_bIsConnected || m_bIsBusy)
+    if(!m_bIsConnected || IsBusy())
     {
-        return false;
+        return RejectedAction();
     }
 
-    if (angles.size() != m_NbDOF)
+    if (angles.size() != size_t(m_NbDOF))
     {
-        return false;
+        return RejectedAction();
     }
 
     m_Action.mutable_handle()->set_action_type(k_api::Base::REACH_JOINT_ANGLES);  //action type
@@ -295,24 +469,14 @@ bool KortexRobot::SetJointAngles(const std::vector<float> &angles, const k_api::
         constraintJointAngles->mutable_constraint()->set_type(J_constraint.type());
         constraintJointAngles->mutable_constraint()->set_value(J_constraint.value());
     }
-    try
-    {
-        m_pBase->ExecuteAction(m_Action);
-    }
-    catch(k_api::KDetailedException &ex)
-    {
-        OnError(ex);
-    }
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(550));  //to avoid the confliction between next action
-    return true;  
+    return SendAction(m_Action.handle(), [this]() {m_pBase->ExecuteAction(m_Action);});
 }
 
     
 bool KortexRobot::SendTwistCommand(const tCartesianVector &translation, const tCartesianVector &rotation)
 {
     //twist command are priority to the regular actions
-    if(!m_bIsConnected || m_bIsBusy)
+    if(!m_bIsConnected || IsBusy())
     {
         return false;
     }
@@ -335,7 +499,6 @@ bool KortexRobot::SendTwistCommand(const tCartesianVector &translation, const tC
         OnError(ex);
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(550));  //to avoid the confliction between next action
     return true;  
 
 }
@@ -363,12 +526,12 @@ bool KortexRobot::SetTwistReferenceFrame(const k_api::Common::CartesianReference
 
 bool KortexRobot::SetJointSpeeds(std::vector<float> &JointSpeeds)
 {
-    if(!m_bIsConnected || m_bIsBusy)
+    if(!m_bIsConnected || IsBusy())
     {
         return false;
     }
 
-    if (JointSpeeds.size() != m_NbDOF)
+    if (JointSpeeds.size() != size_t(m_NbDOF))
     {
         return false;
     }
@@ -398,7 +561,7 @@ bool KortexRobot::SetJointSpeeds(std::vector<float> &JointSpeeds)
 //functions directly from the client and being useful outside of class
 bool KortexRobot::PlaySequence(const k_api::Base::SequenceHandle &sequenceHandle)
 {
-   if(!m_bIsConnected || m_bIsBusy)
+   if(!m_bIsConnected || IsBusy())
     {
         return false;
     }
@@ -415,47 +578,66 @@ bool KortexRobot::PlaySequence(const k_api::Base::SequenceHandle &sequenceHandle
     return true;
 }
     
-bool KortexRobot::ExecuteAction(const k_api::Base::Action &action)
+tActionCompletion KortexRobot::ExecuteAction(const k_api::Base::Action &action)
 {
-   if(!m_bIsConnected || m_bIsBusy)
-    {
-        return false;
-    }
-
-    try
+   if(!m_bIsConnected || IsBusy())
     {
-        m_pBase->ExecuteAction(action);
-    }
-    catch(k_api::KDetailedException &ex)
-    {
-        OnError(ex);
+        return RejectedAction();
     }
-    
-    return true;
 
+    return SendAction(action.handle(), [this, &action]() {m_pBase->ExecuteAction(action);});
 }
 
 //nessesary for properly using the above functions, avoid problems
 bool KortexRobot::WaitWhileRobotIsMoving(const int timeout)
+{
+    return WaitWhileRobotIsMoving(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout));
+}
+
+bool KortexRobot::WaitWhileRobotIsMoving(const std::chrono::steady_clock::time_point &deadline)
 {
     if(!m_bIsConnected)
     {
         return false;
     }
 
-    //do nothing when the robot is moving
-    int cycle = 0;
-    while(m_bIsBusy && cycle < timeout)
-    {
-        cycle ++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
+    std::unique_lock<std::mutex> lock(s_StateMutex);
+    return s_StateChanged.wait_until(lock, deadline, [this]() {return !IsBusy();});  //robot moving is over
+}
 
-    if (cycle > timeout)
+int KortexRobot::WaitAny(const std::vector<KortexRobot*> &robots, const std::chrono::steady_clock::time_point &deadline)
+{
+    int index = -1;
+    std::unique_lock<std::mutex> lock(s_StateMutex);
+    s_StateChanged.wait_until(lock, deadline, [&robots, &index]()
     {
+        for (size_t i = 0; i < robots.size(); i++)
+        {
+            if (!robots[i]->IsBusy())
+            {
+                index = int(i);
+                return true;
+            }
+        }
         return false;
-    }
-    return true;  //robot moving is over
+    });
+    return index;
+}
+
+bool KortexRobot::WaitAll(const std::vector<KortexRobot*> &robots, const std::chrono::steady_clock::time_point &deadline)
+{
+    std::unique_lock<std::mutex> lock(s_StateMutex);
+    return s_StateChanged.wait_until(lock, deadline, [&robots]()
+    {
+        for (KortexRobot *pRobot : robots)
+        {
+            if (pRobot->IsBusy())
+            {
+                return false;
+            }
+        }
+        return true;
+    });
 }
 
     
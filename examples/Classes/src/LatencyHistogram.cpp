@@ -0,0 +1,85 @@
+#include "Classes/include/LatencyHistogram.h"
+
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+constexpr int LatencyHistogram::BUCKET_COUNT;
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+    memset(m_Counts, 0, sizeof(m_Counts));
+    m_nCount = 0;
+    m_nSum = 0;
+    m_nMin = std::numeric_limits<uint64_t>::max();
+    m_nMax = 0;
+}
+
+void LatencyHistogram::Add(const LatencyHistogram &other)
+{
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        m_Counts[i] += other.m_Counts[i];
+    }
+    m_nCount += other.m_nCount;
+    m_nSum += other.m_nSum;
+    if (other.m_nMin < m_nMin) m_nMin = other.m_nMin;
+    if (other.m_nMax > m_nMax) m_nMax = other.m_nMax;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index)
+{
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return uint64_t(index);
+    }
+    int magnitude = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = uint64_t(index % SUB_BUCKET_COUNT);
+    uint64_t lowerBound = (SUB_BUCKET_COUNT + subBucket) << (magnitude - SUB_BUCKET_BITS);
+    return lowerBound + (uint64_t(1) << (magnitude - SUB_BUCKET_BITS)) - 1;
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+    if (m_nCount == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = uint64_t(percentile / 100.0 * double(m_nCount) + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > m_nCount) rank = m_nCount;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        seen += m_Counts[i];
+        if (seen >= rank)
+        {
+            //the bucket bound can overshoot the largest value actually recorded
+            uint64_t bound = BucketUpperBound(i);
+            return (bound < m_nMax) ? bound : m_nMax;
+        }
+    }
+    return m_nMax;
+}
+
+std::string LatencyHistogram::ToString() const
+{
+    std::ostringstream stream;
+    stream.precision(1);
+    stream << std::fixed
+           << "count " << m_nCount
+           << ", min " << GetMin() / 1000.0
+           << ", mean " << GetMean() / 1000.0
+           << ", p50 " << GetPercentile(50.0) / 1000.0
+           << ", p99 " << GetPercentile(99.0) / 1000.0
+           << ", p99.9 " << GetPercentile(99.9) / 1000.0
+           << ", max " << GetMax() / 1000.0 << " us";
+    return stream.str();
+}
@@ -0,0 +1,169 @@
+#include "Classes/include/LoopbackTransport.h"
+
+#include <utility>
+
+#include "Classes/include/EventTrace.h"
+
+namespace k_api = Kinova::Api;
+
+constexpr size_t LoopbackTransport::MAX_FRAME_SIZE;
+
+LoopbackTransport::LoopbackTransport(ILoopbackServer *pServer)
+{
+    readyState = k_api::UNINITIALIZED;
+    m_pServer = pServer;
+    m_nPort = 0;
+    m_bStop = true;
+    m_nSent = 0;
+    m_nDelivered = 0;
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+    disconnect();
+}
+
+bool LoopbackTransport::connect(std::string host, uint32_t port)
+{
+    if (m_Worker.joinable())
+    {
+        return true;
+    }
+    m_Host = host;
+    m_nPort = port;
+    m_nSent = 0;
+    m_nDelivered = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStop = false;
+    }
+    m_Worker = std::thread(&LoopbackTransport::Run, this);
+    readyState = k_api::OPEN;
+    return true;
+}
+
+void LoopbackTransport::disconnect()
+{
+    if (!m_Worker.joinable())
+    {
+        return;
+    }
+    readyState = k_api::CLOSING;
+    m_pServer->OnDisconnect(this);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStop = true;
+    }
+    m_Condition.notify_one();
+    m_Worker.join();
+
+    //what was not handled is dropped, as a socket would
+    m_Queue.clear();
+    readyState = k_api::CLOSED;
+}
+
+void LoopbackTransport::send(const char *txBuffer, uint32_t txSize)
+{
+    std::string bytes = TakeBuffer();
+    bytes.assign(txBuffer, txSize);
+    Push(true, bytes);
+    m_nSent++;
+}
+
+void LoopbackTransport::onMessage(std::function<void (const char*, uint32_t)> callback)
+{
+    std::lock_guard<std::mutex> lock(m_CallbackMutex);
+    m_Callback = callback;
+}
+
+char* LoopbackTransport::getTxBuffer(uint32_t const &allocation_size)
+{
+    if (m_TxBuffer.size() < allocation_size)
+    {
+        m_TxBuffer.resize(allocation_size);
+    }
+    return m_TxBuffer.data();
+}
+
+void LoopbackTransport::getHostAddress(std::string &host, uint32_t &port)
+{
+    host = m_Host;
+    port = m_nPort;
+}
+
+void LoopbackTransport::Deliver(const k_api::Frame &frame)
+{
+    std::string bytes = TakeBuffer();
+    frame.SerializeToString(&bytes);
+    Push(false, bytes);
+}
+
+std::string LoopbackTransport::TakeBuffer()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_FreeBuffers.empty())
+    {
+        return std::string();
+    }
+    std::string bytes = std::move(m_FreeBuffers.back());
+    m_FreeBuffers.pop_back();
+    return bytes;
+}
+
+void LoopbackTransport::Push(bool bFromRouter, std::string &bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_bStop)
+        {
+            return;
+        }
+        m_Queue.push_back(tItem());
+        m_Queue.back().bFromRouter = bFromRouter;
+        m_Queue.back().bytes.swap(bytes);
+    }
+    m_Condition.notify_one();
+}
+
+void LoopbackTransport::Run()
+{
+    KORTEX_TRACE_THREAD_NAME("loopback");
+    k_api::Frame request;
+    tItem item;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Condition.wait(lock, [this]() {return m_bStop || !m_Queue.empty();});
+        if (m_bStop)
+        {
+            return;
+        }
+        item.bFromRouter = m_Queue.front().bFromRouter;
+        item.bytes.swap(m_Queue.front().bytes);
+        m_Queue.pop_front();
+        lock.unlock();
+
+        if (item.bFromRouter)
+        {
+            //the router only sends what it serialized itself
+            if (request.ParseFromString(item.bytes))
+            {
+                KORTEX_TRACE_SCOPE("loopback", "server");
+                m_pServer->OnFrame(request, this);
+            }
+        }
+        else
+        {
+            std::lock_guard<std::mutex> callbackLock(m_CallbackMutex);
+            if (m_Callback)
+            {
+                m_Callback(item.bytes.data(), uint32_t(item.bytes.size()));
+                m_nDelivered++;
+            }
+        }
+
+        lock.lock();
+        m_FreeBuffers.push_back(std::string());
+        m_FreeBuffers.back().swap(item.bytes);
+    }
+}
@@ -0,0 +1,329 @@
+#include "Classes/include/MetricsTransport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <HeaderInfo.h>
+
+#include "Classes/include/FrameHeader.h"
+#include "Classes/include/KortexFunctionNames.h"
+
+namespace k_api = Kinova::Api;
+
+using std::chrono::steady_clock;
+
+namespace
+{
+    //the expired requests are looked for at most this often, by the frames and the snapshots
+    const std::chrono::milliseconds EXPIRE_PERIOD(100);
+
+    //latency buckets of the Prometheus histogram, in seconds
+    const double LATENCY_BOUNDS[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5,
+                                     1.0, 2.5, 5.0};
+
+    std::string EscapeLabel(const std::string &value)
+    {
+        std::string escaped;
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c; break;
+            }
+        }
+        return escaped;
+    }
+
+    std::string Labels(const tRpcMetrics &metrics)
+    {
+        std::ostringstream stream;
+        stream << "channel=\"" << EscapeLabel(metrics.channel) << "\",function=\"" << EscapeLabel(metrics.name)
+               << "\",uid=\"0x" << std::hex << metrics.functionUid << std::dec << "\",device=\"" << metrics.deviceId << "\"";
+        return stream.str();
+    }
+
+    void WriteFamily(std::ostream &stream, const std::vector<tRpcMetrics> &metrics, const char *name, const char *type,
+                     const char *help, uint64_t tRpcMetrics::*pCounter)
+    {
+        stream << "# HELP " << name << " " << help << "\n"
+               << "# TYPE " << name << " " << type << "\n";
+        for (const tRpcMetrics &function : metrics)
+        {
+            stream << name << "{" << Labels(function) << "} " << function.*pCounter << "\n";
+        }
+    }
+}
+
+MetricsTransport::MetricsTransport(k_api::ITransportClient *pTransport, const std::string &channel, uint32_t timeout_ms) :
+    m_Channel(channel), m_Timeout(timeout_ms)
+{
+    m_pTransport = pTransport;
+    readyState = m_pTransport->readyState;
+    m_LastExpire = steady_clock::now();
+    m_nMalformed = 0;
+}
+
+bool MetricsTransport::connect(std::string host, uint32_t port)
+{
+    bool bConnected = m_pTransport->connect(host, port);
+    readyState = m_pTransport->readyState;
+    return bConnected;
+}
+
+void MetricsTransport::disconnect()
+{
+    m_pTransport->disconnect();
+    readyState = m_pTransport->readyState;
+}
+
+void MetricsTransport::send(const char *txBuffer, uint32_t txSize)
+{
+    Count(true, txBuffer, txSize);
+    m_pTransport->send(txBuffer, txSize);
+}
+
+void MetricsTransport::onMessage(std::function<void (const char*, uint32_t)> callback)
+{
+    m_pTransport->onMessage([this, callback](const char *rxBuffer, uint32_t rxSize)
+    {
+        Count(false, rxBuffer, rxSize);
+        callback(rxBuffer, rxSize);
+    });
+}
+
+char* MetricsTransport::getTxBuffer(uint32_t const &allocation_size)
+{
+    return m_pTransport->getTxBuffer(allocation_size);
+}
+
+size_t MetricsTransport::getMaxTxBufferSize()
+{
+    return m_pTransport->getMaxTxBufferSize();
+}
+
+void MetricsTransport::getHostAddress(std::string &host, uint32_t &port)
+{
+    m_pTransport->getHostAddress(host, port);
+}
+
+void MetricsTransport::Count(bool bTx, const char *pData, uint32_t size)
+{
+    tFrameHeader header;
+    bool bParsed = ParseFrameHeader(pData, size, header);
+    auto now = steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!bParsed)
+    {
+        m_nMalformed++;
+        return;
+    }
+
+    const uint32_t functionUid = header.service.functionUid;
+    const uint64_t pendingKey = (uint64_t(header.message.messageId) << 32) | functionUid;
+    tRpcMetrics *pMetrics = nullptr;
+    switch (header.frame.frameType)
+    {
+    case k_api::MSG_FRAME_REQUEST:
+    {
+        pMetrics = &GetMetrics(functionUid, header.frame.deviceId);
+        pMetrics->nCalls++;
+        pMetrics->nInFlight++;
+        auto pending = m_Pending.insert({pendingKey, tPending{pMetrics, now}});
+        if (!pending.second)
+        {
+            //the message id wrapped around before the previous request was answered
+            pending.first->second.pMetrics->nInFlight--;
+            pending.first->second.pMetrics->nTimeouts++;
+            pending.first->second = tPending{pMetrics, now};
+        }
+        break;
+    }
+    case k_api::MSG_FRAME_RESPONSE:
+    {
+        auto pending = m_Pending.find(pendingKey);
+        if (pending != m_Pending.end())
+        {
+            pMetrics = pending->second.pMetrics;
+            pMetrics->nResponses++;
+            pMetrics->nInFlight--;
+            pMetrics->latency.Record(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - pending->second.start).count()));
+            m_Pending.erase(pending);
+        }
+        else
+        {
+            pMetrics = &GetMetrics(functionUid, header.frame.deviceId);
+            pMetrics->nLateResponses++;
+        }
+        if (header.frame.errorCode != k_api::ERROR_NONE)
+        {
+            pMetrics->nServerErrors++;
+        }
+        break;
+    }
+    case k_api::MSG_FRAME_NOTIFICATION:
+        pMetrics = &GetMetrics(functionUid, header.frame.deviceId);
+        pMetrics->nNotifications++;
+        break;
+    default:
+        //pings of the keep-alive
+        break;
+    }
+
+    if (pMetrics != nullptr)
+    {
+        (bTx ? pMetrics->nTxBytes : pMetrics->nRxBytes) += size;
+    }
+    if (now - m_LastExpire >= EXPIRE_PERIOD)
+    {
+        Expire(now);
+    }
+}
+
+tRpcMetrics& MetricsTransport::GetMetrics(uint32_t functionUid, uint32_t deviceId)
+{
+    std::unique_ptr<tRpcMetrics> &pMetrics = m_Metrics[(uint64_t(deviceId) << 32) | functionUid];
+    if (!pMetrics)
+    {
+        pMetrics.reset(new tRpcMetrics());
+        pMetrics->channel = m_Channel;
+        pMetrics->functionUid = functionUid;
+        pMetrics->deviceId = deviceId;
+        const char *name = GetKortexFunctionName(functionUid);
+        if (name != nullptr)
+        {
+            pMetrics->name = name;
+        }
+        else
+        {
+            std::ostringstream stream;
+            stream << "0x" << std::hex << functionUid;
+            pMetrics->name = stream.str();
+        }
+    }
+    return *pMetrics;
+}
+
+void MetricsTransport::Expire(steady_clock::time_point now)
+{
+    m_LastExpire = now;
+    for (auto pending = m_Pending.begin(); pending != m_Pending.end();)
+    {
+        if (now - pending->second.start >= m_Timeout)
+        {
+            pending->second.pMetrics->nInFlight--;
+            pending->second.pMetrics->nTimeouts++;
+            pending = m_Pending.erase(pending);
+        }
+        else
+        {
+            ++pending;
+        }
+    }
+}
+
+std::vector<tRpcMetrics> MetricsTransport::GetSnapshot()
+{
+    std::vector<tRpcMetrics> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        Expire(steady_clock::now());
+        snapshot.reserve(m_Metrics.size());
+        for (const auto &metrics : m_Metrics)
+        {
+            snapshot.push_back(*metrics.second);
+        }
+    }
+    std::sort(snapshot.begin(), snapshot.end(), [](const tRpcMetrics &a, const tRpcMetrics &b)
+    {
+        return a.nTxBytes + a.nRxBytes > b.nTxBytes + b.nRxBytes;
+    });
+    return snapshot;
+}
+
+uint64_t MetricsTransport::GetMalformedCount()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_nMalformed;
+}
+
+void MetricsTransport::Reset()
+{
+    //the requests in flight stay so, their responses are counted
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto &metrics : m_Metrics)
+    {
+        tRpcMetrics &counters = *metrics.second;
+        counters.nCalls = 0;
+        counters.nResponses = 0;
+        counters.nServerErrors = 0;
+        counters.nTimeouts = 0;
+        counters.nLateResponses = 0;
+        counters.nNotifications = 0;
+        counters.nTxBytes = 0;
+        counters.nRxBytes = 0;
+        counters.latency.Reset();
+    }
+    m_nMalformed = 0;
+}
+
+std::string MetricsTransport::ToPrometheus(const std::vector<tRpcMetrics> &metrics)
+{
+    std::ostringstream stream;
+    WriteFamily(stream, metrics, "kortex_rpc_calls_total", "counter", "Requests sent", &tRpcMetrics::nCalls);
+    WriteFamily(stream, metrics, "kortex_rpc_responses_total", "counter", "Responses matched to their request", &tRpcMetrics::nResponses);
+    WriteFamily(stream, metrics, "kortex_rpc_server_errors_total", "counter", "Responses with an error code", &tRpcMetrics::nServerErrors);
+    WriteFamily(stream, metrics, "kortex_rpc_timeouts_total", "counter", "Requests left without a response", &tRpcMetrics::nTimeouts);
+    WriteFamily(stream, metrics, "kortex_rpc_late_responses_total", "counter", "Responses to no pending request", &tRpcMetrics::nLateResponses);
+    WriteFamily(stream, metrics, "kortex_rpc_notifications_total", "counter", "Notifications received", &tRpcMetrics::nNotifications);
+    WriteFamily(stream, metrics, "kortex_rpc_tx_bytes_total", "counter", "Bytes of the frames sent", &tRpcMetrics::nTxBytes);
+    WriteFamily(stream, metrics, "kortex_rpc_rx_bytes_total", "counter", "Bytes of the frames received", &tRpcMetrics::nRxBytes);
+    WriteFamily(stream, metrics, "kortex_rpc_in_flight", "gauge", "Requests waiting for their response", &tRpcMetrics::nInFlight);
+
+    //the buckets of LatencyHistogram are counted in the first bound above their upper bound
+    stream << "# HELP kortex_rpc_latency_seconds Time from the request sent to its response received\n"
+           << "# TYPE kortex_rpc_latency_seconds histogram\n";
+    for (const tRpcMetrics &function : metrics)
+    {
+        const std::string labels = Labels(function);
+        int bucket = 0;
+        uint64_t count = 0;
+        for (double bound : LATENCY_BOUNDS)
+        {
+            const uint64_t bound_ns = uint64_t(bound * 1e9);
+            for (; bucket < LatencyHistogram::BUCKET_COUNT && LatencyHistogram::BucketUpperBound(bucket) <= bound_ns; bucket++)
+            {
+                count += function.latency.GetBucketCount(bucket);
+            }
+            stream << "kortex_rpc_latency_seconds_bucket{" << labels << ",le=\"" << bound << "\"} " << count << "\n";
+        }
+        stream << "kortex_rpc_latency_seconds_bucket{" << labels << ",le=\"+Inf\"} " << function.latency.GetCount() << "\n"
+               << "kortex_rpc_latency_seconds_sum{" << labels << "} " << std::setprecision(9)
+               << function.latency.GetMean() * function.latency.GetCount() / 1e9 << std::setprecision(6) << "\n"
+               << "kortex_rpc_latency_seconds_count{" << labels << "} " << function.latency.GetCount() << "\n";
+    }
+    return stream.str();
+}
+
+bool MetricsTransport::WritePrometheusFile(const std::string &path, const std::vector<tRpcMetrics> &metrics)
+{
+    //a collector reading the file while it is written sees the previous one
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary);
+        file << ToPrometheus(metrics);
+        file.close();
+        if (!file)
+        {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
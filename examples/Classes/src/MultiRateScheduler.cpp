@@ -0,0 +1,220 @@
+#include "Classes/include/MultiRateScheduler.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+namespace k_api = Kinova::Api;
+
+using std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+
+namespace
+{
+    uint64_t ElapsedNs(const steady_clock::time_point &start, const steady_clock::time_point &end)
+    {
+        return uint64_t(std::chrono::duration_cast<nanoseconds>(end - start).count());
+    }
+}
+
+MultiRateScheduler::MultiRateScheduler(CyclicExecutor *pExecutor)
+{
+    m_pExecutor = pExecutor;
+    m_pMirror.reset(new FeedbackMirror());
+    m_pActiveMirror = m_pMirror.get();
+    m_nTick = 0;
+    m_bStopBackground = false;
+}
+
+int MultiRateScheduler::AddCyclicTask(const std::string &name, std::chrono::microseconds period, const CyclicTask &task)
+{
+    auto basePeriod = m_pExecutor->GetPeriod().count();
+    auto taskPeriod = std::chrono::duration_cast<nanoseconds>(period).count();
+    if (basePeriod <= 0 || taskPeriod < basePeriod || taskPeriod % basePeriod != 0)
+    {
+        return -1;
+    }
+
+    std::unique_ptr<tTask> pTask(new tTask());
+    pTask->cyclic = task;
+    pTask->nDivider = uint64_t(taskPeriod / basePeriod);
+    pTask->nPhase = 0;
+    pTask->statistics.name = name;
+    pTask->statistics.period = period;
+    pTask->statistics.nRuns = 0;
+    pTask->statistics.nSkippedReleases = 0;
+
+    m_CyclicTasks.push_back(pTask.get());
+    std::stable_sort(m_CyclicTasks.begin(), m_CyclicTasks.end(), [](const tTask *a, const tTask *b) {return a->nDivider < b->nDivider;});
+    AssignPhases();
+
+    m_Tasks.push_back(std::move(pTask));
+    return int(m_Tasks.size()) - 1;
+}
+
+int MultiRateScheduler::AddBackgroundTask(const std::string &name, std::chrono::microseconds period, const BackgroundTask &task)
+{
+    if (period.count() <= 0)
+    {
+        return -1;
+    }
+
+    std::unique_ptr<tTask> pTask(new tTask());
+    pTask->background = task;
+    pTask->nDivider = 0;
+    pTask->nPhase = 0;
+    pTask->statistics.name = name;
+    pTask->statistics.period = period;
+    pTask->statistics.nRuns = 0;
+    pTask->statistics.nSkippedReleases = 0;
+
+    m_BackgroundTasks.push_back(pTask.get());
+    std::stable_sort(m_BackgroundTasks.begin(), m_BackgroundTasks.end(), [](const tTask *a, const tTask *b) {return a->statistics.period < b->statistics.period;});
+
+    m_Tasks.push_back(std::move(pTask));
+    return int(m_Tasks.size()) - 1;
+}
+
+void MultiRateScheduler::AssignPhases()
+{
+    //the lower rate tasks take the ticks one after the other, the base rate ones run on every tick anyway
+    uint64_t slot = 0;
+    for (auto pTask : m_CyclicTasks)
+    {
+        if (pTask->nDivider > 1)
+        {
+            pTask->nPhase = slot % pTask->nDivider;
+            slot++;
+        }
+    }
+}
+
+bool MultiRateScheduler::Tick(const k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command)
+{
+    bool bContinue = true;
+    for (auto pTask : m_CyclicTasks)
+    {
+        if (m_nTick % pTask->nDivider != pTask->nPhase)
+        {
+            continue;
+        }
+        auto start = steady_clock::now();
+        bContinue = pTask->cyclic(feedback, command) && bContinue;
+        pTask->statistics.duration.Record(ElapsedNs(start, steady_clock::now()));
+        pTask->statistics.nRuns++;
+    }
+    m_nTick++;
+    return bContinue;
+}
+
+void MultiRateScheduler::RunBackgroundTasks()
+{
+    std::vector<steady_clock::time_point> releases(m_BackgroundTasks.size(), steady_clock::now());
+    std::unique_ptr<tFlatFeedback> pSnapshot(new tFlatFeedback());
+
+    std::unique_lock<std::mutex> lock(m_StopMutex);
+    while (!m_bStopBackground)
+    {
+        auto next = *std::min_element(releases.begin(), releases.end());
+        if (m_StopCondition.wait_until(lock, next, [this] {return m_bStopBackground;}))
+        {
+            break;
+        }
+        lock.unlock();
+
+        //false until the first Refresh went through
+        bool bHasSnapshot = m_pActiveMirror->Read(*pSnapshot);
+
+        //all the tasks released by now, fastest first
+        for (size_t i = 0; i < m_BackgroundTasks.size(); i++)
+        {
+            tTask *pTask = m_BackgroundTasks[i];
+            auto now = steady_clock::now();
+            if (releases[i] > now)
+            {
+                continue;
+            }
+            if (bHasSnapshot)
+            {
+                pTask->background(*pSnapshot);
+                pTask->statistics.duration.Record(ElapsedNs(now, steady_clock::now()));
+                pTask->statistics.nRuns++;
+            }
+
+            //absolute releases, the ones already in the past after a long run are skipped
+            releases[i] += pTask->statistics.period;
+            now = steady_clock::now();
+            while (releases[i] <= now)
+            {
+                releases[i] += pTask->statistics.period;
+                pTask->statistics.nSkippedReleases++;
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+void MultiRateScheduler::Run(k_api::BaseCyclic::Feedback &feedback, k_api::BaseCyclic::Command &command, uint64_t maxTicks)
+{
+    m_nTick = 0;
+
+    //the background tasks read the feedbacks through the mirror of the executor, one is lent to it if it has none
+    FeedbackMirror *pPreviousMirror = m_pExecutor->GetFeedbackMirror();
+    if (!pPreviousMirror)
+    {
+        m_pMirror.reset(new FeedbackMirror());
+    }
+    m_pActiveMirror = pPreviousMirror ? pPreviousMirror : m_pMirror.get();
+    m_pExecutor->SetFeedbackMirror(m_pActiveMirror);
+
+    std::thread background;
+    if (!m_BackgroundTasks.empty())
+    {
+        m_bStopBackground = false;
+        background = std::thread(&MultiRateScheduler::RunBackgroundTasks, this);
+    }
+
+    m_pExecutor->Run(feedback, command, [this](k_api::BaseCyclic::Feedback &f, k_api::BaseCyclic::Command &c) {return Tick(f, c);}, maxTicks);
+
+    if (background.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_StopMutex);
+            m_bStopBackground = true;
+        }
+        m_StopCondition.notify_all();
+        background.join();
+    }
+    m_pExecutor->SetFeedbackMirror(pPreviousMirror);
+}
+
+void MultiRateScheduler::Stop()
+{
+    m_pExecutor->Stop();
+}
+
+std::string MultiRateScheduler::ToString() const
+{
+    std::ostringstream stream;
+    bool bFirst = true;
+    for (auto list : {&m_CyclicTasks, &m_BackgroundTasks})
+    {
+        for (auto pTask : *list)
+        {
+            if (!bFirst)
+            {
+                stream << std::endl;
+            }
+            bFirst = false;
+            stream << pTask->statistics.name << " (" << (pTask->cyclic ? "cyclic" : "background") << ", "
+                   << pTask->statistics.period.count() << " us): runs " << pTask->statistics.nRuns;
+            if (!pTask->cyclic)
+            {
+                stream << ", skipped releases " << pTask->statistics.nSkippedReleases;
+            }
+            stream << ", duration " << pTask->statistics.duration.ToString();
+        }
+    }
+    return stream.str();
+}
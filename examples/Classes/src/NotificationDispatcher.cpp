@@ -0,0 +1,230 @@
+#include "Classes/include/NotificationDispatcher.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <HeaderInfo.h>
+#include <KDetailedException.h>
+
+#include "Classes/include/EventTrace.h"
+
+namespace k_api = Kinova::Api;
+
+namespace
+{
+    const uint32_t TOPIC_SERVICE_VERSION = 1;
+}
+
+NotificationDispatcher::NotificationDispatcher(k_api::IRouterClient *pRouter, uint32_t serviceId, eStrategy strategy, int nThreads) :
+    m_eStrategy(strategy)
+{
+    m_pRouter = pRouter;
+    m_nReceived = 0;
+    m_nDispatched = 0;
+    m_nDropped = 0;
+    m_nMaxQueueDepth = 0;
+
+    int workerCount = strategy == INLINE ? 0 : strategy == QUEUE ? 1 : std::max(1, nThreads);
+    for (int i = 0; i < workerCount; i++)
+    {
+        m_Workers.emplace_back(new tWorker);
+    }
+    for (auto &pWorker : m_Workers)
+    {
+        pWorker->thread = std::thread(&NotificationDispatcher::RunWorker, this, pWorker.get());
+    }
+
+    m_pLink = std::make_shared<tLink>();
+    m_pLink->pDispatcher = this;
+    std::shared_ptr<tLink> pLink = m_pLink;
+    m_pRouter->registerNotificationCallback(serviceId, [pLink](k_api::Frame &frame)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pLink->mutex);
+            if (pLink->pDispatcher)
+            {
+                pLink->pDispatcher->OnNotification(frame);
+            }
+        }
+        k_api::Error error;
+        error.set_error_code(k_api::ERROR_NONE);
+        return error;
+    });
+}
+
+NotificationDispatcher::~NotificationDispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pLink->mutex);
+        m_pLink->pDispatcher = nullptr;
+    }
+    for (auto &pWorker : m_Workers)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pWorker->mutex);
+            pWorker->bStop = true;
+        }
+        pWorker->condition.notify_one();
+        pWorker->thread.join();
+    }
+}
+
+k_api::Common::NotificationHandle NotificationDispatcher::SubscribeTopic(uint32_t topicUid, const google::protobuf::Message &options,
+                                                                         uint32_t deviceId, uint32_t timeout_ms)
+{
+    k_api::RouterClientSendOptions sendOptions = {false, 0, timeout_ms};
+    auto futureFrame = m_pRouter->send(options.SerializeAsString(), TOPIC_SERVICE_VERSION, topicUid, deviceId, sendOptions);
+    if (futureFrame.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready)
+    {
+        throw k_api::KBasicException("Notification subscription timed out");
+    }
+
+    //rethrows what the router set on the promise
+    k_api::Frame frame = futureFrame.get();
+
+    k_api::HeaderInfo header(frame.header());
+    if (header.m_frameInfo.errorCode != k_api::ERROR_NONE)
+    {
+        throw k_api::KDetailedException(k_api::KError(header, k_api::ErrorCodes(header.m_frameInfo.errorCode),
+                                                      k_api::SubErrorCodes(header.m_frameInfo.errorSubCode),
+                                                      "Notification subscription failed"));
+    }
+
+    k_api::Common::NotificationHandle handle;
+    if (!handle.ParseFromString(frame.payload()))
+    {
+        throw k_api::KBasicException("Cannot parse the notification handle");
+    }
+    return handle;
+}
+
+std::shared_ptr<const NotificationDispatcher::Handler> NotificationDispatcher::AddHandler(uint32_t topicUid, const Handler &handler)
+{
+    std::shared_ptr<const Handler> pHandler = std::make_shared<Handler>(handler);
+    std::lock_guard<std::mutex> lock(m_HandlerMutex);
+    std::shared_ptr<HandlerList> pHandlers = std::make_shared<HandlerList>();
+    auto current = m_Handlers.find(topicUid);
+    if (current != m_Handlers.end())
+    {
+        *pHandlers = *current->second;
+    }
+    pHandlers->push_back(pHandler);
+    m_Handlers[topicUid] = pHandlers;
+    return pHandler;
+}
+
+void NotificationDispatcher::RemoveHandler(uint32_t topicUid, const std::shared_ptr<const Handler> &pHandler)
+{
+    std::lock_guard<std::mutex> lock(m_HandlerMutex);
+    auto current = m_Handlers.find(topicUid);
+    if (current == m_Handlers.end())
+    {
+        return;
+    }
+    std::shared_ptr<HandlerList> pHandlers = std::make_shared<HandlerList>(*current->second);
+    pHandlers->erase(std::remove(pHandlers->begin(), pHandlers->end(), pHandler), pHandlers->end());
+    //no handler left: the topic counts as dropped again
+    if (pHandlers->empty())
+    {
+        m_Handlers.erase(current);
+    }
+    else
+    {
+        current->second = pHandlers;
+    }
+}
+
+void NotificationDispatcher::RemoveCallbacks(uint32_t topicUid)
+{
+    std::lock_guard<std::mutex> lock(m_HandlerMutex);
+    m_Handlers.erase(topicUid);
+}
+
+NotificationDispatcher::tStatistics NotificationDispatcher::GetStatistics() const
+{
+    tStatistics statistics;
+    statistics.nReceived = m_nReceived;
+    statistics.nDispatched = m_nDispatched;
+    statistics.nDropped = m_nDropped;
+    statistics.nMaxQueueDepth = m_nMaxQueueDepth;
+    return statistics;
+}
+
+void NotificationDispatcher::OnNotification(k_api::Frame &frame)
+{
+    m_nReceived++;
+    if (m_eStrategy == INLINE)
+    {
+        Dispatch(frame);
+        return;
+    }
+
+    k_api::HeaderInfo header(frame.header());
+    tWorker &worker = *m_Workers[header.m_serviceInfo.functionUid % m_Workers.size()];
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(frame);
+        depth = worker.queue.size();
+    }
+    worker.condition.notify_one();
+
+    size_t maxDepth = m_nMaxQueueDepth;
+    while (depth > maxDepth && !m_nMaxQueueDepth.compare_exchange_weak(maxDepth, depth))
+    {
+    }
+}
+
+void NotificationDispatcher::Dispatch(const k_api::Frame &frame)
+{
+    KORTEX_TRACE_SCOPE("notification", "dispatch");
+    k_api::HeaderInfo header(frame.header());
+    std::shared_ptr<const HandlerList> pHandlers;
+    {
+        std::lock_guard<std::mutex> lock(m_HandlerMutex);
+        auto found = m_Handlers.find(header.m_serviceInfo.functionUid);
+        if (found != m_Handlers.end())
+        {
+            pHandlers = found->second;
+        }
+    }
+    if (!pHandlers)
+    {
+        m_nDropped++;
+        return;
+    }
+
+    bool bDecoded = true;
+    for (const auto &pHandler : *pHandlers)
+    {
+        bDecoded = (*pHandler)(frame) && bDecoded;
+    }
+    if (bDecoded)
+    {
+        m_nDispatched++;
+    }
+    else
+    {
+        m_nDropped++;
+    }
+}
+
+void NotificationDispatcher::RunWorker(tWorker *pWorker)
+{
+    KORTEX_TRACE_THREAD_NAME("notification worker");
+    k_api::Frame frame;
+    std::unique_lock<std::mutex> lock(pWorker->mutex);
+    while (true)
+    {
+        pWorker->condition.wait(lock, [pWorker]() {return pWorker->bStop || !pWorker->queue.empty();});
+        if (pWorker->bStop)
+        {
+            return;
+        }
+        frame.Swap(&pWorker->queue.front());
+        pWorker->queue.pop_front();
+        lock.unlock();
+        Dispatch(frame);
+        lock.lock();
+    }
+}
@@ -0,0 +1,251 @@
+#include "Classes/include/PipelinedCyclicClient.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+
+#include <HeaderInfo.h>
+
+#include "Classes/include/AlignedNew.h"
+#include "Classes/include/EventTrace.h"
+#include "Classes/include/FeedbackMirror.h"
+
+namespace k_api = Kinova::Api;
+
+constexpr int PipelinedCyclicClient::PIPELINE_DEPTH;
+
+namespace
+{
+    enum eSlotState
+    {
+        SLOT_EMPTY = 0,
+        SLOT_IN_FLIGHT = 1,
+        SLOT_RECEIVED = 2,
+    };
+
+    //frame id in the high 32 bits and eSlotState in the low ones, so a slot changes with one atomic operation
+    uint64_t SlotState(uint32_t frameId, eSlotState state)
+    {
+        return (uint64_t(frameId) << 32) | uint64_t(state);
+    }
+
+    uint64_t NowNs()
+    {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+struct PipelinedCyclicClient::tSharedState : public tAlignedNew<64>
+{
+    struct tSlot
+    {
+        std::atomic<uint64_t> state;
+        std::atomic<uint64_t> sendTime_ns;
+    };
+
+    tSlot slots[PIPELINE_DEPTH];
+
+    //router thread; the mutex orders the callbacks between themselves, only the timing snapshots take it too
+    std::mutex callbackMutex;
+    tFlatFeedback decoded;
+    tRefreshTiming timing;
+    FeedbackMirror latest;
+
+    //Send() stamps from the control thread and the callbacks classify from the router thread, both under this mutex;
+    //it is held for that only, never across a decode or a send
+    mutable std::mutex sequenceMutex;
+    CyclicSequencer sequencer;
+
+    std::atomic<uint64_t> nSent;
+    std::atomic<uint64_t> nSendErrors;
+    std::atomic<uint64_t> nReceived;
+    std::atomic<uint64_t> nErrorReplies;
+    std::atomic<uint64_t> nLost;
+    std::atomic<uint64_t> nDecodeErrors;
+
+    tSharedState()
+    {
+        for (int i = 0; i < PIPELINE_DEPTH; i++)
+        {
+            slots[i].state = SlotState(0, SLOT_EMPTY);
+            slots[i].sendTime_ns = 0;
+        }
+        //the control thread only moves forward: a feedback older than one already published is counted, not published
+        sequencer.SetDiscardStaleFeedback(true);
+        nSent = 0;
+        nSendErrors = 0;
+        nReceived = 0;
+        nErrorReplies = 0;
+        nLost = 0;
+        nDecodeErrors = 0;
+    }
+
+    void OnFeedback(const k_api::Frame &frame);
+};
+
+void PipelinedCyclicClient::tSharedState::OnFeedback(const k_api::Frame &frame)
+{
+    uint64_t receivedTime = NowNs();
+    KORTEX_TRACE_SCOPE("cyclic", "pipelined feedback");
+    std::lock_guard<std::mutex> lock(callbackMutex);
+
+    k_api::HeaderInfo header(frame.header());
+    if (header.m_frameInfo.errorCode != k_api::ERROR_NONE)
+    {
+        nErrorReplies++;
+        return;
+    }
+    if (!decoded.Decode(frame.payload()))
+    {
+        nDecodeErrors++;
+        return;
+    }
+    uint64_t decodedTime = NowNs();
+
+    uint32_t frameId = decoded.frameId & CyclicSequencer::FRAME_ID_MASK;
+    tSlot &slot = slots[frameId % PIPELINE_DEPTH];
+    uint64_t expected = SlotState(frameId, SLOT_IN_FLIGHT);
+    //not in flight: a duplicate, too old or never sent, the sequencer tells which; no send time to time it against
+    bool bInFlight = slot.state.compare_exchange_strong(expected, SlotState(frameId, SLOT_RECEIVED), std::memory_order_acq_rel);
+
+    bool bAccepted;
+    {
+        std::lock_guard<std::mutex> sequenceLock(sequenceMutex);
+        bAccepted = sequencer.Accept(frameId);
+    }
+    if (bAccepted)
+    {
+        latest.Publish(decoded);
+    }
+    if (!bInFlight)
+    {
+        return;
+    }
+    nReceived++;
+
+    timing.Record(receivedTime - slot.sendTime_ns.load(std::memory_order_relaxed), decodedTime - receivedTime, NowNs() - receivedTime,
+                  tRefreshTiming::GetMaxJitterComm(decoded));
+}
+
+std::string tPipelineStatistics::ToString() const
+{
+    std::ostringstream stream;
+    stream << "sent " << nSent << ", received " << nReceived << ", lost " << nLost
+           << ", send errors " << nSendErrors << ", error replies " << nErrorReplies << ", decode errors " << nDecodeErrors
+           << "; sequence: " << sequence.ToString();
+    return stream.str();
+}
+
+PipelinedCyclicClient::PipelinedCyclicClient(k_api::IRouterClient *pRouter, uint32_t deviceId)
+{
+    m_pRouter = pRouter;
+    m_nDeviceId = deviceId;
+    //not make_shared: its allocation would not honour the 64 bytes alignment
+    m_pState = std::shared_ptr<tSharedState>(new tSharedState());
+}
+
+bool PipelinedCyclicClient::Init(const k_api::BaseCyclic::Command &command)
+{
+    if (!m_Command.Init(command))
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_pState->sequenceMutex);
+    m_pState->sequencer.Reset(command.frame_id());
+    return true;
+}
+
+bool PipelinedCyclicClient::Send()
+{
+    KORTEX_TRACE_SCOPE("cyclic", "pipelined send");
+    uint32_t frameId;
+    {
+        std::lock_guard<std::mutex> lock(m_pState->sequenceMutex);
+        frameId = m_pState->sequencer.Stamp(m_Command);
+    }
+
+    //take the slot of the frame sent PIPELINE_DEPTH frames ago, still in flight means its feedback never came
+    tSharedState::tSlot &slot = m_pState->slots[frameId % PIPELINE_DEPTH];
+    slot.sendTime_ns.store(NowNs(), std::memory_order_relaxed);
+    uint64_t previous = slot.state.exchange(SlotState(frameId, SLOT_IN_FLIGHT), std::memory_order_acq_rel);
+    if ((previous & 0xFFFFFFFF) == SLOT_IN_FLIGHT)
+    {
+        m_pState->nLost++;
+    }
+
+    //the callback owns a reference: the state outlives the client if a feedback comes back after it is destroyed
+    std::shared_ptr<tSharedState> pState = m_pState;
+    k_api::Error error = m_pRouter->sendWithCallback(m_Command.GetPayload(), PreencodedCyclicCommand::SERVICE_VERSION,
+                                                     k_api::BaseCyclic::eUidRefresh, m_nDeviceId,
+                                                     [pState](const k_api::Frame &frame) {pState->OnFeedback(frame);});
+    if (error.error_code() != k_api::ERROR_NONE)
+    {
+        slot.state.store(SlotState(frameId, SLOT_EMPTY), std::memory_order_release);
+        m_pState->nSendErrors++;
+        return false;
+    }
+    m_pState->nSent++;
+    return true;
+}
+
+bool PipelinedCyclicClient::GetLatestFeedback(tFlatFeedback &feedback, uint64_t *pReceiveTime_ns) const
+{
+    return m_pState->latest.Read(feedback, pReceiveTime_ns);
+}
+
+uint64_t PipelinedCyclicClient::GetFeedbackVersion() const
+{
+    return m_pState->latest.GetVersion();
+}
+
+uint32_t PipelinedCyclicClient::GetLastSentFrameId() const
+{
+    std::lock_guard<std::mutex> lock(m_pState->sequenceMutex);
+    return m_pState->sequencer.GetLastSentFrameId();
+}
+
+uint32_t PipelinedCyclicClient::GetLatestReceivedFrameId() const
+{
+    std::lock_guard<std::mutex> lock(m_pState->sequenceMutex);
+    return m_pState->sequencer.GetLastAcceptedFrameId();
+}
+
+int PipelinedCyclicClient::GetInFlightCount() const
+{
+    int count = 0;
+    for (int i = 0; i < PIPELINE_DEPTH; i++)
+    {
+        if ((m_pState->slots[i].state.load(std::memory_order_relaxed) & 0xFFFFFFFF) == SLOT_IN_FLIGHT)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+tPipelineStatistics PipelinedCyclicClient::GetStatistics() const
+{
+    tPipelineStatistics statistics;
+    statistics.nSent = m_pState->nSent;
+    statistics.nSendErrors = m_pState->nSendErrors;
+    statistics.nReceived = m_pState->nReceived;
+    statistics.nErrorReplies = m_pState->nErrorReplies;
+    statistics.nLost = m_pState->nLost;
+    statistics.nDecodeErrors = m_pState->nDecodeErrors;
+    std::lock_guard<std::mutex> lock(m_pState->sequenceMutex);
+    statistics.sequence = m_pState->sequencer.GetStatistics();
+    return statistics;
+}
+
+void PipelinedCyclicClient::GetRefreshTiming(tRefreshTiming &snapshot) const
+{
+    std::lock_guard<std::mutex> lock(m_pState->callbackMutex);
+    snapshot = m_pState->timing;
+}
+
+void PipelinedCyclicClient::ResetRefreshTiming()
+{
+    std::lock_guard<std::mutex> lock(m_pState->callbackMutex);
+    m_pState->timing.Reset();
+}
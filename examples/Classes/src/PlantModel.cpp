@@ -0,0 +1,288 @@
+#include "Classes/include/PlantModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace k_api = Kinova::Api;
+
+namespace
+{
+    const float TURN = 360.0f;
+    const float RADIANS_PER_DEGREE = 3.14159265358979f / 180.0f;
+
+    //to [-180, 180)
+    float Wrap(float angle)
+    {
+        return angle - TURN * std::floor((angle + 0.5f * TURN) / TURN);
+    }
+
+    float Clamp(float value, float limit)
+    {
+        return std::max(-limit, std::min(limit, value));
+    }
+}
+
+tJointDynamics tJointDynamics::BigActuator()
+{
+    tJointDynamics dynamics;
+    dynamics.inertia = 0.5f;
+    dynamics.damping = 2.0f;
+    dynamics.bandwidth_hz = 8.0f;
+    dynamics.velocityTimeConstant_s = 0.02f;
+    dynamics.maxVelocity = 80.0f;
+    dynamics.maxAcceleration = 500.0f;
+    dynamics.maxTorque = 39.0f;
+    dynamics.bContinuous = true;
+    dynamics.minPosition = -180.0f;
+    dynamics.maxPosition = 180.0f;
+    dynamics.torqueConstant = 11.0f;
+    dynamics.thermalTimeConstant_s = 600.0f;
+    dynamics.temperatureRise = 2.0f;
+    return dynamics;
+}
+
+tJointDynamics tJointDynamics::SmallActuator()
+{
+    tJointDynamics dynamics = BigActuator();
+    dynamics.inertia = 0.05f;
+    dynamics.damping = 0.5f;
+    dynamics.bandwidth_hz = 10.0f;
+    dynamics.velocityTimeConstant_s = 0.015f;
+    dynamics.maxVelocity = 70.0f;
+    dynamics.maxAcceleration = 600.0f;
+    dynamics.maxTorque = 9.0f;
+    dynamics.torqueConstant = 7.6f;
+    dynamics.thermalTimeConstant_s = 300.0f;
+    dynamics.temperatureRise = 4.0f;
+    return dynamics;
+}
+
+tPlantSettings::tPlantSettings()
+{
+    period_s = 0.001f;
+    nSubsteps = 1;
+    nDelayTicks = 1;
+    ambientTemperature = 25.0f;
+    for (int i = 0; i < CyclicWire::MAX_ACTUATORS; i++)
+    {
+        joints[i] = i < 4 ? tJointDynamics::BigActuator() : tJointDynamics::SmallActuator();
+    }
+    const int limited[] = {1, 3, 5};
+    const float limits[] = {128.9f, 147.8f, 120.3f};
+    for (int i = 0; i < 3; i++)
+    {
+        joints[limited[i]].bContinuous = false;
+        joints[limited[i]].minPosition = -limits[i];
+        joints[limited[i]].maxPosition = limits[i];
+    }
+}
+
+PlantModel::PlantModel(int nActuatorCount, bool bGripper, const tPlantSettings &settings) :
+    m_Settings(settings),
+    m_nActuatorCount(std::min(nActuatorCount, int(CyclicWire::MAX_ACTUATORS))),
+    m_bGripper(bGripper)
+{
+    m_nTicks = 0;
+    m_nDelayedIndex = 0;
+    m_Delayed.resize(size_t(std::max(0, m_Settings.nDelayTicks)));
+    for (int i = 0; i < CyclicWire::MAX_ACTUATORS; i++)
+    {
+        m_eModes[i] = POSITION;
+        m_Position[i] = 0.0f;
+        m_Velocity[i] = 0.0f;
+        m_Torque[i] = 0.0f;
+        m_Temperature[i] = m_Settings.ambientTemperature;
+    }
+    m_GripperPosition = 0.0f;
+    m_GripperVelocity = 0.0f;
+    m_GripperCurrent = 0.0f;
+    Hold();
+}
+
+void PlantModel::SetControlMode(int actuator, eControlMode mode)
+{
+    //a new loop starts from where the joint is
+    m_Pending.position[actuator] = m_Position[actuator];
+    m_Pending.velocity[actuator] = m_Velocity[actuator];
+    for (auto &delayed : m_Delayed)
+    {
+        delayed.position[actuator] = m_Position[actuator];
+        delayed.velocity[actuator] = m_Velocity[actuator];
+    }
+    m_eModes[actuator] = mode;
+}
+
+void PlantModel::SetCommand(const k_api::BaseCyclic::Command &command)
+{
+    int count = std::min(command.actuators_size(), m_nActuatorCount);
+    for (int i = 0; i < count; i++)
+    {
+        const auto &actuator = command.actuators(i);
+        m_Pending.position[i] = actuator.position();
+        m_Pending.velocity[i] = actuator.velocity();
+        m_Pending.torque[i] = actuator.torque_joint();
+    }
+    if (m_bGripper && command.has_interconnect() && command.interconnect().has_gripper_command()
+        && command.interconnect().gripper_command().motor_cmd_size() > 0)
+    {
+        const auto &motor = command.interconnect().gripper_command().motor_cmd(0);
+        m_Pending.gripperPosition = motor.position();
+        m_Pending.gripperVelocity = motor.velocity();
+        m_Pending.gripperForce = motor.force();
+    }
+}
+
+void PlantModel::SetActuatorCommand(int actuator, const k_api::ActuatorCyclic::Command &command)
+{
+    m_Pending.position[actuator] = command.position();
+    m_Pending.velocity[actuator] = command.velocity();
+    m_Pending.torque[actuator] = command.torque_joint();
+}
+
+void PlantModel::Hold()
+{
+    for (int i = 0; i < CyclicWire::MAX_ACTUATORS; i++)
+    {
+        m_Pending.position[i] = m_Position[i];
+        m_Pending.velocity[i] = 0.0f;
+        m_Pending.torque[i] = 0.0f;
+    }
+    m_Pending.gripperPosition = m_GripperPosition;
+    m_Pending.gripperVelocity = 0.0f;
+    m_Pending.gripperForce = 0.0f;
+    std::fill(m_Delayed.begin(), m_Delayed.end(), m_Pending);
+}
+
+void PlantModel::SetFromFeedback(const tFlatFeedback &state)
+{
+    for (int i = 0; i < m_nActuatorCount; i++)
+    {
+        m_Position[i] = Wrap(state.actuators.position[i]);
+        m_Velocity[i] = state.actuators.velocity[i];
+    }
+    if (m_bGripper && state.interconnect.gripper.nMotorCount > 0)
+    {
+        m_GripperPosition = state.interconnect.gripper.position[0];
+        m_GripperVelocity = 0.0f;
+    }
+    Hold();
+}
+
+void PlantModel::Step()
+{
+    //the command of nDelayTicks periods ago is applied, the pending one takes its place in the ring
+    tCommand command = m_Pending;
+    if (!m_Delayed.empty())
+    {
+        std::swap(command, m_Delayed[m_nDelayedIndex]);
+        m_nDelayedIndex = (m_nDelayedIndex + 1) % m_Delayed.size();
+    }
+
+    int substeps = std::max(1, m_Settings.nSubsteps);
+    float dt = m_Settings.period_s / float(substeps);
+    for (int i = 0; i < substeps; i++)
+    {
+        StepJoints(command, dt);
+        if (m_bGripper)
+        {
+            StepGripper(command, dt);
+        }
+    }
+    m_nTicks++;
+}
+
+void PlantModel::StepJoints(const tCommand &command, float dt)
+{
+    for (int i = 0; i < m_nActuatorCount; i++)
+    {
+        const tJointDynamics &joint = m_Settings.joints[i];
+        float velocity = m_Velocity[i];
+
+        //acceleration asked by the loop of the mode, deg/s2
+        float acceleration;
+        if (m_eModes[i] == POSITION)
+        {
+            float target = Wrap(command.position[i]);
+            float error = joint.bContinuous ? Wrap(target - m_Position[i])
+                                            : std::max(joint.minPosition, std::min(joint.maxPosition, target)) - m_Position[i];
+            float omega = 2.0f * 3.14159265f * joint.bandwidth_hz;
+            acceleration = omega * omega * error - 2.0f * omega * velocity;
+        }
+        else if (m_eModes[i] == VELOCITY)
+        {
+            acceleration = (Clamp(command.velocity[i], joint.maxVelocity) - velocity) / joint.velocityTimeConstant_s;
+        }
+        else
+        {
+            float torque = Clamp(command.torque[i], joint.maxTorque);
+            acceleration = (torque - joint.damping * velocity * RADIANS_PER_DEGREE) / joint.inertia / RADIANS_PER_DEGREE;
+        }
+
+        //within what the actuator can give
+        float dampingTorque = joint.damping * velocity * RADIANS_PER_DEGREE;
+        float torque = Clamp(joint.inertia * acceleration * RADIANS_PER_DEGREE + dampingTorque, joint.maxTorque);
+        acceleration = Clamp((torque - dampingTorque) / joint.inertia / RADIANS_PER_DEGREE, joint.maxAcceleration);
+
+        float nextVelocity = Clamp(velocity + acceleration * dt, joint.maxVelocity);
+        float position = m_Position[i] + nextVelocity * dt;
+        if (joint.bContinuous)
+        {
+            position = Wrap(position);
+        }
+        else if (position < joint.minPosition || position > joint.maxPosition)
+        {
+            position = std::max(joint.minPosition, std::min(joint.maxPosition, position));
+            nextVelocity = 0.0f;
+        }
+
+        //measured torque: what accelerated the joint and overcame the damping
+        float actualAcceleration = (nextVelocity - velocity) / dt;
+        m_Torque[i] = joint.inertia * actualAcceleration * RADIANS_PER_DEGREE + joint.damping * nextVelocity * RADIANS_PER_DEGREE;
+        m_Velocity[i] = nextVelocity;
+        m_Position[i] = position;
+
+        float current = m_Torque[i] / joint.torqueConstant;
+        float steadyTemperature = m_Settings.ambientTemperature + joint.temperatureRise * current * current;
+        m_Temperature[i] += (steadyTemperature - m_Temperature[i]) * dt / joint.thermalTimeConstant_s;
+    }
+}
+
+void PlantModel::StepGripper(const tCommand &command, float dt)
+{
+    const tGripperDynamics &gripper = m_Settings.gripper;
+    float target = std::max(0.0f, std::min(100.0f, command.gripperPosition));
+    float speed = std::max(0.0f, std::min(100.0f, command.gripperVelocity)) * 0.01f * gripper.maxSpeed;
+
+    //closing stops on the object
+    float stop = target > m_GripperPosition ? std::min(target, gripper.objectPosition) : target;
+    float distance = stop - m_GripperPosition;
+    float step = std::min(speed * dt, std::fabs(distance));
+    m_GripperPosition += distance < 0.0f ? -step : step;
+    m_GripperVelocity = 100.0f * step / dt / gripper.maxSpeed;
+
+    bool bSqueezing = target > gripper.objectPosition && m_GripperPosition >= gripper.objectPosition;
+    float force = std::max(0.0f, std::min(100.0f, command.gripperForce));
+    m_GripperCurrent = bSqueezing ? force * 0.01f * gripper.maxCurrent : gripper.idleCurrent;
+}
+
+void PlantModel::ToFeedback(tFlatFeedback &state) const
+{
+    tFlatActuatorFeedback &actuators = state.actuators;
+    for (int i = 0; i < std::min(m_nActuatorCount, actuators.nCount); i++)
+    {
+        //[0, 360) on the wire
+        actuators.position[i] = m_Position[i] < 0.0f ? m_Position[i] + TURN : m_Position[i];
+        actuators.velocity[i] = m_Velocity[i];
+        actuators.torque[i] = m_Torque[i];
+        actuators.currentMotor[i] = m_Torque[i] / m_Settings.joints[i].torqueConstant;
+        actuators.temperatureMotor[i] = m_Temperature[i];
+    }
+
+    tFlatGripperFeedback &gripper = state.interconnect.gripper;
+    if (m_bGripper && gripper.nMotorCount > 0)
+    {
+        gripper.position[0] = m_GripperPosition;
+        gripper.velocity[0] = m_GripperVelocity;
+        gripper.currentMotor[0] = m_GripperCurrent;
+    }
+}
@@ -0,0 +1,352 @@
+#include "Classes/include/PreencodedCyclicCommand.h"
+
+#include <chrono>
+#include <future>
+
+#include <HeaderInfo.h>
+#include <KDetailedException.h>
+
+namespace k_api = Kinova::Api;
+
+using namespace CyclicWire;
+
+constexpr int PreencodedCyclicCommand::MAX_PAYLOAD_SIZE;
+constexpr uint32_t PreencodedCyclicCommand::SERVICE_VERSION;
+
+namespace
+{
+    int Uint32FieldSize(uint32_t value)
+    {
+        return value ? 1 + Varint32Size(value) : 0;
+    }
+
+    int FloatFieldSize(float value)
+    {
+        return (value != 0) ? 1 + 4 : 0;
+    }
+
+    int MessageIdFieldSize(bool bPresent, uint32_t identifier)
+    {
+        if (!bPresent)
+        {
+            return 0;
+        }
+        int size = Uint32FieldSize(identifier);
+        return 1 + Varint32Size(uint32_t(size)) + size;
+    }
+}
+
+PreencodedCyclicCommand::PreencodedCyclicCommand()
+{
+    //reserved once, Encode() never reallocates
+    m_Payload.reserve(MAX_PAYLOAD_SIZE);
+    m_bLayoutChanged = false;
+    m_nReencodeCount = 0;
+    m_nFrameId = 0;
+    m_FrameIdOffset = -1;
+    m_nActuatorCount = 0;
+    m_bHasInterconnect = false;
+    m_Interconnect = tInterconnectValues();
+    m_nGripperMotorCount = 0;
+}
+
+bool PreencodedCyclicCommand::Init(const k_api::BaseCyclic::Command &command)
+{
+    if (command.actuators_size() > MAX_ACTUATORS)
+    {
+        return false;
+    }
+
+    m_nFrameId = command.frame_id();
+
+    m_nActuatorCount = command.actuators_size();
+    for (int i = 0; i < m_nActuatorCount; i++)
+    {
+        const auto &actuator = command.actuators(i);
+        m_Actuators[i].commandId = actuator.command_id();
+        m_Actuators[i].flags = actuator.flags();
+        m_Actuators[i].position = actuator.position();
+        m_Actuators[i].velocity = actuator.velocity();
+        m_Actuators[i].torqueJoint = actuator.torque_joint();
+        m_Actuators[i].currentMotor = actuator.current_motor();
+    }
+
+    m_bHasInterconnect = command.has_interconnect();
+    m_Interconnect = tInterconnectValues();
+    m_nGripperMotorCount = 0;
+    if (m_bHasInterconnect)
+    {
+        const auto &interconnect = command.interconnect();
+        m_Interconnect.bHasCommandId = interconnect.has_command_id();
+        m_Interconnect.commandId = interconnect.command_id().identifier();
+        m_Interconnect.flags = interconnect.flags();
+        m_Interconnect.bHasGripperCommand = interconnect.has_gripper_command();
+
+        const auto &gripper = interconnect.gripper_command();
+        if (gripper.motor_cmd_size() > MAX_GRIPPER_MOTORS)
+        {
+            return false;
+        }
+        m_Interconnect.bHasGripperCommandId = gripper.has_command_id();
+        m_Interconnect.gripperCommandId = gripper.command_id().identifier();
+        m_Interconnect.gripperFlags = gripper.flags();
+
+        m_nGripperMotorCount = gripper.motor_cmd_size();
+        for (int i = 0; i < m_nGripperMotorCount; i++)
+        {
+            const auto &motor = gripper.motor_cmd(i);
+            m_GripperMotors[i].motorId = motor.motor_id();
+            m_GripperMotors[i].position = motor.position();
+            m_GripperMotors[i].velocity = motor.velocity();
+            m_GripperMotors[i].force = motor.force();
+        }
+    }
+
+    Encode();
+    m_nReencodeCount = 0;
+
+    //anything this class does not model (unknown fields, another wire type for the uint32) shows up here
+    return m_Payload == command.SerializeAsString();
+}
+
+void PreencodedCyclicCommand::SetSequenceId(uint32_t id)
+{
+    SetFrameId(id);
+    for (int i = 0; i < m_nActuatorCount; i++)
+    {
+        SetCommandId(i, id);
+    }
+    if (m_bHasInterconnect)
+    {
+        if (!m_Interconnect.bHasCommandId)
+        {
+            m_Interconnect.bHasCommandId = true;
+            m_bLayoutChanged = true;
+        }
+        SetInterconnectCommandId(id);
+    }
+}
+
+uint8_t* PreencodedCyclicCommand::EncodeUint32(uint8_t *p, uint32_t fieldNumber, uint32_t value, int32_t &offset)
+{
+    if (!value)
+    {
+        offset = -1;
+        return p;
+    }
+    p = WriteTag(p, fieldNumber, WIRETYPE_VARINT);
+    offset = int32_t(p - Data());
+    return WriteVarint32(p, value);
+}
+
+uint8_t* PreencodedCyclicCommand::EncodeFloat(uint8_t *p, uint32_t fieldNumber, float value, int32_t &offset)
+{
+    if (value == 0)
+    {
+        offset = -1;
+        return p;
+    }
+    p = WriteTag(p, fieldNumber, WIRETYPE_FIXED32);
+    offset = int32_t(p - Data());
+    StoreFloat(p, value);
+    return p + 4;
+}
+
+int PreencodedCyclicCommand::ActuatorSize(int actuator) const
+{
+    const tActuatorValues &values = m_Actuators[actuator];
+    return Uint32FieldSize(values.commandId) + Uint32FieldSize(values.flags)
+         + FloatFieldSize(values.position) + FloatFieldSize(values.velocity)
+         + FloatFieldSize(values.torqueJoint) + FloatFieldSize(values.currentMotor);
+}
+
+int PreencodedCyclicCommand::GripperMotorSize(int motor) const
+{
+    const tGripperMotorValues &values = m_GripperMotors[motor];
+    return Uint32FieldSize(values.motorId) + FloatFieldSize(values.position)
+         + FloatFieldSize(values.velocity) + FloatFieldSize(values.force);
+}
+
+int PreencodedCyclicCommand::GripperCommandSize() const
+{
+    int size = MessageIdFieldSize(m_Interconnect.bHasGripperCommandId, m_Interconnect.gripperCommandId)
+             + Uint32FieldSize(m_Interconnect.gripperFlags);
+    for (int i = 0; i < m_nGripperMotorCount; i++)
+    {
+        int motorSize = GripperMotorSize(i);
+        size += 1 + Varint32Size(uint32_t(motorSize)) + motorSize;
+    }
+    return size;
+}
+
+int PreencodedCyclicCommand::InterconnectSize() const
+{
+    int size = MessageIdFieldSize(m_Interconnect.bHasCommandId, m_Interconnect.commandId)
+             + Uint32FieldSize(m_Interconnect.flags);
+    if (m_Interconnect.bHasGripperCommand)
+    {
+        int gripperSize = GripperCommandSize();
+        size += 1 + Varint32Size(uint32_t(gripperSize)) + gripperSize;
+    }
+    return size;
+}
+
+uint8_t* PreencodedCyclicCommand::EncodeActuator(uint8_t *p, int actuator)
+{
+    const tActuatorValues &values = m_Actuators[actuator];
+    tActuatorOffsets &offsets = m_ActuatorOffsets[actuator];
+
+    p = WriteTag(p, k_api::BaseCyclic::Command::kActuatorsFieldNumber, WIRETYPE_LENGTH_DELIMITED);
+    p = WriteVarint32(p, uint32_t(ActuatorSize(actuator)));
+    p = EncodeUint32(p, k_api::BaseCyclic::ActuatorCommand::kCommandIdFieldNumber, values.commandId, offsets.commandId);
+    p = EncodeUint32(p, k_api::BaseCyclic::ActuatorCommand::kFlagsFieldNumber, values.flags, offsets.flags);
+    p = EncodeFloat(p, k_api::BaseCyclic::ActuatorCommand::kPositionFieldNumber, values.position, offsets.position);
+    p = EncodeFloat(p, k_api::BaseCyclic::ActuatorCommand::kVelocityFieldNumber, values.velocity, offsets.velocity);
+    p = EncodeFloat(p, k_api::BaseCyclic::ActuatorCommand::kTorqueJointFieldNumber, values.torqueJoint, offsets.torqueJoint);
+    return EncodeFloat(p, k_api::BaseCyclic::ActuatorCommand::kCurrentMotorFieldNumber, values.currentMotor, offsets.currentMotor);
+}
+
+uint8_t* PreencodedCyclicCommand::EncodeGripperMotor(uint8_t *p, int motor)
+{
+    const tGripperMotorValues &values = m_GripperMotors[motor];
+    tGripperMotorOffsets &offsets = m_GripperMotorOffsets[motor];
+
+    p = WriteTag(p, k_api::GripperCyclic::Command::kMotorCmdFieldNumber, WIRETYPE_LENGTH_DELIMITED);
+    p = WriteVarint32(p, uint32_t(GripperMotorSize(motor)));
+    p = EncodeUint32(p, k_api::GripperCyclic::MotorCommand::kMotorIdFieldNumber, values.motorId, offsets.motorId);
+    p = EncodeFloat(p, k_api::GripperCyclic::MotorCommand::kPositionFieldNumber, values.position, offsets.position);
+    p = EncodeFloat(p, k_api::GripperCyclic::MotorCommand::kVelocityFieldNumber, values.velocity, offsets.velocity);
+    return EncodeFloat(p, k_api::GripperCyclic::MotorCommand::kForceFieldNumber, values.force, offsets.force);
+}
+
+uint8_t* PreencodedCyclicCommand::EncodeInterconnect(uint8_t *p)
+{
+    const tInterconnectValues &values = m_Interconnect;
+    tInterconnectOffsets &offsets = m_InterconnectOffsets;
+
+    p = WriteTag(p, k_api::BaseCyclic::Command::kInterconnectFieldNumber, WIRETYPE_LENGTH_DELIMITED);
+    p = WriteVarint32(p, uint32_t(InterconnectSize()));
+
+    if (values.bHasCommandId)
+    {
+        p = WriteTag(p, k_api::InterconnectCyclic::Command::kCommandIdFieldNumber, WIRETYPE_LENGTH_DELIMITED);
+        p = WriteVarint32(p, uint32_t(Uint32FieldSize(values.commandId)));
+        p = EncodeUint32(p, k_api::InterconnectCyclic::MessageId::kIdentifierFieldNumber, values.commandId, offsets.commandId);
+    }
+    p = EncodeUint32(p, k_api::InterconnectCyclic::Command::kFlagsFieldNumber, values.flags, offsets.flags);
+
+    if (values.bHasGripperCommand)
+    {
+        p = WriteTag(p, k_api::InterconnectCyclic::Command::kGripperCommandFieldNumber, WIRETYPE_LENGTH_DELIMITED);
+        p = WriteVarint32(p, uint32_t(GripperCommandSize()));
+        if (values.bHasGripperCommandId)
+        {
+            p = WriteTag(p, k_api::GripperCyclic::Command::kCommandIdFieldNumber, WIRETYPE_LENGTH_DELIMITED);
+            p = WriteVarint32(p, uint32_t(Uint32FieldSize(values.gripperCommandId)));
+            p = EncodeUint32(p, k_api::GripperCyclic::MessageId::kIdentifierFieldNumber, values.gripperCommandId, offsets.gripperCommandId);
+        }
+        p = EncodeUint32(p, k_api::GripperCyclic::Command::kFlagsFieldNumber, values.gripperFlags, offsets.gripperFlags);
+        for (int i = 0; i < m_nGripperMotorCount; i++)
+        {
+            p = EncodeGripperMotor(p, i);
+        }
+    }
+    return p;
+}
+
+void PreencodedCyclicCommand::Encode()
+{
+    //capacity is reserved, resizing never reallocates
+    m_Payload.resize(MAX_PAYLOAD_SIZE);
+
+    //sub-messages left out keep their offsets at -1, their setters only mark the layout as changed
+    m_InterconnectOffsets.commandId = -1;
+    m_InterconnectOffsets.flags = -1;
+    m_InterconnectOffsets.gripperCommandId = -1;
+    m_InterconnectOffsets.gripperFlags = -1;
+
+    //fields in field number order, like protobuf
+    uint8_t *p = Data();
+    p = EncodeUint32(p, k_api::BaseCyclic::Command::kFrameIdFieldNumber, m_nFrameId, m_FrameIdOffset);
+    for (int i = 0; i < m_nActuatorCount; i++)
+    {
+        p = EncodeActuator(p, i);
+    }
+    if (m_bHasInterconnect)
+    {
+        p = EncodeInterconnect(p);
+    }
+
+    m_Payload.resize(size_t(p - Data()));
+    m_bLayoutChanged = false;
+    m_nReencodeCount++;
+}
+
+void PreencodedCyclicCommand::ToCommand(k_api::BaseCyclic::Command &command) const
+{
+    command.Clear();
+    command.set_frame_id(m_nFrameId);
+    for (int i = 0; i < m_nActuatorCount; i++)
+    {
+        auto actuator = command.add_actuators();
+        actuator->set_command_id(m_Actuators[i].commandId);
+        actuator->set_flags(m_Actuators[i].flags);
+        actuator->set_position(m_Actuators[i].position);
+        actuator->set_velocity(m_Actuators[i].velocity);
+        actuator->set_torque_joint(m_Actuators[i].torqueJoint);
+        actuator->set_current_motor(m_Actuators[i].currentMotor);
+    }
+
+    if (!m_bHasInterconnect)
+    {
+        return;
+    }
+    auto interconnect = command.mutable_interconnect();
+    if (m_Interconnect.bHasCommandId)
+    {
+        interconnect->mutable_command_id()->set_identifier(m_Interconnect.commandId);
+    }
+    interconnect->set_flags(m_Interconnect.flags);
+    if (m_Interconnect.bHasGripperCommand)
+    {
+        auto gripper = interconnect->mutable_gripper_command();
+        if (m_Interconnect.bHasGripperCommandId)
+        {
+            gripper->mutable_command_id()->set_identifier(m_Interconnect.gripperCommandId);
+        }
+        gripper->set_flags(m_Interconnect.gripperFlags);
+        for (int i = 0; i < m_nGripperMotorCount; i++)
+        {
+            auto motor = gripper->add_motor_cmd();
+            motor->set_motor_id(m_GripperMotors[i].motorId);
+            motor->set_position(m_GripperMotors[i].position);
+            motor->set_velocity(m_GripperMotors[i].velocity);
+            motor->set_force(m_GripperMotors[i].force);
+        }
+    }
+}
+
+void PreencodedCyclicCommand::Refresh(k_api::IRouterClient *pRouter, k_api::BaseCyclic::Feedback &feedback, uint32_t deviceId, const k_api::RouterClientSendOptions &options)
+{
+    auto futureFrame = pRouter->send(GetPayload(), SERVICE_VERSION, k_api::BaseCyclic::eUidRefresh, deviceId, options);
+    if (futureFrame.wait_for(std::chrono::milliseconds(options.timeout_ms)) != std::future_status::ready)
+    {
+        throw k_api::KBasicException("BaseCyclic Refresh timed out");
+    }
+
+    //rethrows what the router set on the promise
+    k_api::Frame frame = futureFrame.get();
+
+    k_api::HeaderInfo header(frame.header());
+    if (header.m_frameInfo.errorCode != k_api::ERROR_NONE)
+    {
+        throw k_api::KDetailedException(k_api::KError(header, k_api::ErrorCodes(header.m_frameInfo.errorCode),
+                                                      k_api::SubErrorCodes(header.m_frameInfo.errorSubCode),
+                                                      "BaseCyclic Refresh failed"));
+    }
+
+    if (!feedback.ParseFromString(frame.payload()))
+    {
+        throw k_api::KBasicException("Cannot parse the BaseCyclic feedback");
+    }
+}
@@ -0,0 +1,74 @@
+#include "Classes/include/RecordingTransport.h"
+
+#include <KBasicException.h>
+
+namespace k_api = Kinova::Api;
+
+RecordingTransport::RecordingTransport(k_api::ITransportClient *pTransport, const std::string &path)
+{
+    m_pTransport = pTransport;
+    m_nLost = 0;
+    readyState = m_pTransport->readyState;
+    m_Writer.Open(path, uint32_t(m_pTransport->getMaxTxBufferSize()));
+}
+
+RecordingTransport::~RecordingTransport()
+{
+    m_Writer.Close();
+}
+
+bool RecordingTransport::connect(std::string host, uint32_t port)
+{
+    bool bConnected = m_pTransport->connect(host, port);
+    readyState = m_pTransport->readyState;
+    return bConnected;
+}
+
+void RecordingTransport::disconnect()
+{
+    m_pTransport->disconnect();
+    readyState = m_pTransport->readyState;
+    m_Writer.Close();
+}
+
+void RecordingTransport::send(const char *txBuffer, uint32_t txSize)
+{
+    Record(FrameCapture::TX, txBuffer, txSize);
+    m_pTransport->send(txBuffer, txSize);
+}
+
+void RecordingTransport::onMessage(std::function<void (const char*, uint32_t)> callback)
+{
+    m_pTransport->onMessage([this, callback](const char *rxBuffer, uint32_t rxSize)
+    {
+        Record(FrameCapture::RX, rxBuffer, rxSize);
+        callback(rxBuffer, rxSize);
+    });
+}
+
+char* RecordingTransport::getTxBuffer(uint32_t const &allocation_size)
+{
+    return m_pTransport->getTxBuffer(allocation_size);
+}
+
+size_t RecordingTransport::getMaxTxBufferSize()
+{
+    return m_pTransport->getMaxTxBufferSize();
+}
+
+void RecordingTransport::getHostAddress(std::string &host, uint32_t &port)
+{
+    m_pTransport->getHostAddress(host, port);
+}
+
+void RecordingTransport::Record(FrameCapture::eDirection direction, const char *pData, uint32_t size)
+{
+    try
+    {
+        m_Writer.Append(direction, pData, size);
+    }
+    catch (k_api::KBasicException&)
+    {
+        m_nLost++;
+    }
+}
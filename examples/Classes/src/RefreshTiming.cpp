@@ -0,0 +1,175 @@
+#include "Classes/include/RefreshTiming.h"
+
+#include <cmath>
+#include <sstream>
+
+namespace k_api = Kinova::Api;
+
+constexpr uint64_t tRefreshTiming::NOT_MEASURED;
+
+void tCorrelation::Reset()
+{
+    nCount = 0;
+    meanX = 0.0;
+    meanY = 0.0;
+    m2X = 0.0;
+    m2Y = 0.0;
+    coMoment = 0.0;
+}
+
+void tCorrelation::Merge(const tCorrelation &other)
+{
+    if (other.nCount == 0)
+    {
+        return;
+    }
+    if (nCount == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    //pairwise combination of the two partial moments
+    double count = double(nCount + other.nCount);
+    double dx = other.meanX - meanX;
+    double dy = other.meanY - meanY;
+    double weight = double(nCount) * double(other.nCount) / count;
+    m2X += other.m2X + dx * dx * weight;
+    m2Y += other.m2Y + dy * dy * weight;
+    coMoment += other.coMoment + dx * dy * weight;
+    meanX += dx * double(other.nCount) / count;
+    meanY += dy * double(other.nCount) / count;
+    nCount += other.nCount;
+}
+
+double tCorrelation::Get() const
+{
+    if (nCount < 2 || m2X <= 0.0 || m2Y <= 0.0)
+    {
+        return 0.0;
+    }
+    return coMoment / std::sqrt(m2X * m2Y);
+}
+
+void tRefreshTiming::Record(uint64_t roundTrip_ns, uint64_t parse_ns, uint64_t callback_ns, uint32_t jitterComm_us)
+{
+    double jitter = double(jitterComm_us);
+    jitterComm.Record(uint64_t(jitterComm_us) * 1000);
+
+    if (roundTrip_ns != NOT_MEASURED)
+    {
+        roundTrip.Record(roundTrip_ns);
+        roundTripJitter.Add(double(roundTrip_ns), jitter);
+    }
+    if (parse_ns != NOT_MEASURED)
+    {
+        parse.Record(parse_ns);
+        parseJitter.Add(double(parse_ns), jitter);
+    }
+    if (callback_ns != NOT_MEASURED)
+    {
+        callback.Record(callback_ns);
+        callbackJitter.Add(double(callback_ns), jitter);
+    }
+}
+
+void tRefreshTiming::Reset()
+{
+    roundTrip.Reset();
+    parse.Reset();
+    callback.Reset();
+    jitterComm.Reset();
+    roundTripJitter.Reset();
+    parseJitter.Reset();
+    callbackJitter.Reset();
+}
+
+void tRefreshTiming::Add(const tRefreshTiming &other)
+{
+    roundTrip.Add(other.roundTrip);
+    parse.Add(other.parse);
+    callback.Add(other.callback);
+    jitterComm.Add(other.jitterComm);
+    roundTripJitter.Merge(other.roundTripJitter);
+    parseJitter.Merge(other.parseJitter);
+    callbackJitter.Merge(other.callbackJitter);
+}
+
+std::string tRefreshTiming::ToString() const
+{
+    std::ostringstream stream;
+    stream.precision(2);
+    stream << std::fixed
+           << "  round trip:  " << roundTrip.ToString() << ", r(jitter_comm) " << roundTripJitter.Get() << std::endl
+           << "  parse:       " << parse.ToString() << ", r(jitter_comm) " << parseJitter.Get() << std::endl
+           << "  callback:    " << callback.ToString() << ", r(jitter_comm) " << callbackJitter.Get() << std::endl
+           << "  jitter_comm: " << jitterComm.ToString();
+    return stream.str();
+}
+
+namespace
+{
+    void WriteCsvRow(std::ostringstream &stream, const char *name, const LatencyHistogram &histogram, const tCorrelation *pCorrelation)
+    {
+        stream << name << ',' << histogram.GetCount()
+               << ',' << histogram.GetMin() / 1000.0
+               << ',' << histogram.GetMean() / 1000.0
+               << ',' << histogram.GetPercentile(50.0) / 1000.0
+               << ',' << histogram.GetPercentile(99.0) / 1000.0
+               << ',' << histogram.GetPercentile(99.9) / 1000.0
+               << ',' << histogram.GetMax() / 1000.0
+               << ',';
+        if (pCorrelation)
+        {
+            stream << pCorrelation->Get();
+        }
+        stream << '\n';
+    }
+}
+
+std::string tRefreshTiming::ToCsv() const
+{
+    std::ostringstream stream;
+    stream.precision(3);
+    stream << std::fixed
+           << "metric,count,min_us,mean_us,p50_us,p99_us,p99.9_us,max_us,jitter_comm_correlation\n";
+    WriteCsvRow(stream, "round_trip", roundTrip, &roundTripJitter);
+    WriteCsvRow(stream, "parse", parse, &parseJitter);
+    WriteCsvRow(stream, "callback", callback, &callbackJitter);
+    WriteCsvRow(stream, "jitter_comm", jitterComm, nullptr);
+    return stream.str();
+}
+
+uint32_t tRefreshTiming::GetMaxJitterComm(const k_api::BaseCyclic::Feedback &feedback)
+{
+    uint32_t jitter = 0;
+    for (int i = 0; i < feedback.actuators_size(); i++)
+    {
+        if (feedback.actuators(i).jitter_comm() > jitter)
+        {
+            jitter = feedback.actuators(i).jitter_comm();
+        }
+    }
+    if (feedback.has_interconnect() && feedback.interconnect().jitter_comm() > jitter)
+    {
+        jitter = feedback.interconnect().jitter_comm();
+    }
+    return jitter;
+}
+
+uint32_t tRefreshTiming::GetMaxJitterComm(const tFlatFeedback &feedback)
+{
+    uint32_t jitter = 0;
+    for (int i = 0; i < feedback.actuators.nCount; i++)
+    {
+        if (feedback.actuators.jitterComm[i] > jitter)
+        {
+            jitter = feedback.actuators.jitterComm[i];
+        }
+    }
+    if (feedback.interconnect.bPresent && feedback.interconnect.jitterComm > jitter)
+    {
+        jitter = feedback.interconnect.jitterComm;
+    }
+    return jitter;
+}
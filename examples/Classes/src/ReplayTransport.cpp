@@ -0,0 +1,182 @@
+#include "Classes/include/ReplayTransport.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace k_api = Kinova::Api;
+
+using std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+
+ReplayTransport::ReplayTransport(const std::string &path, eTiming timing, bool bFollowSends) :
+    m_eTiming(timing), m_bFollowSends(bFollowSends)
+{
+    readyState = k_api::UNINITIALIZED;
+    m_nPort = 0;
+    m_bStop = true;
+    m_nPlayed = 0;
+    m_nSent = 0;
+    m_nMismatches = 0;
+
+    m_Reader.Open(path);
+    FrameCapture::tRecord record;
+    bool bFirst = true;
+    uint64_t first_ns = 0;
+    while (m_Reader.Next(record))
+    {
+        if (bFirst)
+        {
+            first_ns = record.timestamp_ns;
+            bFirst = false;
+        }
+        uint64_t offset_ns = record.timestamp_ns - first_ns;
+        if (record.direction == FrameCapture::TX)
+        {
+            m_Tx.push_back({record.pData, record.size, offset_ns});
+        }
+        else if (record.direction == FrameCapture::RX)
+        {
+            uint64_t delay_ns = m_Tx.empty() ? offset_ns : offset_ns - m_Tx.back().offset_ns;
+            m_Rx.push_back({record.pData, record.size, offset_ns, m_Tx.size(), delay_ns});
+        }
+    }
+    m_SendTimes.resize(m_Tx.size());
+}
+
+ReplayTransport::~ReplayTransport()
+{
+    disconnect();
+}
+
+bool ReplayTransport::connect(std::string host, uint32_t port)
+{
+    if (m_Worker.joinable())
+    {
+        return true;
+    }
+    m_Host = host;
+    m_nPort = port;
+    m_nPlayed = 0;
+    m_nSent = 0;
+    m_nMismatches = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStop = false;
+        m_Start = steady_clock::now();
+    }
+    m_Worker = std::thread(&ReplayTransport::Run, this);
+    readyState = k_api::OPEN;
+    return true;
+}
+
+void ReplayTransport::disconnect()
+{
+    if (!m_Worker.joinable())
+    {
+        return;
+    }
+    readyState = k_api::CLOSING;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStop = true;
+    }
+    m_Condition.notify_all();
+    m_Worker.join();
+    readyState = k_api::CLOSED;
+}
+
+void ReplayTransport::send(const char *txBuffer, uint32_t txSize)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        size_t index = m_nSent;
+        if (index < m_Tx.size())
+        {
+            const tTx &captured = m_Tx[index];
+            if (captured.size != txSize || memcmp(captured.pData, txBuffer, txSize) != 0)
+            {
+                m_nMismatches++;
+            }
+            m_SendTimes[index] = steady_clock::now();
+        }
+        else
+        {
+            m_nMismatches++;
+        }
+        m_nSent++;
+    }
+    m_Condition.notify_all();
+}
+
+void ReplayTransport::onMessage(std::function<void (const char*, uint32_t)> callback)
+{
+    std::lock_guard<std::mutex> lock(m_CallbackMutex);
+    m_Callback = callback;
+}
+
+char* ReplayTransport::getTxBuffer(uint32_t const &allocation_size)
+{
+    if (m_TxBuffer.size() < allocation_size)
+    {
+        m_TxBuffer.resize(allocation_size);
+    }
+    return m_TxBuffer.data();
+}
+
+size_t ReplayTransport::getMaxTxBufferSize()
+{
+    return m_Reader.GetMaxTxBufferSize();
+}
+
+void ReplayTransport::getHostAddress(std::string &host, uint32_t &port)
+{
+    host = m_Host;
+    port = m_nPort;
+}
+
+bool ReplayTransport::WaitForEnd(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    return m_Condition.wait_for(lock, timeout, [this]() {return m_nPlayed == m_Rx.size();});
+}
+
+void ReplayTransport::Run()
+{
+    for (const tRx &rx : m_Rx)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            bool bGated = m_bFollowSends && rx.nTxBefore > 0;
+            if (bGated)
+            {
+                m_Condition.wait(lock, [this, &rx]() {return m_bStop || m_nSent >= rx.nTxBefore;});
+            }
+            if (m_eTiming == ORIGINAL_TIMING)
+            {
+                auto due = m_Start + nanoseconds(rx.offset_ns);
+                if (bGated)
+                {
+                    due = std::max(due, m_SendTimes[rx.nTxBefore - 1] + nanoseconds(rx.delay_ns));
+                }
+                m_Condition.wait_until(lock, due, [this]() {return m_bStop;});
+            }
+            if (m_bStop)
+            {
+                return;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> callbackLock(m_CallbackMutex);
+            if (m_Callback)
+            {
+                m_Callback(rx.pData, rx.size);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_nPlayed++;
+        }
+        m_Condition.notify_all();
+    }
+}
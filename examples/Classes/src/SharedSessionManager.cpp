@@ -0,0 +1,114 @@
+#include "Classes/include/SharedSessionManager.h"
+#include "Classes/include/KeepAliveService.h"
+
+#include <iostream>
+
+#include <KBasicException.h>
+
+namespace k_api = Kinova::Api;
+
+//the robot closes the connection after connection_inactivity_timeout, the service checks three times within it
+constexpr int WINDOWS_PER_INACTIVITY_TIMEOUT = 3;
+
+SharedSessionManager::SharedSessionManager(k_api::IRouterClient* router, std::function<void()> connectionTimeoutCallback)
+    : k_api::Session::SessionClient(router)
+{
+    m_connectionTimeoutCallback = connectionTimeoutCallback;
+    m_bHasBeenSent = false;
+    m_bHasBeenReceived = false;
+    m_bIsRegistered = false;
+    m_nSilentWindows = 0;
+
+    //the router reports every frame going out or coming in, it is the only traffic information needed
+    m_clientRouter->registerHitCallback([this](k_api::FrameTypes hitType){ Hit(hitType); });
+}
+
+SharedSessionManager::~SharedSessionManager()
+{
+    if (m_bIsRegistered)
+    {
+        KeepAliveService::Instance().Unregister(this);
+        m_bIsRegistered = false;
+    }
+    //the router may outlive this object
+    m_clientRouter->registerHitCallback([](k_api::FrameTypes){});
+}
+
+void SharedSessionManager::CreateSession(const k_api::Session::CreateSessionInfo &info)
+{
+    m_sessionInfo = info;
+    k_api::Session::SessionClient::CreateSession(info);
+
+    m_nSilentWindows = 0;
+    m_bHasBeenReceived = true;
+    if (!m_bIsRegistered)
+    {
+        KeepAliveService::Instance().Register(this, info.connection_inactivity_timeout() / WINDOWS_PER_INACTIVITY_TIMEOUT);
+        m_bIsRegistered = true;
+    }
+}
+
+void SharedSessionManager::CloseSession()
+{
+    //stop the keepalives before the robot forgets about the session
+    if (m_bIsRegistered)
+    {
+        KeepAliveService::Instance().Unregister(this);
+        m_bIsRegistered = false;
+    }
+    k_api::Session::SessionClient::CloseSession();
+}
+
+void SharedSessionManager::Hit(k_api::FrameTypes hitType)
+{
+    switch (hitType)
+    {
+        case k_api::MSG_FRAME_REQUEST:
+        {
+            m_bHasBeenSent = true;
+            break;
+        }
+
+        case k_api::MSG_FRAME_RESPONSE:
+        case k_api::MSG_FRAME_NOTIFICATION:
+        {
+            m_bHasBeenReceived = true;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+bool SharedSessionManager::CheckWindow(bool &bKeepAliveSent)
+{
+    bKeepAliveSent = false;
+
+    //any request sent during the window (cyclic refresh, rpc...) already proved to the robot that we are alive
+    if (!m_bHasBeenSent.exchange(false))
+    {
+        try
+        {
+            //never block the shared thread on a single slow robot
+            KeepAlive_callback([](const k_api::Error &err){});
+            bKeepAliveSent = true;
+        }
+        catch (k_api::KBasicException &ex)
+        {
+            std::cout << "Keepalive not sent: " << ex.what() << std::endl;
+        }
+        //our own heartbeat must not be taken as traffic in the next window
+        m_bHasBeenSent = false;
+    }
+
+    if (m_bHasBeenReceived.exchange(false))
+    {
+        m_nSilentWindows = 0;
+        return false;
+    }
+
+    //report the lost connection only once
+    m_nSilentWindows++;
+    return m_nSilentWindows == WINDOWS_PER_INACTIVITY_TIMEOUT;
+}
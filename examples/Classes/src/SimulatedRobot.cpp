@@ -0,0 +1,961 @@
+#include "Classes/include/SimulatedRobot.h"
+
+#include <algorithm>
+
+#include <HeaderInfo.h>
+
+namespace k_api = Kinova::Api;
+
+using namespace std::placeholders;
+
+namespace
+{
+    const uint32_t NOTIFICATION_SERVICE_VERSION = 1;
+
+    //joint angles of the actions stored in the simulated base, in degrees for a 7 DoF arm
+    struct tStoredAction
+    {
+        uint32_t identifier;
+        const char *name;
+        float jointAngles[7];
+    };
+
+    const tStoredAction STORED_ACTIONS[] =
+    {
+        {1, "Home", {0.0f, 15.0f, 180.0f, 230.0f, 0.0f, 55.0f, 90.0f}},
+        {2, "Retract", {0.0f, 340.0f, 180.0f, 214.0f, 0.0f, 310.0f, 90.0f}},
+        {3, "Zero", {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}},
+    };
+
+    const int BIG_ACTUATOR_COUNT = 4;
+    const uint32_t INTERCONNECT_DEVICE_ID = 8;
+
+    uint32_t ServiceOf(uint32_t functionUid)
+    {
+        return functionUid >> 16;
+    }
+}
+
+constexpr k_api::SubErrorCodes SimulatedRobot::NO_REPLY;
+
+SimulatedRobot::SimulatedRobot(const tSimulatedRobotSettings &settings): m_Settings(settings)
+{
+    m_nRequests = 0;
+    m_nLastSessionId = 0;
+    m_nLastSubscriptionHandle = 0;
+    m_eServoingMode = k_api::Base::SINGLE_LEVEL_SERVOING;
+    m_nActuatorsCommanded = 0;
+    m_bStopDeferred = false;
+
+    for (const auto &stored : STORED_ACTIONS)
+    {
+        k_api::Base::Action action;
+        action.set_name(stored.name);
+        action.mutable_handle()->set_identifier(stored.identifier);
+        action.mutable_handle()->set_action_type(k_api::Base::REACH_JOINT_ANGLES);
+        auto pAngles = action.mutable_reach_joint_angles()->mutable_joint_angles();
+        for (int i = 0; i < m_Settings.nActuatorCount; i++)
+        {
+            auto pAngle = pAngles->add_joint_angles();
+            pAngle->set_joint_identifier(i);
+            pAngle->set_value(i < 7 ? stored.jointAngles[i] : 0.0f);
+        }
+        m_Actions.push_back(action);
+    }
+
+    //powered up at home, in single level servoing
+    m_pState.reset(new tFlatFeedback);
+    tFlatFeedback &state = *m_pState;
+    state.Reset();
+    state.actuators.nCount = std::min(m_Settings.nActuatorCount, int(CyclicWire::MAX_ACTUATORS));
+    for (int i = 0; i < state.actuators.nCount; i++)
+    {
+        state.actuators.position[i] = i < 7 ? STORED_ACTIONS[0].jointAngles[i] : 0.0f;
+        state.actuators.voltage[i] = 24.0f;
+        state.actuators.temperatureMotor[i] = 30.0f;
+        state.actuators.temperatureCore[i] = 35.0f;
+    }
+    state.base.bPresent = true;
+    state.base.activeState = k_api::Common::ARMSTATE_SERVOING_READY;
+    state.base.armVoltage = 24.0f;
+    state.base.temperatureCpu = 45.0f;
+    state.base.temperatureAmbient = 25.0f;
+    state.base.imuAcceleration[2] = 9.81f;
+    state.interconnect.bPresent = true;
+    state.interconnect.bHasFeedbackId = true;
+    state.interconnect.voltage = 24.0f;
+    state.interconnect.temperatureCore = 35.0f;
+    if (m_Settings.bGripper)
+    {
+        state.interconnect.gripper.bPresent = true;
+        state.interconnect.gripper.bHasFeedbackId = true;
+        state.interconnect.gripper.nMotorCount = 1;
+        state.interconnect.gripper.motorId[0] = 1;
+        state.interconnect.gripper.voltage[0] = 24.0f;
+        state.interconnect.gripper.temperatureMotor[0] = 30.0f;
+    }
+    m_pPlant.reset(new PlantModel(state.actuators.nCount, m_Settings.bGripper, m_Settings.plant));
+    m_pPlant->SetFromFeedback(state);
+    m_pPlant->ToFeedback(state);
+
+    AddBuiltInHandlers();
+    AddTestHandlers();
+}
+
+SimulatedRobot::~SimulatedRobot()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_DeferredMutex);
+        m_bStopDeferred = true;
+    }
+    m_DeferredCondition.notify_all();
+    if (m_DeferredWorker.joinable())
+    {
+        m_DeferredWorker.join();
+    }
+}
+
+void SimulatedRobot::AddBuiltInHandlers()
+{
+    auto empty = [](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        response.clear();
+        return k_api::SUB_ERROR_NONE;
+    };
+
+    SetHandler(k_api::Session::eUidCreateSession, std::bind(&SimulatedRobot::CreateSession, this, _1, _2, _3));
+    SetHandler(k_api::Session::eUidCloseSession, std::bind(&SimulatedRobot::CloseSession, this, _1, _2, _3));
+    SetHandler(k_api::Session::eUidKeepAlive, empty);
+
+    AddTopic(k_api::Base::eUidActionTopic);
+    AddTopic(k_api::Base::eUidArmStateTopic);
+    SetHandler(k_api::Base::eUidUnsubscribe, std::bind(&SimulatedRobot::Unsubscribe, this, _1, _2, _3));
+    SetHandler(k_api::Base::eUidSetServoingMode, std::bind(&SimulatedRobot::SetServoingMode, this, _1, _2, _3));
+    SetHandler(k_api::Base::eUidGetServoingMode, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        k_api::Base::ServoingModeInformation information;
+        {
+            std::lock_guard<std::mutex> lock(m_StateMutex);
+            information.set_servoing_mode(m_eServoingMode);
+        }
+        information.SerializeToString(&response);
+        return k_api::SUB_ERROR_NONE;
+    });
+    SetHandler(k_api::Base::eUidGetArmState, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        k_api::Base::ArmStateInformation information;
+        {
+            std::lock_guard<std::mutex> lock(m_StateMutex);
+            information.set_active_state(k_api::Common::ArmState(m_pState->base.activeState));
+        }
+        information.SerializeToString(&response);
+        return k_api::SUB_ERROR_NONE;
+    });
+    SetHandler(k_api::Base::eUidGetMeasuredJointAngles, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        k_api::Base::JointAngles angles;
+        {
+            std::lock_guard<std::mutex> lock(m_StateMutex);
+            for (int i = 0; i < m_pState->actuators.nCount; i++)
+            {
+                auto pAngle = angles.add_joint_angles();
+                pAngle->set_joint_identifier(i);
+                pAngle->set_value(m_pState->actuators.position[i]);
+            }
+        }
+        angles.SerializeToString(&response);
+        return k_api::SUB_ERROR_NONE;
+    });
+    SetHandler(k_api::Base::eUidReadAllActions, std::bind(&SimulatedRobot::ReadAllActions, this, _1, _2, _3));
+    SetHandler(k_api::Base::eUidReadAction, std::bind(&SimulatedRobot::ReadAction, this, _1, _2, _3));
+    SetHandler(k_api::Base::eUidExecuteAction, [this](const k_api::Frame &request, LoopbackTransport*, std::string &response)
+    {
+        k_api::Base::Action action;
+        if (!action.ParseFromString(request.payload()))
+        {
+            return k_api::PAYLOAD_DECODING_ERR;
+        }
+        response.clear();
+        return ExecuteAction(action);
+    });
+    SetHandler(k_api::Base::eUidExecuteActionFromReference, [this](const k_api::Frame &request, LoopbackTransport*, std::string &response)
+    {
+        k_api::Base::ActionHandle handle;
+        if (!handle.ParseFromString(request.payload()))
+        {
+            return k_api::PAYLOAD_DECODING_ERR;
+        }
+        k_api::Base::Action action;
+        {
+            std::lock_guard<std::mutex> lock(m_StateMutex);
+            auto found = std::find_if(m_Actions.begin(), m_Actions.end(), [&handle](const k_api::Base::Action &stored)
+            {
+                return stored.handle().identifier() == handle.identifier();
+            });
+            if (found == m_Actions.end())
+            {
+                return k_api::ENTITY_NOT_FOUND;
+            }
+            action = *found;
+        }
+        response.clear();
+        return ExecuteAction(action);
+    });
+    SetHandler(k_api::Base::eUidStop, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        std::lock_guard<std::mutex> lock(m_StateMutex);
+        m_pPlant->Hold();
+        response.clear();
+        return k_api::SUB_ERROR_NONE;
+    });
+    SetHandler(k_api::Base::eUidApplyEmergencyStop, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        std::lock_guard<std::mutex> lock(m_StateMutex);
+        SetArmState(k_api::Common::ARMSTATE_IN_FAULT);
+        m_pPlant->Hold();
+        response.clear();
+        return k_api::SUB_ERROR_NONE;
+    });
+    SetHandler(k_api::Base::eUidClearFaults, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        std::lock_guard<std::mutex> lock(m_StateMutex);
+        SetArmState(m_eServoingMode == k_api::Base::LOW_LEVEL_SERVOING ? k_api::Common::ARMSTATE_SERVOING_LOW_LEVEL
+                                                                       : k_api::Common::ARMSTATE_SERVOING_READY);
+        response.clear();
+        return k_api::SUB_ERROR_NONE;
+    });
+
+    SetHandler(k_api::BaseCyclic::eUidRefresh, std::bind(&SimulatedRobot::BaseCyclicRefresh, this, _1, true, true, _3));
+    SetHandler(k_api::BaseCyclic::eUidRefreshCommand, std::bind(&SimulatedRobot::BaseCyclicRefresh, this, _1, true, false, _3));
+    SetHandler(k_api::BaseCyclic::eUidRefreshFeedback, std::bind(&SimulatedRobot::BaseCyclicRefresh, this, _1, false, true, _3));
+
+    SetHandler(k_api::ActuatorCyclic::eUidRefresh, std::bind(&SimulatedRobot::ActuatorCyclicRefresh, this, _1, true, true, _3));
+    SetHandler(k_api::ActuatorCyclic::eUidRefreshCommand, std::bind(&SimulatedRobot::ActuatorCyclicRefresh, this, _1, true, false, _3));
+    SetHandler(k_api::ActuatorCyclic::eUidRefreshFeedback, std::bind(&SimulatedRobot::ActuatorCyclicRefresh, this, _1, false, true, _3));
+
+    SetHandler(k_api::ActuatorConfig::eUidSetControlMode, [this](const k_api::Frame &request, LoopbackTransport*, std::string &response)
+    {
+        return SetControlMode(request, response);
+    });
+    SetHandler(k_api::ActuatorConfig::eUidGetControlMode, [this](const k_api::Frame &request, LoopbackTransport*, std::string &response)
+    {
+        return GetControlMode(request, response);
+    });
+
+    SetHandler(k_api::DeviceManager::eUidReadAllDevices, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        return ReadAllDevices(response);
+    });
+}
+
+void SimulatedRobot::AddTestHandlers()
+{
+    auto empty = [](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        response.clear();
+        return k_api::SUB_ERROR_NONE;
+    };
+    auto noReply = [](const k_api::Frame&, LoopbackTransport*, std::string&)
+    {
+        return NO_REPLY;
+    };
+
+    SetHandler(k_api::Test::eUidTestParamAndReturn, [this](const k_api::Frame &request, LoopbackTransport*, std::string &response)
+    {
+        return TestParamAndReturn(request, response);
+    });
+    SetHandler(k_api::Test::eUidTestParamOnly, empty);
+    SetHandler(k_api::Test::eUidTestReturnOnly, [](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        k_api::Test::RcvStruct result;
+        result.SerializeToString(&response);
+        return k_api::SUB_ERROR_NONE;
+    });
+    SetHandler(k_api::Test::eUidTestConcurrence, empty);
+    SetHandler(k_api::Test::eUidTestTimeout, noReply);
+    SetHandler(k_api::Test::eUidForget, noReply);
+    SetHandler(k_api::Test::eUidTestAsync, [this](const k_api::Frame &request, LoopbackTransport *pTransport, std::string&)
+    {
+        k_api::Test::timeToResponse time;
+        if (!time.ParseFromString(request.payload()))
+        {
+            return k_api::PAYLOAD_DECODING_ERR;
+        }
+        ReplyLater(request, pTransport, std::chrono::milliseconds(time.time_ms()), k_api::SUB_ERROR_NONE, "");
+        return NO_REPLY;
+    });
+    SetHandler(k_api::Test::eUidWait, [this](const k_api::Frame &request, LoopbackTransport *pTransport, std::string&)
+    {
+        k_api::Test::Delay delay;
+        if (!delay.ParseFromString(request.payload()))
+        {
+            return k_api::PAYLOAD_DECODING_ERR;
+        }
+        ReplyLater(request, pTransport, std::chrono::milliseconds(delay.ms()), k_api::SUB_ERROR_NONE, "");
+        return NO_REPLY;
+    });
+
+    AddTopic(k_api::Test::eUidTestNotif);
+    SetHandler(k_api::Test::eUidTestNotifUnsubscribe, std::bind(&SimulatedRobot::Unsubscribe, this, _1, _2, _3));
+    SetHandler(k_api::Test::eUidTestTriggerNotif, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+    {
+        k_api::Test::TestNotification notification;
+        notification.set_dummy_property(1);
+        Notify(k_api::Test::eUidTestNotif, notification);
+        response.clear();
+        return k_api::SUB_ERROR_NONE;
+    });
+}
+
+void SimulatedRobot::SetHandler(uint32_t functionUid, const RpcHandler &handler)
+{
+    std::lock_guard<std::mutex> lock(m_HandlerMutex);
+    m_Handlers[functionUid] = handler;
+}
+
+void SimulatedRobot::RemoveHandler(uint32_t functionUid)
+{
+    std::lock_guard<std::mutex> lock(m_HandlerMutex);
+    m_Handlers.erase(functionUid);
+}
+
+std::vector<uint32_t> SimulatedRobot::GetFunctionUids() const
+{
+    std::lock_guard<std::mutex> lock(m_HandlerMutex);
+    std::vector<uint32_t> functionUids;
+    for (auto &handler : m_Handlers)
+    {
+        functionUids.push_back(handler.first);
+    }
+    return functionUids;
+}
+
+void SimulatedRobot::AddTopic(uint32_t topicUid)
+{
+    SetHandler(topicUid, std::bind(&SimulatedRobot::Subscribe, this, _1, _2, _3));
+}
+
+int SimulatedRobot::Notify(uint32_t topicUid, const google::protobuf::Message &notification)
+{
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    return NotifyLocked(topicUid, notification);
+}
+
+tFlatFeedback SimulatedRobot::GetState() const
+{
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    return *m_pState;
+}
+
+void SimulatedRobot::SetState(const tFlatFeedback &state)
+{
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    *m_pState = state;
+    m_pPlant->SetFromFeedback(state);
+}
+
+uint64_t SimulatedRobot::GetRequestCount() const
+{
+    std::lock_guard<std::mutex> lock(m_HandlerMutex);
+    return m_nRequests;
+}
+
+void SimulatedRobot::OnFrame(const k_api::Frame &frame, LoopbackTransport *pTransport)
+{
+    //reused by the worker thread of each transport, so a cyclic flow does not allocate
+    thread_local std::string response;
+
+    k_api::HeaderInfo header(frame.header());
+    if (header.m_frameInfo.frameType == k_api::MSG_FRAME_PING)
+    {
+        k_api::Frame pong;
+        header.m_frameInfo.frameType = k_api::MSG_FRAME_PONG;
+        header.fillHeader(pong.mutable_header());
+        pTransport->Deliver(pong);
+        return;
+    }
+    if (header.m_frameInfo.frameType != k_api::MSG_FRAME_REQUEST)
+    {
+        return;
+    }
+
+    uint32_t functionUid = header.m_serviceInfo.functionUid;
+    RpcHandler handler;
+    bool bKnownService = false;
+    {
+        std::lock_guard<std::mutex> lock(m_HandlerMutex);
+        m_nRequests++;
+        auto found = m_Handlers.find(functionUid);
+        if (found != m_Handlers.end())
+        {
+            handler = found->second;
+        }
+        else
+        {
+            auto next = m_Handlers.lower_bound(ServiceOf(functionUid) << 16);
+            bKnownService = next != m_Handlers.end() && ServiceOf(next->first) == ServiceOf(functionUid);
+        }
+    }
+
+    if (!handler)
+    {
+        Reply(frame, pTransport, k_api::ERROR_DEVICE, bKnownService ? k_api::UNSUPPORTED_METHOD : k_api::UNSUPPORTED_SERVICE, "");
+        return;
+    }
+
+    response.clear();
+    k_api::SubErrorCodes subError = handler(frame, pTransport, response);
+    if (subError == NO_REPLY)
+    {
+        return;
+    }
+    Reply(frame, pTransport, subError == k_api::SUB_ERROR_NONE ? k_api::ERROR_NONE : k_api::ERROR_DEVICE, subError, response);
+}
+
+void SimulatedRobot::OnDisconnect(LoopbackTransport *pTransport)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_DeferredMutex);
+        for (auto deferred = m_DeferredReplies.begin(); deferred != m_DeferredReplies.end();)
+        {
+            if (deferred->second.pTransport == pTransport)
+            {
+                deferred = m_DeferredReplies.erase(deferred);
+            }
+            else
+            {
+                ++deferred;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    m_Sessions.erase(pTransport);
+    m_Subscriptions.erase(std::remove_if(m_Subscriptions.begin(), m_Subscriptions.end(), [pTransport](const tSubscription &subscription)
+    {
+        return subscription.pTransport == pTransport;
+    }), m_Subscriptions.end());
+}
+
+void SimulatedRobot::ReplyLater(const k_api::Frame &request, LoopbackTransport *pTransport, std::chrono::milliseconds delay,
+                                k_api::SubErrorCodes subError, const std::string &payload)
+{
+    tDeferredReply deferred;
+    *deferred.request.mutable_header() = request.header();
+    deferred.pTransport = pTransport;
+    deferred.subError = subError;
+    deferred.payload = payload;
+    {
+        std::lock_guard<std::mutex> lock(m_DeferredMutex);
+        m_DeferredReplies.emplace(std::chrono::steady_clock::now() + delay, std::move(deferred));
+        if (!m_DeferredWorker.joinable())
+        {
+            m_DeferredWorker = std::thread(&SimulatedRobot::RunDeferredReplies, this);
+        }
+    }
+    m_DeferredCondition.notify_all();
+}
+
+void SimulatedRobot::RunDeferredReplies()
+{
+    std::unique_lock<std::mutex> lock(m_DeferredMutex);
+    while (!m_bStopDeferred)
+    {
+        if (m_DeferredReplies.empty())
+        {
+            m_DeferredCondition.wait(lock);
+            continue;
+        }
+        auto next = m_DeferredReplies.begin();
+        auto due = next->first;     //the reply may be dropped while waiting
+        if (due > std::chrono::steady_clock::now())
+        {
+            m_DeferredCondition.wait_until(lock, due);
+            continue;
+        }
+        const tDeferredReply &deferred = next->second;
+        Reply(deferred.request, deferred.pTransport, deferred.subError == k_api::SUB_ERROR_NONE ? k_api::ERROR_NONE : k_api::ERROR_DEVICE,
+              deferred.subError, deferred.payload);
+        m_DeferredReplies.erase(next);
+    }
+}
+
+void SimulatedRobot::Reply(const k_api::Frame &request, LoopbackTransport *pTransport, k_api::ErrorCodes error,
+                           k_api::SubErrorCodes subError, const std::string &payload)
+{
+    thread_local k_api::Frame reply;
+
+    k_api::HeaderInfo header(request.header());
+    header.m_frameInfo.frameType = k_api::MSG_FRAME_RESPONSE;
+    header.m_frameInfo.errorCode = error;
+    header.m_frameInfo.errorSubCode = subError;
+    {
+        std::lock_guard<std::mutex> lock(m_StateMutex);
+        auto session = m_Sessions.find(pTransport);
+        if (session != m_Sessions.end())
+        {
+            header.m_messageInfo.sessionId = session->second;
+        }
+    }
+
+    if (error == k_api::ERROR_NONE)
+    {
+        reply.set_payload(payload);
+    }
+    else
+    {
+        k_api::Error errorPayload;
+        errorPayload.set_error_code(error);
+        errorPayload.set_error_sub_code(subError);
+        errorPayload.set_error_sub_string(k_api::SubErrorCodes_Name(subError));
+        errorPayload.SerializeToString(reply.mutable_payload());
+    }
+    header.m_payloadInfo.payloadLength = uint32_t(reply.payload().size());
+    header.fillHeader(reply.mutable_header());
+    pTransport->Deliver(reply);
+}
+
+k_api::SubErrorCodes SimulatedRobot::CreateSession(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response)
+{
+    k_api::Session::CreateSessionInfo information;
+    if (!information.ParseFromString(request.payload()))
+    {
+        return k_api::PAYLOAD_DECODING_ERR;
+    }
+    if (information.username() != m_Settings.username)
+    {
+        return k_api::USER_NOT_FOUND;
+    }
+    if (information.password() != m_Settings.password)
+    {
+        return k_api::INVALID_PASSWORD;
+    }
+
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    m_Sessions[pTransport] = ++m_nLastSessionId;
+    response.clear();
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::CloseSession(const k_api::Frame&, LoopbackTransport *pTransport, std::string &response)
+{
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    if (m_Sessions.erase(pTransport) == 0)
+    {
+        return k_api::INVALID_SESSION;
+    }
+    response.clear();
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::Subscribe(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response)
+{
+    k_api::HeaderInfo header(request.header());
+
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    tSubscription subscription;
+    subscription.pTransport = pTransport;
+    subscription.topicUid = header.m_serviceInfo.functionUid;
+    subscription.handle = ++m_nLastSubscriptionHandle;
+    m_Subscriptions.push_back(subscription);
+
+    k_api::Common::NotificationHandle handle;
+    handle.set_identifier(subscription.handle);
+    handle.SerializeToString(&response);
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::Unsubscribe(const k_api::Frame &request, LoopbackTransport *pTransport, std::string &response)
+{
+    k_api::Common::NotificationHandle handle;
+    if (!handle.ParseFromString(request.payload()))
+    {
+        return k_api::PAYLOAD_DECODING_ERR;
+    }
+
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    auto found = std::find_if(m_Subscriptions.begin(), m_Subscriptions.end(), [&](const tSubscription &subscription)
+    {
+        return subscription.pTransport == pTransport && subscription.handle == handle.identifier();
+    });
+    if (found == m_Subscriptions.end())
+    {
+        return k_api::ENTITY_NOT_FOUND;
+    }
+    m_Subscriptions.erase(found);
+    response.clear();
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::SetServoingMode(const k_api::Frame &request, LoopbackTransport*, std::string &response)
+{
+    k_api::Base::ServoingModeInformation information;
+    if (!information.ParseFromString(request.payload()))
+    {
+        return k_api::PAYLOAD_DECODING_ERR;
+    }
+
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    if (information.servoing_mode() != m_eServoingMode)
+    {
+        //the first low level command must be where the arm is, as on the arm
+        m_pPlant->Hold();
+    }
+    m_eServoingMode = information.servoing_mode();
+    if (m_pState->base.activeState != k_api::Common::ARMSTATE_IN_FAULT)
+    {
+        SetArmState(m_eServoingMode == k_api::Base::LOW_LEVEL_SERVOING ? k_api::Common::ARMSTATE_SERVOING_LOW_LEVEL
+                                                                       : k_api::Common::ARMSTATE_SERVOING_READY);
+    }
+    response.clear();
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::ReadAllActions(const k_api::Frame &request, LoopbackTransport*, std::string &response)
+{
+    k_api::Base::RequestedActionType requested;
+    if (!requested.ParseFromString(request.payload()))
+    {
+        return k_api::PAYLOAD_DECODING_ERR;
+    }
+
+    k_api::Base::ActionList list;
+    {
+        std::lock_guard<std::mutex> lock(m_StateMutex);
+        for (const auto &action : m_Actions)
+        {
+            if (action.handle().action_type() == requested.action_type())
+            {
+                *list.add_action_list() = action;
+            }
+        }
+    }
+    list.SerializeToString(&response);
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::ReadAction(const k_api::Frame &request, LoopbackTransport*, std::string &response)
+{
+    k_api::Base::ActionHandle handle;
+    if (!handle.ParseFromString(request.payload()))
+    {
+        return k_api::PAYLOAD_DECODING_ERR;
+    }
+
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    for (const auto &action : m_Actions)
+    {
+        if (action.handle().identifier() == handle.identifier())
+        {
+            action.SerializeToString(&response);
+            return k_api::SUB_ERROR_NONE;
+        }
+    }
+    return k_api::ENTITY_NOT_FOUND;
+}
+
+k_api::SubErrorCodes SimulatedRobot::ExecuteAction(const k_api::Base::Action &action)
+{
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    if (m_pState->base.activeState == k_api::Common::ARMSTATE_IN_FAULT)
+    {
+        return k_api::ROBOT_NOT_READY;
+    }
+    if (m_eServoingMode == k_api::Base::LOW_LEVEL_SERVOING)
+    {
+        return k_api::LOW_LEVEL_SERVOING;
+    }
+    if (!action.has_reach_joint_angles())
+    {
+        return k_api::UNSUPPORTED_ACTION;
+    }
+
+    k_api::Base::ActionNotification notification;
+    *notification.mutable_handle() = action.handle();
+    notification.set_action_event(k_api::Base::ACTION_START);
+    NotifyLocked(k_api::Base::eUidActionTopic, notification);
+
+    const auto &angles = action.reach_joint_angles().joint_angles();
+    for (int i = 0; i < angles.joint_angles_size(); i++)
+    {
+        uint32_t joint = angles.joint_angles(i).joint_identifier();
+        if (joint < uint32_t(m_pState->actuators.nCount))
+        {
+            m_pState->actuators.position[joint] = angles.joint_angles(i).value();
+            m_pState->actuators.velocity[joint] = 0.0f;
+        }
+    }
+    m_pPlant->SetFromFeedback(*m_pState);
+
+    notification.set_action_event(k_api::Base::ACTION_END);
+    NotifyLocked(k_api::Base::eUidActionTopic, notification);
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::BaseCyclicRefresh(const k_api::Frame &request, bool bCommand, bool bFeedback, std::string &response)
+{
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    tFlatFeedback &state = *m_pState;
+    if (bCommand)
+    {
+        if (!m_CyclicCommand.ParseFromString(request.payload()))
+        {
+            return k_api::PAYLOAD_DECODING_ERR;
+        }
+        //the frame id comes back whatever the servoing mode, the values are only followed in low level servoing
+        state.frameId = m_CyclicCommand.frame_id();
+        if (m_eServoingMode == k_api::Base::LOW_LEVEL_SERVOING && state.base.activeState != k_api::Common::ARMSTATE_IN_FAULT)
+        {
+            int count = std::min(m_CyclicCommand.actuators_size(), state.actuators.nCount);
+            for (int i = 0; i < count; i++)
+            {
+                const auto &actuator = m_CyclicCommand.actuators(i);
+                state.actuators.commandId[i] = actuator.command_id();
+                if (m_Settings.bIdealTracking)
+                {
+                    state.actuators.position[i] = actuator.position();
+                    state.actuators.velocity[i] = actuator.velocity();
+                    state.actuators.torque[i] = actuator.torque_joint();
+                    state.actuators.currentMotor[i] = actuator.current_motor();
+                }
+            }
+            if (m_CyclicCommand.has_interconnect())
+            {
+                const auto &interconnect = m_CyclicCommand.interconnect();
+                state.interconnect.feedbackId = interconnect.command_id().identifier();
+                tFlatGripperFeedback &gripper = state.interconnect.gripper;
+                if (gripper.bPresent && interconnect.has_gripper_command())
+                {
+                    const auto &command = interconnect.gripper_command();
+                    gripper.feedbackId = command.command_id().identifier();
+                    int motors = std::min(command.motor_cmd_size(), gripper.nMotorCount);
+                    for (int i = 0; i < motors && m_Settings.bIdealTracking; i++)
+                    {
+                        gripper.position[i] = command.motor_cmd(i).position();
+                        gripper.velocity[i] = command.motor_cmd(i).velocity();
+                    }
+                }
+            }
+            if (!m_Settings.bIdealTracking)
+            {
+                m_pPlant->SetCommand(m_CyclicCommand);
+            }
+        }
+        StepPlant();
+    }
+
+    if (bFeedback)
+    {
+        state.ToFeedback(m_CyclicFeedback);
+        m_CyclicFeedback.SerializeToString(&response);
+    }
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::ActuatorCyclicRefresh(const k_api::Frame &request, bool bCommand, bool bFeedback, std::string &response)
+{
+    k_api::HeaderInfo header(request.header());
+    int actuator = int(header.m_frameInfo.deviceId) - 1;
+
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    tFlatActuatorFeedback &actuators = m_pState->actuators;
+    if (actuator < 0 || actuator >= actuators.nCount)
+    {
+        return k_api::INVALID_DEVICE;
+    }
+    if (bCommand)
+    {
+        if (!m_ActuatorCommand.ParseFromString(request.payload()))
+        {
+            return k_api::PAYLOAD_DECODING_ERR;
+        }
+        actuators.commandId[actuator] = m_ActuatorCommand.command_id().identifier();
+        if (m_nActuatorsCommanded & (1u << actuator))
+        {
+            StepPlant();
+        }
+        m_nActuatorsCommanded |= 1u << actuator;
+        if (m_eServoingMode == k_api::Base::LOW_LEVEL_SERVOING && m_pState->base.activeState != k_api::Common::ARMSTATE_IN_FAULT)
+        {
+            if (m_Settings.bIdealTracking)
+            {
+                actuators.position[actuator] = m_ActuatorCommand.position();
+                actuators.velocity[actuator] = m_ActuatorCommand.velocity();
+                actuators.torque[actuator] = m_ActuatorCommand.torque_joint();
+                actuators.currentMotor[actuator] = m_ActuatorCommand.current_motor();
+            }
+            else
+            {
+                m_pPlant->SetActuatorCommand(actuator, m_ActuatorCommand);
+            }
+        }
+    }
+
+    if (bFeedback)
+    {
+        m_ActuatorFeedback.mutable_feedback_id()->set_identifier(actuators.commandId[actuator]);
+        m_ActuatorFeedback.set_status_flags(actuators.statusFlags[actuator]);
+        m_ActuatorFeedback.set_jitter_comm(actuators.jitterComm[actuator]);
+        m_ActuatorFeedback.set_position(actuators.position[actuator]);
+        m_ActuatorFeedback.set_velocity(actuators.velocity[actuator]);
+        m_ActuatorFeedback.set_torque(actuators.torque[actuator]);
+        m_ActuatorFeedback.set_current_motor(actuators.currentMotor[actuator]);
+        m_ActuatorFeedback.set_voltage(actuators.voltage[actuator]);
+        m_ActuatorFeedback.set_temperature_motor(actuators.temperatureMotor[actuator]);
+        m_ActuatorFeedback.set_temperature_core(actuators.temperatureCore[actuator]);
+        m_ActuatorFeedback.set_fault_bank_a(actuators.faultBankA[actuator]);
+        m_ActuatorFeedback.set_fault_bank_b(actuators.faultBankB[actuator]);
+        m_ActuatorFeedback.set_warning_bank_a(actuators.warningBankA[actuator]);
+        m_ActuatorFeedback.set_warning_bank_b(actuators.warningBankB[actuator]);
+        m_ActuatorFeedback.SerializeToString(&response);
+    }
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::ReadAllDevices(std::string &response)
+{
+    //the devices behind the base, with the device ids their RPCs are sent to
+    k_api::DeviceManager::DeviceHandles devices;
+    uint32_t order = 0;
+    for (int i = 0; i < m_Settings.nActuatorCount; i++)
+    {
+        auto pDevice = devices.add_device_handle();
+        pDevice->set_device_type(i < BIG_ACTUATOR_COUNT ? k_api::Common::BIG_ACTUATOR : k_api::Common::SMALL_ACTUATOR);
+        pDevice->set_device_identifier(i + 1);
+        pDevice->set_order(order++);
+    }
+    auto pInterconnect = devices.add_device_handle();
+    pInterconnect->set_device_type(k_api::Common::INTERCONNECT);
+    pInterconnect->set_device_identifier(INTERCONNECT_DEVICE_ID);
+    pInterconnect->set_order(order++);
+
+    devices.SerializeToString(&response);
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::SetControlMode(const k_api::Frame &request, std::string &response)
+{
+    k_api::ActuatorConfig::ControlModeInformation information;
+    if (!information.ParseFromString(request.payload()))
+    {
+        return k_api::PAYLOAD_DECODING_ERR;
+    }
+    PlantModel::eControlMode mode;
+    switch (information.control_mode())
+    {
+    case k_api::ActuatorConfig::POSITION:
+        mode = PlantModel::POSITION;
+        break;
+    case k_api::ActuatorConfig::VELOCITY:
+        mode = PlantModel::VELOCITY;
+        break;
+    case k_api::ActuatorConfig::TORQUE:
+        mode = PlantModel::TORQUE;
+        break;
+    default:
+        return k_api::INVALID_PARAM;
+    }
+
+    k_api::HeaderInfo header(request.header());
+    int actuator = int(header.m_frameInfo.deviceId) - 1;
+    std::lock_guard<std::mutex> lock(m_StateMutex);
+    if (actuator < 0 || actuator >= m_pState->actuators.nCount)
+    {
+        return k_api::INVALID_DEVICE;
+    }
+    m_pPlant->SetControlMode(actuator, mode);
+    response.clear();
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::GetControlMode(const k_api::Frame &request, std::string &response)
+{
+    k_api::HeaderInfo header(request.header());
+    int actuator = int(header.m_frameInfo.deviceId) - 1;
+    k_api::ActuatorConfig::ControlModeInformation information;
+    {
+        std::lock_guard<std::mutex> lock(m_StateMutex);
+        if (actuator < 0 || actuator >= m_pState->actuators.nCount)
+        {
+            return k_api::INVALID_DEVICE;
+        }
+        const k_api::ActuatorConfig::ControlMode modes[] = {k_api::ActuatorConfig::POSITION, k_api::ActuatorConfig::VELOCITY,
+                                                            k_api::ActuatorConfig::TORQUE};
+        information.set_control_mode(modes[m_pPlant->GetControlMode(actuator)]);
+    }
+    information.SerializeToString(&response);
+    return k_api::SUB_ERROR_NONE;
+}
+
+k_api::SubErrorCodes SimulatedRobot::TestParamAndReturn(const k_api::Frame &request, std::string &response)
+{
+    k_api::Test::SendStruct sent;
+    if (!sent.ParseFromString(request.payload()))
+    {
+        return k_api::PAYLOAD_DECODING_ERR;
+    }
+    //RcvStruct has the fields of SendStruct, with the same numbers: the echo is the request
+    response = request.payload();
+    return k_api::SUB_ERROR_NONE;
+}
+
+void SimulatedRobot::StepPlant()
+{
+    m_nActuatorsCommanded = 0;
+    if (!m_Settings.bIdealTracking)
+    {
+        m_pPlant->Step();
+        m_pPlant->ToFeedback(*m_pState);
+    }
+}
+
+void SimulatedRobot::SetArmState(k_api::Common::ArmState state)
+{
+    if (m_pState->base.activeState == state)
+    {
+        return;
+    }
+    m_pState->base.activeState = state;
+
+    k_api::Base::ArmStateNotification notification;
+    notification.set_active_state(state);
+    NotifyLocked(k_api::Base::eUidArmStateTopic, notification);
+}
+
+int SimulatedRobot::NotifyLocked(uint32_t topicUid, const google::protobuf::Message &notification)
+{
+    int count = 0;
+    bool bSerialized = false;
+    for (const auto &subscription : m_Subscriptions)
+    {
+        if (subscription.topicUid != topicUid)
+        {
+            continue;
+        }
+        if (!bSerialized)
+        {
+            notification.SerializeToString(m_Notification.mutable_payload());
+            bSerialized = true;
+        }
+
+        k_api::HeaderInfo header;
+        header.m_frameInfo.frame_info = 0;
+        header.m_frameInfo.frameType = k_api::MSG_FRAME_NOTIFICATION;
+        header.m_frameInfo.headerVersion = k_api::CURRENT_VERSION;
+        header.m_messageInfo.message_info = 0;
+        auto session = m_Sessions.find(subscription.pTransport);
+        if (session != m_Sessions.end())
+        {
+            header.m_messageInfo.sessionId = session->second;
+        }
+        header.m_serviceInfo.service_info = 0;
+        header.m_serviceInfo.functionUid = topicUid;
+        header.m_serviceInfo.serviceVersion = NOTIFICATION_SERVICE_VERSION;
+        header.m_payloadInfo.payload_info = 0;
+        header.m_payloadInfo.payloadLength = uint32_t(m_Notification.payload().size());
+        header.fillHeader(m_Notification.mutable_header());
+        subscription.pTransport->Deliver(m_Notification);
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,427 @@
+#include "Classes/include/StandInServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#if defined(_OS_UNIX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <KBasicException.h>
+#include <SessionClientRpc.h>
+
+#include "Classes/include/FrameHeader.h"
+
+namespace k_api = Kinova::Api;
+
+//framing of the TCP stream, as in KinovaTcpUtilities: the magic string then the length of the Frame
+static const char KINOVA_MAGIC_STRING[] = "\07xEtRoK\07";
+static const size_t KINOVA_MAGIC_SIZE = sizeof(KINOVA_MAGIC_STRING) - 1;
+static const size_t KINOVA_HEADER_SIZE = KINOVA_MAGIC_SIZE + sizeof(uint32_t);
+static const uint32_t MAX_TCP_FRAME_SIZE = 16 * 1024 * 1024;
+
+//a UDP peer is kept that long after its CloseSession request, for the response to go through its downlink
+static const std::chrono::milliseconds CLOSED_PEER_LINGER(1000);
+//the receive timeout of the UDP reader, so it also expires the peers when no datagram comes
+static const std::chrono::milliseconds EXPIRE_PERIOD(100);
+
+StandInServer::StandInServer(ILoopbackServer *pServer, const tStandInSettings &settings) :
+    m_pServer(pServer), m_Settings(settings)
+{
+    m_nTcpSocket = -1;
+    m_nUdpSocket = -1;
+    m_bStop = true;
+    m_nPeerCount = 0;
+    m_nTcpConnections = 0;
+    m_nFramesIn = 0;
+    m_nFramesOut = 0;
+    m_nDropped = 0;
+    m_nReordered = 0;
+    m_nRetransmitted = 0;
+}
+
+StandInServer::~StandInServer()
+{
+    Stop();
+}
+
+tStandInStatistics StandInServer::GetStatistics() const
+{
+    tStandInStatistics statistics;
+    statistics.nTcpConnections = m_nTcpConnections;
+    statistics.nFramesIn = m_nFramesIn;
+    statistics.nFramesOut = m_nFramesOut;
+    statistics.nDropped = m_nDropped;
+    statistics.nReordered = m_nReordered;
+    statistics.nRetransmitted = m_nRetransmitted;
+
+    std::lock_guard<std::mutex> lock(m_PeerMutex);
+    statistics.nUdpPeers = m_UdpPeers.size();
+    for (auto *pPeers : {&m_TcpPeers, &m_UdpPeers})
+    {
+        for (auto &pPeer : *pPeers)
+        {
+            for (auto *pLine : {pPeer->pUplink.get(), pPeer->pDownlink.get()})
+            {
+                statistics.nDropped += pLine->GetDroppedCount();
+                statistics.nReordered += pLine->GetReorderedCount();
+                statistics.nRetransmitted += pLine->GetRetransmittedCount();
+            }
+        }
+    }
+    return statistics;
+}
+
+#if defined(_OS_UNIX)
+
+static bool ReceiveAll(int nSocket, char *pBuffer, size_t size)
+{
+    while (size > 0)
+    {
+        auto received = recv(nSocket, pBuffer, size, 0);
+        if (received <= 0)
+        {
+            return false;
+        }
+        pBuffer += received;
+        size -= size_t(received);
+    }
+    return true;
+}
+
+static int OpenSocket(const std::string &address, uint32_t port, int type)
+{
+    sockaddr_in socketAddress;
+    memset(&socketAddress, 0, sizeof(socketAddress));
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(uint16_t(port));
+    if (inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1)
+    {
+        throw k_api::KBasicException("Invalid address " + address);
+    }
+
+    int nSocket = socket(AF_INET, type, 0);
+    if (nSocket < 0)
+    {
+        throw k_api::KBasicException("Unable to create a socket for " + address + ":" + std::to_string(port) + ", " + strerror(errno));
+    }
+    int reuse = 1;
+    setsockopt(nSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(nSocket, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0
+        || (type == SOCK_STREAM && listen(nSocket, 16) != 0))
+    {
+        std::string error = strerror(errno);
+        close(nSocket);
+        throw k_api::KBasicException("Unable to listen on " + address + ":" + std::to_string(port) + ", " + error);
+    }
+    return nSocket;
+}
+
+void StandInServer::Start()
+{
+    if (!m_bStop)
+    {
+        return;
+    }
+    m_nTcpSocket = OpenSocket(m_Settings.address, m_Settings.nTcpPort, SOCK_STREAM);
+    try
+    {
+        m_nUdpSocket = OpenSocket(m_Settings.address, m_Settings.nUdpPort, SOCK_DGRAM);
+    }
+    catch (...)
+    {
+        close(m_nTcpSocket);
+        m_nTcpSocket = -1;
+        throw;
+    }
+
+    m_bStop = false;
+    m_TcpAcceptor = std::thread(&StandInServer::AcceptConnections, this);
+    m_UdpReader = std::thread(&StandInServer::ReadDatagrams, this);
+}
+
+void StandInServer::Stop()
+{
+    if (m_bStop)
+    {
+        return;
+    }
+    m_bStop = true;
+
+    //shutdown() wakes up the threads blocked in accept() and recv()
+    shutdown(m_nTcpSocket, SHUT_RDWR);
+    shutdown(m_nUdpSocket, SHUT_RDWR);
+    m_TcpAcceptor.join();
+    m_UdpReader.join();
+    {
+        std::lock_guard<std::mutex> lock(m_PeerMutex);
+        for (auto &pPeer : m_TcpPeers)
+        {
+            shutdown(pPeer->nSocket, SHUT_RDWR);
+        }
+    }
+    ReapPeers(m_TcpPeers, true);
+    ReapPeers(m_UdpPeers, true);
+
+    close(m_nTcpSocket);
+    close(m_nUdpSocket);
+    m_nTcpSocket = -1;
+    m_nUdpSocket = -1;
+}
+
+StandInServer::tPeer* StandInServer::AddPeer(int nSocket, const std::vector<uint8_t> &address)
+{
+    std::unique_ptr<tPeer> pPeer(new tPeer());
+    tPeer *pRaw = pPeer.get();
+    pPeer->nSocket = nSocket;
+    pPeer->address = address;
+    pPeer->bClosed = false;
+
+    bool bStream = address.empty();
+    uint32_t seed = m_Settings.nSeed + 2 * m_nPeerCount++;
+    pPeer->pTransport.reset(new LoopbackTransport(m_pServer));
+    pPeer->pUplink.reset(new DelayLine(m_Settings.profile, bStream, seed, [pRaw](const std::string &bytes)
+    {
+        pRaw->pTransport->send(bytes.data(), uint32_t(bytes.size()));
+    }));
+    pPeer->pDownlink.reset(new DelayLine(m_Settings.profile, bStream, seed + 1, [this, pRaw](const std::string &bytes)
+    {
+        SendToPeer(pRaw, bytes);
+    }));
+    pPeer->pTransport->onMessage([pRaw](const char *data, uint32_t size)
+    {
+        pRaw->answer.assign(data, size);
+        pRaw->pDownlink->Push(pRaw->answer);
+    });
+    pPeer->pTransport->connect(m_Settings.address, bStream ? m_Settings.nTcpPort : m_Settings.nUdpPort);
+
+    std::lock_guard<std::mutex> lock(m_PeerMutex);
+    (bStream ? m_TcpPeers : m_UdpPeers).push_back(std::move(pPeer));
+    return pRaw;
+}
+
+void StandInServer::SendToPeer(tPeer *pPeer, const std::string &bytes)
+{
+    if (pPeer->address.empty())
+    {
+        uint32_t length = uint32_t(bytes.size());
+        pPeer->txBuffer.assign(KINOVA_MAGIC_STRING, KINOVA_MAGIC_SIZE);
+        pPeer->txBuffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        pPeer->txBuffer.append(bytes);
+
+        const char *pData = pPeer->txBuffer.data();
+        size_t size = pPeer->txBuffer.size();
+        while (size > 0)
+        {
+            auto sent = send(pPeer->nSocket, pData, size, MSG_NOSIGNAL);
+            if (sent <= 0)
+            {
+                //the reader sees the connection closing too
+                return;
+            }
+            pData += sent;
+            size -= size_t(sent);
+        }
+    }
+    else
+    {
+        sendto(pPeer->nSocket, bytes.data(), bytes.size(), 0,
+               reinterpret_cast<const sockaddr*>(pPeer->address.data()), socklen_t(pPeer->address.size()));
+    }
+    m_nFramesOut++;
+}
+
+void StandInServer::ReapPeers(std::vector<std::unique_ptr<tPeer>> &peers, bool bAll)
+{
+    std::vector<std::unique_ptr<tPeer>> reaped;
+    {
+        std::lock_guard<std::mutex> lock(m_PeerMutex);
+        auto closed = std::stable_partition(peers.begin(), peers.end(),
+                                            [bAll](const std::unique_ptr<tPeer> &pPeer) {return !bAll && !pPeer->bClosed;});
+        std::move(closed, peers.end(), std::back_inserter(reaped));
+        peers.erase(closed, peers.end());
+    }
+
+    for (auto &pPeer : reaped)
+    {
+        if (pPeer->reader.joinable())
+        {
+            pPeer->reader.join();
+        }
+        for (auto *pLine : {pPeer->pUplink.get(), pPeer->pDownlink.get()})
+        {
+            m_nDropped += pLine->GetDroppedCount();
+            m_nReordered += pLine->GetReorderedCount();
+            m_nRetransmitted += pLine->GetRetransmittedCount();
+        }
+        //in the order of the frames: nothing more to the server, nothing more from it, then the socket
+        pPeer->pUplink.reset();
+        pPeer->pTransport->disconnect();
+        pPeer->pDownlink.reset();
+        if (pPeer->address.empty())
+        {
+            close(pPeer->nSocket);
+        }
+    }
+}
+
+void StandInServer::AcceptConnections()
+{
+    while (!m_bStop)
+    {
+        int nSocket = accept(m_nTcpSocket, nullptr, nullptr);
+        if (nSocket < 0)
+        {
+            continue;
+        }
+        if (m_bStop)
+        {
+            close(nSocket);
+            break;
+        }
+        int noDelay = 1;
+        setsockopt(nSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        m_nTcpConnections++;
+
+        ReapPeers(m_TcpPeers, false);
+        tPeer *pPeer = AddPeer(nSocket, std::vector<uint8_t>());
+        pPeer->reader = std::thread(&StandInServer::ReadConnection, this, pPeer);
+    }
+}
+
+void StandInServer::ReadConnection(tPeer *pPeer)
+{
+    char header[KINOVA_HEADER_SIZE];
+    std::string frame;
+    while (ReceiveAll(pPeer->nSocket, header, KINOVA_HEADER_SIZE))
+    {
+        uint32_t length;
+        memcpy(&length, header + KINOVA_MAGIC_SIZE, sizeof(length));
+        if (memcmp(header, KINOVA_MAGIC_STRING, KINOVA_MAGIC_SIZE) != 0 || length > MAX_TCP_FRAME_SIZE)
+        {
+            //out of sync, the stream cannot be trusted anymore
+            break;
+        }
+        frame.resize(length);
+        if (!ReceiveAll(pPeer->nSocket, &frame[0], length))
+        {
+            break;
+        }
+        m_nFramesIn++;
+        pPeer->pUplink->Push(frame);
+    }
+
+    //the session goes with the connection, as on the arm
+    pPeer->pTransport->disconnect();
+    pPeer->bClosed = true;
+}
+
+void StandInServer::ExpireUdpPeers()
+{
+    auto now = std::chrono::steady_clock::now();
+    bool bExpired = false;
+    {
+        std::lock_guard<std::mutex> lock(m_PeerMutex);
+        for (auto &pPeer : m_UdpPeers)
+        {
+            if (pPeer->expiry <= now)
+            {
+                pPeer->bClosed = true;
+                bExpired = true;
+            }
+        }
+    }
+    if (bExpired)
+    {
+        ReapPeers(m_UdpPeers, false);
+    }
+}
+
+void StandInServer::ReadDatagrams()
+{
+    timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = std::chrono::duration_cast<std::chrono::microseconds>(EXPIRE_PERIOD).count();
+    setsockopt(m_nUdpSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string datagram;
+    std::vector<uint8_t> address;
+    auto nextExpiry = std::chrono::steady_clock::now() + EXPIRE_PERIOD;
+    while (!m_bStop)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextExpiry)
+        {
+            ExpireUdpPeers();
+            nextExpiry = now + EXPIRE_PERIOD;
+        }
+
+        sockaddr_storage peerAddress;
+        socklen_t addressSize = sizeof(peerAddress);
+        datagram.resize(LoopbackTransport::MAX_FRAME_SIZE);
+        auto received = recvfrom(m_nUdpSocket, &datagram[0], datagram.size(), 0,
+                                 reinterpret_cast<sockaddr*>(&peerAddress), &addressSize);
+        if (received <= 0)
+        {
+            continue;
+        }
+        datagram.resize(size_t(received));
+        m_nFramesIn++;
+
+        address.assign(reinterpret_cast<uint8_t*>(&peerAddress), reinterpret_cast<uint8_t*>(&peerAddress) + addressSize);
+        tPeer *pPeer = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_PeerMutex);
+            for (auto &pUdpPeer : m_UdpPeers)
+            {
+                if (pUdpPeer->address == address)
+                {
+                    pPeer = pUdpPeer.get();
+                    break;
+                }
+            }
+        }
+        if (!pPeer)
+        {
+            pPeer = AddPeer(m_nUdpSocket, address);
+        }
+
+        //the session of the peer ends with its CloseSession, a new one on the same port starts over
+        tFrameHeader header;
+        bool bCloseSession = ParseFrameHeader(datagram.data(), uint32_t(datagram.size()), header)
+                             && header.frame.frameType == k_api::MSG_FRAME_REQUEST
+                             && header.service.functionUid == k_api::Session::eUidCloseSession;
+        if (bCloseSession)
+        {
+            pPeer->expiry = std::chrono::steady_clock::now() + CLOSED_PEER_LINGER;
+        }
+        else if (m_Settings.nUdpPeerTimeout_ms > 0)
+        {
+            pPeer->expiry = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_Settings.nUdpPeerTimeout_ms);
+        }
+        else
+        {
+            pPeer->expiry = std::chrono::steady_clock::time_point::max();
+        }
+        pPeer->pUplink->Push(datagram);
+    }
+}
+
+#else
+
+void StandInServer::Start()
+{
+    throw k_api::KBasicException("StandInServer needs POSIX sockets");
+}
+
+void StandInServer::Stop()
+{
+}
+
+#endif
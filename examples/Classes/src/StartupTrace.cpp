@@ -0,0 +1,141 @@
+#include "Classes/include/StartupTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+using std::chrono::steady_clock;
+using std::chrono::microseconds;
+
+namespace
+{
+    struct tTrace
+    {
+        std::mutex mutex;
+        steady_clock::time_point origin;
+        std::vector<StartupTrace::tPhase> phases;
+
+        tTrace(): origin(steady_clock::now()) {}
+    };
+
+    tTrace &GetTrace()
+    {
+        //never destroyed, the trace is printed at exit
+        static tTrace *pTrace = new tTrace;
+        return *pTrace;
+    }
+
+    void PrintAtExit()
+    {
+        fprintf(stderr, "%s", StartupTrace::ToString().c_str());
+    }
+
+    //before the default priority initializers, among which those of the .pb.cc
+    struct tOrigin
+    {
+        tOrigin()
+        {
+            GetTrace();
+            if (getenv("KORTEX_STARTUP_TRACE") != nullptr)
+            {
+                StartupTrace::Enable(true);
+            }
+        }
+    };
+#if defined(__GNUC__)
+    tOrigin s_Origin __attribute__((init_priority(101)));
+#else
+    tOrigin s_Origin;
+#endif
+}
+
+std::atomic<bool> StartupTrace::s_bEnabled(false);
+
+StartupTrace::Scope::Scope(const std::string &name)
+{
+    m_bEnabled = IsEnabled();
+    if (m_bEnabled)
+    {
+        m_Name = name;
+        m_Start = steady_clock::now();
+    }
+}
+
+StartupTrace::Scope::~Scope()
+{
+    if (m_bEnabled)
+    {
+        Record(m_Name, m_Start, steady_clock::now());
+    }
+}
+
+void StartupTrace::Enable(bool bPrintAtExit)
+{
+    if (!s_bEnabled.exchange(true) && bPrintAtExit)
+    {
+        atexit(PrintAtExit);
+    }
+}
+
+namespace
+{
+    void Add(const std::string &name, steady_clock::time_point start, steady_clock::time_point end, bool bMark)
+    {
+        if (!StartupTrace::IsEnabled())
+        {
+            return;
+        }
+        tTrace &trace = GetTrace();
+        StartupTrace::tPhase phase = {name, std::chrono::duration_cast<microseconds>(start - trace.origin),
+                                      std::chrono::duration_cast<microseconds>(end - start), bMark};
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        trace.phases.push_back(phase);
+    }
+}
+
+void StartupTrace::Record(const std::string &name, steady_clock::time_point start, steady_clock::time_point end)
+{
+    Add(name, start, end, false);
+}
+
+void StartupTrace::Mark(const std::string &name)
+{
+    auto now = steady_clock::now();
+    Add(name, now, now, true);
+}
+
+std::vector<StartupTrace::tPhase> StartupTrace::GetPhases()
+{
+    tTrace &trace = GetTrace();
+    std::vector<tPhase> phases;
+    {
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        phases = trace.phases;
+    }
+    //recorded when they end
+    std::stable_sort(phases.begin(), phases.end(), [](const tPhase &a, const tPhase &b) {return a.start < b.start;});
+    return phases;
+}
+
+std::string StartupTrace::ToString()
+{
+    std::ostringstream stream;
+    stream << "startup trace (us):" << std::endl;
+    for (const tPhase &phase : GetPhases())
+    {
+        stream << std::setw(10) << phase.start.count() << " " << std::setw(10);
+        if (phase.bMark)
+        {
+            stream << "-";
+        }
+        else
+        {
+            stream << phase.duration.count();
+        }
+        stream << "  " << phase.name << std::endl;
+    }
+    return stream.str();
+}
@@ -0,0 +1,57 @@
+#include "Classes/include/TracingTransport.h"
+
+#include "Classes/include/EventTrace.h"
+
+namespace k_api = Kinova::Api;
+
+TracingTransport::TracingTransport(k_api::ITransportClient *pTransport, const std::string &channel) :
+    m_RxThreadName(channel + " rx")
+{
+    m_pTransport = pTransport;
+    readyState = m_pTransport->readyState;
+}
+
+bool TracingTransport::connect(std::string host, uint32_t port)
+{
+    KORTEX_TRACE_SCOPE("transport", "connect");
+    bool bConnected = m_pTransport->connect(host, port);
+    readyState = m_pTransport->readyState;
+    return bConnected;
+}
+
+void TracingTransport::disconnect()
+{
+    m_pTransport->disconnect();
+    readyState = m_pTransport->readyState;
+}
+
+void TracingTransport::send(const char *txBuffer, uint32_t txSize)
+{
+    KORTEX_TRACE_SCOPE("transport", "send");
+    m_pTransport->send(txBuffer, txSize);
+}
+
+void TracingTransport::onMessage(std::function<void (const char*, uint32_t)> callback)
+{
+    m_pTransport->onMessage([this, callback](const char *rxBuffer, uint32_t rxSize)
+    {
+        KORTEX_TRACE_THREAD_NAME(m_RxThreadName);
+        KORTEX_TRACE_SCOPE("router", "frameHandler");
+        callback(rxBuffer, rxSize);
+    });
+}
+
+char* TracingTransport::getTxBuffer(uint32_t const &allocation_size)
+{
+    return m_pTransport->getTxBuffer(allocation_size);
+}
+
+size_t TracingTransport::getMaxTxBufferSize()
+{
+    return m_pTransport->getMaxTxBufferSize();
+}
+
+void TracingTransport::getHostAddress(std::string &host, uint32_t &port)
+{
+    m_pTransport->getHostAddress(host, port);
+}
@@ -2,10 +2,22 @@
 #include "KortexRobot.h"
 
 namespace k_api = Kinova::Api;
+constexpr auto TIMEOUT_DURATION = std::chrono::seconds{20};
+
+//waits for the end of an action, true when it ended (not aborted, rejected or timed out)
+bool WaitForAction(const tActionCompletion &completion)
+{
+    if (completion.finished.wait_for(TIMEOUT_DURATION) != std::future_status::ready)
+    {
+        std::cout << "Timeout on action notification wait" << std::endl;
+        return false;
+    }
+    return completion.finished.get() == k_api::Base::ACTION_END;
+}
 
 int main(int argc, char **argv)
 {
-    KortexRobot robot = KortexRobot("192.168.1.10");
+    KortexRobot robot("192.168.1.10");
 
     if(robot.IsConnected())
     {
@@ -15,8 +27,7 @@ int main(int argc, char **argv)
         //Go to home position;
         auto action_type = k_api::Base::RequestedActionType();
         action_type.set_action_type(k_api::Base::REACH_JOINT_ANGLES);        
-        robot.ExecuteExistingAction("Home", action_type);
-        robot.WaitWhileRobotIsMoving(10000);
+        WaitForAction(robot.ExecuteExistingAction("Home", action_type));
 
         //Go to a position in the cartisian frame
         
@@ -25,15 +36,13 @@ int main(int argc, char **argv)
         k_api::Base::CartesianTrajectoryConstraint constraint = k_api::Base::CartesianTrajectoryConstraint();
         constraint.mutable_speed()->set_translation(0.25f);
         constraint.mutable_speed()->set_orientation(30.0f);
-        robot.MoveTo(position, orientation, constraint);
-        robot.WaitWhileRobotIsMoving(10000);
+        WaitForAction(robot.MoveTo(position, orientation, constraint));
 
         
         //angular action
         std::vector <float> jointAngles {340.0f, 25.5f, 205.0f, 240.0f, 345.0f, 320.0f, 100.0f};
         k_api::Base::JointTrajectoryConstraint jointConstraint = k_api::Base::JointTrajectoryConstraint();
-        robot.SetJointAngles(jointAngles, jointConstraint);
-        robot.WaitWhileRobotIsMoving(10000);
+        WaitForAction(robot.SetJointAngles(jointAngles, jointConstraint));
 
         //twist command
         
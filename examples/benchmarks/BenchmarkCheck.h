@@ -0,0 +1,14 @@
+#ifndef KORTEXAPICPPEXAMPLE_BENCHMARKCHECK_H
+#define KORTEXAPICPPEXAMPLE_BENCHMARKCHECK_H
+
+#include <iostream>
+#include <string>
+
+//shared by the benchmarks: prints "ok" or "FAILED" before the name of the check and returns its result
+inline bool Check(bool bCondition, const std::string &name)
+{
+    std::cout << (bCondition ? "ok     " : "FAILED ") << name << std::endl;
+    return bCondition;
+}
+
+#endif
@@ -0,0 +1,372 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Compares the ActuatorCyclic per-actuator path with full BaseCyclic frames, no robot needed.
+*
+* A simulated router stands for the link: every frame pays the per-byte time of a shared up and down link plus a fixed
+* one-way latency, and the simulated robot echoes the command values in its feedback.
+*
+* 1- Bytes: payload sizes of a BaseCyclic command and feedback of 7 actuators and of the ActuatorCyclic ones.
+* 2- Check: the feedbacks of ActuatorCyclicController and ActuatorCyclicGroup are the ones of their own device and frame.
+*    A feedback held up past the timeout of its Refresh is counted late and dropped, the next Refresh gets its own.
+* 3- Latency of one cycle: a BaseCyclic Refresh, a single actuator Refresh, and 7 actuators refreshed one after the
+*    other or fanned out by ActuatorCyclicGroup.
+*
+* The process returns 1 if the check fails.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+#include <ActuatorCyclicClientRpc.h>
+#include <KDetailedException.h>
+
+#include <ActuatorCyclicController.h>
+#include <LatencyHistogram.h>
+#include <PreencodedCyclicCommand.h>
+
+namespace k_api = Kinova::Api;
+
+using std::chrono::steady_clock;
+
+#define ACTUATOR_COUNT 7
+#define LINK_LATENCY_US 100     // one way, switch and robot stack
+#define LINK_NS_PER_BYTE 8      // 1 Gbit/s
+#define FRAME_OVERHEAD 62       // Ethernet + IP + UDP + Kortex header bytes
+#define BENCHMARK_CYCLES 2000
+#define LATE_FRAME_US 20000     // past the 1 ms timeout of the late feedback check
+
+// Answers every frame like the robot would, after the time the link would take
+class SimulatedLinkRouter : public k_api::IRouterClient
+{
+public:
+    SimulatedLinkRouter()
+    {
+        m_bStop = false;
+        m_UplinkFree = steady_clock::now();
+        m_DownlinkFree = m_UplinkFree;
+        m_NextDelay = std::chrono::microseconds(0);
+        m_Thread = std::thread(&SimulatedLinkRouter::Deliver, this);
+    }
+
+    ~SimulatedLinkRouter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bStop = true;
+        }
+        m_Condition.notify_all();
+        m_Thread.join();
+    }
+
+    std::future<k_api::Frame> send(const std::string &txPayload, uint32_t, uint32_t funcId, uint32_t deviceId, const k_api::RouterClientSendOptions&) override
+    {
+        tPending pending;
+        pending.pPromise = std::make_shared<std::promise<k_api::Frame>>();
+        auto future = pending.pPromise->get_future();
+        Queue(pending, txPayload, funcId, deviceId);
+        return future;
+    }
+
+    k_api::Error sendWithCallback(const std::string &txPayload, uint32_t, uint32_t funcId, uint32_t deviceId, k_api::MessageCallback callback) override
+    {
+        tPending pending;
+        pending.callback = callback;
+        Queue(pending, txPayload, funcId, deviceId);
+        return k_api::Error();
+    }
+
+    // the next frame answered that much later, as a datagram held up on the way
+    void DelayNextFrame(std::chrono::microseconds delay)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_NextDelay = delay;
+    }
+
+    void reset() override {}
+    void registerBridgingCallback(std::function<void (k_api::Frame&)>) override {}
+    void registerNotificationCallback(uint32_t, std::function<k_api::Error (k_api::Frame&)>) override {}
+    void registerErrorCallback(std::function<void (k_api::KError)>) override {}
+    void registerHitCallback(std::function<void (k_api::FrameTypes)>) override {}
+    k_api::Error sendMsgFrame(const k_api::Frame&) override {return k_api::Error();}
+    uint16_t getConnectionId() override {return 0;}
+    void SetActivationStatus(bool) override {}
+    k_api::ITransportClient* getTransport() override {return nullptr;}
+
+private:
+    struct tPending
+    {
+        steady_clock::time_point due;
+        std::shared_ptr<std::promise<k_api::Frame>> pPromise;    // or the callback
+        k_api::MessageCallback callback;
+        k_api::Frame frame;
+
+        bool operator<(const tPending &other) const {return due > other.due;}
+    };
+
+    void Queue(tPending &pending, const std::string &txPayload, uint32_t funcId, uint32_t deviceId)
+    {
+        pending.frame.set_payload(Answer(txPayload, funcId, deviceId));
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto now = steady_clock::now();
+        auto sent = std::max(now, m_UplinkFree) + std::chrono::nanoseconds((txPayload.size() + FRAME_OVERHEAD) * LINK_NS_PER_BYTE);
+        m_UplinkFree = sent;
+        auto replyStart = std::max(sent + std::chrono::microseconds(2 * LINK_LATENCY_US), m_DownlinkFree);
+        pending.due = replyStart + std::chrono::nanoseconds((pending.frame.payload().size() + FRAME_OVERHEAD) * LINK_NS_PER_BYTE);
+        m_DownlinkFree = pending.due;
+        pending.due += m_NextDelay;
+        m_NextDelay = std::chrono::microseconds(0);
+        m_Queue.push(pending);
+        m_Condition.notify_all();
+    }
+
+    static std::string Answer(const std::string &payload, uint32_t funcId, uint32_t deviceId)
+    {
+        if (funcId == k_api::ActuatorCyclic::eUidRefresh)
+        {
+            k_api::ActuatorCyclic::Command command;
+            command.ParseFromString(payload);
+            k_api::ActuatorCyclic::Feedback feedback;
+            FillActuator(feedback, command.command_id().identifier(), deviceId, command.position());
+            return feedback.SerializeAsString();
+        }
+
+        k_api::BaseCyclic::Command command;
+        command.ParseFromString(payload);
+        k_api::BaseCyclic::Feedback feedback;
+        feedback.set_frame_id(command.frame_id());
+        auto base = feedback.mutable_base();
+        base->set_arm_voltage(24.1f);
+        base->set_arm_current(1.3f);
+        base->set_temperature_cpu(48.2f);
+        base->set_temperature_ambient(31.5f);
+        base->set_imu_acceleration_x(0.01f);
+        base->set_imu_acceleration_y(-0.02f);
+        base->set_imu_acceleration_z(-9.81f);
+        base->set_tool_pose_x(0.45f);
+        base->set_tool_pose_y(0.12f);
+        base->set_tool_pose_z(0.33f);
+        base->set_tool_pose_theta_x(90.0f);
+        base->set_tool_pose_theta_y(0.5f);
+        base->set_tool_pose_theta_z(89.5f);
+        for (int i = 0; i < command.actuators_size(); i++)
+        {
+            auto actuator = feedback.add_actuators();
+            actuator->set_command_id(command.actuators(i).command_id());
+            actuator->set_status_flags(0x21);
+            actuator->set_jitter_comm(uint32_t(30 + i));
+            actuator->set_position(command.actuators(i).position());
+            actuator->set_velocity(0.25f);
+            actuator->set_torque(1.5f + float(i));
+            actuator->set_current_motor(0.8f);
+            actuator->set_voltage(23.9f);
+            actuator->set_temperature_motor(35.0f);
+            actuator->set_temperature_core(40.0f);
+        }
+        return feedback.SerializeAsString();
+    }
+
+    static void FillActuator(k_api::ActuatorCyclic::Feedback &feedback, uint32_t commandId, uint32_t deviceId, float position)
+    {
+        feedback.mutable_feedback_id()->set_identifier(commandId);
+        feedback.set_status_flags(0x21);
+        feedback.set_jitter_comm(30 + deviceId);
+        feedback.set_position(position);
+        feedback.set_velocity(0.25f);
+        feedback.set_torque(float(deviceId));
+        feedback.set_current_motor(0.8f);
+        feedback.set_voltage(23.9f);
+        feedback.set_temperature_motor(35.0f);
+        feedback.set_temperature_core(40.0f);
+    }
+
+    void Deliver()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (!m_bStop)
+        {
+            if (m_Queue.empty())
+            {
+                m_Condition.wait(lock);
+                continue;
+            }
+            auto due = m_Queue.top().due;
+            if (steady_clock::now() < due)
+            {
+                m_Condition.wait_until(lock, due);
+                continue;
+            }
+            tPending pending = m_Queue.top();
+            m_Queue.pop();
+            lock.unlock();
+            if (pending.pPromise)
+            {
+                pending.pPromise->set_value(pending.frame);
+            }
+            else
+            {
+                pending.callback(pending.frame);
+            }
+            lock.lock();
+        }
+    }
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::priority_queue<tPending> m_Queue;
+    steady_clock::time_point m_UplinkFree;
+    steady_clock::time_point m_DownlinkFree;
+    std::chrono::microseconds m_NextDelay;
+    bool m_bStop;
+    std::thread m_Thread;
+};
+
+uint64_t ElapsedNs(const steady_clock::time_point &start)
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - start).count());
+}
+
+int main(int argc, char **argv)
+{
+    SimulatedLinkRouter router;
+
+    k_api::BaseCyclic::Command baseCommand;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        auto actuator = baseCommand.add_actuators();
+        actuator->set_position(10.0f * float(i + 1));
+        actuator->set_velocity(0.5f);
+    }
+    PreencodedCyclicCommand preencoded;
+    preencoded.Init(baseCommand);
+    CyclicSequencer baseSequencer;
+
+    std::vector<uint32_t> deviceIds;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        deviceIds.push_back(uint32_t(i + 1));
+    }
+    ActuatorCyclicGroup group(&router, deviceIds);
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        group.Get(i).GetCommand().position = 10.0f * float(i + 1);
+        group.Get(i).GetCommand().velocity = 0.5f;
+    }
+    ActuatorCyclicController &single = group.Get(ACTUATOR_COUNT - 1);
+
+    // 1- bytes
+    k_api::BaseCyclic::Feedback baseFeedback;
+    baseSequencer.Stamp(preencoded);
+    preencoded.Refresh(&router, baseFeedback);
+    single.Refresh();
+    std::cout << "BaseCyclic command / feedback:     " << preencoded.GetPayload().size() << " / " << baseFeedback.ByteSizeLong() << " bytes" << std::endl;
+    std::cout << "ActuatorCyclic command / feedback: " << single.GetCommandSize() << " / " << single.GetFeedbackSize() << " bytes" << std::endl;
+
+    // 2- check, the positions change every cycle and must come back from the right device
+    for (int cycle = 0; cycle < 200; cycle++)
+    {
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            group.Get(i).GetCommand().position = float(cycle * 10 + i);
+        }
+        group.Refresh();
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            const tActuatorCyclicFeedback &feedback = group.Get(i).GetFeedback();
+            if (feedback.position != float(cycle * 10 + i) || feedback.torque != float(deviceIds[i]))
+            {
+                std::cout << "MISMATCH on actuator " << i << " at cycle " << cycle << std::endl;
+                return 1;
+            }
+        }
+    }
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        const tSequenceStatistics &statistics = group.Get(i).GetSequenceStatistics();
+        if (statistics.nInOrder != statistics.nStamped)
+        {
+            std::cout << "out of order feedback on actuator " << i << ": " << statistics.ToString() << std::endl;
+            return 1;
+        }
+    }
+
+    // a feedback late past the timeout, not taken for the one of the next Refresh
+    router.DelayNextFrame(std::chrono::microseconds(LATE_FRAME_US));
+    single.GetCommand().position = 1.0f;
+    bool bTimedOut = false;
+    try
+    {
+        single.Refresh({false, 0, 1});
+    }
+    catch (k_api::KBasicException&)
+    {
+        bTimedOut = true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(2 * LATE_FRAME_US));
+    single.GetCommand().position = 2.0f;
+    if (!bTimedOut || single.Refresh().position != 2.0f || single.GetLateReplyCount() != 1)
+    {
+        std::cout << "late feedback not dropped: timed out " << bTimedOut << ", position " << single.GetFeedback().position
+                  << ", late replies " << single.GetLateReplyCount() << std::endl;
+        return 1;
+    }
+
+    // 3- latency of one cycle
+    LatencyHistogram baseTime, singleTime, sequentialTime, groupTime;
+    for (int cycle = 0; cycle < BENCHMARK_CYCLES; cycle++)
+    {
+        auto start = steady_clock::now();
+        baseSequencer.Stamp(preencoded);
+        preencoded.Refresh(&router, baseFeedback);
+        baseTime.Record(ElapsedNs(start));
+
+        start = steady_clock::now();
+        single.Refresh();
+        singleTime.Record(ElapsedNs(start));
+
+        start = steady_clock::now();
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            group.Get(i).Refresh();
+        }
+        sequentialTime.Record(ElapsedNs(start));
+
+        start = steady_clock::now();
+        group.Refresh();
+        groupTime.Record(ElapsedNs(start));
+    }
+
+    std::cout << "link: " << LINK_LATENCY_US << " us one way, " << LINK_NS_PER_BYTE << " ns/byte, " << FRAME_OVERHEAD << " bytes of headers per frame" << std::endl;
+    std::ostringstream sequential, fannedOut;
+    sequential << "ActuatorCyclic, " << ACTUATOR_COUNT << " one by one:";
+    fannedOut << "ActuatorCyclicGroup, " << ACTUATOR_COUNT << " fanned out:";
+    std::cout << std::left
+              << std::setw(36) << "BaseCyclic, all actuators:" << baseTime.ToString() << std::endl
+              << std::setw(36) << "ActuatorCyclic, 1 actuator:" << singleTime.ToString() << std::endl
+              << std::setw(36) << sequential.str() << sequentialTime.ToString() << std::endl
+              << std::setw(36) << fannedOut.str() << groupTime.ToString() << std::endl;
+    return 0;
+}
@@ -0,0 +1,333 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times the JointKernels control law building blocks for each instruction set the processor runs, no robot
+* needed.
+*
+* 1- Check: every kernel, and a whole torque law made of them, is run on random feedback for many cycles with each
+*    instruction set. The outputs and the filter states must match the scalar kernels.
+* 2- Benchmark: ns per call of each kernel, then of a 1 kHz torque law for 7 joints: wrapped position error, filtered
+*    velocity, PD plus feedforward, second-order output filter, saturation and rate limiting, from tFlatFeedback into
+*    a PreencodedCyclicCommand. The same law written one joint at a time with the protobuf accessors is timed too.
+*
+* The process returns 1 if the check fails.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+
+#include <AlignedNew.h>
+#include <FlatFeedback.h>
+#include <JointKernels.h>
+#include <PreencodedCyclicCommand.h>
+
+namespace k_api = Kinova::Api;
+
+#define ACTUATOR_COUNT 7
+#define CHECK_CYCLES 100000
+#define BENCHMARK_ITERATIONS 2000000
+#define LAW_ITERATIONS 500000
+#define SAMPLE_RATE_HZ 1000.0f
+#define TOLERANCE 1e-5f
+
+const int LANES = CyclicWire::MAX_ACTUATORS;
+
+//one torque law, all joint vectors
+struct tTorqueLaw : public tAlignedNew<32>
+{
+    tPdGains gains;
+    alignas(32) float target[LANES];
+    alignas(32) float feedforward[LANES];
+    alignas(32) float low[LANES];
+    alignas(32) float high[LANES];
+    alignas(32) float maxStep[LANES];
+    alignas(32) float previous[LANES];
+    tFirstOrderFilter velocityFilter;
+    tSecondOrderFilter torqueFilter;
+
+    alignas(32) float error[LANES];
+    alignas(32) float velocity[LANES];
+    alignas(32) float torque[LANES];
+
+    void Init(const tFlatActuatorFeedback &feedback)
+    {
+        std::memset(this, 0, sizeof(*this));
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            gains.kp[i] = i < 4 ? 2.0f : 0.8f;
+            gains.kd[i] = i < 4 ? 0.3f : 0.1f;
+            target[i] = feedback.position[i];
+            low[i] = i < 4 ? -39.0f : -9.0f;
+            high[i] = -low[i];
+            maxStep[i] = 0.5f;
+        }
+        velocityFilter.SetLowPass(50.0f, SAMPLE_RATE_HZ, feedback.velocity);
+        torqueFilter.SetLowPass(100.0f, SAMPLE_RATE_HZ, 0.7071f, previous);
+    }
+
+    void Step(const JointKernels &kernels, const tFlatActuatorFeedback &feedback)
+    {
+        kernels.PositionError(target, feedback.position, error);
+        kernels.Filter(velocityFilter, feedback.velocity, velocity);
+        kernels.Pd(gains, error, velocity, feedforward, torque);
+        kernels.Filter(torqueFilter, torque, torque);
+        kernels.Saturate(low, high, torque);
+        kernels.RateLimit(maxStep, previous, torque);
+        std::memcpy(previous, torque, sizeof(previous));
+    }
+};
+
+void RandomFeedback(std::mt19937 &generator, tFlatActuatorFeedback &feedback)
+{
+    std::uniform_real_distribution<float> position(0.0f, 360.0f);
+    std::uniform_real_distribution<float> velocity(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> torque(-30.0f, 30.0f);
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        feedback.position[i] = position(generator);
+        feedback.velocity[i] = velocity(generator);
+        feedback.torque[i] = torque(generator);
+    }
+}
+
+bool Same(const float *a, const float *b, int count = LANES)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (std::fabs(a[i] - b[i]) > TOLERANCE * std::max(1.0f, std::fabs(b[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CheckIsa(JointKernels::eIsa isa)
+{
+    JointKernels reference(JointKernels::SCALAR);
+    JointKernels kernels(isa);
+    std::mt19937 generator(1);
+
+    tFlatActuatorFeedback feedback;
+    std::memset(&feedback, 0, sizeof(feedback));
+    RandomFeedback(generator, feedback);
+
+    std::unique_ptr<tTorqueLaw> pExpected(new tTorqueLaw);
+    std::unique_ptr<tTorqueLaw> pLaw(new tTorqueLaw);
+    pExpected->Init(feedback);
+    pLaw->Init(feedback);
+
+    std::uniform_real_distribution<float> value(-400.0f, 400.0f);
+    for (int cycle = 0; cycle < CHECK_CYCLES; cycle++)
+    {
+        //the kernels one by one on unrelated random vectors, the errors cross several turns
+        alignas(32) float a[LANES], b[LANES], c[LANES], expected[LANES], result[LANES];
+        for (int i = 0; i < LANES; i++)
+        {
+            a[i] = value(generator);
+            b[i] = value(generator);
+            c[i] = std::fabs(value(generator)) * 0.01f;
+        }
+
+        reference.PositionError(a, b, expected);
+        kernels.PositionError(a, b, result);
+        bool bSame = Same(expected, result);
+
+        reference.Pd(pExpected->gains, a, b, c, expected);
+        kernels.Pd(pLaw->gains, a, b, c, result);
+        bSame = bSame && Same(expected, result);
+
+        std::memcpy(expected, a, sizeof(a));
+        std::memcpy(result, a, sizeof(a));
+        reference.Saturate(pExpected->low, pExpected->high, expected);
+        kernels.Saturate(pLaw->low, pLaw->high, result);
+        bSame = bSame && Same(expected, result);
+
+        std::memcpy(expected, a, sizeof(a));
+        std::memcpy(result, a, sizeof(a));
+        reference.RateLimit(c, b, expected);
+        kernels.RateLimit(c, b, result);
+        bSame = bSame && Same(expected, result);
+
+        //the whole law, the filter states carry over from cycle to cycle
+        if (cycle % 100 == 0)
+        {
+            for (int i = 0; i < ACTUATOR_COUNT; i++)
+            {
+                pExpected->target[i] = pLaw->target[i] = std::fmod(std::fabs(a[i]), 360.0f);
+                pExpected->feedforward[i] = pLaw->feedforward[i] = b[i] * 0.01f;
+            }
+        }
+        RandomFeedback(generator, feedback);
+        pExpected->Step(reference, feedback);
+        pLaw->Step(kernels, feedback);
+        bSame = bSame && Same(pExpected->torque, pLaw->torque) && Same(pExpected->velocityFilter.y, pLaw->velocityFilter.y)
+            && Same(pExpected->torqueFilter.z1, pLaw->torqueFilter.z1) && Same(pExpected->torqueFilter.z2, pLaw->torqueFilter.z2);
+
+        if (!bSame)
+        {
+            std::cout << JointKernels::GetIsaName(isa) << ": differs from the scalar kernels at cycle " << cycle << std::endl;
+            return false;
+        }
+    }
+    std::cout << JointKernels::GetIsaName(isa) << ": " << CHECK_CYCLES << " cycles identical to the scalar kernels" << std::endl;
+    return true;
+}
+
+template <typename Function>
+double TimeNs(int iterations, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        function();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+}
+
+k_api::BaseCyclic::Command MakeCommand()
+{
+    k_api::BaseCyclic::Command command;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        auto actuator = command.add_actuators();
+        actuator->set_flags(1);
+        actuator->set_position(10.0f * i);
+        actuator->set_torque_joint(0.5f);
+    }
+    return command;
+}
+
+void BenchmarkIsa(JointKernels::eIsa isa, const tFlatFeedback &flat, float &sink)
+{
+    JointKernels kernels(isa);
+    std::unique_ptr<tTorqueLaw> pLaw(new tTorqueLaw);
+    pLaw->Init(flat.actuators);
+    alignas(32) float out[LANES];
+    std::memcpy(out, flat.actuators.torque, sizeof(out));
+
+    double errorNs = TimeNs(BENCHMARK_ITERATIONS, [&]() {kernels.PositionError(pLaw->target, flat.actuators.position, out);});
+    double pdNs = TimeNs(BENCHMARK_ITERATIONS, [&]() {kernels.Pd(pLaw->gains, out, flat.actuators.velocity, pLaw->feedforward, out);});
+    double saturateNs = TimeNs(BENCHMARK_ITERATIONS, [&]() {kernels.Saturate(pLaw->low, pLaw->high, out);});
+    double rateLimitNs = TimeNs(BENCHMARK_ITERATIONS, [&]() {kernels.RateLimit(pLaw->maxStep, pLaw->previous, out);});
+    double firstOrderNs = TimeNs(BENCHMARK_ITERATIONS, [&]() {kernels.Filter(pLaw->velocityFilter, flat.actuators.velocity, out);});
+    double secondOrderNs = TimeNs(BENCHMARK_ITERATIONS, [&]() {kernels.Filter(pLaw->torqueFilter, out, out);});
+    sink += out[0];
+
+    PreencodedCyclicCommand command;
+    command.Init(MakeCommand());
+    double lawNs = TimeNs(LAW_ITERATIONS, [&]()
+    {
+        pLaw->Step(kernels, flat.actuators);
+        JointKernels::ToTorqueCommand(pLaw->torque, ACTUATOR_COUNT, command);
+    });
+    sink += pLaw->torque[0];
+
+    std::cout << JointKernels::GetIsaName(isa) << ":" << std::endl;
+    std::cout << "  position error: " << errorNs << " ns, PD: " << pdNs << " ns, saturation: " << saturateNs
+              << " ns, rate limit: " << rateLimitNs << " ns" << std::endl;
+    std::cout << "  first order: " << firstOrderNs << " ns, second order: " << secondOrderNs << " ns" << std::endl;
+    std::cout << "  torque law into the pre-encoded command: " << lawNs << " ns/cycle" << std::endl;
+}
+
+//the same law the way example 108 writes it, joint by joint through the protobuf accessors
+double BenchmarkProtobuf(const tFlatFeedback &flat, float &sink)
+{
+    k_api::BaseCyclic::Feedback feedback;
+    flat.ToFeedback(feedback);
+    k_api::BaseCyclic::Command command = MakeCommand();
+
+    std::unique_ptr<tTorqueLaw> pLaw(new tTorqueLaw);
+    pLaw->Init(flat.actuators);
+    tTorqueLaw &law = *pLaw;
+
+    double lawNs = TimeNs(LAW_ITERATIONS, [&]()
+    {
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            const k_api::BaseCyclic::ActuatorFeedback &actuator = feedback.actuators(i);
+            float error = law.target[i] - actuator.position();
+            error -= 360.0f * std::nearbyint(error / 360.0f);
+            float velocity = law.velocityFilter.y[i] += law.velocityFilter.alpha[i] * (actuator.velocity() - law.velocityFilter.y[i]);
+            float torque = law.gains.kp[i] * error - law.gains.kd[i] * velocity + law.feedforward[i];
+
+            tSecondOrderFilter &filter = law.torqueFilter;
+            float y = filter.b0[i] * torque + filter.z1[i];
+            filter.z1[i] = filter.b1[i] * torque - filter.a1[i] * y + filter.z2[i];
+            filter.z2[i] = filter.b2[i] * torque - filter.a2[i] * y;
+
+            torque = std::min(std::max(y, law.low[i]), law.high[i]);
+            torque = law.previous[i] + std::min(std::max(torque - law.previous[i], -law.maxStep[i]), law.maxStep[i]);
+            law.previous[i] = torque;
+            command.mutable_actuators(i)->set_torque_joint(torque);
+        }
+    });
+    sink += command.actuators(0).torque_joint();
+    return lawNs;
+}
+
+int main(int argc, char **argv)
+{
+    std::cout << "best instruction set: " << JointKernels::GetIsaName(JointKernels::GetBestIsa()) << std::endl;
+
+    const JointKernels::eIsa isas[] = {JointKernels::SCALAR, JointKernels::SSE2, JointKernels::AVX2};
+    std::vector<JointKernels::eIsa> supported;
+    for (auto isa : isas)
+    {
+        if (JointKernels::IsSupported(isa))
+        {
+            supported.push_back(isa);
+        }
+        else
+        {
+            std::cout << JointKernels::GetIsaName(isa) << ": not supported, skipped" << std::endl;
+        }
+    }
+
+    bool bOk = true;
+    for (auto isa : supported)
+    {
+        bOk = CheckIsa(isa) && bOk;
+    }
+
+    std::mt19937 generator(2);
+    std::unique_ptr<tFlatFeedback> pFlat(new tFlatFeedback);
+    pFlat->Reset();
+    pFlat->actuators.nCount = ACTUATOR_COUNT;
+    RandomFeedback(generator, pFlat->actuators);
+
+    float sink = 0.0f;
+    for (auto isa : supported)
+    {
+        BenchmarkIsa(isa, *pFlat, sink);
+    }
+    std::cout << "protobuf, one joint at a time: " << BenchmarkProtobuf(*pFlat, sink) << " ns/cycle" << std::endl;
+    std::cout << "(" << sink << ")" << std::endl;
+
+    if (!bOk)
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Compares the cost of producing the BaseCyclic::Command payload of a 1 kHz loop, no robot needed.
+*
+* 1- Check: random commands are written both through PreencodedCyclicCommand and a protobuf Command,
+*    the payload must be byte for byte the output of SerializeToString. Zeros and varints of every length are included.
+* 2- Benchmark: a torque control tick (frame id, 7 command ids, positions and torques) followed by the serialization,
+*    with protobuf then with the pre-encoded command.
+*
+* The process returns 1 if the check fails.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <BaseCyclicClientRpc.h>
+
+#include <PreencodedCyclicCommand.h>
+
+namespace k_api = Kinova::Api;
+
+#define ACTUATOR_COUNT 7
+#define GRIPPER_MOTOR_COUNT 1
+#define CHECK_ITERATIONS 200000
+#define BENCHMARK_ITERATIONS 2000000
+
+// Some values are zero (left out of the wire) and the others cover every varint length
+uint32_t RandomUint32(std::mt19937 &generator)
+{
+    switch (generator() % 4)
+    {
+        case 0: return 0;
+        case 1: return generator() % 128;
+        case 2: return generator() % 20000;
+        default: return uint32_t(generator());
+    }
+}
+
+float RandomFloat(std::mt19937 &generator)
+{
+    if (generator() % 4 == 0)
+    {
+        return 0.0f;
+    }
+    return std::uniform_real_distribution<float>(-360.0f, 360.0f)(generator);
+}
+
+k_api::BaseCyclic::Command CreateCommand(bool bWithGripper)
+{
+    k_api::BaseCyclic::Command command;
+    command.set_frame_id(1);
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        auto actuator = command.add_actuators();
+        actuator->set_command_id(1);
+        actuator->set_position(float(10 * i));
+    }
+    if (bWithGripper)
+    {
+        auto interconnect = command.mutable_interconnect();
+        interconnect->mutable_command_id()->set_identifier(1);
+        auto gripper = interconnect->mutable_gripper_command();
+        for (int i = 0; i < GRIPPER_MOTOR_COUNT; i++)
+        {
+            auto motor = gripper->add_motor_cmd();
+            motor->set_motor_id(uint32_t(i + 1));
+            motor->set_velocity(100.0f);
+        }
+    }
+    return command;
+}
+
+bool CheckByteIdentity(bool bWithGripper)
+{
+    k_api::BaseCyclic::Command reference = CreateCommand(bWithGripper);
+    PreencodedCyclicCommand preencoded;
+    if (!preencoded.Init(reference))
+    {
+        std::cout << "Init refused the reference command" << std::endl;
+        return false;
+    }
+
+    std::mt19937 generator(42);
+    std::string expected;
+    for (int iteration = 0; iteration < CHECK_ITERATIONS; iteration++)
+    {
+        uint32_t frameId = RandomUint32(generator);
+        reference.set_frame_id(frameId);
+        preencoded.SetFrameId(frameId);
+
+        // A few fields per tick, like a control loop
+        int changes = 1 + int(generator() % 8);
+        for (int change = 0; change < changes; change++)
+        {
+            int i = int(generator() % ACTUATOR_COUNT);
+            auto actuator = reference.mutable_actuators(i);
+            uint32_t value = RandomUint32(generator);
+            float real = RandomFloat(generator);
+            switch (generator() % 6)
+            {
+                case 0: actuator->set_command_id(value); preencoded.SetCommandId(i, value); break;
+                case 1: actuator->set_flags(value); preencoded.SetFlags(i, value); break;
+                case 2: actuator->set_position(real); preencoded.SetPosition(i, real); break;
+                case 3: actuator->set_velocity(real); preencoded.SetVelocity(i, real); break;
+                case 4: actuator->set_torque_joint(real); preencoded.SetTorqueJoint(i, real); break;
+                default: actuator->set_current_motor(real); preencoded.SetCurrentMotor(i, real); break;
+            }
+        }
+
+        if (bWithGripper)
+        {
+            uint32_t value = RandomUint32(generator);
+            float real = RandomFloat(generator);
+            reference.mutable_interconnect()->mutable_command_id()->set_identifier(value);
+            preencoded.SetInterconnectCommandId(value);
+            reference.mutable_interconnect()->mutable_gripper_command()->mutable_motor_cmd(0)->set_position(real);
+            preencoded.SetGripperMotorPosition(0, real);
+        }
+
+        reference.SerializeToString(&expected);
+        if (preencoded.GetPayload() != expected)
+        {
+            std::cout << "Payload differs from protobuf at iteration " << iteration << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << (bWithGripper ? "with" : "without") << " gripper: " << CHECK_ITERATIONS << " payloads identical to protobuf, "
+              << preencoded.GetReencodeCount() << " re-encodings" << std::endl;
+    return true;
+}
+
+void Benchmark()
+{
+    k_api::BaseCyclic::Command command = CreateCommand(false);
+    PreencodedCyclicCommand preencoded;
+    preencoded.Init(command);
+
+    std::string payload;
+    size_t totalSize = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t tick = 1; tick <= BENCHMARK_ITERATIONS; tick++)
+    {
+        command.set_frame_id(tick);
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            auto actuator = command.mutable_actuators(i);
+            actuator->set_command_id(tick);
+            actuator->set_position(float(tick % 360) + i);
+            actuator->set_torque_joint(0.5f + i);
+        }
+        command.SerializeToString(&payload);
+        totalSize += payload.size();
+    }
+    auto protobufTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t tick = 1; tick <= BENCHMARK_ITERATIONS; tick++)
+    {
+        preencoded.SetFrameId(tick);
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            preencoded.SetCommandId(i, tick);
+            preencoded.SetPosition(i, float(tick % 360) + i);
+            preencoded.SetTorqueJoint(i, 0.5f + i);
+        }
+        totalSize += preencoded.GetPayload().size();
+    }
+    auto preencodedTime = std::chrono::steady_clock::now() - start;
+
+    double protobufNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(protobufTime).count()) / BENCHMARK_ITERATIONS;
+    double preencodedNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(preencodedTime).count()) / BENCHMARK_ITERATIONS;
+    std::cout << "protobuf:    " << protobufNs << " ns/tick" << std::endl;
+    std::cout << "pre-encoded: " << preencodedNs << " ns/tick (" << preencoded.GetReencodeCount() << " re-encodings)" << std::endl;
+    std::cout << "speed-up:    " << protobufNs / preencodedNs << "x" << " (" << totalSize << " bytes)" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    bool success = CheckByteIdentity(false) && CheckByteIdentity(true);
+    if (!success)
+    {
+        return 1;
+    }
+
+    Benchmark();
+    return 0;
+}
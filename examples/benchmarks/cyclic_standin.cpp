@@ -0,0 +1,166 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks CyclicExecutor at 1 kHz over UDP against a SimulatedRobot served by a StandInServer on 127.0.0.1, port 10001
+* as an arm, with the lan then the wifi network profile. No robot needed.
+*
+* For each profile, a session on the UDP channel, then 1000 ticks of BaseCyclic Refresh:
+* 1- Ticks: every tick is done, a Refresh lost by the network times out after 20 ms and the loop goes on.
+* 2- Deadlines: on lan the round trip fits in the period; on wifi it does not, the missed releases are skipped instead
+*    of sent in a burst.
+* 3- Sequence statistics: the frame id of each lost exchange is counted as dropped, nothing is reordered, duplicated or
+*    unknown (the client waits for each feedback), and the errors of the executor are the frames the stand-in dropped.
+* 4- On lan, the UDP peer of the stand-in is removed after the CloseSession.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <BaseCyclicClientRpc.h>
+#include <KDetailedException.h>
+#include <RouterClient.h>
+#include <SessionManager.h>
+#include <TransportClientUdp.h>
+
+#include <CyclicExecutor.h>
+#include <DelayLine.h>
+#include <SimulatedRobot.h>
+#include <StandInServer.h>
+
+#include "BenchmarkCheck.h"
+
+#define ACTUATOR_COUNT 7
+#define PERIOD_US 1000
+#define TICK_COUNT 1000
+#define REFRESH_TIMEOUT_MS 20
+#define PEER_REMOVAL_MS 1500
+
+namespace k_api = Kinova::Api;
+
+bool CheckProfile(const std::string &profileName)
+{
+    std::cout << "--- " << profileName << std::endl;
+    tSimulatedRobotSettings robotSettings;
+    robotSettings.nActuatorCount = ACTUATOR_COUNT;
+    SimulatedRobot robot(robotSettings);
+
+    tStandInSettings settings;
+    tNetworkProfile::FromName(profileName, settings.profile);
+    StandInServer server(&robot, settings);
+    server.Start();
+
+    auto error_callback = [](k_api::KError err){ std::cout << "_________ callback error _________" << err.toString(); };
+    k_api::TransportClientUdp transport;
+    k_api::RouterClient router(&transport, error_callback);
+    transport.connect(settings.address, settings.nUdpPort);
+
+    auto create_session_info = k_api::Session::CreateSessionInfo();
+    create_session_info.set_username("admin");
+    create_session_info.set_password("admin");
+    create_session_info.set_session_inactivity_timeout(60000);   // (milliseconds)
+    //no KeepAlive within the run, the frames dropped by the stand-in are then the ones of the Refresh calls
+    create_session_info.set_connection_inactivity_timeout(60000); // (milliseconds)
+    k_api::SessionManager session_manager(&router);
+    session_manager.CreateSession(create_session_info);
+
+    k_api::BaseCyclic::BaseCyclicClient base_cyclic(&router);
+    k_api::BaseCyclic::Feedback feedback;
+    k_api::BaseCyclic::Command command;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        command.add_actuators();
+    }
+
+    CyclicExecutor executor(&base_cyclic, std::chrono::microseconds(PERIOD_US));
+    executor.SetRefreshTimeout(std::chrono::milliseconds(REFRESH_TIMEOUT_MS));
+    uint64_t nTimeouts = 0;
+    executor.SetRefreshErrorCallback([&nTimeouts](k_api::KBasicException &ex)
+    {
+        auto *pDetailed = dynamic_cast<k_api::KDetailedException*>(&ex);
+        if (pDetailed && pDetailed->getErrorInfo().getError().error_sub_code() == k_api::METHOD_TIMEOUT)
+        {
+            nTimeouts++;
+        }
+    });
+
+    tStandInStatistics before = server.GetStatistics();
+    executor.Run(feedback, command, [](k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command &command)
+    {
+        command.mutable_actuators(0)->set_position(command.actuators(0).position() + 0.01f);
+        return true;
+    }, TICK_COUNT);
+    tStandInStatistics after = server.GetStatistics();
+
+    const tCyclicStatistics &statistics = executor.GetStatistics();
+    const tSequenceStatistics &sequence = statistics.sequence;
+    std::cout << statistics.ToString() << std::endl
+              << "stand-in: frames in " << after.nFramesIn - before.nFramesIn << ", out " << after.nFramesOut - before.nFramesOut
+              << ", dropped " << after.nDropped - before.nDropped << ", reordered " << after.nReordered - before.nReordered << std::endl;
+
+    bool bLossy = settings.profile.lossRatio > 0.0;
+    bool bOk = Check(statistics.nTicks == TICK_COUNT, profileName + ": every tick done");
+    bOk &= Check(statistics.nRefreshErrors == nTimeouts && (bLossy ? nTimeouts > 0 : nTimeouts == 0),
+                 profileName + (bLossy ? ": lost Refresh time out, the loop goes on" : ": no Refresh lost"));
+    bOk &= Check(statistics.nRefreshErrors == after.nDropped - before.nDropped, profileName + ": errors are the frames dropped by the stand-in");
+    if (settings.profile.nLatency_us * 2 < PERIOD_US)
+    {
+        bOk &= Check(statistics.nDeadlineMisses * 20 < TICK_COUNT, profileName + ": round trip within the period");
+    }
+    else
+    {
+        bOk &= Check(statistics.nDeadlineMisses > TICK_COUNT / 2 && statistics.nSkippedPeriods >= statistics.nDeadlineMisses,
+                     profileName + ": missed releases skipped");
+    }
+
+    //the last frame id may be lost with nothing after it to show it
+    bOk &= Check(sequence.nStamped == TICK_COUNT && sequence.nInOrder + statistics.nRefreshErrors == TICK_COUNT,
+                 profileName + ": one feedback in order per Refresh that went through");
+    bOk &= Check(sequence.nDropped <= statistics.nRefreshErrors && sequence.nDropped + 1 >= statistics.nRefreshErrors,
+                 profileName + ": lost exchanges counted as dropped frame ids");
+    bOk &= Check(sequence.nReordered == 0 && sequence.nDuplicates == 0 && sequence.nUnknown == 0,
+                 profileName + ": nothing reordered, duplicated or unknown");
+
+    if (bLossy)
+    {
+        //the CloseSession may be lost as well
+        try
+        {
+            session_manager.CloseSession();
+        }
+        catch (k_api::KDetailedException&)
+        {
+        }
+    }
+    else
+    {
+        session_manager.CloseSession();
+        std::this_thread::sleep_for(std::chrono::milliseconds(PEER_REMOVAL_MS));
+        bOk &= Check(server.GetStatistics().nUdpPeers == 0, profileName + ": UDP peer removed after CloseSession");
+    }
+    transport.disconnect();
+    server.Stop();
+    return bOk;
+}
+
+int main()
+{
+    bool bOk = CheckProfile("lan");
+    bOk = CheckProfile("wifi") && bOk;
+    return bOk ? 0 : 1;
+}
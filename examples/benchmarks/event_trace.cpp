@@ -0,0 +1,248 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times EventTrace, the per-thread rings of trace events, no robot needed.
+*
+* 1- Threads record nested scopes while another one reads the rings: every event read is whole, and once the threads
+*    are done each one has its events, the oldest overwritten when its ring is full.
+* 2- Both dumps: the Chrome JSON has an event per scope, the Perfetto trace a track per thread and its slices nest.
+*    They are written to event_trace.json and event_trace.pftrace, to open in ui.perfetto.dev.
+* 3- Benchmark: the cost of a scope recorded, of a scope while the trace is disabled, and of the KORTEX_TRACE_SCOPE
+*    macro in this build (nothing without -DKORTEX_TRACE=ON).
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CyclicWireFormat.h>
+#include <EventTrace.h>
+
+#include "BenchmarkCheck.h"
+
+#define THREAD_COUNT 4
+#define SCOPES_PER_THREAD 20000
+#define RING_EVENTS 16384
+#define BENCHMARK_ITERATIONS 1000000
+
+static const char *const CATEGORY = "benchmark";
+static const char *const OUTER = "outer";
+static const char *const INNER = "inner";
+
+static bool IsWhole(const EventTrace::tEvent &event)
+{
+    return event.category == CATEGORY && (event.name == OUTER || event.name == INNER) && event.duration_ns < 1000000000;
+}
+
+//the nesting of the slices of each track of a Perfetto trace: depth never below 0 and back to 0 at the end
+static bool CheckPerfetto(const std::string &bytes, size_t &tracks, size_t &slices)
+{
+    using namespace CyclicWire;
+    std::map<uint64_t, int> depths;
+    tracks = 0;
+    slices = 0;
+    const uint8_t *p = reinterpret_cast<const uint8_t*>(bytes.data());
+    const uint8_t *end = p + bytes.size();
+    uint32_t field;
+    int wireType;
+    while (ReadTag(p, end, field, wireType))
+    {
+        const uint8_t *packetEnd;
+        if (field != 1 || !ReadLengthDelimited(p, end, wireType, packetEnd))
+        {
+            return false;
+        }
+        while (ReadTag(p, packetEnd, field, wireType))
+        {
+            if (field == 60)
+            {
+                tracks++;
+            }
+            if (field != 11)
+            {
+                if (!SkipField(p, packetEnd, field, wireType))
+                {
+                    return false;
+                }
+                continue;
+            }
+            const uint8_t *eventEnd;
+            if (!ReadLengthDelimited(p, packetEnd, wireType, eventEnd))
+            {
+                return false;
+            }
+            uint64_t type = 0, track = 0;
+            while (ReadTag(p, eventEnd, field, wireType))
+            {
+                uint64_t value = 0;
+                if (wireType == WIRETYPE_VARINT)
+                {
+                    ReadVarint(p, eventEnd, value);
+                }
+                else if (!SkipField(p, eventEnd, field, wireType))
+                {
+                    return false;
+                }
+                if (field == 9) type = value;
+                if (field == 11) track = value;
+            }
+            if (type == 1)
+            {
+                depths[track]++;
+                slices++;
+            }
+            else if (type == 2 && --depths[track] < 0)
+            {
+                return false;
+            }
+        }
+    }
+    for (const auto &depth : depths)
+    {
+        if (depth.second != 0)
+        {
+            return false;
+        }
+    }
+    return p == end;
+}
+
+int main()
+{
+    bool bOk = true;
+    EventTrace::SetRingEvents(RING_EVENTS);
+    EventTrace::Enable();
+
+    //1- recording threads and a reader
+    std::atomic<bool> bReading(false), bRunning(true);
+    std::atomic<uint64_t> nRead(0), nTorn(0);
+    std::thread reader([&]()
+    {
+        bReading = true;
+        while (bRunning || nRead == 0)
+        {
+            for (const EventTrace::tEvent &event : EventTrace::GetEvents())
+            {
+                nRead++;
+                if (!IsWhole(event))
+                {
+                    nTorn++;
+                }
+            }
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; i++)
+    {
+        threads.emplace_back([i, &bReading]()
+        {
+            while (!bReading)
+            {
+                std::this_thread::yield();
+            }
+            EventTrace::SetThreadName("worker " + std::to_string(i));
+            for (int j = 0; j < SCOPES_PER_THREAD / 2; j++)
+            {
+                EventTrace::Scope outer(CATEGORY, OUTER);
+                EventTrace::Scope inner(CATEGORY, INNER);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    bRunning = false;
+    reader.join();
+    bOk &= Check(nRead > 0 && nTorn == 0, "rings: " + std::to_string(nRead) + " events read while recorded, all whole");
+
+    std::vector<EventTrace::tEvent> events = EventTrace::GetEvents();
+    std::vector<EventTrace::tThread> traced = EventTrace::GetThreads();
+    std::map<uint32_t, size_t> perThread;
+    bool bWhole = true;
+    for (const EventTrace::tEvent &event : events)
+    {
+        perThread[event.threadId]++;
+        bWhole &= IsWhole(event);
+    }
+    bool bRings = traced.size() == THREAD_COUNT && perThread.size() == THREAD_COUNT && bWhole;
+    for (const EventTrace::tThread &thread : traced)
+    {
+        bRings &= perThread[thread.threadId] == RING_EVENTS && thread.nOverwritten == SCOPES_PER_THREAD - RING_EVENTS
+               && thread.name.compare(0, 7, "worker ") == 0;
+    }
+    bOk &= Check(bRings, "rings: the last events of each thread, the oldest overwritten");
+
+    //2- dumps
+    std::ostringstream json;
+    EventTrace::Dump(json, EventTrace::CHROME_JSON);
+    const std::string chrome = json.str();
+    size_t completes = 0;
+    for (size_t position = chrome.find("\"ph\":\"X\""); position != std::string::npos; position = chrome.find("\"ph\":\"X\"", position + 1))
+    {
+        completes++;
+    }
+    bOk &= Check(chrome.compare(0, 15, "{\"displayTimeUn") == 0 && completes == events.size(), "Chrome JSON: an event per scope");
+
+    std::ostringstream perfetto;
+    EventTrace::Dump(perfetto, EventTrace::PERFETTO);
+    size_t tracks, slices;
+    bOk &= Check(CheckPerfetto(perfetto.str(), tracks, slices) && tracks == THREAD_COUNT && slices == events.size(),
+                 "Perfetto: a track per thread, nested slices");
+    bOk &= Check(EventTrace::Dump("event_trace.json") && EventTrace::Dump("event_trace.pftrace"), "dumps written");
+
+    //3- benchmark, on the ring of this thread
+    EventTrace::Clear();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        EventTrace::Scope scope(CATEGORY, INNER);
+    }
+    double enabled_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_ITERATIONS;
+
+    EventTrace::Enable(false);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        EventTrace::Scope scope(CATEGORY, INNER);
+    }
+    double disabled_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_ITERATIONS;
+
+    EventTrace::Enable();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        KORTEX_TRACE_SCOPE(CATEGORY, INNER);
+    }
+    double macro_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_ITERATIONS;
+
+    std::cout << "scope: recorded " << enabled_ns << " ns, disabled " << disabled_ns << " ns, KORTEX_TRACE_SCOPE "
+#if defined(KORTEX_TRACE)
+              << macro_ns << " ns (KORTEX_TRACE on)" << std::endl;
+#else
+              << macro_ns << " ns (KORTEX_TRACE off, compiled out)" << std::endl;
+#endif
+
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Compares Feedback::ParseFromString with the flat decoder of tFlatFeedback, no robot needed.
+*
+* 1- Fuzz equivalence: random feedbacks (optional base, interconnect and gripper, 0 to 8 actuators, zeros, varints of
+*    every length) are serialized by protobuf, decoded flat and converted back. The result must serialize to the same bytes.
+* 2- Mutations: the same payloads truncated or with random bytes overwritten, so with unknown fields and fields of
+*    another wire type than their schema one, must be decoded without reading outside the buffer and give every field
+*    ParseFromString gives, or be refused when it refuses them.
+* 3- Benchmark: decoding a 7 actuator feedback with base and gripper, then reading the positions and torques. Protobuf
+*    is timed parsing into a new Feedback every tick like BaseCyclicClient::Refresh, and into a reused one.
+*
+* The process returns 1 if the check fails.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+
+#include <FlatFeedback.h>
+
+namespace k_api = Kinova::Api;
+
+#define ACTUATOR_COUNT 7
+#define FUZZ_ITERATIONS 100000
+#define MUTATION_ITERATIONS 100000
+#define BENCHMARK_ITERATIONS 1000000
+
+class RandomValues
+{
+public:
+    RandomValues(uint32_t seed) : m_generator(seed) {}
+
+    // Zero (left out of the wire) a quarter of the time, otherwise any varint length
+    uint32_t Uint32()
+    {
+        switch (m_generator() % 4)
+        {
+            case 0: return 0;
+            case 1: return m_generator() % 128;
+            case 2: return m_generator() % 20000;
+            default: return uint32_t(m_generator());
+        }
+    }
+
+    float Float()
+    {
+        if (m_generator() % 4 == 0)
+        {
+            return 0.0f;
+        }
+        return std::uniform_real_distribution<float>(-1000.0f, 1000.0f)(m_generator);
+    }
+
+    bool Chance(int percent) {return int(m_generator() % 100) < percent;}
+    int Below(int limit) {return int(m_generator() % uint32_t(limit));}
+
+private:
+    std::mt19937 m_generator;
+};
+
+void FillBase(k_api::BaseCyclic::BaseFeedback *base, RandomValues &random)
+{
+    base->set_active_state_connection_identifier(random.Uint32());
+    base->set_active_state(k_api::Common::ArmState(random.Below(10)));
+    base->set_arm_voltage(random.Float());
+    base->set_arm_current(random.Float());
+    base->set_temperature_cpu(random.Float());
+    base->set_temperature_ambient(random.Float());
+    base->set_imu_acceleration_x(random.Float());
+    base->set_imu_acceleration_y(random.Float());
+    base->set_imu_acceleration_z(random.Float());
+    base->set_imu_angular_velocity_x(random.Float());
+    base->set_imu_angular_velocity_y(random.Float());
+    base->set_imu_angular_velocity_z(random.Float());
+    base->set_tool_pose_x(random.Float());
+    base->set_tool_pose_y(random.Float());
+    base->set_tool_pose_z(random.Float());
+    base->set_tool_pose_theta_x(random.Float());
+    base->set_tool_pose_theta_y(random.Float());
+    base->set_tool_pose_theta_z(random.Float());
+    base->set_tool_twist_linear_x(random.Float());
+    base->set_tool_twist_linear_y(random.Float());
+    base->set_tool_twist_linear_z(random.Float());
+    base->set_tool_twist_angular_x(random.Float());
+    base->set_tool_twist_angular_y(random.Float());
+    base->set_tool_twist_angular_z(random.Float());
+    base->set_tool_external_wrench_force_x(random.Float());
+    base->set_tool_external_wrench_force_y(random.Float());
+    base->set_tool_external_wrench_force_z(random.Float());
+    base->set_tool_external_wrench_torque_x(random.Float());
+    base->set_tool_external_wrench_torque_y(random.Float());
+    base->set_tool_external_wrench_torque_z(random.Float());
+    base->set_fault_bank_a(random.Uint32());
+    base->set_fault_bank_b(random.Uint32());
+    base->set_warning_bank_a(random.Uint32());
+    base->set_warning_bank_b(random.Uint32());
+    base->set_commanded_tool_pose_x(random.Float());
+    base->set_commanded_tool_pose_y(random.Float());
+    base->set_commanded_tool_pose_z(random.Float());
+    base->set_commanded_tool_pose_theta_x(random.Float());
+    base->set_commanded_tool_pose_theta_y(random.Float());
+    base->set_commanded_tool_pose_theta_z(random.Float());
+}
+
+void FillActuator(k_api::BaseCyclic::ActuatorFeedback *actuator, RandomValues &random)
+{
+    actuator->set_command_id(random.Uint32());
+    actuator->set_status_flags(random.Uint32());
+    actuator->set_jitter_comm(random.Uint32());
+    actuator->set_position(random.Float());
+    actuator->set_velocity(random.Float());
+    actuator->set_torque(random.Float());
+    actuator->set_current_motor(random.Float());
+    actuator->set_voltage(random.Float());
+    actuator->set_temperature_motor(random.Float());
+    actuator->set_temperature_core(random.Float());
+    actuator->set_fault_bank_a(random.Uint32());
+    actuator->set_fault_bank_b(random.Uint32());
+    actuator->set_warning_bank_a(random.Uint32());
+    actuator->set_warning_bank_b(random.Uint32());
+}
+
+void FillInterconnect(k_api::InterconnectCyclic::Feedback *interconnect, RandomValues &random, bool bWithGripper)
+{
+    if (random.Chance(80))
+    {
+        interconnect->mutable_feedback_id()->set_identifier(random.Uint32());
+    }
+    interconnect->set_status_flags(random.Uint32());
+    interconnect->set_jitter_comm(random.Uint32());
+    interconnect->set_imu_acceleration_x(random.Float());
+    interconnect->set_imu_acceleration_y(random.Float());
+    interconnect->set_imu_acceleration_z(random.Float());
+    interconnect->set_imu_angular_velocity_x(random.Float());
+    interconnect->set_imu_angular_velocity_y(random.Float());
+    interconnect->set_imu_angular_velocity_z(random.Float());
+    interconnect->set_voltage(random.Float());
+    interconnect->set_temperature_core(random.Float());
+    interconnect->set_fault_bank_a(random.Uint32());
+    interconnect->set_fault_bank_b(random.Uint32());
+    interconnect->set_warning_bank_a(random.Uint32());
+    interconnect->set_warning_bank_b(random.Uint32());
+
+    if (!bWithGripper)
+    {
+        return;
+    }
+    auto gripper = interconnect->mutable_gripper_feedback();
+    if (random.Chance(80))
+    {
+        gripper->mutable_feedback_id()->set_identifier(random.Uint32());
+    }
+    gripper->set_status_flags(random.Uint32());
+    gripper->set_fault_bank_a(random.Uint32());
+    gripper->set_fault_bank_b(random.Uint32());
+    gripper->set_warning_bank_a(random.Uint32());
+    gripper->set_warning_bank_b(random.Uint32());
+    int motorCount = random.Below(CyclicWire::MAX_GRIPPER_MOTORS + 1);
+    for (int i = 0; i < motorCount; i++)
+    {
+        auto motor = gripper->add_motor();
+        motor->set_motor_id(random.Uint32());
+        motor->set_position(random.Float());
+        motor->set_velocity(random.Float());
+        motor->set_current_motor(random.Float());
+        motor->set_voltage(random.Float());
+        motor->set_temperature_motor(random.Float());
+    }
+}
+
+k_api::BaseCyclic::Feedback RandomFeedback(RandomValues &random)
+{
+    k_api::BaseCyclic::Feedback feedback;
+    feedback.set_frame_id(random.Uint32());
+    if (random.Chance(90))
+    {
+        FillBase(feedback.mutable_base(), random);
+    }
+    int actuatorCount = random.Below(CyclicWire::MAX_ACTUATORS + 1);
+    for (int i = 0; i < actuatorCount; i++)
+    {
+        FillActuator(feedback.add_actuators(), random);
+    }
+    if (random.Chance(80))
+    {
+        FillInterconnect(feedback.mutable_interconnect(), random, random.Chance(70));
+    }
+    return feedback;
+}
+
+bool CheckEquivalence(std::vector<std::string> &payloads)
+{
+    RandomValues random(42);
+    k_api::BaseCyclic::Feedback decoded;
+    tFlatFeedback flat;
+    std::string reencoded;
+
+    for (int iteration = 0; iteration < FUZZ_ITERATIONS; iteration++)
+    {
+        std::string payload = RandomFeedback(random).SerializeAsString();
+        if (!flat.Decode(payload))
+        {
+            std::cout << "Valid payload refused at iteration " << iteration << std::endl;
+            return false;
+        }
+        flat.ToFeedback(decoded);
+        decoded.SerializeToString(&reencoded);
+        if (reencoded != payload)
+        {
+            std::cout << "Flat decoding differs from protobuf at iteration " << iteration << std::endl;
+            return false;
+        }
+        if (iteration < 1000)
+        {
+            payloads.push_back(payload);
+        }
+    }
+    std::cout << FUZZ_ITERATIONS << " random feedbacks decoded like protobuf" << std::endl;
+    return true;
+}
+
+// true if protobuf decoded it and the flat lanes can hold it all
+bool FitsFlat(const k_api::BaseCyclic::Feedback &feedback)
+{
+    return feedback.actuators_size() <= CyclicWire::MAX_ACTUATORS
+        && feedback.interconnect().gripper_feedback().motor_size() <= CyclicWire::MAX_GRIPPER_MOTORS;
+}
+
+bool CheckMutations(const std::vector<std::string> &payloads)
+{
+    RandomValues random(7);
+    tFlatFeedback flat;
+    k_api::BaseCyclic::Feedback parsed;
+    k_api::BaseCyclic::Feedback decoded;
+    int refused = 0;
+
+    for (int iteration = 0; iteration < MUTATION_ITERATIONS; iteration++)
+    {
+        std::string payload = payloads[size_t(random.Below(int(payloads.size())))];
+        if (payload.empty())
+        {
+            continue;
+        }
+        if (random.Chance(30))
+        {
+            payload.resize(size_t(random.Below(int(payload.size()))));
+        }
+        int mutations = 1 + random.Below(4);
+        for (int i = 0; i < mutations && !payload.empty(); i++)
+        {
+            payload[size_t(random.Below(int(payload.size())))] = char(random.Below(256));
+        }
+
+        // a copy sized exactly, so a read past the end shows under a memory checker
+        std::vector<uint8_t> exact(payload.begin(), payload.end());
+        bool bDecoded = flat.Decode(exact.data(), exact.size());
+        bool bParsed = parsed.ParseFromString(payload);
+        if (!bDecoded)
+        {
+            refused++;
+        }
+
+        // every field decoded must be the one protobuf reads, the unknown fields it keeps aside
+        if (bParsed && FitsFlat(parsed))
+        {
+            if (!bDecoded)
+            {
+                std::cout << "Mutated payload parsed by protobuf but refused at iteration " << iteration << std::endl;
+                return false;
+            }
+            parsed.DiscardUnknownFields();
+            flat.ToFeedback(decoded);
+            if (decoded.SerializeAsString() != parsed.SerializeAsString())
+            {
+                std::cout << "Flat decoding differs from protobuf on a mutated payload at iteration " << iteration << std::endl;
+                return false;
+            }
+        }
+        else if (!bParsed && bDecoded)
+        {
+            std::cout << "Mutated payload refused by protobuf but decoded at iteration " << iteration << std::endl;
+            return false;
+        }
+    }
+    std::cout << MUTATION_ITERATIONS << " mutated payloads decoded like protobuf, " << refused << " refused" << std::endl;
+    return true;
+}
+
+void Benchmark()
+{
+    RandomValues random(1);
+    k_api::BaseCyclic::Feedback reference;
+    reference.set_frame_id(1234);
+    FillBase(reference.mutable_base(), random);
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        FillActuator(reference.add_actuators(), random);
+    }
+    FillInterconnect(reference.mutable_interconnect(), random, true);
+    std::string payload = reference.SerializeAsString();
+
+    float sum = 0.0f;
+
+    // BaseCyclicClient::Refresh returns a new Feedback every tick
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        k_api::BaseCyclic::Feedback feedback;
+        feedback.ParseFromString(payload);
+        for (int i = 0; i < feedback.actuators_size(); i++)
+        {
+            sum += feedback.actuators(i).position() + feedback.actuators(i).torque();
+        }
+    }
+    auto freshTime = std::chrono::steady_clock::now() - start;
+
+    k_api::BaseCyclic::Feedback feedback;
+    start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        feedback.ParseFromString(payload);
+        for (int i = 0; i < feedback.actuators_size(); i++)
+        {
+            sum += feedback.actuators(i).position() + feedback.actuators(i).torque();
+        }
+    }
+    auto protobufTime = std::chrono::steady_clock::now() - start;
+
+    tFlatFeedback flat;
+    start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        flat.Decode(payload);
+        for (int i = 0; i < flat.actuators.nCount; i++)
+        {
+            sum += flat.actuators.position[i] + flat.actuators.torque[i];
+        }
+    }
+    auto flatTime = std::chrono::steady_clock::now() - start;
+
+    double freshNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(freshTime).count()) / BENCHMARK_ITERATIONS;
+    double protobufNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(protobufTime).count()) / BENCHMARK_ITERATIONS;
+    double flatNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(flatTime).count()) / BENCHMARK_ITERATIONS;
+    std::cout << "payload:                          " << payload.size() << " bytes" << std::endl;
+    std::cout << "ParseFromString, new Feedback:    " << freshNs << " ns" << std::endl;
+    std::cout << "ParseFromString, reused Feedback: " << protobufNs << " ns" << std::endl;
+    std::cout << "tFlatFeedback::Decode:            " << flatNs << " ns" << std::endl;
+    std::cout << "speed-up:                         " << freshNs / flatNs << "x / " << protobufNs / flatNs << "x"
+              << " (checksum " << sum << ")" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> payloads;
+    if (!CheckEquivalence(payloads))
+    {
+        return 1;
+    }
+    if (!CheckMutations(payloads))
+    {
+        return 1;
+    }
+
+    Benchmark();
+    return 0;
+}
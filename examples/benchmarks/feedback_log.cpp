@@ -0,0 +1,205 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times FeedbackLog, the ring file recorder of BaseCyclic feedbacks, no robot needed.
+*
+* 1- Record 10 s of 1 kHz feedbacks of a 7 DoF arm into a ring of 2 s, paced like a cyclic thread: nothing is dropped
+*    and the reader gets the last 2 s back, field for field, in order.
+* 2- Benchmark, per feedback:
+*    - the cost of Push() on the cyclic thread, against Feedback::SerializeToString and the MessageToJsonString of the
+*      200 example
+*    - the bytes on disk, against the serialized protobuf and the JSON
+*    - the samples per second the writer thread keeps up with
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <google/protobuf/util/json_util.h>
+
+#include <BaseCyclicClientRpc.h>
+
+#include <FeedbackLog.h>
+#include <FlatFeedback.h>
+
+#include "BenchmarkCheck.h"
+
+#define LOG_PATH "feedback_log.kflg"
+#define ACTUATOR_COUNT 7
+#define RATE_HZ 1000
+#define RECORD_SECONDS 10
+#define RING_SECONDS 2
+#define BLOCK_SAMPLES 256
+#define BENCHMARK_ITERATIONS 100000
+
+namespace k_api = Kinova::Api;
+
+//a feedback of the arm moving slowly, different at each tick
+static void FillFeedback(uint32_t tick, k_api::BaseCyclic::Feedback &feedback)
+{
+    feedback.Clear();
+    feedback.set_frame_id(tick & 0xFFFF);
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        auto *pActuator = feedback.add_actuators();
+        float angle = 0.001f * tick + i;
+        pActuator->set_command_id(tick);
+        pActuator->set_status_flags(0x1000 | i);
+        pActuator->set_jitter_comm(100 + tick % 50);
+        pActuator->set_position(180.0f * std::sin(angle));
+        pActuator->set_velocity(10.0f * std::cos(angle));
+        pActuator->set_torque(5.0f * std::sin(2.0f * angle));
+        pActuator->set_current_motor(0.5f + 0.1f * std::sin(angle));
+        pActuator->set_voltage(24.0f);
+        pActuator->set_temperature_motor(35.0f + i);
+        pActuator->set_temperature_core(40.0f + i);
+    }
+    auto *pBase = feedback.mutable_base();
+    pBase->set_active_state(k_api::Common::ARMSTATE_SERVOING_LOW_LEVEL);
+    pBase->set_arm_voltage(24.0f);
+    pBase->set_arm_current(1.5f);
+    pBase->set_imu_acceleration_z(9.81f + 0.01f * std::sin(0.1f * tick));
+    pBase->set_tool_pose_x(0.5f + 0.1f * std::sin(0.001f * tick));
+    pBase->set_tool_pose_y(0.1f * std::cos(0.001f * tick));
+    pBase->set_tool_pose_z(0.4f);
+    pBase->set_tool_pose_theta_x(90.0f);
+    pBase->set_tool_pose_theta_z(0.01f * tick);
+}
+
+int main()
+{
+    bool bOk = true;
+    const uint32_t ringBlocks = (RING_SECONDS * RATE_HZ + BLOCK_SAMPLES - 1) / BLOCK_SAMPLES;
+    const uint32_t total = RECORD_SECONDS * RATE_HZ;
+
+    //1- record at 1 kHz, the wall time is not needed: the writer runs every 10 ms, a 1 s queue is plenty
+    {
+        FeedbackLog::Recorder recorder(ACTUATOR_COUNT);
+        recorder.Open(LOG_PATH, ringBlocks, BLOCK_SAMPLES);
+        k_api::BaseCyclic::Feedback feedback;
+        auto next = std::chrono::steady_clock::now();
+        for (uint32_t tick = 0; tick < total; tick++)
+        {
+            FillFeedback(tick, feedback);
+            recorder.Push(feedback, uint64_t(tick) * 1000000);
+            //paced by 10 ms slices, like a loop at 1 kHz without waiting 10 s
+            if (tick % 10 == 9)
+            {
+                next += std::chrono::microseconds(500);
+                std::this_thread::sleep_until(next);
+            }
+        }
+        recorder.Close();
+        FeedbackLog::tRecorderStatistics statistics = recorder.GetStatistics();
+        bOk &= Check(statistics.nDropped == 0 && statistics.nWritten == total, "recorder: every feedback written");
+    }
+
+    {
+        FeedbackLog::Reader reader;
+        reader.Open(LOG_PATH);
+        const auto &blocks = reader.GetBlocks();
+        const uint32_t kept = (total - 1) % BLOCK_SAMPLES + 1 + (ringBlocks - 1) * BLOCK_SAMPLES;
+        bOk &= Check(blocks.size() == ringBlocks && reader.GetSampleCount() == kept, "reader: the last blocks of the ring");
+
+        bool bSame = true;
+        uint32_t tick = total - kept;
+        k_api::BaseCyclic::Feedback feedback;
+        tFlatFeedback expected;
+        tFlatFeedback read;
+        for (const auto &block : blocks)
+        {
+            for (uint32_t i = 0; i < block.sampleCount; i++, tick++)
+            {
+                FillFeedback(tick, feedback);
+                expected.FromFeedback(feedback);
+                uint64_t time_ns;
+                reader.GetSample(block, i, read, time_ns);
+                bSame &= time_ns == uint64_t(tick) * 1000000 && read.frameId == expected.frameId
+                      && memcmp(&read.actuators, &expected.actuators, sizeof(read.actuators)) == 0
+                      && memcmp(read.base.toolPose, expected.base.toolPose, sizeof(read.base.toolPose)) == 0
+                      && read.base.imuAcceleration[2] == expected.base.imuAcceleration[2];
+            }
+        }
+        bOk &= Check(bSame && tick == total, "reader: same feedbacks, in order");
+    }
+
+    //2- benchmark
+    k_api::BaseCyclic::Feedback feedback;
+    FillFeedback(1234, feedback);
+    tFlatFeedback flat;
+    flat.FromFeedback(feedback);
+
+    std::string serialized;
+    feedback.SerializeToString(&serialized);
+    std::string json;
+    google::protobuf::util::MessageToJsonString(feedback, &json);
+
+    {
+        FeedbackLog::Recorder recorder(ACTUATOR_COUNT, BENCHMARK_ITERATIONS);
+        recorder.Open(LOG_PATH, BENCHMARK_ITERATIONS / BLOCK_SAMPLES + 2, BLOCK_SAMPLES);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+        {
+            recorder.Push(flat, uint64_t(i));
+        }
+        double push_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_ITERATIONS;
+
+        //the writer wakes up every 10 ms and drains the whole queue
+        while (recorder.GetStatistics().nWritten < BENCHMARK_ITERATIONS)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        double drain_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        recorder.Close();
+        bOk &= Check(recorder.GetStatistics().nDropped == 0, "benchmark: no feedback dropped");
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+        {
+            feedback.SerializeToString(&serialized);
+        }
+        double serialize_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_ITERATIONS;
+
+        const int jsonIterations = BENCHMARK_ITERATIONS / 100;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < jsonIterations; i++)
+        {
+            json.clear();
+            google::protobuf::util::MessageToJsonString(feedback, &json);
+        }
+        double json_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / jsonIterations;
+
+        size_t logBytes = 0;
+        for (const FeedbackLog::tColumn &column : recorder.GetColumns())
+        {
+            logBytes += column.type == FeedbackLog::U64 ? 8 : 4;
+        }
+
+        std::cout << "per feedback of " << ACTUATOR_COUNT << " actuators:" << std::endl
+                  << "  FeedbackLog Push      " << push_ns << " ns, " << logBytes << " bytes on disk, "
+                  << recorder.GetColumns().size() << " columns" << std::endl
+                  << "  SerializeToString     " << serialize_ns << " ns, " << serialized.size() << " bytes" << std::endl
+                  << "  MessageToJsonString   " << json_ns << " ns, " << json.size() << " bytes" << std::endl
+                  << "writer thread: " << BENCHMARK_ITERATIONS / drain_s << " feedbacks/s" << std::endl;
+    }
+
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times FeedbackMirror, the seqlock snapshot of the feedback shared by the cyclic thread, no robot needed.
+*
+* 1- Before the first publish nothing can be read, after it the snapshot and the version are the ones published.
+* 2- Torn snapshots: one writer publishes as fast as it can while 3 readers copy the snapshot in a loop. Every word of
+*    a published feedback holds its publish number, so a snapshot mixing two publishes is seen at once. No snapshot
+*    may be torn and a reader never goes back to an older publish.
+* 3- Benchmark: ns per Publish() and per Read() without contention, the cost added to the cyclic thread.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+
+#include <FeedbackMirror.h>
+#include <FlatFeedback.h>
+
+#include "BenchmarkCheck.h"
+
+#define READER_COUNT 3
+#define PUBLISH_COUNT 1000000
+#define BENCHMARK_ITERATIONS 1000000
+
+namespace k_api = Kinova::Api;
+
+static const size_t FEEDBACK_WORDS = sizeof(tFlatFeedback) / sizeof(uint32_t);
+
+//every 32 bit word of the feedback, padding included, set to the publish number
+static void FillFeedback(uint32_t nPublish, tFlatFeedback &feedback)
+{
+    unsigned char *bytes = reinterpret_cast<unsigned char*>(&feedback);
+    for (size_t i = 0; i < FEEDBACK_WORDS; i++)
+    {
+        memcpy(bytes + i * sizeof(nPublish), &nPublish, sizeof(nPublish));
+    }
+}
+
+//the publish number of a whole snapshot, false if its words come from different publishes
+static bool GetPublish(const tFlatFeedback &feedback, uint32_t &nPublish)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&feedback);
+    memcpy(&nPublish, bytes, sizeof(nPublish));
+    for (size_t i = 1; i < FEEDBACK_WORDS; i++)
+    {
+        uint32_t word;
+        memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+        if (word != nPublish)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct tReaderResult
+{
+    uint64_t nReads;
+    uint64_t nTorn;
+    uint64_t nBackwards;
+};
+
+static void ReaderLoop(const FeedbackMirror &mirror, const std::atomic<bool> &bRunning, tReaderResult &result)
+{
+    std::unique_ptr<tFlatFeedback> pSnapshot(new tFlatFeedback);
+    uint32_t nLast = 0;
+    result = tReaderResult();
+    //at least one read after the writer stopped, on a single core the readers may not run before
+    do
+    {
+        if (!mirror.Read(*pSnapshot))
+        {
+            continue;
+        }
+        result.nReads++;
+        uint32_t nPublish;
+        if (!GetPublish(*pSnapshot, nPublish))
+        {
+            result.nTorn++;
+            continue;
+        }
+        if (nPublish < nLast)
+        {
+            result.nBackwards++;
+        }
+        nLast = nPublish;
+    }
+    while (bRunning || result.nReads == 0);
+}
+
+bool CheckFirstPublish()
+{
+    FeedbackMirror mirror;
+    std::unique_ptr<tFlatFeedback> pFeedback(new tFlatFeedback);
+    std::unique_ptr<tFlatFeedback> pSnapshot(new tFlatFeedback);
+    bool bOk = Check(!mirror.Read(*pSnapshot) && !mirror.TryRead(*pSnapshot) && mirror.GetVersion() == 0, "nothing to read before the first publish");
+
+    k_api::BaseCyclic::Feedback feedback;
+    feedback.set_frame_id(42);
+    feedback.add_actuators()->set_position(12.5f);
+    mirror.Publish(feedback);
+    uint64_t nPublishTime_ns = 0;
+    bOk &= Check(mirror.Read(*pSnapshot, &nPublishTime_ns) && pSnapshot->frameId == 42 && pSnapshot->actuators.nCount == 1
+                 && pSnapshot->actuators.position[0] == 12.5f && nPublishTime_ns != 0 && mirror.GetVersion() == 1,
+                 "protobuf feedback published");
+
+    FillFeedback(7, *pFeedback);
+    mirror.Publish(*pFeedback);
+    uint32_t nPublish = 0;
+    bOk &= Check(mirror.TryRead(*pSnapshot) && GetPublish(*pSnapshot, nPublish) && nPublish == 7 && mirror.GetVersion() == 2,
+                 "flat feedback published");
+    return bOk;
+}
+
+bool CheckTornSnapshots()
+{
+    FeedbackMirror mirror;
+    std::unique_ptr<tFlatFeedback> pFeedback(new tFlatFeedback);
+    std::atomic<bool> bRunning(true);
+    std::vector<tReaderResult> results(READER_COUNT);
+    std::vector<std::thread> readers;
+
+    FillFeedback(0, *pFeedback);
+    mirror.Publish(*pFeedback);
+    for (int i = 0; i < READER_COUNT; i++)
+    {
+        readers.emplace_back(ReaderLoop, std::cref(mirror), std::cref(bRunning), std::ref(results[i]));
+    }
+    for (uint32_t nPublish = 1; nPublish <= PUBLISH_COUNT; nPublish++)
+    {
+        FillFeedback(nPublish, *pFeedback);
+        mirror.Publish(*pFeedback);
+    }
+    bRunning = false;
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+
+    tReaderResult total = tReaderResult();
+    for (const auto &result : results)
+    {
+        total.nReads += result.nReads;
+        total.nTorn += result.nTorn;
+        total.nBackwards += result.nBackwards;
+    }
+    std::cout << PUBLISH_COUNT << " publishes, " << READER_COUNT << " readers: " << total.nReads << " reads, "
+              << total.nTorn << " torn, " << total.nBackwards << " backwards" << std::endl;
+    bool bOk = Check(total.nTorn == 0, "no torn snapshot");
+    bOk &= Check(total.nBackwards == 0, "readers never go back to an older publish");
+    return Check(mirror.GetVersion() == PUBLISH_COUNT + 1, "every publish counted") && bOk;
+}
+
+void Benchmark()
+{
+    FeedbackMirror mirror;
+    std::unique_ptr<tFlatFeedback> pFeedback(new tFlatFeedback);
+    std::unique_ptr<tFlatFeedback> pSnapshot(new tFlatFeedback);
+    FillFeedback(1, *pFeedback);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        pFeedback->frameId = i;
+        mirror.Publish(*pFeedback);
+    }
+    auto published = std::chrono::steady_clock::now();
+    uint64_t nSink = 0;
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        mirror.Read(*pSnapshot);
+        nSink += pSnapshot->frameId;
+    }
+    auto read = std::chrono::steady_clock::now();
+
+    std::cout << "tFlatFeedback of " << sizeof(tFlatFeedback) << " bytes:" << std::endl
+              << "  Publish: " << std::chrono::duration<double, std::nano>(published - start).count() / BENCHMARK_ITERATIONS << " ns" << std::endl
+              << "  Read:    " << std::chrono::duration<double, std::nano>(read - published).count() / BENCHMARK_ITERATIONS << " ns" << std::endl
+              << "(" << nSink << ")" << std::endl;
+}
+
+int main()
+{
+    bool bOk = CheckFirstPublish();
+    bOk = CheckTornSnapshots() && bOk;
+    Benchmark();
+    return bOk ? 0 : 1;
+}
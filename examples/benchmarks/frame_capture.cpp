@@ -0,0 +1,164 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times RecordingTransport and ReplayTransport against SimulatedRobot, no robot needed.
+*
+* 1- Record: a session and a 1 kHz BaseCyclic Refresh loop through a RecordingTransport over a LoopbackTransport.
+* 2- Replay the capture to a new RouterClient, the same calls get the same feedbacks, bit for bit, and send the same
+*    bytes:
+*    - as fast as possible
+*    - with the original timing, which takes as long as the recording
+* 3- Benchmark: ns per record appended to a capture and read back, for the size of a 7 DoF feedback.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+#include <RouterClient.h>
+#include <SessionManager.h>
+
+#include <FrameCapture.h>
+#include <LoopbackTransport.h>
+#include <RecordingTransport.h>
+#include <ReplayTransport.h>
+#include <SimulatedRobot.h>
+
+#include "BenchmarkCheck.h"
+
+#define CAPTURE_PATH "frame_capture.kcap"
+#define BENCHMARK_PATH "frame_capture_benchmark.kcap"
+#define ACTUATOR_COUNT 7
+#define RATE_HZ 1000
+#define REFRESH_COUNT 1000
+#define BENCHMARK_RECORDS 1000000
+#define END_TIMEOUT_MS 5000
+
+namespace k_api = Kinova::Api;
+
+//the calls of the capture: a session, then REFRESH_COUNT refreshes paced at RATE_HZ when bPaced
+static void RunSession(k_api::ITransportClient *pTransport, bool bPaced, std::vector<std::string> &feedbacks)
+{
+    auto error_callback = [](k_api::KError err){ std::cout << "_________ callback error _________" << err.toString(); };
+    k_api::RouterClient router(pTransport, error_callback);
+    pTransport->connect("simulated", 10001);
+
+    auto create_session_info = k_api::Session::CreateSessionInfo();
+    create_session_info.set_username("admin");
+    create_session_info.set_password("admin");
+    create_session_info.set_session_inactivity_timeout(60000);   // (milliseconds)
+    //long enough for no KeepAlive within the run, the replay would get it at another time
+    create_session_info.set_connection_inactivity_timeout(60000); // (milliseconds)
+    k_api::SessionManager session_manager(&router);
+    session_manager.CreateSession(create_session_info);
+
+    k_api::BaseCyclic::BaseCyclicClient base_cyclic(&router);
+    k_api::BaseCyclic::Command command;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        command.add_actuators()->set_position(10.0f * i);
+    }
+
+    feedbacks.clear();
+    auto next = std::chrono::steady_clock::now();
+    for (int i = 0; i < REFRESH_COUNT; i++)
+    {
+        command.set_frame_id(i);
+        feedbacks.push_back(base_cyclic.Refresh(command).SerializeAsString());
+        if (bPaced)
+        {
+            next += std::chrono::microseconds(1000000 / RATE_HZ);
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    session_manager.CloseSession();
+    pTransport->disconnect();
+}
+
+static bool CheckReplay(ReplayTransport::eTiming timing, const std::vector<std::string> &recorded, double recordedMs, const char *name)
+{
+    ReplayTransport replay(CAPTURE_PATH, timing);
+    std::vector<std::string> replayed;
+    auto start = std::chrono::steady_clock::now();
+    RunSession(&replay, false, replayed);
+    double replayedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << name << ": " << replayedMs << " ms for " << recordedMs << " ms recorded" << std::endl;
+    bool bOk = Check(replayed == recorded, "same calls, same feedbacks");
+    bOk = Check(replay.GetMismatchCount() == 0 && replay.GetSentCount() == replay.GetCapturedSendCount(), "same sends") && bOk;
+    bOk = Check(replay.WaitForEnd(std::chrono::milliseconds(END_TIMEOUT_MS)), "whole capture played") && bOk;
+    if (timing == ReplayTransport::ORIGINAL_TIMING)
+    {
+        bOk = Check(replayedMs > 0.9 * recordedMs, "original timing takes as long as the recording") && bOk;
+    }
+    return bOk;
+}
+
+int main(int argc, char **argv)
+{
+    tSimulatedRobotSettings settings;
+    settings.nActuatorCount = ACTUATOR_COUNT;
+    SimulatedRobot robot(settings);
+    LoopbackTransport loopback(&robot);
+
+    std::vector<std::string> recorded;
+    double recordedMs = 0.0;
+    uint64_t nRecords = 0;
+    {
+        RecordingTransport recording(&loopback, CAPTURE_PATH);
+        auto start = std::chrono::steady_clock::now();
+        RunSession(&recording, true, recorded);
+        recordedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        nRecords = recording.GetRecordCount();
+        std::cout << "Recorded " << nRecords << " buffers, " << recording.GetLostCount() << " lost" << std::endl;
+    }
+    bool bOk = Check(recorded.size() == REFRESH_COUNT && nRecords >= 2 * REFRESH_COUNT, "capture recorded");
+    bOk = CheckReplay(ReplayTransport::AS_FAST_AS_POSSIBLE, recorded, recordedMs, "As fast as possible") && bOk;
+    bOk = CheckReplay(ReplayTransport::ORIGINAL_TIMING, recorded, recordedMs, "Original timing") && bOk;
+
+    const std::string &feedback = recorded.back();
+    FrameCapture::Writer writer;
+    writer.Open(BENCHMARK_PATH, uint32_t(loopback.getMaxTxBufferSize()));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_RECORDS; i++)
+    {
+        writer.Append(FrameCapture::RX, feedback.data(), uint32_t(feedback.size()));
+    }
+    double appendNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_RECORDS;
+    writer.Close();
+
+    FrameCapture::Reader reader;
+    reader.Open(BENCHMARK_PATH);
+    FrameCapture::tRecord record;
+    uint64_t nRead = 0;
+    uint64_t nBytes = 0;
+    start = std::chrono::steady_clock::now();
+    while (reader.Next(record))
+    {
+        nRead++;
+        nBytes += record.size;
+    }
+    double readNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_RECORDS;
+    bOk = Check(nRead == BENCHMARK_RECORDS && nBytes == uint64_t(BENCHMARK_RECORDS) * feedback.size(), "records read back") && bOk;
+
+    std::cout << "Record of " << feedback.size() << " bytes: append " << appendNs << " ns, read " << readNs << " ns" << std::endl;
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,556 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Microbenchmarks of the hot paths of the API under every call, no robot needed:
+*    - HeaderInfo from a Header and fillHeader
+*    - Frame serialize and parse, with the payload of a 7 DoF feedback
+*    - BaseCyclic::Command serialize and BaseCyclic::Feedback parse
+*    - KinovaTcpUtilities::PrependHeader and ParseBufferHeader of the TCP transport
+*    - NotificationHandler::call dispatch, to a callback and to none
+*
+* For stable numbers to track from release to release, each benchmark is calibrated to batches of at least
+* MIN_BATCH_MS, then timed over --repetitions batches: the median and the minimum ns/op are reported, with the heap
+* allocations per op counted by the operator new of this executable. --csv writes the same table to a file.
+*
+* The process returns 1 if a benchmark does not do its work (a parse failing, a callback not called).
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <BaseClientRpc.h>
+#include <BaseCyclicClientRpc.h>
+#include <HeaderInfo.h>
+#include <KinovaTcpUtilities.h>
+#include <NotificationHandler.h>
+
+namespace k_api = Kinova::Api;
+
+#define ACTUATOR_COUNT 7
+#define MIN_BATCH_MS 20
+#define MAX_BATCH_ITERATIONS (1u << 26)
+#define CALLBACK_TIMEOUT_MS 1000
+
+static std::atomic<uint64_t> g_nAllocations(0);
+
+//kept out of line: gcc pairs the new and delete calls it sees, and reports a malloc or a free inlined on one side only
+#if defined(__GNUC__)
+#define REPLACED_OPERATOR __attribute__((noinline))
+#else
+#define REPLACED_OPERATOR
+#endif
+
+REPLACED_OPERATOR void* operator new(size_t size)
+{
+    g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+REPLACED_OPERATOR void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+REPLACED_OPERATOR void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+REPLACED_OPERATOR void* operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+REPLACED_OPERATOR void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete(void *p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete[](void *p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+#if defined(__cpp_aligned_new)
+REPLACED_OPERATOR void* operator new(size_t size, std::align_val_t alignment)
+{
+    g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = nullptr;
+    if (posix_memalign(&p, std::max(size_t(alignment), sizeof(void*)), size ? size : 1) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+REPLACED_OPERATOR void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+REPLACED_OPERATOR void operator delete(void *p, std::align_val_t) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete[](void *p, std::align_val_t) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete(void *p, size_t, std::align_val_t) noexcept
+{
+    free(p);
+}
+
+REPLACED_OPERATOR void operator delete[](void *p, size_t, std::align_val_t) noexcept
+{
+    free(p);
+}
+#endif
+
+//keeps the results of the loops alive
+static volatile uint64_t g_sink;
+
+struct tResult
+{
+    std::string name;
+    uint64_t nIterations;       //per batch
+    double medianNs;
+    double minNs;
+    double allocations;         //per op
+};
+
+//body(n) does n ops
+static tResult Measure(const std::string &name, int repetitions, const std::function<void(uint64_t)> &body)
+{
+    tResult result;
+    result.name = name;
+
+    uint64_t n = 1;
+    while (true)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body(n);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed >= std::chrono::milliseconds(MIN_BATCH_MS) || n >= MAX_BATCH_ITERATIONS)
+        {
+            break;
+        }
+        n *= 2;
+    }
+    result.nIterations = n;
+
+    std::vector<double> ns;
+    uint64_t allocations = g_nAllocations.load();
+    for (int repetition = 0; repetition < repetitions; repetition++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body(n);
+        ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n);
+    }
+    allocations = g_nAllocations.load() - allocations;
+
+    std::sort(ns.begin(), ns.end());
+    result.medianNs = ns[ns.size() / 2];
+    result.minNs = ns.front();
+    result.allocations = double(allocations) / (double(n) * repetitions);
+    return result;
+}
+
+static k_api::BaseCyclic::Command CreateCommand()
+{
+    k_api::BaseCyclic::Command command;
+    command.set_frame_id(1);
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        auto actuator = command.add_actuators();
+        actuator->set_command_id(1);
+        actuator->set_position(10.0f * i + 0.5f);
+        actuator->set_velocity(1.5f);
+        actuator->set_torque_joint(0.25f * i);
+    }
+    auto motor = command.mutable_interconnect()->mutable_gripper_command()->add_motor_cmd();
+    motor->set_position(50.0f);
+    motor->set_velocity(100.0f);
+    motor->set_force(20.0f);
+    return command;
+}
+
+static k_api::BaseCyclic::Feedback CreateFeedback()
+{
+    k_api::BaseCyclic::Feedback feedback;
+    feedback.set_frame_id(1);
+    auto base = feedback.mutable_base();
+    base->set_active_state(k_api::Common::ARMSTATE_SERVOING_LOW_LEVEL);
+    base->set_tool_pose_x(0.45f);
+    base->set_tool_pose_y(0.01f);
+    base->set_tool_pose_z(0.43f);
+    base->set_arm_voltage(24.1f);
+    base->set_arm_current(1.3f);
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        auto actuator = feedback.add_actuators();
+        actuator->set_command_id(1);
+        actuator->set_status_flags(0x10001);
+        actuator->set_position(10.0f * i + 0.5f);
+        actuator->set_velocity(0.1f * i);
+        actuator->set_torque(1.5f * i - 4.0f);
+        actuator->set_current_motor(0.3f * i);
+        actuator->set_voltage(24.0f);
+        actuator->set_temperature_motor(31.5f);
+        actuator->set_temperature_core(38.0f);
+    }
+    auto motor = feedback.mutable_interconnect()->mutable_gripper_feedback()->add_motor();
+    motor->set_position(50.0f);
+    motor->set_current_motor(0.05f);
+    return feedback;
+}
+
+static k_api::HeaderInfo CreateHeaderInfo(int frameType, uint32_t functionUid, uint32_t payloadLength)
+{
+    k_api::HeaderInfo header;
+    header.m_frameInfo.frame_info = 0;
+    header.m_frameInfo.frameType = frameType;
+    header.m_frameInfo.headerVersion = k_api::CURRENT_VERSION;
+    header.m_messageInfo.message_info = 0;
+    header.m_messageInfo.sessionId = 1;
+    header.m_messageInfo.messageId = 1;
+    header.m_serviceInfo.service_info = 0;
+    header.m_serviceInfo.functionUid = functionUid;
+    header.m_serviceInfo.serviceVersion = 1;
+    header.m_payloadInfo.payload_info = 0;
+    header.m_payloadInfo.payloadLength = payloadLength;
+    return header;
+}
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options(argv[0], "Microbenchmarks of the Kortex API hot paths");
+    options.add_options()
+        ("filter", "Only the benchmarks whose name contains this", cxxopts::value<std::string>()->default_value(""))
+        ("repetitions", "Timed batches per benchmark", cxxopts::value<int>()->default_value("9"))
+        ("csv", "File to write the results to", cxxopts::value<std::string>())
+        ("h,help", "Print usage");
+
+    std::string filter;
+    std::string csvPath;
+    int repetitions;
+    try
+    {
+        auto parsed = options.parse(argc, argv);
+        if (parsed.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        filter = parsed["filter"].as<std::string>();
+        repetitions = std::max(1, parsed["repetitions"].as<int>());
+        if (parsed.count("csv"))
+        {
+            csvPath = parsed["csv"].as<std::string>();
+        }
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    bool bOk = true;
+    std::vector<tResult> results;
+    auto run = [&](const std::string &name, const std::function<void(uint64_t)> &body)
+    {
+        if (name.find(filter) == std::string::npos)
+        {
+            return;
+        }
+        results.push_back(Measure(name, repetitions, body));
+        const tResult &result = results.back();
+        std::cout << std::left << std::setw(40) << result.name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(12) << result.medianNs
+                  << std::setw(12) << result.minNs
+                  << std::setprecision(2) << std::setw(12) << result.allocations << std::endl;
+    };
+
+    const k_api::BaseCyclic::Command command = CreateCommand();
+    const k_api::BaseCyclic::Feedback feedback = CreateFeedback();
+    const std::string commandPayload = command.SerializeAsString();
+    const std::string feedbackPayload = feedback.SerializeAsString();
+
+    k_api::Frame feedbackFrame;
+    CreateHeaderInfo(k_api::MSG_FRAME_RESPONSE, k_api::BaseCyclic::eUidRefresh, uint32_t(feedbackPayload.size()))
+        .fillHeader(feedbackFrame.mutable_header());
+    feedbackFrame.set_payload(feedbackPayload);
+    const std::string feedbackFrameBytes = feedbackFrame.SerializeAsString();
+
+    std::cout << "Command payload " << commandPayload.size() << " bytes, feedback payload " << feedbackPayload.size()
+              << " bytes, feedback frame " << feedbackFrameBytes.size() << " bytes" << std::endl << std::endl;
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "median ns"
+              << std::setw(12) << "min ns" << std::setw(12) << "allocs/op" << std::endl;
+
+    run("header_info/from_header", [&](uint64_t n)
+    {
+        const k_api::Header &header = feedbackFrame.header();
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            k_api::HeaderInfo info(header);
+            sum += info.m_serviceInfo.functionUid;
+        }
+        g_sink = sum;
+    });
+
+    run("header_info/fill_header", [&](uint64_t n)
+    {
+        k_api::HeaderInfo info = CreateHeaderInfo(k_api::MSG_FRAME_REQUEST, k_api::BaseCyclic::eUidRefresh, 0);
+        k_api::Header header;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            info.m_messageInfo.messageId = uint32_t(i);
+            info.fillHeader(&header);
+        }
+        g_sink = header.message_info();
+    });
+
+    //like the router: a new frame per call, serialized into the buffer of the transport
+    run("frame/serialize_to_array", [&](uint64_t n)
+    {
+        std::vector<char> buffer(feedbackFrameBytes.size() * 2);
+        k_api::HeaderInfo info = CreateHeaderInfo(k_api::MSG_FRAME_REQUEST, k_api::BaseCyclic::eUidRefresh,
+                                                  uint32_t(commandPayload.size()));
+        size_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            k_api::Frame frame;
+            info.fillHeader(frame.mutable_header());
+            frame.set_payload(commandPayload);
+            int size = frame.ByteSize();
+            frame.SerializeToArray(buffer.data(), size);
+            sum += size_t(size);
+        }
+        g_sink = sum;
+    });
+
+    run("frame/parse_from_array_new", [&](uint64_t n)
+    {
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            k_api::Frame frame;
+            if (!frame.ParseFromArray(feedbackFrameBytes.data(), int(feedbackFrameBytes.size())))
+            {
+                bOk = false;
+            }
+            sum += frame.payload().size();
+        }
+        g_sink = sum;
+    });
+
+    run("frame/parse_from_array_reused", [&](uint64_t n)
+    {
+        k_api::Frame frame;
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            if (!frame.ParseFromArray(feedbackFrameBytes.data(), int(feedbackFrameBytes.size())))
+            {
+                bOk = false;
+            }
+            sum += frame.payload().size();
+        }
+        g_sink = sum;
+    });
+
+    run("base_cyclic/command_serialize", [&](uint64_t n)
+    {
+        k_api::BaseCyclic::Command tick = command;
+        std::string payload;
+        size_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            tick.set_frame_id(uint32_t(i));
+            tick.mutable_actuators(0)->set_position(float(i % 360));
+            tick.SerializeToString(&payload);
+            sum += payload.size();
+        }
+        g_sink = sum;
+    });
+
+    //like BaseCyclicClient::Refresh, a new feedback per call
+    run("base_cyclic/feedback_parse_new", [&](uint64_t n)
+    {
+        float sum = 0.0f;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            k_api::BaseCyclic::Feedback decoded;
+            if (!decoded.ParseFromString(feedbackPayload))
+            {
+                bOk = false;
+            }
+            sum += decoded.actuators(ACTUATOR_COUNT - 1).position();
+        }
+        g_sink = uint64_t(sum);
+    });
+
+    run("base_cyclic/feedback_parse_reused", [&](uint64_t n)
+    {
+        k_api::BaseCyclic::Feedback decoded;
+        float sum = 0.0f;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            if (!decoded.ParseFromString(feedbackPayload))
+            {
+                bOk = false;
+            }
+            sum += decoded.actuators(ACTUATOR_COUNT - 1).position();
+        }
+        g_sink = uint64_t(sum);
+    });
+
+    KinovaTcpUtilities tcpUtilities;
+    run("tcp/prepend_header", [&](uint64_t n)
+    {
+        std::vector<uint8_t> buffer(tcpUtilities.KINOVA_HEADER_SIZE + feedbackFrameBytes.size());
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            tcpUtilities.PrependHeader(buffer.data(), uint32_t(feedbackFrameBytes.size()));
+            sum += buffer[tcpUtilities.KINOVA_HEADER_SIZE - 1];
+        }
+        g_sink = sum;
+    });
+
+    run("tcp/parse_buffer_header", [&](uint64_t n)
+    {
+        std::vector<uint8_t> buffer(tcpUtilities.KINOVA_HEADER_SIZE + feedbackFrameBytes.size());
+        tcpUtilities.PrependHeader(buffer.data(), uint32_t(feedbackFrameBytes.size()));
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            sum += tcpUtilities.ParseBufferHeader(buffer.data());
+        }
+        g_sink = sum;
+        if (sum != n * feedbackFrameBytes.size())
+        {
+            bOk = false;
+        }
+    });
+
+    //keyed on the function uid of the topic, like the notifications of the base; each call runs its callback in a
+    //detached thread, the batch waits for all of them
+    k_api::Base::ActionNotification action;
+    action.set_action_event(k_api::Base::ACTION_END);
+    action.mutable_handle()->set_identifier(2);
+    action.mutable_handle()->set_action_type(k_api::Base::REACH_JOINT_ANGLES);
+    k_api::Frame notificationFrame;
+    CreateHeaderInfo(k_api::MSG_FRAME_NOTIFICATION, k_api::Base::eUidActionTopic, uint32_t(action.ByteSize()))
+        .fillHeader(notificationFrame.mutable_header());
+    notificationFrame.set_payload(action.SerializeAsString());
+
+    std::atomic<uint64_t> nCallbacks(0);
+    k_api::NotificationHandler handler;
+    handler.addCallback<k_api::Base::ActionNotification>(k_api::Base::eUidActionTopic,
+        [&nCallbacks](k_api::Base::ActionNotification) {nCallbacks++;});
+
+    run("notification/call_to_callback", [&](uint64_t n)
+    {
+        uint64_t expected = nCallbacks + n;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            handler.call(notificationFrame);
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CALLBACK_TIMEOUT_MS);
+        while (nCallbacks < expected && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+        if (nCallbacks < expected)
+        {
+            bOk = false;
+        }
+    });
+
+    k_api::NotificationHandler emptyHandler;
+    run("notification/call_no_callback", [&](uint64_t n)
+    {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            emptyHandler.call(notificationFrame);
+        }
+    });
+
+    if (!csvPath.empty())
+    {
+        std::ofstream csv(csvPath);
+        csv << "benchmark,iterations,median_ns,min_ns,allocations_per_op" << std::endl;
+        for (const tResult &result : results)
+        {
+            csv << result.name << "," << result.nIterations << "," << result.medianNs << "," << result.minNs << ","
+                << result.allocations << std::endl;
+        }
+        if (!csv)
+        {
+            std::cerr << "Cannot write " << csvPath << std::endl;
+            bOk = false;
+        }
+    }
+
+    if (!bOk)
+    {
+        std::cout << "FAILED: a benchmark did not do its work" << std::endl;
+    }
+    return bOk ? 0 : 1;
+}
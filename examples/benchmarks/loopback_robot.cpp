@@ -0,0 +1,203 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times a RouterClient running over a LoopbackTransport against an in-process SimulatedRobot, no robot
+* needed. The robot follows the BaseCyclic commands ideally (bIdealTracking).
+*
+* 1- Session: CreateSession is refused with a wrong password and accepted with the right one.
+* 2- Base RPCs: GetArmState, SetServoingMode then GetServoingMode, GetMeasuredJointAngles.
+* 3- BaseCyclic Refresh: the feedback carries the frame id and the positions of the command, for every actuator.
+* 4- Disconnect and reconnect: the robot forgets the session of the transport (CloseSession is then refused), the
+*    counters of the transport restart, a new session is created and the state of the robot was kept.
+* 5- Benchmark: round trip of a Base RPC and of a BaseCyclic Refresh through the router and the loopback.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <BaseClientRpc.h>
+#include <BaseCyclicClientRpc.h>
+#include <KDetailedException.h>
+#include <RouterClient.h>
+#include <SessionClientRpc.h>
+#include <SessionManager.h>
+
+#include <LatencyHistogram.h>
+#include <LoopbackTransport.h>
+#include <SimulatedRobot.h>
+
+#include "BenchmarkCheck.h"
+
+#define ACTUATOR_COUNT 7
+#define ITERATIONS 10000
+
+namespace k_api = Kinova::Api;
+
+//sub error code of a refused RPC, SUB_ERROR_NONE if it went through
+template <typename Function>
+static k_api::SubErrorCodes SubErrorOf(Function function)
+{
+    try
+    {
+        function();
+    }
+    catch (k_api::KDetailedException &ex)
+    {
+        return k_api::SubErrorCodes(ex.getErrorInfo().getError().error_sub_code());
+    }
+    return k_api::SUB_ERROR_NONE;
+}
+
+static k_api::Session::CreateSessionInfo SessionInfo(const std::string &password)
+{
+    auto create_session_info = k_api::Session::CreateSessionInfo();
+    create_session_info.set_username("admin");
+    create_session_info.set_password(password);
+    create_session_info.set_session_inactivity_timeout(60000);   // (milliseconds)
+    create_session_info.set_connection_inactivity_timeout(60000); // (milliseconds)
+    return create_session_info;
+}
+
+//a command to the positions of the feedback, moved by offset degrees
+static k_api::BaseCyclic::Command CommandFrom(const k_api::BaseCyclic::Feedback &feedback, float offset, uint32_t frameId)
+{
+    k_api::BaseCyclic::Command command;
+    command.set_frame_id(frameId);
+    for (int i = 0; i < feedback.actuators_size(); i++)
+    {
+        auto *pActuator = command.add_actuators();
+        pActuator->set_command_id(frameId);
+        pActuator->set_position(feedback.actuators(i).position() + offset);
+    }
+    return command;
+}
+
+static bool FollowsCommand(const k_api::BaseCyclic::Feedback &feedback, const k_api::BaseCyclic::Command &command)
+{
+    if (feedback.frame_id() != command.frame_id() || feedback.actuators_size() != command.actuators_size())
+    {
+        return false;
+    }
+    for (int i = 0; i < command.actuators_size(); i++)
+    {
+        if (feedback.actuators(i).position() != command.actuators(i).position())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    bool bOk = true;
+    auto error_callback = [](k_api::KError err){ std::cout << "_________ callback error _________" << err.toString(); };
+
+    tSimulatedRobotSettings settings;
+    settings.nActuatorCount = ACTUATOR_COUNT;
+    settings.bIdealTracking = true;
+    SimulatedRobot robot(settings);
+
+    LoopbackTransport transport(&robot);
+    k_api::RouterClient router(&transport, error_callback);
+    if (!Check(transport.connect("simulated", 10000), "transport connected"))
+    {
+        return 1;
+    }
+
+    //1- session
+    std::unique_ptr<k_api::SessionManager> pSessionManager(new k_api::SessionManager(&router));
+    bOk &= Check(SubErrorOf([&]() {pSessionManager->CreateSession(SessionInfo("wrong"));}) == k_api::INVALID_PASSWORD,
+                 "session: refused with a wrong password");
+    if (!Check(SubErrorOf([&]() {pSessionManager->CreateSession(SessionInfo("admin"));}) == k_api::SUB_ERROR_NONE,
+               "session: created"))
+    {
+        return 1;
+    }
+
+    //2- Base RPCs
+    k_api::Base::BaseClient base(&router);
+    k_api::BaseCyclic::BaseCyclicClient baseCyclic(&router);
+    k_api::Session::SessionClient session(&router);
+    try
+    {
+        bOk &= Check(base.GetArmState().active_state() == k_api::Common::ARMSTATE_SERVOING_READY,
+                     "base: GetArmState, servoing ready");
+        k_api::Base::ServoingModeInformation servoingMode;
+        servoingMode.set_servoing_mode(k_api::Base::LOW_LEVEL_SERVOING);
+        base.SetServoingMode(servoingMode);
+        bOk &= Check(base.GetServoingMode().servoing_mode() == k_api::Base::LOW_LEVEL_SERVOING,
+                     "base: SetServoingMode then GetServoingMode");
+        bOk &= Check(base.GetMeasuredJointAngles().joint_angles_size() == ACTUATOR_COUNT,
+                     "base: GetMeasuredJointAngles, one angle per actuator");
+
+        //3- BaseCyclic Refresh
+        k_api::BaseCyclic::Feedback feedback = baseCyclic.RefreshFeedback();
+        bOk &= Check(feedback.actuators_size() == ACTUATOR_COUNT, "cyclic: RefreshFeedback, one feedback per actuator");
+        k_api::BaseCyclic::Command command = CommandFrom(feedback, 1.0f, 1);
+        bOk &= Check(FollowsCommand(baseCyclic.Refresh(command), command), "cyclic: Refresh, the feedback follows the command");
+
+        //4- disconnect and reconnect
+        pSessionManager->CloseSession();
+        pSessionManager.reset();
+        router.SetActivationStatus(false);
+        transport.disconnect();
+        bool bConnected = transport.connect("simulated", 10000);
+        router.SetActivationStatus(true);
+        bOk &= Check(bConnected && transport.GetSentCount() == 0 && transport.GetDeliveredCount() == 0,
+                     "reconnect: transport connected again, counters restarted");
+        bOk &= Check(SubErrorOf([&]() {session.CloseSession();}) == k_api::INVALID_SESSION,
+                     "reconnect: the session of the first connection is gone");
+        pSessionManager.reset(new k_api::SessionManager(&router));
+        pSessionManager->CreateSession(SessionInfo("admin"));
+        bOk &= Check(base.GetServoingMode().servoing_mode() == k_api::Base::LOW_LEVEL_SERVOING
+                     && FollowsCommand(baseCyclic.RefreshFeedback(), command),
+                     "reconnect: new session, the robot kept its servoing mode and positions");
+
+        //5- round trips
+        LatencyHistogram rpcHistogram;
+        LatencyHistogram refreshHistogram;
+        bool bFollowed = true;
+        for (int i = 0; i < ITERATIONS; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            base.GetArmState();
+            auto middle = std::chrono::steady_clock::now();
+            command = CommandFrom(feedback, std::sin(i * 0.01f), uint32_t(i + 2));
+            bFollowed &= FollowsCommand(baseCyclic.Refresh(command), command);
+            auto end = std::chrono::steady_clock::now();
+            rpcHistogram.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count());
+            refreshHistogram.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count());
+        }
+        bOk &= Check(bFollowed, "cyclic: every Refresh of the benchmark followed its command");
+        std::cout << "GetArmState round trip:        " << rpcHistogram.ToString() << std::endl;
+        std::cout << "BaseCyclic Refresh round trip: " << refreshHistogram.ToString() << std::endl;
+
+        pSessionManager->CloseSession();
+    }
+    catch (k_api::KBasicException &ex)
+    {
+        std::cout << "Unexpected error: " << ex.what() << std::endl;
+        bOk = false;
+    }
+    router.SetActivationStatus(false);
+    transport.disconnect();
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks MultiRateScheduler on a CyclicExecutor at 1 kHz, against an in-process SimulatedRobot, no robot needed.
+*
+* 1- Cyclic tasks at 1 kHz, 100 Hz (two of them) and 10 Hz, added slowest first:
+*    - run counts of a Run of 1000 ticks, and of a second one (maxTicks counts the ticks of each call)
+*    - rate-monotonic order: in every tick the faster tasks run first
+*    - phases: a lower rate task always runs on the same tick of its period, and no two of them share a tick
+*    - one Refresh per tick, the lower rate tasks ride on the 1 kHz frames
+*    - Stop() from a task ends the Run after that tick
+* 2- Background tasks at 100 Hz and 50 Hz, the second one lasting longer than its period: the releases it misses are
+*    skipped, not queued, and the cyclic thread keeps all its ticks.
+* 3- Feedback mirror: the background tasks read the feedbacks through a mirror lent to the executor when it has none,
+*    given back after the Run, or through the one of the executor.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <BaseCyclicClientRpc.h>
+#include <RouterClient.h>
+#include <SessionManager.h>
+
+#include <CyclicExecutor.h>
+#include <FeedbackMirror.h>
+#include <LoopbackTransport.h>
+#include <MultiRateScheduler.h>
+#include <SimulatedRobot.h>
+
+#include "BenchmarkCheck.h"
+
+#define ACTUATOR_COUNT 7
+#define BASE_PERIOD_US 1000
+#define RUN_TICKS 1000
+#define TELEMETRY_PERIOD_US 10000
+#define SLOW_PERIOD_US 20000
+#define SLOW_DURATION_MS 50
+
+namespace k_api = Kinova::Api;
+
+//the task and tick of each cyclic run, in the order of the runs
+struct tCyclicRun
+{
+    int task;
+    uint64_t nTick;
+};
+
+static k_api::BaseCyclic::Command MakeCommand()
+{
+    k_api::BaseCyclic::Command command;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        command.add_actuators();
+    }
+    command.mutable_interconnect()->mutable_gripper_command()->add_motor_cmd();
+    return command;
+}
+
+bool CheckCyclicTasks(k_api::BaseCyclic::BaseCyclicClient *pBaseCyclic, SimulatedRobot &robot)
+{
+    CyclicExecutor executor(pBaseCyclic, std::chrono::microseconds(BASE_PERIOD_US));
+    MultiRateScheduler scheduler(&executor);
+
+    //the arm task counts the ticks, it runs first in each of them
+    std::vector<tCyclicRun> runs;
+    uint64_t nTick = 0;
+    std::atomic<bool> bStopFromTool(false);
+    auto record = [&runs, &nTick](int task) {runs.push_back(tCyclicRun{task, nTick - 1});};
+
+    //slowest first, the scheduler sorts them
+    int tool = scheduler.AddCyclicTask("tool 10 Hz", std::chrono::microseconds(100000),
+        [&](const k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command&)
+        {
+            record(0);
+            if (bStopFromTool)
+            {
+                scheduler.Stop();
+            }
+            return true;
+        });
+    int gripper = scheduler.AddCyclicTask("gripper 100 Hz", std::chrono::microseconds(10000),
+        [&](const k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command &command)
+        {
+            record(1);
+            command.mutable_interconnect()->mutable_gripper_command()->mutable_motor_cmd(0)->set_position(float(nTick % 100));
+            return true;
+        });
+    int arm = scheduler.AddCyclicTask("arm 1 kHz", std::chrono::microseconds(BASE_PERIOD_US),
+        [&](const k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command &command)
+        {
+            nTick++;
+            record(2);
+            command.mutable_actuators(0)->set_position(float(nTick % 360));
+            return true;
+        });
+    int planner = scheduler.AddCyclicTask("planner 100 Hz", std::chrono::microseconds(10000),
+        [&](const k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command&) {record(3); return true;});
+    const int periods[] = {100, 10, 1, 10};
+
+    bool bOk = Check(scheduler.AddCyclicTask("1.5 ms", std::chrono::microseconds(1500),
+                                             [](const k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command&) {return true;}) == -1,
+                     "a period not multiple of the base period is refused");
+
+    k_api::BaseCyclic::Feedback feedback;
+    k_api::BaseCyclic::Command command = MakeCommand();
+    uint64_t nRequests = robot.GetRequestCount();
+    scheduler.Run(feedback, command, RUN_TICKS);
+    std::cout << scheduler.ToString() << std::endl;
+
+    bOk &= Check(nTick == RUN_TICKS && scheduler.GetTaskStatistics(arm).nRuns == RUN_TICKS, "1 kHz task on every tick");
+    bOk &= Check(scheduler.GetTaskStatistics(gripper).nRuns == RUN_TICKS / 10 && scheduler.GetTaskStatistics(planner).nRuns == RUN_TICKS / 10,
+                 "100 Hz tasks on one tick in 10");
+    bOk &= Check(scheduler.GetTaskStatistics(tool).nRuns == RUN_TICKS / 100, "10 Hz task on one tick in 100");
+    bOk &= Check(robot.GetRequestCount() - nRequests == RUN_TICKS && executor.GetStatistics().nRefreshErrors == 0,
+                 "one Refresh per tick");
+
+    //in each tick the periods go up; each lower rate task keeps one phase, on a tick of its own
+    bool bRateMonotonic = true;
+    bool bSamePhase = true;
+    bool bOwnTick = true;
+    std::vector<int> phases(4, -1);
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        const tCyclicRun &run = runs[i];
+        if (i > 0 && runs[i - 1].nTick == run.nTick)
+        {
+            bRateMonotonic = bRateMonotonic && periods[runs[i - 1].task] <= periods[run.task];
+            bOwnTick = bOwnTick && (periods[runs[i - 1].task] == 1 || periods[run.task] == 1);
+        }
+        int phase = int(run.nTick % periods[run.task]);
+        bSamePhase = bSamePhase && (phases[run.task] == -1 || phases[run.task] == phase);
+        phases[run.task] = phase;
+    }
+    std::cout << "phases: gripper " << phases[1] << ", planner " << phases[3] << ", tool " << phases[0] << std::endl;
+    bOk &= Check(bRateMonotonic, "faster tasks first in each tick");
+    bOk &= Check(bSamePhase, "each task keeps its phase");
+    bOk &= Check(bOwnTick && phases[1] != phases[3], "lower rate tasks on different ticks");
+
+    //maxTicks is per call, the phases start again
+    runs.clear();
+    nTick = 0;
+    scheduler.Run(feedback, command, RUN_TICKS / 2);
+    bOk &= Check(nTick == RUN_TICKS / 2 && executor.GetStatistics().nTicks == RUN_TICKS + RUN_TICKS / 2, "second Run, maxTicks of this call");
+    bOk &= Check(scheduler.GetTaskStatistics(gripper).nRuns == RUN_TICKS / 10 + RUN_TICKS / 20
+                 && scheduler.GetTaskStatistics(tool).nRuns == RUN_TICKS / 100 + RUN_TICKS / 200,
+                 "second Run, statistics add up");
+    bool bPhasesKept = true;
+    for (const auto &run : runs)
+    {
+        bPhasesKept = bPhasesKept && int(run.nTick % periods[run.task]) == phases[run.task];
+    }
+    bOk &= Check(bPhasesKept, "second Run, same phases");
+
+    //the 10 Hz task stops the loop at its first run, the Refresh of that tick still goes
+    nTick = 0;
+    bStopFromTool = true;
+    uint64_t nTicksBefore = executor.GetStatistics().nTicks;
+    scheduler.Run(feedback, command);
+    bOk &= Check(executor.GetStatistics().nTicks - nTicksBefore == uint64_t(phases[0]) + 1, "Stop() from a task ends the Run after its tick");
+    return bOk;
+}
+
+bool CheckBackgroundTasks(k_api::BaseCyclic::BaseCyclicClient *pBaseCyclic)
+{
+    CyclicExecutor executor(pBaseCyclic, std::chrono::microseconds(BASE_PERIOD_US));
+    MultiRateScheduler scheduler(&executor);
+    std::atomic<int> nActuatorsSeen(0);
+    std::atomic<uint32_t> nFramesSeen(0);
+
+    scheduler.AddCyclicTask("arm 1 kHz", std::chrono::microseconds(BASE_PERIOD_US),
+        [](const k_api::BaseCyclic::Feedback&, k_api::BaseCyclic::Command &command)
+        {
+            command.mutable_actuators(0)->set_position(10.0f);
+            return true;
+        });
+    int telemetry = scheduler.AddBackgroundTask("telemetry 100 Hz", std::chrono::microseconds(TELEMETRY_PERIOD_US),
+        [&](const tFlatFeedback &snapshot)
+        {
+            nActuatorsSeen = snapshot.actuators.nCount;
+            nFramesSeen++;
+        });
+    int slow = scheduler.AddBackgroundTask("slow 50 Hz", std::chrono::microseconds(SLOW_PERIOD_US),
+        [](const tFlatFeedback&) {std::this_thread::sleep_for(std::chrono::milliseconds(SLOW_DURATION_MS));});
+
+    bool bOk = true;
+    k_api::BaseCyclic::Feedback feedback;
+    k_api::BaseCyclic::Command command = MakeCommand();
+
+    //1- lent mirror
+    auto start = std::chrono::steady_clock::now();
+    scheduler.Run(feedback, command, RUN_TICKS);
+    double duration_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << scheduler.ToString() << std::endl
+              << "cyclic: " << executor.GetStatistics().nTicks << " ticks, " << executor.GetStatistics().nDeadlineMisses
+              << " deadline misses in " << duration_us / 1000 << " ms" << std::endl;
+
+    const tTaskStatistics &slowStatistics = scheduler.GetTaskStatistics(slow);
+    const tTaskStatistics &telemetryStatistics = scheduler.GetTaskStatistics(telemetry);
+    bOk &= Check(executor.GetStatistics().nTicks == RUN_TICKS, "cyclic thread keeps its ticks");
+    bOk &= Check(slowStatistics.nRuns > 0 && slowStatistics.nSkippedReleases >= slowStatistics.nRuns,
+                 "slow background task skips the releases it missed");
+    //the releases are not queued: runs and skips together are the releases of the Run, a few at the start and the end
+    //may go without the feedback or the thread
+    double releases = duration_us / SLOW_PERIOD_US;
+    double counted = double(slowStatistics.nRuns + slowStatistics.nSkippedReleases);
+    bOk &= Check(counted > 0.8 * releases - 2 && counted < releases + 2, "slow background task, no release queued");
+    bOk &= Check(telemetryStatistics.nRuns > 0 && nActuatorsSeen == ACTUATOR_COUNT, "background tasks get the feedbacks through the lent mirror");
+    bOk &= Check(executor.GetFeedbackMirror() == nullptr, "lent mirror given back");
+
+    //2- mirror of the executor
+    FeedbackMirror mirror;
+    executor.SetFeedbackMirror(&mirror);
+    uint32_t nFramesBefore = nFramesSeen;
+    scheduler.Run(feedback, command, RUN_TICKS);
+    bOk &= Check(executor.GetFeedbackMirror() == &mirror && mirror.GetVersion() == RUN_TICKS, "mirror of the executor used and kept");
+    bOk &= Check(nFramesSeen > nFramesBefore, "background tasks get the feedbacks through the mirror of the executor");
+    executor.SetFeedbackMirror(nullptr);
+    return bOk;
+}
+
+int main()
+{
+    tSimulatedRobotSettings settings;
+    settings.nActuatorCount = ACTUATOR_COUNT;
+    SimulatedRobot robot(settings);
+    LoopbackTransport transport(&robot);
+
+    auto error_callback = [](k_api::KError err){ std::cout << "_________ callback error _________" << err.toString(); };
+    k_api::RouterClient router(&transport, error_callback);
+    transport.connect("simulated", 10001);
+
+    auto create_session_info = k_api::Session::CreateSessionInfo();
+    create_session_info.set_username("admin");
+    create_session_info.set_password("admin");
+    create_session_info.set_session_inactivity_timeout(60000);   // (milliseconds)
+    //long enough for no KeepAlive within the runs, the Refresh requests are counted
+    create_session_info.set_connection_inactivity_timeout(60000); // (milliseconds)
+    k_api::SessionManager session_manager(&router);
+    session_manager.CreateSession(create_session_info);
+
+    k_api::BaseCyclic::BaseCyclicClient base_cyclic(&router);
+
+    bool bOk = CheckCyclicTasks(&base_cyclic, robot);
+    bOk = CheckBackgroundTasks(&base_cyclic) && bOk;
+
+    session_manager.CloseSession();
+    transport.disconnect();
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,561 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Fan-out of Base notifications to many subscribers, against an in-process SimulatedRobot, no robot needed.
+*
+* --subscribers connections (LoopbackTransport, RouterClient, session) each subscribe to the ArmStateTopic and the
+* ActionTopic. The robot pushes notifications to all of them at each of the --rates (notifications per second, the two
+* topics in turn) for --phase-s seconds, as TestTriggerNotif and the stand-in server do. Each notification carries its
+* sequence number on its topic and the steady clock time it was sent at, and each subscriber measures:
+*    - the delivery latency, p50, p99 and max
+*    - the notifications received out of order on a topic
+*    - the notifications lost, not received 5 s after the end of the phase
+* while the thread count and the resident memory of the process are sampled every 50 ms.
+*
+* For each dispatch strategy:
+*    library  the OnNotification*Topic methods of BaseClient: the NotificationHandler starts a thread per notification
+*    inline   NotificationDispatcher in the receive thread of the router
+*    queue    NotificationDispatcher with one worker thread per router
+*    sharded  NotificationDispatcher with --shards worker threads per router, one per topic
+*
+* --stress doubles the rate from 1000/s for each strategy until the p99 latency goes over --max-p99-ms, a notification
+* is lost or the process goes over 2000 threads, and prints the highest rate it kept up with.
+* --samples writes the thread and memory samples to a CSV file.
+*
+* The process returns 1 if a NotificationDispatcher strategy loses or reorders a notification outside of --stress.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <BaseClientRpc.h>
+#include <RouterClient.h>
+#include <SessionManager.h>
+
+#include <LatencyHistogram.h>
+#include <LoopbackTransport.h>
+#include <NotificationDispatcher.h>
+#include <SimulatedRobot.h>
+
+#include "BenchmarkCheck.h"
+
+#define SAMPLE_PERIOD_MS 50
+#define DRAIN_TIMEOUT_MS 5000
+#define STRESS_START_RATE 1000
+#define STRESS_MAX_RATE 1024000
+#define STRESS_MAX_THREADS 2000
+#define TOPIC_COUNT 2
+
+namespace k_api = Kinova::Api;
+
+static uint64_t NowNs()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//what one subscriber received; shared with its callbacks, which the library may still run after it is gone
+struct tReceived
+{
+    std::mutex mutex;
+    LatencyHistogram histogram;
+    uint32_t lastSequence[TOPIC_COUNT];
+    uint64_t nDelivered;
+    uint64_t nOutOfOrder;
+
+    tReceived() {Reset();}
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        histogram.Reset();
+        std::fill(lastSequence, lastSequence + TOPIC_COUNT, 0);
+        nDelivered = 0;
+        nOutOfOrder = 0;
+    }
+
+    void Record(int topic, uint32_t sequence, const k_api::Common::Timestamp &sent)
+    {
+        uint64_t now = NowNs();
+        uint64_t sent_ns = (uint64_t(sent.sec()) * 1000000 + sent.usec()) * 1000;
+        std::lock_guard<std::mutex> lock(mutex);
+        histogram.Record(now > sent_ns ? now - sent_ns : 0);
+        if (sequence <= lastSequence[topic])
+        {
+            nOutOfOrder++;
+        }
+        else
+        {
+            lastSequence[topic] = sequence;
+        }
+        nDelivered++;
+    }
+};
+
+struct tSubscriber
+{
+    std::unique_ptr<LoopbackTransport> pTransport;
+    std::unique_ptr<k_api::RouterClient> pRouter;
+    std::unique_ptr<k_api::SessionManager> pSessionManager;
+    std::unique_ptr<k_api::Base::BaseClient> pBase;
+    std::unique_ptr<NotificationDispatcher> pDispatcher;
+    std::vector<k_api::Common::NotificationHandle> handles;
+    std::shared_ptr<tReceived> pReceived;
+};
+
+//threads and resident memory of the process, from /proc
+struct tProcessSample
+{
+    double time_s;
+    int nThreads;
+    uint64_t rss_kB;
+};
+
+static tProcessSample SampleProcess(std::chrono::steady_clock::time_point start)
+{
+    tProcessSample sample = {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0, 0};
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "Threads:")
+        {
+            fields >> sample.nThreads;
+        }
+        else if (key == "VmRSS:")
+        {
+            fields >> sample.rss_kB;
+        }
+    }
+    return sample;
+}
+
+//samples the process in a thread of its own, for the whole run
+class ProcessMonitor
+{
+public:
+    ProcessMonitor() : m_Start(std::chrono::steady_clock::now()), m_bStop(false)
+    {
+        m_Thread = std::thread([this]()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            while (!m_Condition.wait_for(lock, std::chrono::milliseconds(SAMPLE_PERIOD_MS), [this]() {return m_bStop;}))
+            {
+                lock.unlock();
+                tProcessSample sample = SampleProcess(m_Start);
+                lock.lock();
+                sample.time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+                m_Samples.push_back(sample);
+                m_Labels.push_back(m_Label);
+            }
+        });
+    }
+
+    ~ProcessMonitor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bStop = true;
+        }
+        m_Condition.notify_one();
+        m_Thread.join();
+    }
+
+    //the samples from now on are counted for this phase
+    void StartPhase(const std::string &label)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Label = label;
+        m_nPhaseStart = m_Samples.size();
+    }
+
+    //the highest thread count and memory since StartPhase()
+    tProcessSample GetPhasePeak()
+    {
+        tProcessSample peak = SampleProcess(m_Start);
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (size_t i = m_nPhaseStart; i < m_Samples.size(); i++)
+        {
+            peak.nThreads = std::max(peak.nThreads, m_Samples[i].nThreads);
+            peak.rss_kB = std::max(peak.rss_kB, m_Samples[i].rss_kB);
+        }
+        return peak;
+    }
+
+    void WriteCsv(const std::string &path)
+    {
+        std::ofstream file(path);
+        file << "time_s,phase,threads,rss_kB\n";
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (size_t i = 0; i < m_Samples.size(); i++)
+        {
+            file << m_Samples[i].time_s << "," << m_Labels[i] << "," << m_Samples[i].nThreads << "," << m_Samples[i].rss_kB << "\n";
+        }
+    }
+
+private:
+    const std::chrono::steady_clock::time_point m_Start;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_bStop;
+    std::string m_Label;
+    size_t m_nPhaseStart = 0;
+    std::vector<tProcessSample> m_Samples;
+    std::vector<std::string> m_Labels;
+    std::thread m_Thread;
+};
+
+static bool ParseStrategy(const std::string &name, NotificationDispatcher::eStrategy &strategy)
+{
+    if (name == "inline") strategy = NotificationDispatcher::INLINE;
+    else if (name == "queue") strategy = NotificationDispatcher::QUEUE;
+    else if (name == "sharded") strategy = NotificationDispatcher::SHARDED;
+    else return false;
+    return true;
+}
+
+//connects nCount subscribers with the strategy and subscribes each to both topics
+static void Connect(SimulatedRobot &robot, int nCount, const std::string &strategyName, int nShards,
+                    std::vector<std::unique_ptr<tSubscriber>> &subscribers)
+{
+    auto error_callback = [](k_api::KError err){ std::cout << "_________ callback error _________" << err.toString(); };
+    NotificationDispatcher::eStrategy strategy = NotificationDispatcher::INLINE;
+    bool bLibrary = !ParseStrategy(strategyName, strategy);
+
+    auto create_session_info = k_api::Session::CreateSessionInfo();
+    create_session_info.set_username("admin");
+    create_session_info.set_password("admin");
+    create_session_info.set_session_inactivity_timeout(60000);   // (milliseconds)
+    create_session_info.set_connection_inactivity_timeout(60000); // (milliseconds)
+
+    k_api::Common::NotificationOptions notificationOptions;
+    notificationOptions.set_type(k_api::Common::NOTIFICATION_TYPE_EVENT);
+
+    for (int i = 0; i < nCount; i++)
+    {
+        std::unique_ptr<tSubscriber> pSubscriber(new tSubscriber);
+        pSubscriber->pTransport.reset(new LoopbackTransport(&robot));
+        pSubscriber->pRouter.reset(new k_api::RouterClient(pSubscriber->pTransport.get(), error_callback));
+        pSubscriber->pTransport->connect("simulated", 10000);
+        pSubscriber->pSessionManager.reset(new k_api::SessionManager(pSubscriber->pRouter.get()));
+        pSubscriber->pSessionManager->CreateSession(create_session_info);
+        pSubscriber->pBase.reset(new k_api::Base::BaseClient(pSubscriber->pRouter.get()));
+        pSubscriber->pReceived = std::make_shared<tReceived>();
+
+        std::shared_ptr<tReceived> pReceived = pSubscriber->pReceived;
+        auto onArmState = [pReceived](const k_api::Base::ArmStateNotification &notification)
+        {
+            pReceived->Record(0, notification.connection().connection_identifier(), notification.timestamp());
+        };
+        auto onAction = [pReceived](const k_api::Base::ActionNotification &notification)
+        {
+            pReceived->Record(1, notification.handle().identifier(), notification.timestamp());
+        };
+
+        if (bLibrary)
+        {
+            pSubscriber->handles.push_back(pSubscriber->pBase->OnNotificationArmStateTopic(onArmState, notificationOptions));
+            pSubscriber->handles.push_back(pSubscriber->pBase->OnNotificationActionTopic(onAction, notificationOptions));
+        }
+        else
+        {
+            //after the BaseClient, which registers its own notification callback
+            pSubscriber->pDispatcher.reset(new NotificationDispatcher(pSubscriber->pRouter.get(), k_api::eIdBase, strategy, nShards));
+            pSubscriber->handles.push_back(pSubscriber->pDispatcher->Subscribe<k_api::Base::ArmStateNotification>(
+                k_api::Base::eUidArmStateTopic, notificationOptions, onArmState));
+            pSubscriber->handles.push_back(pSubscriber->pDispatcher->Subscribe<k_api::Base::ActionNotification>(
+                k_api::Base::eUidActionTopic, notificationOptions, onAction));
+        }
+        subscribers.push_back(std::move(pSubscriber));
+    }
+}
+
+static void Disconnect(std::vector<std::unique_ptr<tSubscriber>> &subscribers)
+{
+    for (auto &pSubscriber : subscribers)
+    {
+        for (auto &handle : pSubscriber->handles)
+        {
+            pSubscriber->pBase->Unsubscribe(handle);
+        }
+        pSubscriber->pDispatcher.reset();
+        pSubscriber->pSessionManager->CloseSession();
+        pSubscriber->pTransport->disconnect();
+    }
+    subscribers.clear();
+}
+
+struct tPhaseResult
+{
+    uint64_t nPushed;           //notifications sent by the robot
+    uint64_t nExpected;         //deliveries, nPushed times the subscribers
+    uint64_t nDelivered;
+    uint64_t nOutOfOrder;
+    double pushRate;            //reached, below the one asked for when Notify cannot keep up
+    double drain_s;             //from the last notification to the last delivery
+    LatencyHistogram histogram;
+    tProcessSample peak;
+};
+
+//pushes the two topics in turn at rate notifications per second for duration_s, then waits for the deliveries
+static tPhaseResult RunPhase(SimulatedRobot &robot, std::vector<std::unique_ptr<tSubscriber>> &subscribers,
+                             double rate, double duration_s, ProcessMonitor &monitor, const std::string &label)
+{
+    for (auto &pSubscriber : subscribers)
+    {
+        pSubscriber->pReceived->Reset();
+    }
+    monitor.StartPhase(label);
+
+    tPhaseResult result;
+    result.nPushed = 0;
+    result.nExpected = 0;
+    k_api::Base::ArmStateNotification armState;
+    armState.set_active_state(k_api::Common::ARMSTATE_SERVOING_READY);
+    k_api::Base::ActionNotification action;
+    action.set_action_event(k_api::Base::ACTION_START);
+    action.mutable_handle()->set_action_type(k_api::Base::REACH_JOINT_ANGLES);
+    uint32_t sequences[TOPIC_COUNT] = {0, 0};
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(duration_s));
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    auto next = start;
+    while (next < end)
+    {
+        //late pushes are sent at once, in a burst
+        std::this_thread::sleep_until(next);
+        next += period;
+
+        int topic = int(result.nPushed % TOPIC_COUNT);
+        uint64_t now_us = NowNs() / 1000;
+        k_api::Common::Timestamp *pTimestamp = topic == 0 ? armState.mutable_timestamp() : action.mutable_timestamp();
+        pTimestamp->set_sec(uint32_t(now_us / 1000000));
+        pTimestamp->set_usec(uint32_t(now_us % 1000000));
+        if (topic == 0)
+        {
+            armState.mutable_connection()->set_connection_identifier(++sequences[0]);
+            result.nExpected += uint64_t(robot.Notify(k_api::Base::eUidArmStateTopic, armState));
+        }
+        else
+        {
+            action.mutable_handle()->set_identifier(++sequences[1]);
+            result.nExpected += uint64_t(robot.Notify(k_api::Base::eUidActionTopic, action));
+        }
+        result.nPushed++;
+    }
+    const auto pushEnd = std::chrono::steady_clock::now();
+    result.pushRate = result.nPushed / std::chrono::duration<double>(pushEnd - start).count();
+
+    //the deliveries still queued in the transports and the dispatchers
+    const auto drainTimeout = pushEnd + std::chrono::milliseconds(DRAIN_TIMEOUT_MS);
+    while (true)
+    {
+        result.nDelivered = 0;
+        for (auto &pSubscriber : subscribers)
+        {
+            std::lock_guard<std::mutex> lock(pSubscriber->pReceived->mutex);
+            result.nDelivered += pSubscriber->pReceived->nDelivered;
+        }
+        if (result.nDelivered >= result.nExpected || std::chrono::steady_clock::now() > drainTimeout)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    result.drain_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - pushEnd).count();
+    result.peak = monitor.GetPhasePeak();
+
+    result.nOutOfOrder = 0;
+    for (auto &pSubscriber : subscribers)
+    {
+        std::lock_guard<std::mutex> lock(pSubscriber->pReceived->mutex);
+        result.histogram.Add(pSubscriber->pReceived->histogram);
+        result.nOutOfOrder += pSubscriber->pReceived->nOutOfOrder;
+    }
+    return result;
+}
+
+static void PrintHeader()
+{
+    std::cout << std::left << std::setw(10) << "strategy" << std::right
+              << std::setw(10) << "rate/s" << std::setw(10) << "pushed/s"
+              << std::setw(11) << "p50 us" << std::setw(11) << "p99 us" << std::setw(11) << "max us"
+              << std::setw(10) << "reorder" << std::setw(8) << "lost" << std::setw(10) << "drain ms"
+              << std::setw(9) << "threads" << std::setw(10) << "RSS MB" << std::endl;
+}
+
+static void PrintResult(const std::string &strategy, double rate, const tPhaseResult &result)
+{
+    std::cout << std::left << std::setw(10) << strategy << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << rate << std::setw(10) << result.pushRate
+              << std::setprecision(1)
+              << std::setw(11) << result.histogram.GetPercentile(50) / 1000.0
+              << std::setw(11) << result.histogram.GetPercentile(99) / 1000.0
+              << std::setw(11) << result.histogram.GetMax() / 1000.0
+              << std::setw(10) << result.nOutOfOrder
+              << std::setw(8) << (result.nExpected - std::min(result.nExpected, result.nDelivered))
+              << std::setw(10) << result.drain_s * 1000.0
+              << std::setw(9) << result.peak.nThreads
+              << std::setw(10) << result.peak.rss_kB / 1024.0 << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+static std::vector<std::string> Split(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options(argv[0], "Fan-out of Base notifications to many subscribers");
+    options.add_options()
+        ("subscribers", "Connections subscribed to both topics", cxxopts::value<int>()->default_value("16"))
+        ("rates", "Notifications per second of each phase", cxxopts::value<std::string>()->default_value("100,1000,5000"))
+        ("phase-s", "Seconds of each phase", cxxopts::value<double>()->default_value("2"))
+        ("strategies", "library, inline, queue and sharded", cxxopts::value<std::string>()->default_value("library,inline,queue,sharded"))
+        ("shards", "Worker threads per router of the sharded strategy", cxxopts::value<int>()->default_value("2"))
+        ("stress", "Raise the rate until a strategy falls behind")
+        ("max-p99-ms", "Latency a strategy keeps up under, with --stress", cxxopts::value<double>()->default_value("10"))
+        ("samples", "CSV file to write the thread and memory samples to", cxxopts::value<std::string>())
+        ("h,help", "Print usage");
+
+    int subscriberCount;
+    std::vector<double> rates;
+    double phase_s;
+    std::vector<std::string> strategies;
+    int shardCount;
+    bool bStress;
+    double maxP99_ms;
+    std::string samplesPath;
+    try
+    {
+        auto parsed = options.parse(argc, argv);
+        if (parsed.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        subscriberCount = std::max(1, parsed["subscribers"].as<int>());
+        for (const std::string &rate : Split(parsed["rates"].as<std::string>()))
+        {
+            rates.push_back(std::max(1.0, std::stod(rate)));
+        }
+        phase_s = parsed["phase-s"].as<double>();
+        strategies = Split(parsed["strategies"].as<std::string>());
+        shardCount = std::max(1, parsed["shards"].as<int>());
+        bStress = parsed.count("stress") > 0;
+        maxP99_ms = parsed["max-p99-ms"].as<double>();
+        if (parsed.count("samples"))
+        {
+            samplesPath = parsed["samples"].as<std::string>();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl << options.help() << std::endl;
+        return 1;
+    }
+    for (const std::string &strategy : strategies)
+    {
+        NotificationDispatcher::eStrategy parsedStrategy;
+        if (strategy != "library" && !ParseStrategy(strategy, parsedStrategy))
+        {
+            std::cerr << "Unknown strategy " << strategy << std::endl;
+            return 1;
+        }
+    }
+
+    bool bOk = true;
+    ProcessMonitor monitor;
+    std::cout << subscriberCount << " subscribers, " << TOPIC_COUNT << " topics each" << std::endl;
+    PrintHeader();
+    for (const std::string &strategy : strategies)
+    {
+        SimulatedRobot robot;
+        std::vector<std::unique_ptr<tSubscriber>> subscribers;
+        Connect(robot, subscriberCount, strategy, shardCount, subscribers);
+
+        if (!bStress)
+        {
+            for (double rate : rates)
+            {
+                tPhaseResult result = RunPhase(robot, subscribers, rate, phase_s, monitor, strategy + "@" + std::to_string(int(rate)));
+                PrintResult(strategy, rate, result);
+                if (strategy != "library")
+                {
+                    bOk &= Check(result.nDelivered == result.nExpected, strategy + ": every notification delivered");
+                    bOk &= Check(result.nOutOfOrder == 0, strategy + ": in order per topic");
+                }
+            }
+        }
+        else
+        {
+            double keptUp = 0;
+            for (double rate = STRESS_START_RATE; rate <= STRESS_MAX_RATE; rate *= 2)
+            {
+                tPhaseResult result = RunPhase(robot, subscribers, rate, phase_s, monitor, strategy + "@" + std::to_string(int(rate)));
+                PrintResult(strategy, rate, result);
+                bool bKeptUp = result.nDelivered >= result.nExpected
+                            && result.histogram.GetPercentile(99) <= uint64_t(maxP99_ms * 1e6)
+                            && result.pushRate >= 0.9 * rate;
+                if (!bKeptUp || result.peak.nThreads > STRESS_MAX_THREADS)
+                {
+                    break;
+                }
+                keptUp = rate;
+            }
+            std::cout << strategy << " kept up with " << keptUp << " notifications/s to " << subscriberCount
+                      << " subscribers" << std::endl;
+        }
+
+        Disconnect(subscribers);
+        //the library may still be running callbacks in its threads
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    if (!samplesPath.empty())
+    {
+        monitor.WriteCsv(samplesPath);
+    }
+    return bOk ? 0 : 1;
+}
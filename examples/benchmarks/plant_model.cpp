@@ -0,0 +1,245 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times PlantModel, the actuators and gripper behind SimulatedRobot, no robot needed.
+*
+* 1- Closed loops of the examples against the model:
+*    - a position step settles on its target within the velocity limit, and a limited joint stops at its limit
+*    - the velocity loop of 200-Actuator_low_level_control (position integrated at 1 kHz) tracks its velocity
+*    - the proportional loop of 107-Gripper_low_level_command reaches its target, and closing on an object stops
+*      there with the current of the commanded force
+*    - a constant torque accelerates a joint as the first order solution says
+* 2- Determinism: the same commands give the same feedback, bit for bit.
+* 3- Benchmark: ns per period of the model for a 7 DoF arm and its gripper, against the 1 ms of real time.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include <BaseCyclicClientRpc.h>
+
+#include <FlatFeedback.h>
+#include <PlantModel.h>
+
+#include "BenchmarkCheck.h"
+
+#define ACTUATOR_COUNT 7
+#define RATE_HZ 1000
+#define DETERMINISM_TICKS 10000
+#define BENCHMARK_TICKS 1000000
+#define PROPORTIONAL_GAIN (2.2f)
+#define MINIMAL_POSITION_ERROR (1.5f)
+
+namespace k_api = Kinova::Api;
+
+struct tHarness
+{
+    PlantModel plant;
+    k_api::BaseCyclic::Command command;
+    k_api::GripperCyclic::MotorCommand *pGripper;
+    std::unique_ptr<tFlatFeedback> pFeedback;
+
+    tHarness(const tPlantSettings &settings = tPlantSettings()) : plant(ACTUATOR_COUNT, true, settings), pFeedback(new tFlatFeedback)
+    {
+        pFeedback->Reset();
+        pFeedback->actuators.nCount = ACTUATOR_COUNT;
+        pFeedback->interconnect.gripper.nMotorCount = 1;
+        for (int i = 0; i < ACTUATOR_COUNT; i++)
+        {
+            command.add_actuators();
+        }
+        pGripper = command.mutable_interconnect()->mutable_gripper_command()->add_motor_cmd();
+        Refresh();
+    }
+
+    void Refresh()
+    {
+        plant.SetCommand(command);
+        plant.Step();
+        plant.ToFeedback(*pFeedback);
+    }
+
+    float Position(int i) const {return pFeedback->actuators.position[i];}
+};
+
+static float AngleError(float a, float b)
+{
+    float error = std::fmod(a - b + 540.0f, 360.0f) - 180.0f;
+    return std::fabs(error);
+}
+
+bool CheckPositionStep()
+{
+    tHarness harness;
+    float start = harness.Position(0);
+    float maxVelocity = 0.0f;
+    harness.command.mutable_actuators(0)->set_position(start + 30.0f);
+    harness.command.mutable_actuators(1)->set_position(150.0f);     //past the limit of joint 2
+    for (int tick = 0; tick < 2 * RATE_HZ; tick++)
+    {
+        harness.Refresh();
+        maxVelocity = std::max(maxVelocity, std::fabs(harness.pFeedback->actuators.velocity[0]));
+    }
+    bool bOk = Check(AngleError(harness.Position(0), start + 30.0f) < 0.1f, "position step settles");
+    bOk = Check(maxVelocity <= tPlantSettings().joints[0].maxVelocity, "position step within the velocity limit") && bOk;
+    bOk = Check(std::fabs(harness.Position(1) - tPlantSettings().joints[1].maxPosition) < 0.01f, "limited joint stops at its limit") && bOk;
+    return bOk;
+}
+
+bool CheckVelocityLoop()
+{
+    //as 200-Actuator_low_level_control: the position command moves by velocity / 1000 each period
+    const float velocity = 10.0f;
+    tHarness harness;
+    float command = harness.Position(6);
+    for (int tick = 0; tick < 5 * RATE_HZ; tick++)
+    {
+        command += 0.001f * velocity;
+        harness.command.mutable_actuators(6)->set_position(std::fmod(command, 360.0f));
+        harness.Refresh();
+    }
+    bool bOk = Check(std::fabs(harness.pFeedback->actuators.velocity[6] - velocity) < 0.1f, "velocity loop tracks its velocity");
+    return Check(AngleError(harness.Position(6), std::fmod(command, 360.0f)) < 1.0f, "velocity loop follows its positions") && bOk;
+}
+
+//the GoTo of 107-Gripper_low_level_command, returns the ticks taken or -1
+int GripperGoTo(tHarness &harness, float target, int maxTicks)
+{
+    for (int tick = 0; tick < maxTicks; tick++)
+    {
+        float error = target - harness.pFeedback->interconnect.gripper.position[0];
+        if (std::fabs(error) < MINIMAL_POSITION_ERROR)
+        {
+            harness.pGripper->set_velocity(0.0f);
+            harness.Refresh();
+            return tick;
+        }
+        harness.pGripper->set_position(target);
+        harness.pGripper->set_velocity(std::min(100.0f, PROPORTIONAL_GAIN * std::fabs(error)));
+        harness.Refresh();
+    }
+    return -1;
+}
+
+bool CheckGripper()
+{
+    tHarness harness;
+    harness.pGripper->set_force(100.0f);
+    int ticks = GripperGoTo(harness, 50.0f, 5 * RATE_HZ);
+    bool bOk = Check(ticks > 0, "gripper proportional loop reaches its target");
+    std::cout << "        in " << ticks << " ms" << std::endl;
+
+    tPlantSettings settings;
+    settings.gripper.objectPosition = 40.0f;
+    tHarness grasp(settings);
+    grasp.pGripper->set_position(100.0f);
+    grasp.pGripper->set_velocity(100.0f);
+    grasp.pGripper->set_force(50.0f);
+    for (int tick = 0; tick < RATE_HZ; tick++)
+    {
+        grasp.Refresh();
+    }
+    const auto &gripper = grasp.pFeedback->interconnect.gripper;
+    bOk = Check(std::fabs(gripper.position[0] - 40.0f) < 1e-3f && gripper.velocity[0] == 0.0f, "gripper stops on the object") && bOk;
+    return Check(std::fabs(gripper.currentMotor[0] - 0.5f * settings.gripper.maxCurrent) < 1e-6f, "gripper squeezes with its force") && bOk;
+}
+
+bool CheckTorque()
+{
+    const int joint = 5;
+    const float torque = 0.3f;     //within the acceleration limit
+    const double radiansPerDegree = 3.14159265358979 / 180.0;
+    tPlantSettings settings;
+    settings.nDelayTicks = 0;
+    tHarness harness(settings);
+    harness.plant.SetControlMode(joint, PlantModel::TORQUE);
+    harness.command.mutable_actuators(joint)->set_torque_joint(torque);
+    const int ticks = RATE_HZ / 10;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        harness.Refresh();
+    }
+
+    //I dw/dt = torque - d w
+    const auto &dynamics = settings.joints[joint];
+    double t = double(ticks) / RATE_HZ;
+    double expected = torque / dynamics.damping * (1.0 - std::exp(-t * dynamics.damping / dynamics.inertia)) / radiansPerDegree;
+    double measured = harness.pFeedback->actuators.velocity[joint];
+    std::cout << "        " << measured << " deg/s, " << expected << " expected" << std::endl;
+    return Check(std::fabs(measured - expected) < 0.02 * expected, "torque mode follows the first order solution");
+}
+
+bool CheckDeterminism()
+{
+    tHarness first, second;
+    for (int tick = 0; tick < DETERMINISM_TICKS; tick++)
+    {
+        for (auto *pHarness : {&first, &second})
+        {
+            for (int i = 0; i < ACTUATOR_COUNT; i++)
+            {
+                pHarness->command.mutable_actuators(i)->set_position(90.0f + 60.0f * std::sin(0.001f * tick * (i + 1)));
+            }
+            pHarness->pGripper->set_position(50.0f + 50.0f * std::sin(0.002f * tick));
+            pHarness->pGripper->set_velocity(80.0f);
+            pHarness->Refresh();
+        }
+        if (memcmp(first.pFeedback.get(), second.pFeedback.get(), sizeof(tFlatFeedback)) != 0)
+        {
+            return Check(false, "same commands, same feedback");
+        }
+    }
+    return Check(true, "same commands, same feedback");
+}
+
+int main(int argc, char **argv)
+{
+    bool bOk = CheckPositionStep();
+    bOk = CheckVelocityLoop() && bOk;
+    bOk = CheckGripper() && bOk;
+    bOk = CheckTorque() && bOk;
+    bOk = CheckDeterminism() && bOk;
+
+    tHarness harness;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        harness.command.mutable_actuators(i)->set_position(120.0f);
+    }
+    harness.pGripper->set_position(80.0f);
+    harness.pGripper->set_velocity(50.0f);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCHMARK_TICKS; tick++)
+    {
+        harness.plant.Step();
+    }
+    double stepNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_TICKS;
+
+    start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCHMARK_TICKS; tick++)
+    {
+        harness.Refresh();
+    }
+    double refreshNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_TICKS;
+
+    std::cout << "Step: " << stepNs << " ns, SetCommand + Step + ToFeedback: " << refreshNs << " ns, "
+              << 1e6 / refreshNs << "x real time at " << RATE_HZ << " Hz" << std::endl;
+    return bOk ? 0 : 1;
+}
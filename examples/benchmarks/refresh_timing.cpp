@@ -0,0 +1,166 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times tRefreshTiming, the Refresh instrumentation of CyclicExecutor and PipelinedCyclicClient, no robot needed.
+*
+* 1- Correlation: synthetic round trips that follow jitter_comm plus noise are recorded, the online correlation must
+*    match a two-pass computation over the same samples, also when two unequal parts recorded apart are merged.
+* 2- Benchmark: cost of one Record (4 histograms, 3 correlations) against the 3 clock reads needed to measure a cycle.
+*    Both must stay small beside a 1 ms period for the instrumentation to be left on.
+*
+* The text and CSV exports of the synthetic run are printed at the end. The process returns 1 if the check fails.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <RefreshTiming.h>
+
+#define SAMPLE_COUNT 100000
+#define BENCHMARK_ITERATIONS 1000000
+#define TOLERANCE 1e-9
+
+struct tSample
+{
+    uint64_t roundTrip_ns;
+    uint64_t parse_ns;
+    uint64_t callback_ns;
+    uint32_t jitterComm_us;
+};
+
+std::vector<tSample> MakeSamples()
+{
+    std::mt19937 generator(1);
+    std::exponential_distribution<double> jitter(1.0 / 40.0);
+    std::normal_distribution<double> noise(0.0, 50000.0);
+    std::vector<tSample> samples(SAMPLE_COUNT);
+    for (auto &sample : samples)
+    {
+        sample.jitterComm_us = uint32_t(jitter(generator));
+        //the round trip follows the robot side jitter, the parse time does not
+        sample.roundTrip_ns = uint64_t(std::max(1000.0, 400000.0 + 1000.0 * sample.jitterComm_us + noise(generator)));
+        sample.parse_ns = 2000 + generator() % 500;
+        sample.callback_ns = 10000 + generator() % 5000;
+    }
+    return samples;
+}
+
+double TwoPassCorrelation(const std::vector<tSample> &samples)
+{
+    double meanX = 0.0, meanY = 0.0;
+    for (const auto &sample : samples)
+    {
+        meanX += double(sample.roundTrip_ns);
+        meanY += double(sample.jitterComm_us);
+    }
+    meanX /= double(samples.size());
+    meanY /= double(samples.size());
+
+    double sumXX = 0.0, sumYY = 0.0, sumXY = 0.0;
+    for (const auto &sample : samples)
+    {
+        double dx = double(sample.roundTrip_ns) - meanX;
+        double dy = double(sample.jitterComm_us) - meanY;
+        sumXX += dx * dx;
+        sumYY += dy * dy;
+        sumXY += dx * dy;
+    }
+    return sumXY / std::sqrt(sumXX * sumYY);
+}
+
+bool CheckCorrelation(const std::vector<tSample> &samples, tRefreshTiming &timing)
+{
+    tRefreshTiming firstPart, secondPart;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        const tSample &sample = samples[i];
+        timing.Record(sample.roundTrip_ns, sample.parse_ns, sample.callback_ns, sample.jitterComm_us);
+        tRefreshTiming &part = (i < samples.size() / 3) ? firstPart : secondPart;
+        part.Record(sample.roundTrip_ns, sample.parse_ns, sample.callback_ns, sample.jitterComm_us);
+    }
+    firstPart.Add(secondPart);
+
+    double expected = TwoPassCorrelation(samples);
+    double online = timing.roundTripJitter.Get();
+    double merged = firstPart.roundTripJitter.Get();
+    std::cout << "round trip / jitter_comm correlation: two-pass " << expected << ", online " << online
+              << ", merged " << merged << ", parse " << timing.parseJitter.Get() << std::endl;
+
+    if (std::fabs(online - expected) > TOLERANCE || std::fabs(merged - expected) > TOLERANCE
+        || firstPart.roundTrip.GetCount() != timing.roundTrip.GetCount()
+        || firstPart.roundTrip.GetPercentile(99.0) != timing.roundTrip.GetPercentile(99.0))
+    {
+        std::cout << "MISMATCH" << std::endl;
+        return false;
+    }
+    //the parse times were drawn independently of the jitter
+    if (std::fabs(timing.parseJitter.Get()) > 0.05 || expected < 0.3)
+    {
+        std::cout << "unexpected correlation" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Benchmark(const std::vector<tSample> &samples)
+{
+    tRefreshTiming timing;
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        const tSample &sample = samples[size_t(iteration) % samples.size()];
+        timing.Record(sample.roundTrip_ns, sample.parse_ns, sample.callback_ns, sample.jitterComm_us);
+    }
+    auto recordTime = std::chrono::steady_clock::now() - start;
+
+    uint64_t sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        auto a = std::chrono::steady_clock::now();
+        auto b = std::chrono::steady_clock::now();
+        auto c = std::chrono::steady_clock::now();
+        sum += uint64_t((c - a).count() + (b - a).count());
+    }
+    auto clockTime = std::chrono::steady_clock::now() - start;
+
+    double recordNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(recordTime).count()) / BENCHMARK_ITERATIONS;
+    double clockNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(clockTime).count()) / BENCHMARK_ITERATIONS;
+    std::cout << "tRefreshTiming::Record:  " << recordNs << " ns" << std::endl;
+    std::cout << "3 steady_clock::now():   " << clockNs << " ns" << std::endl;
+    std::cout << "share of a 1 ms period:  " << (recordNs + clockNs) / 10000.0 << " %"
+              << " (checksum " << sum % 10 + timing.roundTrip.GetCount() << ")" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<tSample> samples = MakeSamples();
+    tRefreshTiming timing;
+    if (!CheckCorrelation(samples, timing))
+    {
+        return 1;
+    }
+
+    Benchmark(samples);
+
+    std::cout << std::endl << "text export:" << std::endl << timing.ToString() << std::endl;
+    std::cout << std::endl << "CSV export:" << std::endl << timing.ToCsv();
+    return 0;
+}
@@ -0,0 +1,361 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times the waits of KortexRobot on its ActionTopic notifications, against two SimulatedRobots served by
+* StandInServers on 127.0.0.1 and 127.0.0.2 (port 10000, the one of KortexRobot). Their actions get an identifier and
+* send ACTION_START at once, then ACTION_END after a motion time, or ACTION_ABORT on Stop or when the next action
+* replaces them. PauseAction sends ACTION_PAUSE.
+*
+* 1- Completion: the futures returned by SetJointAngles, ACTION_START then ACTION_END.
+* 2- Wake latency: from the ACTION_END sent by the robot to the return of WaitWhileRobotIsMoving, against the 10 ms
+*    poll of the busy flag it replaces.
+* 3- Deadline: a motion that does not end times out, Stop ends it with ACTION_ABORT.
+* 4- Replace: a paused action replaced by a new one finishes with its own ACTION_ABORT, the new one with ACTION_END.
+* 5- Two robots: WaitAny returns with the faster one, WaitAll with the slower one, WaitAny times out when both move.
+* 6- Late start: the arm sends ACTION_END then ACTION_START, the order the detached threads of the NotificationHandler
+*    can deliver them in. The late ACTION_START is ignored, the robot stays idle and takes the next action.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <KDetailedException.h>
+
+#include <KortexRobot.h>
+#include <SimulatedRobot.h>
+#include <StandInServer.h>
+
+#include "BenchmarkCheck.h"
+
+#define ACTUATOR_COUNT 7
+#define MOTION_MS 20
+#define SLOW_MOTION_MS 200
+#define DEADLINE_MS 50
+#define POLL_MS 10
+#define WAIT_ITERATIONS 50
+#define LATE_START_MS 5
+
+namespace k_api = Kinova::Api;
+
+static double ElapsedMs(const std::chrono::steady_clock::time_point &start, const std::chrono::steady_clock::time_point &end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+//a SimulatedRobot whose reach joint angles actions take motion_ms, or until Stop when negative
+struct tSlowArm
+{
+    SimulatedRobot robot;
+    std::unique_ptr<StandInServer> pServer;
+
+    std::mutex mutex;
+    std::condition_variable replaced;
+    k_api::Base::ActionHandle current;      //identifier 0 when no action runs
+    uint32_t nIdentifiers;
+    int motion_ms;
+    bool bEndFirst;     //ACTION_END at once, then ACTION_START LATE_START_MS later
+    std::chrono::steady_clock::time_point endSent;   //of the last ACTION_END or ACTION_ABORT
+    std::vector<std::thread> motions;
+
+    tSlowArm(const std::string &address) : nIdentifiers(0), motion_ms(MOTION_MS), bEndFirst(false)
+    {
+        robot.SetHandler(k_api::Base::eUidGetActuatorCount, [](const k_api::Frame&, LoopbackTransport*, std::string &response)
+        {
+            k_api::Base::ActuatorInformation information;
+            information.set_count(ACTUATOR_COUNT);
+            information.SerializeToString(&response);
+            return k_api::SUB_ERROR_NONE;
+        });
+        robot.SetHandler(k_api::Base::eUidExecuteAction, [this](const k_api::Frame &request, LoopbackTransport*, std::string &response)
+        {
+            k_api::Base::Action action;
+            if (!action.ParseFromString(request.payload()))
+            {
+                return k_api::PAYLOAD_DECODING_ERR;
+            }
+            k_api::Base::ActionNotification notification;
+            {
+                //the motion running, if any, sees it is replaced and aborts once this one has started
+                std::lock_guard<std::mutex> lock(mutex);
+                current = action.handle();
+                current.set_identifier(++nIdentifiers);
+                *notification.mutable_handle() = current;
+                if (bEndFirst)
+                {
+                    current.set_identifier(0);
+                    motions.emplace_back([this, notification]() mutable
+                    {
+                        notification.set_action_event(k_api::Base::ACTION_END);
+                        robot.Notify(k_api::Base::eUidActionTopic, notification);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(LATE_START_MS));
+                        notification.set_action_event(k_api::Base::ACTION_START);
+                        robot.Notify(k_api::Base::eUidActionTopic, notification);
+                    });
+                    response.clear();
+                    return k_api::SUB_ERROR_NONE;
+                }
+                notification.set_action_event(k_api::Base::ACTION_START);
+                robot.Notify(k_api::Base::eUidActionTopic, notification);
+                int duration_ms = motion_ms;
+                uint32_t identifier = current.identifier();
+                motions.emplace_back([this, notification, duration_ms, identifier]() mutable
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    auto isReplaced = [this, identifier]() {return current.identifier() != identifier;};
+                    bool bAborted = true;
+                    if (duration_ms < 0)
+                    {
+                        replaced.wait(lock, isReplaced);
+                    }
+                    else
+                    {
+                        bAborted = replaced.wait_for(lock, std::chrono::milliseconds(duration_ms), isReplaced);
+                    }
+                    if (!bAborted)
+                    {
+                        current.set_identifier(0);
+                    }
+                    notification.set_action_event(bAborted ? k_api::Base::ACTION_ABORT : k_api::Base::ACTION_END);
+                    endSent = std::chrono::steady_clock::now();
+                    lock.unlock();
+                    robot.Notify(k_api::Base::eUidActionTopic, notification);
+                });
+            }
+            replaced.notify_all();
+            response.clear();
+            return k_api::SUB_ERROR_NONE;
+        });
+        robot.SetHandler(k_api::Base::eUidPauseAction, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+        {
+            k_api::Base::ActionNotification notification;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                *notification.mutable_handle() = current;
+            }
+            if (notification.handle().identifier() != 0)
+            {
+                notification.set_action_event(k_api::Base::ACTION_PAUSE);
+                robot.Notify(k_api::Base::eUidActionTopic, notification);
+            }
+            response.clear();
+            return k_api::SUB_ERROR_NONE;
+        });
+        robot.SetHandler(k_api::Base::eUidStop, [this](const k_api::Frame&, LoopbackTransport*, std::string &response)
+        {
+            StopMotion();
+            response.clear();
+            return k_api::SUB_ERROR_NONE;
+        });
+
+        tStandInSettings settings;
+        settings.address = address;
+        pServer.reset(new StandInServer(&robot, settings));
+        pServer->Start();
+    }
+
+    ~tSlowArm()
+    {
+        Join();
+        pServer->Stop();
+    }
+
+    void StopMotion()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current.set_identifier(0);
+        }
+        replaced.notify_all();
+    }
+
+    void SetMotion(int milliseconds)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        motion_ms = milliseconds;
+    }
+
+    void SetEndFirst(bool bEnable)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bEndFirst = bEnable;
+    }
+
+    std::chrono::steady_clock::time_point GetEndSent()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return endSent;
+    }
+
+    //the motions still running are stopped
+    void Join()
+    {
+        StopMotion();
+        std::vector<std::thread> ended;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ended.swap(motions);
+        }
+        for (auto &motion : ended)
+        {
+            motion.join();
+        }
+    }
+};
+
+static double Median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+int main()
+{
+    bool bOk = true;
+    const std::vector<float> angles(ACTUATOR_COUNT, 10.0f);
+    const k_api::Base::JointTrajectoryConstraint constraint;
+
+    std::unique_ptr<tSlowArm> arms[2];
+    std::unique_ptr<KortexRobot> robots[2];
+    try
+    {
+        arms[0].reset(new tSlowArm("127.0.0.1"));
+        arms[1].reset(new tSlowArm("127.0.0.2"));
+    }
+    catch (k_api::KBasicException &ex)
+    {
+        std::cerr << "Cannot serve the simulated robots: " << ex.what() << std::endl;
+        return 1;
+    }
+    robots[0].reset(new KortexRobot("127.0.0.1"));
+    robots[1].reset(new KortexRobot("127.0.0.2"));
+    if (!Check(robots[0]->IsConnected() && robots[1]->IsConnected(), "robots connected"))
+    {
+        return 1;
+    }
+    KortexRobot &robot = *robots[0];
+    tSlowArm &arm = *arms[0];
+
+    //1- completion futures
+    tActionCompletion completion = robot.SetJointAngles(angles, constraint);
+    bool bStarted = completion.started.wait_for(std::chrono::seconds(1)) == std::future_status::ready;
+    bool bFinished = completion.finished.wait_for(std::chrono::seconds(1)) == std::future_status::ready;
+    bOk &= Check(bStarted && bFinished && completion.finished.get() == k_api::Base::ACTION_END && !robot.IsBusy(),
+                 "completion: ACTION_START then ACTION_END");
+    bOk &= Check(robot.SetJointAngles(std::vector<float>(1, 0.0f), constraint).finished.get() == k_api::Base::UNSPECIFIED_ACTION_EVENT,
+                 "completion: a rejected action is finished at once");
+
+    //2- wake latency, condition variable then 10 ms poll
+    std::vector<double> woken_ms, polled_ms;
+    for (int i = 0; i < WAIT_ITERATIONS; i++)
+    {
+        robot.SetJointAngles(angles, constraint);
+        robot.WaitWhileRobotIsMoving(1000);
+        woken_ms.push_back(ElapsedMs(arm.GetEndSent(), std::chrono::steady_clock::now()));
+    }
+    for (int i = 0; i < WAIT_ITERATIONS; i++)
+    {
+        robot.SetJointAngles(angles, constraint);
+        while (robot.IsBusy())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+        }
+        polled_ms.push_back(ElapsedMs(arm.GetEndSent(), std::chrono::steady_clock::now()));
+    }
+    std::cout << "wake after ACTION_END: condition variable median " << Median(woken_ms) << " ms, max "
+              << *std::max_element(woken_ms.begin(), woken_ms.end()) << " ms; " << POLL_MS << " ms poll median "
+              << Median(polled_ms) << " ms, max " << *std::max_element(polled_ms.begin(), polled_ms.end()) << " ms" << std::endl;
+    bOk &= Check(Median(woken_ms) < POLL_MS / 2.0, "wait: woken by ACTION_END, not by a poll");
+
+    //3- deadline, then Stop
+    arm.SetMotion(-1);
+    completion = robot.SetJointAngles(angles, constraint);
+    auto start = std::chrono::steady_clock::now();
+    bool bWaited = robot.WaitWhileRobotIsMoving(DEADLINE_MS);
+    double waited_ms = ElapsedMs(start, std::chrono::steady_clock::now());
+    bOk &= Check(!bWaited && waited_ms >= DEADLINE_MS && robot.GetMotionState() == KortexRobot::MOVING,
+                 "deadline: false after " + std::to_string(int(waited_ms)) + " ms, still moving");
+    robot.Stop();
+    bOk &= Check(robot.WaitWhileRobotIsMoving(1000) && completion.finished.get() == k_api::Base::ACTION_ABORT,
+                 "deadline: Stop ends it with ACTION_ABORT");
+
+    //4- a paused action replaced by a new one
+    tActionCompletion paused = robot.SetJointAngles(angles, constraint);
+    paused.started.wait_for(std::chrono::seconds(1));
+    robot.m_pBase->PauseAction();
+    bool bPaused = robot.WaitWhileRobotIsMoving(1000) && robot.GetMotionState() == KortexRobot::PAUSED;
+    arm.SetMotion(MOTION_MS);
+    completion = robot.SetJointAngles(angles, constraint);
+    bool bReplaced = completion.finished.wait_for(std::chrono::seconds(1)) == std::future_status::ready
+                  && paused.finished.wait_for(std::chrono::seconds(1)) == std::future_status::ready;
+    bOk &= Check(bPaused && bReplaced && paused.finished.get() == k_api::Base::ACTION_ABORT
+                 && completion.finished.get() == k_api::Base::ACTION_END && !robot.IsBusy(),
+                 "replace: the paused action aborted, the new one ended");
+
+    //5- two robots
+    std::vector<KortexRobot*> both = {robots[0].get(), robots[1].get()};
+    arms[1]->SetMotion(SLOW_MOTION_MS);
+    robots[1]->SetJointAngles(angles, constraint);
+    robots[0]->SetJointAngles(angles, constraint);
+    start = std::chrono::steady_clock::now();
+    int first = KortexRobot::WaitAny(both, start + std::chrono::seconds(1));
+    double any_ms = ElapsedMs(start, std::chrono::steady_clock::now());
+    bool bAll = KortexRobot::WaitAll(both, start + std::chrono::seconds(1));
+    double all_ms = ElapsedMs(start, std::chrono::steady_clock::now());
+    std::cout << "two robots: WaitAny after " << any_ms << " ms, WaitAll after " << all_ms << " ms" << std::endl;
+    bOk &= Check(first == 0 && any_ms < SLOW_MOTION_MS, "WaitAny: the faster robot");
+    bOk &= Check(bAll && all_ms >= SLOW_MOTION_MS * 0.9 && !robots[0]->IsBusy() && !robots[1]->IsBusy(), "WaitAll: both robots");
+
+    arms[0]->SetMotion(-1);
+    arms[1]->SetMotion(-1);
+    robots[0]->SetJointAngles(angles, constraint);
+    robots[1]->SetJointAngles(angles, constraint);
+    start = std::chrono::steady_clock::now();
+    first = KortexRobot::WaitAny(both, start + std::chrono::milliseconds(DEADLINE_MS));
+    bOk &= Check(first == -1 && ElapsedMs(start, std::chrono::steady_clock::now()) >= DEADLINE_MS, "WaitAny: -1 at the deadline");
+    robots[0]->Stop();
+    robots[1]->Stop();
+    bOk &= Check(KortexRobot::WaitAll(both, std::chrono::steady_clock::now() + std::chrono::seconds(1)), "WaitAll: both stopped");
+
+    //6- ACTION_END delivered before ACTION_START
+    arm.Join();
+    arm.SetMotion(MOTION_MS);
+    arm.SetEndFirst(true);
+    completion = robot.SetJointAngles(angles, constraint);
+    bool bEnded = completion.finished.wait_for(std::chrono::seconds(1)) == std::future_status::ready
+               && completion.finished.get() == k_api::Base::ACTION_END;
+    arm.Join();     //the late ACTION_START is sent
+    std::this_thread::sleep_for(std::chrono::milliseconds(DEADLINE_MS));
+    bool bIdle = !robot.IsBusy() && robot.WaitWhileRobotIsMoving(DEADLINE_MS);
+    arm.SetEndFirst(false);
+    completion = robot.SetJointAngles(angles, constraint);
+    bool bNext = completion.finished.wait_for(std::chrono::seconds(1)) == std::future_status::ready
+              && completion.finished.get() == k_api::Base::ACTION_END;
+    bOk &= Check(bEnded && bIdle && bNext, "late start: ignored, the robot stays idle and takes the next action");
+
+    arms[0]->Join();
+    arms[1]->Join();
+    robots[0].reset();
+    robots[1].reset();
+    return bOk ? 0 : 1;
+}
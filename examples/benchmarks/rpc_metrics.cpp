@@ -0,0 +1,217 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Checks and times MetricsTransport, the per function UID counters of the frames of a RouterClient, no robot needed.
+*
+* 1- Frames handed to a MetricsTransport by hand: a call and its response, a server error, a request timing out then
+*    answered late, a notification and bytes which are not a frame, each one counted where it belongs, and the
+*    Prometheus text of the counters.
+* 2- A KortexConnection with bRpcMetrics against an in-process SimulatedRobot: the CreateSession of the bring-up and
+*    every Base::GetArmState are counted, answered and none is left in flight.
+* 3- Benchmark: the time a request and its response take through a MetricsTransport, against the bare transport.
+*
+* The process returns 1 if a check fails.
+*/
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <HeaderInfo.h>
+#include <KDetailedException.h>
+
+#include <KortexConnection.h>
+#include <MetricsTransport.h>
+#include <SimulatedRobot.h>
+
+#include "BenchmarkCheck.h"
+
+#define GET_ARM_STATE_CALLS 100
+#define TIMEOUT_MS 50
+#define BENCHMARK_ITERATIONS 1000000
+
+namespace k_api = Kinova::Api;
+
+//transport of nothing: sends nowhere, receives what Deliver() is given
+class tPipeTransport : public k_api::ITransportClient
+{
+public:
+    tPipeTransport() : m_TxBuffer(1024) {readyState = k_api::OPEN;}
+
+    virtual bool connect(std::string, uint32_t) override {return true;}
+    virtual void disconnect() override {}
+    virtual void send(const char*, uint32_t txSize) override {m_nTxBytes += txSize;}
+    virtual void onMessage(std::function<void (const char*, uint32_t)> callback) override {m_Callback = callback;}
+    virtual char* getTxBuffer(uint32_t const &allocation_size) override {m_TxBuffer.resize(allocation_size); return m_TxBuffer.data();}
+    virtual size_t getMaxTxBufferSize() override {return 65507;}
+    virtual void getHostAddress(std::string &host, uint32_t &port) override {host = "pipe"; port = 0;}
+
+    void Deliver(const std::string &bytes) {m_Callback(bytes.data(), uint32_t(bytes.size()));}
+
+    uint64_t m_nTxBytes = 0;
+
+private:
+    std::vector<char> m_TxBuffer;
+    std::function<void (const char*, uint32_t)> m_Callback;
+};
+
+static std::string MakeFrame(k_api::FrameTypes type, uint32_t functionUid, uint16_t messageId,
+                             uint32_t errorCode = k_api::ERROR_NONE, size_t payloadBytes = 16)
+{
+    k_api::HeaderInfo header;
+    header.m_frameInfo.frame_info = 0;
+    header.m_frameInfo.frameType = type;
+    header.m_frameInfo.headerVersion = k_api::CURRENT_VERSION;
+    header.m_frameInfo.errorCode = errorCode;
+    header.m_messageInfo.message_info = 0;
+    header.m_messageInfo.messageId = messageId;
+    header.m_serviceInfo.service_info = 0;
+    header.m_serviceInfo.functionUid = functionUid;
+    header.m_serviceInfo.serviceVersion = 1;
+    header.m_payloadInfo.payload_info = 0;
+    header.m_payloadInfo.payloadLength = uint32_t(payloadBytes);
+
+    k_api::Frame frame;
+    header.fillHeader(frame.mutable_header());
+    frame.set_payload(std::string(payloadBytes, 'x'));
+    return frame.SerializeAsString();
+}
+
+static const tRpcMetrics* Find(const std::vector<tRpcMetrics> &metrics, const std::string &channel, uint32_t functionUid)
+{
+    for (const tRpcMetrics &function : metrics)
+    {
+        if (function.channel == channel && function.functionUid == functionUid)
+        {
+            return &function;
+        }
+    }
+    return nullptr;
+}
+
+static bool CheckFrames()
+{
+    bool bOk = true;
+    tPipeTransport pipe;
+    MetricsTransport metrics(&pipe, "tcp", TIMEOUT_MS);
+    metrics.onMessage([](const char*, uint32_t) {});
+
+    const std::string request = MakeFrame(k_api::MSG_FRAME_REQUEST, k_api::Base::eUidGetArmState, 1);
+    const std::string response = MakeFrame(k_api::MSG_FRAME_RESPONSE, k_api::Base::eUidGetArmState, 1, k_api::ERROR_NONE, 40);
+    metrics.send(request.data(), uint32_t(request.size()));
+    pipe.Deliver(response);
+
+    const std::string failedRequest = MakeFrame(k_api::MSG_FRAME_REQUEST, k_api::Base::eUidPlayCartesianTrajectory, 2);
+    metrics.send(failedRequest.data(), uint32_t(failedRequest.size()));
+    pipe.Deliver(MakeFrame(k_api::MSG_FRAME_RESPONSE, k_api::Base::eUidPlayCartesianTrajectory, 2, k_api::ERROR_DEVICE));
+
+    const std::string lostRequest = MakeFrame(k_api::MSG_FRAME_REQUEST, k_api::DeviceManager::eUidReadAllDevices, 3);
+    metrics.send(lostRequest.data(), uint32_t(lostRequest.size()));
+    bOk &= Check(Find(metrics.GetSnapshot(), "tcp", k_api::DeviceManager::eUidReadAllDevices)->nInFlight == 1, "frames: request in flight");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * TIMEOUT_MS));
+    std::vector<tRpcMetrics> snapshot = metrics.GetSnapshot();
+    const tRpcMetrics *pLost = Find(snapshot, "tcp", k_api::DeviceManager::eUidReadAllDevices);
+    bOk &= Check(pLost->nTimeouts == 1 && pLost->nInFlight == 0, "frames: request timed out");
+    pipe.Deliver(MakeFrame(k_api::MSG_FRAME_RESPONSE, k_api::DeviceManager::eUidReadAllDevices, 3));
+
+    pipe.Deliver(MakeFrame(k_api::MSG_FRAME_NOTIFICATION, k_api::Base::eUidActionTopic, 0));
+    pipe.Deliver(std::string("\xff\xff\xff", 3));
+
+    snapshot = metrics.GetSnapshot();
+    const tRpcMetrics *pArmState = Find(snapshot, "tcp", k_api::Base::eUidGetArmState);
+    const tRpcMetrics *pFailed = Find(snapshot, "tcp", k_api::Base::eUidPlayCartesianTrajectory);
+    pLost = Find(snapshot, "tcp", k_api::DeviceManager::eUidReadAllDevices);
+    const tRpcMetrics *pAction = Find(snapshot, "tcp", k_api::Base::eUidActionTopic);
+    bOk &= Check(pArmState != nullptr && pArmState->name == "Base.GetArmState" && pArmState->nCalls == 1
+                 && pArmState->nResponses == 1 && pArmState->nInFlight == 0 && pArmState->latency.GetCount() == 1
+                 && pArmState->nTxBytes == request.size() && pArmState->nRxBytes == response.size(),
+                 "frames: call and response");
+    bOk &= Check(pFailed != nullptr && pFailed->nServerErrors == 1 && pFailed->nResponses == 1, "frames: server error");
+    bOk &= Check(pLost->nLateResponses == 1 && pLost->nResponses == 0, "frames: late response");
+    bOk &= Check(pAction != nullptr && pAction->name == "Base.ActionTopic" && pAction->nNotifications == 1, "frames: notification");
+    bOk &= Check(metrics.GetMalformedCount() == 1, "frames: malformed frame");
+    bOk &= Check(snapshot.front().functionUid == k_api::Base::eUidGetArmState, "frames: largest bytes first");
+
+    const std::string text = MetricsTransport::ToPrometheus(snapshot);
+    bOk &= Check(text.find("# TYPE kortex_rpc_latency_seconds histogram") != std::string::npos
+                 && text.find("kortex_rpc_calls_total{channel=\"tcp\",function=\"Base.GetArmState\"") != std::string::npos
+                 && text.find("le=\"+Inf\"} 1") != std::string::npos, "frames: Prometheus text");
+    return bOk;
+}
+
+static bool CheckConnection()
+{
+    SimulatedRobot robot;
+    tConnectionSettings settings;
+    settings.pLoopbackServer = &robot;
+    settings.bRpcMetrics = true;
+    std::unique_ptr<KortexConnection> pConnection = KortexConnection::Create(settings, KORTEX_CLIENT_BASE);
+    for (int i = 0; i < GET_ARM_STATE_CALLS; i++)
+    {
+        pConnection->GetBase()->GetArmState();
+    }
+
+    std::vector<tRpcMetrics> metrics = pConnection->GetRpcMetrics();
+    const tRpcMetrics *pSession = Find(metrics, "tcp", k_api::Session::eUidCreateSession);
+    const tRpcMetrics *pArmState = Find(metrics, "tcp", k_api::Base::eUidGetArmState);
+    bool bOk = Check(pSession != nullptr && pSession->nCalls == 1 && pSession->nResponses == 1, "connection: CreateSession");
+    bOk &= Check(pArmState != nullptr && pArmState->nCalls == GET_ARM_STATE_CALLS && pArmState->nResponses == GET_ARM_STATE_CALLS
+                 && pArmState->nInFlight == 0 && pArmState->nTimeouts == 0, "connection: GetArmState");
+    if (pArmState != nullptr)
+    {
+        std::cout << "GetArmState in process: " << pArmState->latency.ToString() << std::endl;
+    }
+    return bOk;
+}
+
+static double TimeRoundTrip(k_api::ITransportClient &transport, tPipeTransport &pipe)
+{
+    const std::string request = MakeFrame(k_api::MSG_FRAME_REQUEST, k_api::Base::eUidGetArmState, 7);
+    const std::string response = MakeFrame(k_api::MSG_FRAME_RESPONSE, k_api::Base::eUidGetArmState, 7, k_api::ERROR_NONE, 40);
+    transport.onMessage([](const char*, uint32_t) {});
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        transport.send(request.data(), uint32_t(request.size()));
+        pipe.Deliver(response);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_ITERATIONS;
+}
+
+int main()
+{
+    bool bOk = CheckFrames();
+    try
+    {
+        bOk &= CheckConnection();
+    }
+    catch (k_api::KBasicException &exception)
+    {
+        bOk = Check(false, std::string("connection: ") + exception.what());
+    }
+
+    tPipeTransport bare;
+    double bare_ns = TimeRoundTrip(bare, bare);
+    tPipeTransport pipe;
+    MetricsTransport metrics(&pipe);
+    double metrics_ns = TimeRoundTrip(metrics, pipe);
+    std::cout << "request and response: bare transport " << bare_ns << " ns, MetricsTransport " << metrics_ns
+              << " ns, " << metrics_ns - bare_ns << " ns of counting" << std::endl;
+
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT BENCHMARK:
+* =================================
+* Where a short-lived tool spends its time before its first useful RPC, against an in-process SimulatedRobot, or an arm
+* or kortex_standin_server with --ip.
+*
+* 1- Static initialization, up to main: the default instances of every .pb.cc linked in the binary.
+* 2- Descriptors: the first descriptor() of each service, which builds its file (and those it imports) from the
+*    generated pool, as reflection, DebugString() or a JSON conversion do.
+* 3- --repetitions bring-ups of a KortexConnection with the --clients, the first one cold, then:
+*    - connect and CreateSession of each channel
+*    - the construction of each client, on first use
+*    - the first RPC: DeviceManager::ReadAllDevices, or Base::GetArmState without device-manager
+*
+* The phases are printed as a StartupTrace, which any tool using KortexConnection prints at exit when
+* KORTEX_STARTUP_TRACE is set in the environment. This benchmark links every service; a tool only getting the
+* DeviceManager client does not link Base, and its static initialization is shorter by the part of Base.
+*
+* The process returns 1 if a bring-up fails or gives a client that was not requested.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <KDetailedException.h>
+
+#include <KortexConnection.h>
+#include <SimulatedRobot.h>
+#include <StartupTrace.h>
+
+#include "BenchmarkCheck.h"
+
+namespace k_api = Kinova::Api;
+
+struct tClientOption
+{
+    const char *name;
+    uint32_t client;
+};
+
+static const tClientOption CLIENT_OPTIONS[] =
+{
+    {"base", KORTEX_CLIENT_BASE},
+    {"device-config", KORTEX_CLIENT_DEVICE_CONFIG},
+    {"device-manager", KORTEX_CLIENT_DEVICE_MANAGER},
+    {"actuator-config", KORTEX_CLIENT_ACTUATOR_CONFIG},
+    {"control-config", KORTEX_CLIENT_CONTROL_CONFIG},
+    {"interconnect-config", KORTEX_CLIENT_INTERCONNECT_CONFIG},
+    {"base-cyclic", KORTEX_CLIENT_BASE_CYCLIC},
+    {"actuator-cyclic", KORTEX_CLIENT_ACTUATOR_CYCLIC},
+    {"interconnect-cyclic", KORTEX_CLIENT_INTERCONNECT_CYCLIC},
+    {"gripper-cyclic", KORTEX_CLIENT_GRIPPER_CYCLIC},
+};
+
+static bool ParseClients(const std::string &list, uint32_t &clients)
+{
+    clients = 0;
+    std::istringstream stream(list);
+    std::string name;
+    while (std::getline(stream, name, ','))
+    {
+        bool bFound = false;
+        for (const tClientOption &option : CLIENT_OPTIONS)
+        {
+            if (name == option.name)
+            {
+                clients |= option.client;
+                bFound = true;
+            }
+        }
+        if (!bFound)
+        {
+            std::cerr << "Unknown client " << name << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+//the first descriptor() of a message of each service, the files it imports are built by the first one importing them
+static void BuildDescriptors()
+{
+    struct tService
+    {
+        const char *name;
+        const google::protobuf::Descriptor* (*descriptor)();
+    };
+    const tService services[] =
+    {
+        {"Common", &k_api::Common::Timestamp::descriptor},
+        {"Errors", &k_api::Error::descriptor},
+        {"Frame", &k_api::Frame::descriptor},
+        {"Session", &k_api::Session::CreateSessionInfo::descriptor},
+        {"DeviceManager", &k_api::DeviceManager::DeviceHandles::descriptor},
+        {"DeviceConfig", &k_api::DeviceConfig::DeviceType::descriptor},
+        {"ActuatorConfig", &k_api::ActuatorConfig::ControlModeInformation::descriptor},
+        {"ControlConfig", &k_api::ControlConfig::GravityVector::descriptor},
+        {"InterconnectConfig", &k_api::InterconnectConfig::EthernetConfiguration::descriptor},
+        {"BaseCyclic", &k_api::BaseCyclic::Feedback::descriptor},
+        {"ActuatorCyclic", &k_api::ActuatorCyclic::Feedback::descriptor},
+        {"Base", &k_api::Base::Action::descriptor},
+    };
+    for (const tService &service : services)
+    {
+        StartupTrace::Scope scope(std::string("descriptors ") + service.name);
+        service.descriptor();
+    }
+}
+
+//one bring-up, its clients and the first RPC
+static bool BringUp(const tConnectionSettings &settings, uint32_t clients, int repetition)
+{
+    const std::string suffix = " #" + std::to_string(repetition);
+    StartupTrace::Scope scope("bring-up" + suffix);
+    std::unique_ptr<KortexConnection> pConnection = KortexConnection::Create(settings, clients);
+
+    bool bOk = true;
+    for (const tClientOption &option : CLIENT_OPTIONS)
+    {
+        void *pClient = nullptr;
+        switch (option.client)
+        {
+        case KORTEX_CLIENT_BASE: pClient = pConnection->GetBase(); break;
+        case KORTEX_CLIENT_DEVICE_CONFIG: pClient = pConnection->GetDeviceConfig(); break;
+        case KORTEX_CLIENT_DEVICE_MANAGER: pClient = pConnection->GetDeviceManager(); break;
+        case KORTEX_CLIENT_ACTUATOR_CONFIG: pClient = pConnection->GetActuatorConfig(); break;
+        case KORTEX_CLIENT_CONTROL_CONFIG: pClient = pConnection->GetControlConfig(); break;
+        case KORTEX_CLIENT_INTERCONNECT_CONFIG: pClient = pConnection->GetInterconnectConfig(); break;
+        case KORTEX_CLIENT_BASE_CYCLIC: pClient = pConnection->GetBaseCyclic(); break;
+        case KORTEX_CLIENT_ACTUATOR_CYCLIC: pClient = pConnection->GetActuatorCyclic(); break;
+        case KORTEX_CLIENT_INTERCONNECT_CYCLIC: pClient = pConnection->GetInterconnectCyclic(); break;
+        case KORTEX_CLIENT_GRIPPER_CYCLIC: pClient = pConnection->GetGripperCyclic(); break;
+        }
+        if ((pClient != nullptr) != ((clients & option.client) != 0))
+        {
+            bOk = Check(false, std::string(option.name) + " client created only when requested");
+        }
+    }
+
+    {
+        StartupTrace::Scope rpcScope("first rpc" + suffix);
+        if (pConnection->GetDeviceManager() != nullptr)
+        {
+            pConnection->GetDeviceManager()->ReadAllDevices();
+        }
+        else if (pConnection->GetBase() != nullptr)
+        {
+            pConnection->GetBase()->GetArmState();
+        }
+    }
+    std::cout << "bring-up" << suffix << ": " << pConnection->GetStartupTiming().ToString() << std::endl;
+    return bOk;
+}
+
+int main(int argc, char **argv)
+{
+    StartupTrace::Enable();
+    StartupTrace::Mark("main");
+
+    cxxopts::Options options(argv[0], "Startup time of a Kortex tool, phase by phase");
+    options.add_options()
+        ("ip", "IP address of the arm or of the stand-in, in process when not given", cxxopts::value<std::string>())
+        ("username", "Username", cxxopts::value<std::string>()->default_value("admin"))
+        ("password", "Password", cxxopts::value<std::string>()->default_value("admin"))
+        ("clients", "Clients of the bring-up: base, device-manager, base-cyclic...",
+            cxxopts::value<std::string>()->default_value("device-manager"))
+        ("repetitions", "Bring-ups, the first one cold", cxxopts::value<int>()->default_value("3"))
+        ("h,help", "Print usage");
+
+    tConnectionSettings settings;
+    uint32_t clients;
+    int repetitions;
+    bool bInProcess;
+    try
+    {
+        auto parsed = options.parse(argc, argv);
+        if (parsed.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        bInProcess = parsed.count("ip") == 0;
+        if (!bInProcess)
+        {
+            settings.IP = parsed["ip"].as<std::string>();
+        }
+        settings.username = parsed["username"].as<std::string>();
+        settings.password = parsed["password"].as<std::string>();
+        repetitions = std::max(1, parsed["repetitions"].as<int>());
+        if (!ParseClients(parsed["clients"].as<std::string>(), clients))
+        {
+            return 1;
+        }
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cerr << e.what() << std::endl << options.help() << std::endl;
+        return 1;
+    }
+
+    BuildDescriptors();
+
+    std::unique_ptr<SimulatedRobot> pRobot;
+    if (bInProcess)
+    {
+        StartupTrace::Scope scope("simulated robot");
+        pRobot.reset(new SimulatedRobot());
+        settings.pLoopbackServer = pRobot.get();
+    }
+
+    bool bOk = true;
+    for (int i = 0; i < repetitions; i++)
+    {
+        try
+        {
+            bOk &= BringUp(settings, clients, i);
+        }
+        catch (k_api::KDetailedException &exception)
+        {
+            bOk = Check(false, std::string("bring-up: ") + exception.what());
+        }
+        catch (k_api::KBasicException &exception)
+        {
+            bOk = Check(false, std::string("bring-up: ") + exception.what());
+        }
+    }
+
+    std::cout << StartupTrace::ToString();
+    return bOk ? 0 : 1;
+}
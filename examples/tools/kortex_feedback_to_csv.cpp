@@ -0,0 +1,146 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT TOOL:
+* ============================
+* Converts a FeedbackLog recording to CSV, one row per feedback, oldest first, for a spreadsheet or a plot. The blocks
+* are read from the mapping of the file as they are: a recording cut by a crash is converted up to its last write.
+*
+*    kortex_feedback_to_csv --input arm.kflg --output arm.csv --columns time_ns,actuators[0].position,base.tool_pose_x
+*
+* --info prints the columns and the blocks instead, with the feedbacks the recorder dropped.
+*/
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <KDetailedException.h>
+
+#include <FeedbackLog.h>
+
+namespace k_api = Kinova::Api;
+
+static void PrintInfo(const FeedbackLog::Reader &reader)
+{
+    std::cout << reader.GetActuatorCount() << " actuators, " << reader.GetColumns().size() << " columns:" << std::endl;
+    for (const FeedbackLog::tColumn &column : reader.GetColumns())
+    {
+        const char *type = column.type == FeedbackLog::U64 ? "u64" : column.type == FeedbackLog::F32 ? "f32" : "u32";
+        std::cout << "  " << column.name << " " << type << std::endl;
+    }
+
+    uint64_t dropped = 0;
+    std::cout << reader.GetBlocks().size() << " blocks, " << reader.GetSampleCount() << " feedbacks:" << std::endl;
+    for (const FeedbackLog::Reader::tBlock &block : reader.GetBlocks())
+    {
+        std::cout << "  #" << block.sequence << " " << block.sampleCount << " feedbacks from " << block.firstTime_ns
+                  << " to " << block.lastTime_ns << " ns";
+        if (block.droppedCount)
+        {
+            std::cout << ", " << block.droppedCount << " dropped before";
+        }
+        std::cout << std::endl;
+        dropped += block.droppedCount;
+    }
+    std::cout << dropped << " feedbacks dropped" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options(argv[0], "Converts a FeedbackLog recording to CSV");
+    options.add_options()
+        ("input", "Recording", cxxopts::value<std::string>())
+        ("output", "CSV file, standard output when not given", cxxopts::value<std::string>())
+        ("columns", "Comma separated columns, all of them when not given", cxxopts::value<std::string>())
+        ("info", "Print the columns and the blocks instead")
+        ("h,help", "Print usage");
+
+    std::string input, output, columnList;
+    bool bInfo;
+    try
+    {
+        auto parsed = options.parse(argc, argv);
+        if (parsed.count("help") || parsed.count("input") == 0)
+        {
+            std::cout << options.help() << std::endl;
+            return parsed.count("help") ? 0 : 1;
+        }
+        input = parsed["input"].as<std::string>();
+        if (parsed.count("output"))
+        {
+            output = parsed["output"].as<std::string>();
+        }
+        if (parsed.count("columns"))
+        {
+            columnList = parsed["columns"].as<std::string>();
+        }
+        bInfo = parsed.count("info") > 0;
+    }
+    catch (cxxopts::OptionException &exception)
+    {
+        std::cerr << exception.what() << std::endl << options.help() << std::endl;
+        return 1;
+    }
+
+    FeedbackLog::Reader reader;
+    try
+    {
+        reader.Open(input);
+    }
+    catch (k_api::KBasicException &exception)
+    {
+        std::cerr << input << ": " << exception.what() << std::endl;
+        return 1;
+    }
+
+    if (bInfo)
+    {
+        PrintInfo(reader);
+        return 0;
+    }
+
+    std::vector<int> columns;
+    std::istringstream stream(columnList);
+    std::string name;
+    while (std::getline(stream, name, ','))
+    {
+        int column = reader.FindColumn(name);
+        if (column < 0)
+        {
+            std::cerr << "Unknown column " << name << ", --info lists them" << std::endl;
+            return 1;
+        }
+        columns.push_back(column);
+    }
+
+    if (output.empty())
+    {
+        reader.WriteCsv(std::cout, columns);
+        return std::cout ? 0 : 1;
+    }
+    std::ofstream file(output);
+    if (!file)
+    {
+        std::cerr << "Cannot create " << output << std::endl;
+        return 1;
+    }
+    reader.WriteCsv(file, columns);
+    file.close();
+    return file ? 0 : 1;
+}
@@ -0,0 +1,507 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT TOOL:
+* ============================
+* RPC load generator on the Test service, against kortex_standin_server, a real controller or an in-process
+* SimulatedRobot (--in-process). --threads threads share one router and session and each keeps --in-flight calls
+* pending, for --duration seconds, in one of the call styles of the generated clients:
+*
+*    sync      TestParamAndReturn(...), one call at a time per thread
+*    future    TestParamAndReturn_async(...), the oldest future is waited for before the next call
+*    callback  TestParamAndReturn_callback(...), a call is made as soon as one returns
+*    forget    RouterClient::send with andForget, the time is the one of the send only
+*
+* on one of the RPCs:
+*
+*    param-and-return  echo of a SendStruct with a --payload-bytes string
+*    concurrence       TestConcurrence
+*    async             TestAsync, answered after --delay-ms
+*    wait              Wait, answered after --delay-ms
+*    trigger-notif     TestTriggerNotif
+*    timeout           TestTimeout, never answered: every call times out after --timeout-ms
+*
+* The throughput and the p50, p99 and p99.9 latencies of the answered calls are printed at the end, with the calls that
+* failed and those that timed out, for example:
+*
+*    kortex_load_generator --ip 127.0.0.1 --threads 4 --in-flight 8 --style future --rpc param-and-return
+*
+* With --metrics, the frames are also counted per function UID by a MetricsTransport: the functions using the most
+* bytes are printed and the counters written to the file in the Prometheus text format.
+*
+* With KORTEX_STARTUP_TRACE set in the environment, the time spent before the load starts is printed at exit.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <KDetailedException.h>
+#include <TestClientRpc.h>
+
+#include <KortexConnection.h>
+#include <LatencyHistogram.h>
+#include <SimulatedRobot.h>
+#include <StartupTrace.h>
+
+namespace k_api = Kinova::Api;
+
+#define TEST_SERVICE_VERSION 1
+#define LATE_ANSWER_MARGIN_MS 1000
+
+//a call of the future style, whatever its result type
+struct tPendingCall
+{
+    std::chrono::steady_clock::time_point start;
+    std::function<bool(std::chrono::milliseconds)> wait;    //true when ready
+    std::function<void()> get;                              //throws the error of the call
+};
+
+template <class T>
+static tPendingCall MakePendingCall(std::future<T> future)
+{
+    auto pFuture = std::make_shared<std::future<T>>(std::move(future));
+    tPendingCall call;
+    call.start = std::chrono::steady_clock::now();
+    call.wait = [pFuture](std::chrono::milliseconds timeout) {return pFuture->wait_for(timeout) == std::future_status::ready;};
+    call.get = [pFuture]() {pFuture->get();};
+    return call;
+}
+
+//one RPC of the Test service in every style
+struct tRpc
+{
+    uint32_t functionUid;
+    std::string payload;    //for the forget style
+    std::function<void(const k_api::RouterClientSendOptions&)> sync;
+    std::function<tPendingCall(const k_api::RouterClientSendOptions&)> async;
+    std::function<void(std::function<void(const k_api::Error&)>)> callback;
+};
+
+static bool MakeRpc(const std::string &name, k_api::Test::TestClient &test, uint32_t payloadBytes, uint32_t delay_ms, tRpc &rpc)
+{
+    if (name == "param-and-return")
+    {
+        k_api::Test::SendStruct sent;
+        sent.set_uint32_value(1);
+        sent.set_string_value(std::string(payloadBytes, 'k'));
+        rpc.functionUid = k_api::Test::eUidTestParamAndReturn;
+        rpc.payload = sent.SerializeAsString();
+        rpc.sync = [&test, sent](const k_api::RouterClientSendOptions &options) {test.TestParamAndReturn(sent, 0, options);};
+        rpc.async = [&test, sent](const k_api::RouterClientSendOptions &options) {return MakePendingCall(test.TestParamAndReturn_async(sent, 0, options));};
+        rpc.callback = [&test, sent](std::function<void(const k_api::Error&)> done)
+        {
+            test.TestParamAndReturn_callback(sent, [done](const k_api::Error &error, const k_api::Test::RcvStruct&) {done(error);});
+        };
+    }
+    else if (name == "concurrence")
+    {
+        rpc.functionUid = k_api::Test::eUidTestConcurrence;
+        rpc.sync = [&test](const k_api::RouterClientSendOptions &options) {test.TestConcurrence(0, options);};
+        rpc.async = [&test](const k_api::RouterClientSendOptions &options) {return MakePendingCall(test.TestConcurrence_async(0, options));};
+        rpc.callback = [&test](std::function<void(const k_api::Error&)> done) {test.TestConcurrence_callback(done);};
+    }
+    else if (name == "async")
+    {
+        k_api::Test::timeToResponse time;
+        time.set_time_ms(delay_ms);
+        rpc.functionUid = k_api::Test::eUidTestAsync;
+        rpc.payload = time.SerializeAsString();
+        rpc.sync = [&test, time](const k_api::RouterClientSendOptions &options) {test.TestAsync(time, 0, options);};
+        rpc.async = [&test, time](const k_api::RouterClientSendOptions &options) {return MakePendingCall(test.TestAsync_async(time, 0, options));};
+        rpc.callback = [&test, time](std::function<void(const k_api::Error&)> done) {test.TestAsync_callback(time, done);};
+    }
+    else if (name == "wait")
+    {
+        k_api::Test::Delay delay;
+        delay.set_ms(delay_ms);
+        rpc.functionUid = k_api::Test::eUidWait;
+        rpc.payload = delay.SerializeAsString();
+        rpc.sync = [&test, delay](const k_api::RouterClientSendOptions &options) {test.Wait(delay, 0, options);};
+        rpc.async = [&test, delay](const k_api::RouterClientSendOptions &options) {return MakePendingCall(test.Wait_async(delay, 0, options));};
+        rpc.callback = [&test, delay](std::function<void(const k_api::Error&)> done) {test.Wait_callback(delay, done);};
+    }
+    else if (name == "trigger-notif")
+    {
+        rpc.functionUid = k_api::Test::eUidTestTriggerNotif;
+        rpc.sync = [&test](const k_api::RouterClientSendOptions &options) {test.TestTriggerNotif(0, options);};
+        rpc.async = [&test](const k_api::RouterClientSendOptions &options) {return MakePendingCall(test.TestTriggerNotif_async(0, options));};
+        rpc.callback = [&test](std::function<void(const k_api::Error&)> done) {test.TestTriggerNotif_callback(done);};
+    }
+    else if (name == "timeout")
+    {
+        rpc.functionUid = k_api::Test::eUidTestTimeout;
+        rpc.sync = [&test](const k_api::RouterClientSendOptions &options) {test.TestTimeout(0, options);};
+        rpc.async = [&test](const k_api::RouterClientSendOptions &options) {return MakePendingCall(test.TestTimeout_async(0, options));};
+        rpc.callback = [&test](std::function<void(const k_api::Error&)> done) {test.TestTimeout_callback(done);};
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+struct tLoadSettings
+{
+    std::string style;
+    int nInFlight;
+    std::chrono::steady_clock::time_point end;
+    k_api::RouterClientSendOptions options;
+};
+
+//results of one thread; the callbacks of its calls write them from the thread of the router
+struct tWorker
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::map<uint64_t, std::chrono::steady_clock::time_point> pending;    //callback style
+    uint64_t nNextCall;
+    LatencyHistogram histogram;
+    uint64_t nErrors;
+    uint64_t nTimeouts;
+
+    tWorker(): nNextCall(0), nErrors(0), nTimeouts(0) {}
+
+    //with the mutex held
+    void Complete(std::chrono::steady_clock::time_point start, const k_api::Error &error)
+    {
+        if (error.error_code() == k_api::ERROR_NONE)
+        {
+            histogram.Record(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+        }
+        else if (error.error_sub_code() == k_api::METHOD_TIMEOUT)
+        {
+            nTimeouts++;
+        }
+        else
+        {
+            nErrors++;
+        }
+    }
+
+    //runs one call, classifying the exception it throws
+    void Run(std::chrono::steady_clock::time_point start, const std::function<void()> &call)
+    {
+        k_api::Error error;
+        error.set_error_code(k_api::ERROR_NONE);
+        try
+        {
+            call();
+        }
+        catch (k_api::KDetailedException &exception)
+        {
+            error = exception.getErrorInfo().getError();
+            if (error.error_code() == k_api::ERROR_NONE)
+            {
+                error.set_error_code(k_api::ERROR_DEVICE);
+            }
+        }
+        catch (std::exception&)
+        {
+            error.set_error_code(k_api::ERROR_DEVICE);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        Complete(start, error);
+    }
+};
+
+static void RunSync(tWorker &worker, const tRpc &rpc, const tLoadSettings &settings)
+{
+    while (std::chrono::steady_clock::now() < settings.end)
+    {
+        worker.Run(std::chrono::steady_clock::now(), [&]() {rpc.sync(settings.options);});
+    }
+}
+
+static void RunFuture(tWorker &worker, const tRpc &rpc, const tLoadSettings &settings)
+{
+    //the router sets the timeout on the future, it is waited for a little longer
+    const auto waitTimeout = std::chrono::milliseconds(settings.options.timeout_ms + LATE_ANSWER_MARGIN_MS);
+    std::deque<tPendingCall> calls;
+    while (true)
+    {
+        bool bRunning = std::chrono::steady_clock::now() < settings.end;
+        while (bRunning && int(calls.size()) < settings.nInFlight)
+        {
+            calls.push_back(rpc.async(settings.options));
+        }
+        if (calls.empty())
+        {
+            return;
+        }
+
+        tPendingCall call = calls.front();
+        calls.pop_front();
+        if (call.wait(waitTimeout))
+        {
+            worker.Run(call.start, call.get);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.nTimeouts++;
+        }
+    }
+}
+
+static void RunCallback(tWorker &worker, const tRpc &rpc, const tLoadSettings &settings)
+{
+    //the callbacks have no timeout of their own, a call pending for longer than the one of the options is abandoned
+    const auto timeout = std::chrono::milliseconds(settings.options.timeout_ms);
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    while (true)
+    {
+        auto now = std::chrono::steady_clock::now();
+        for (auto call = worker.pending.begin(); call != worker.pending.end();)
+        {
+            if (now - call->second > timeout)
+            {
+                worker.nTimeouts++;
+                call = worker.pending.erase(call);
+            }
+            else
+            {
+                ++call;
+            }
+        }
+
+        bool bRunning = now < settings.end;
+        if (!bRunning && worker.pending.empty())
+        {
+            return;
+        }
+        if (bRunning && int(worker.pending.size()) < settings.nInFlight)
+        {
+            uint64_t id = worker.nNextCall++;
+            worker.pending[id] = now;
+            tWorker *pWorker = &worker;
+            lock.unlock();
+            rpc.callback([pWorker, id](const k_api::Error &error)
+            {
+                std::lock_guard<std::mutex> callbackLock(pWorker->mutex);
+                auto call = pWorker->pending.find(id);
+                if (call == pWorker->pending.end())
+                {
+                    return;     //already counted as a timeout
+                }
+                pWorker->Complete(call->second, error);
+                pWorker->pending.erase(call);
+                pWorker->condition.notify_one();
+            });
+            lock.lock();
+            continue;
+        }
+        worker.condition.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+static void RunForget(tWorker &worker, const tRpc &rpc, k_api::IRouterClient *pRouter, const tLoadSettings &settings)
+{
+    k_api::RouterClientSendOptions options = settings.options;
+    options.andForget = true;
+    while (std::chrono::steady_clock::now() < settings.end)
+    {
+        auto start = std::chrono::steady_clock::now();
+        worker.Run(start, [&]() {pRouter->send(rpc.payload, TEST_SERVICE_VERSION, rpc.functionUid, 0, options);});
+    }
+}
+
+int main(int argc, char **argv)
+{
+    StartupTrace::Mark("main");
+
+    cxxopts::Options options(argv[0], "RPC load generator on the Test service");
+    options.add_options()
+        ("ip", "IP address of the controller or of the stand-in", cxxopts::value<std::string>()->default_value("127.0.0.1"))
+        ("udp", "Load the UDP channel instead of the TCP one")
+        ("in-process", "Load an in-process SimulatedRobot instead of the network")
+        ("username", "Username", cxxopts::value<std::string>()->default_value("admin"))
+        ("password", "Password", cxxopts::value<std::string>()->default_value("admin"))
+        ("threads", "Threads making calls", cxxopts::value<int>()->default_value("1"))
+        ("in-flight", "Calls pending per thread, future and callback styles", cxxopts::value<int>()->default_value("1"))
+        ("style", "sync, future, callback or forget", cxxopts::value<std::string>()->default_value("sync"))
+        ("rpc", "param-and-return, concurrence, async, wait, trigger-notif or timeout",
+            cxxopts::value<std::string>()->default_value("param-and-return"))
+        ("payload-bytes", "String sent and echoed by param-and-return", cxxopts::value<uint32_t>()->default_value("64"))
+        ("delay-ms", "Answer delay of async and wait", cxxopts::value<uint32_t>()->default_value("10"))
+        ("timeout-ms", "Timeout of a call", cxxopts::value<uint32_t>()->default_value("3000"))
+        ("duration", "Seconds of load", cxxopts::value<int>()->default_value("10"))
+        ("metrics", "Prometheus text file of the RPC counters", cxxopts::value<std::string>())
+        ("h,help", "Print usage");
+
+    tConnectionSettings connectionSettings;
+    tLoadSettings settings;
+    std::string rpcName, metricsPath;
+    uint32_t payloadBytes, delay_ms;
+    int threadCount, duration;
+    bool bUdp, bInProcess;
+    try
+    {
+        auto parsed = options.parse(argc, argv);
+        if (parsed.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        connectionSettings.IP = parsed["ip"].as<std::string>();
+        connectionSettings.username = parsed["username"].as<std::string>();
+        connectionSettings.password = parsed["password"].as<std::string>();
+        bUdp = parsed.count("udp") > 0;
+        bInProcess = parsed.count("in-process") > 0;
+        threadCount = std::max(1, parsed["threads"].as<int>());
+        settings.nInFlight = std::max(1, parsed["in-flight"].as<int>());
+        settings.style = parsed["style"].as<std::string>();
+        rpcName = parsed["rpc"].as<std::string>();
+        payloadBytes = parsed["payload-bytes"].as<uint32_t>();
+        delay_ms = parsed["delay-ms"].as<uint32_t>();
+        settings.options = {false, 0, parsed["timeout-ms"].as<uint32_t>()};
+        duration = parsed["duration"].as<int>();
+        if (parsed.count("metrics"))
+        {
+            metricsPath = parsed["metrics"].as<std::string>();
+            connectionSettings.bRpcMetrics = true;
+        }
+    }
+    catch (cxxopts::OptionException &exception)
+    {
+        std::cerr << exception.what() << std::endl << options.help() << std::endl;
+        return 1;
+    }
+    if (settings.style != "sync" && settings.style != "future" && settings.style != "callback" && settings.style != "forget")
+    {
+        std::cerr << "Unknown style " << settings.style << std::endl;
+        return 1;
+    }
+    if (settings.style == "sync" || settings.style == "forget")
+    {
+        settings.nInFlight = 1;
+    }
+
+    //the workers outlive the connection: a late callback still finds its worker
+    std::vector<std::unique_ptr<tWorker>> workers;
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(new tWorker);
+    }
+
+    std::unique_ptr<SimulatedRobot> pRobot;
+    if (bInProcess)
+    {
+        pRobot.reset(new SimulatedRobot);
+        connectionSettings.pLoopbackServer = pRobot.get();
+    }
+    std::unique_ptr<KortexConnection> pConnection;
+    try
+    {
+        pConnection = KortexConnection::Create(connectionSettings, bUdp ? uint32_t(KORTEX_CLIENT_BASE_CYCLIC) : 0u);
+    }
+    catch (k_api::KBasicException &exception)
+    {
+        std::cerr << "Cannot connect: " << exception.what() << std::endl;
+        return 1;
+    }
+    k_api::RouterClient *pRouter = bUdp ? pConnection->GetRouterRealTime() : pConnection->GetRouter();
+    k_api::Test::TestClient test(pRouter);
+
+    tRpc rpc;
+    if (!MakeRpc(rpcName, test, payloadBytes, delay_ms, rpc))
+    {
+        std::cerr << "Unknown RPC " << rpcName << std::endl;
+        return 1;
+    }
+
+    std::cout << "Load: " << threadCount << " threads x " << settings.nInFlight << " in flight, " << settings.style << " "
+              << rpcName << ", " << duration << " s on " << (bInProcess ? std::string("in-process robot") : connectionSettings.IP)
+              << (bUdp ? " udp" : " tcp") << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    settings.end = start + std::chrono::seconds(duration);
+    std::vector<std::thread> threads;
+    for (auto &pWorker : workers)
+    {
+        tWorker *pCurrent = pWorker.get();
+        threads.emplace_back([&, pCurrent]()
+        {
+            if (settings.style == "sync")
+            {
+                RunSync(*pCurrent, rpc, settings);
+            }
+            else if (settings.style == "future")
+            {
+                RunFuture(*pCurrent, rpc, settings);
+            }
+            else if (settings.style == "callback")
+            {
+                RunCallback(*pCurrent, rpc, settings);
+            }
+            else
+            {
+                RunForget(*pCurrent, rpc, pRouter, settings);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LatencyHistogram histogram;
+    uint64_t nErrors = 0;
+    uint64_t nTimeouts = 0;
+    for (auto &pWorker : workers)
+    {
+        std::lock_guard<std::mutex> lock(pWorker->mutex);
+        histogram.Add(pWorker->histogram);
+        nErrors += pWorker->nErrors;
+        nTimeouts += pWorker->nTimeouts;
+    }
+    std::cout << (settings.style == "forget" ? "sent " : "answered ") << histogram.GetCount() << " in " << elapsed_s << " s, "
+              << histogram.GetCount() / elapsed_s << " calls/s, errors " << nErrors << ", timeouts " << nTimeouts << std::endl;
+    std::cout << "latency: " << histogram.ToString() << std::endl;
+
+    if (!metricsPath.empty())
+    {
+        std::vector<tRpcMetrics> metrics = pConnection->GetRpcMetrics();
+        for (size_t i = 0; i < metrics.size() && i < 10; i++)
+        {
+            std::cout << metrics[i].channel << " " << metrics[i].name << " device " << metrics[i].deviceId << ": calls "
+                      << metrics[i].nCalls << ", tx " << metrics[i].nTxBytes << " B, rx " << metrics[i].nRxBytes
+                      << " B, timeouts " << metrics[i].nTimeouts << ", server errors " << metrics[i].nServerErrors
+                      << ", latency " << metrics[i].latency.ToString() << std::endl;
+        }
+        if (!MetricsTransport::WritePrometheusFile(metricsPath, metrics))
+        {
+            std::cerr << "Cannot write " << metricsPath << std::endl;
+            return 1;
+        }
+    }
+
+    pConnection.reset();
+    return 0;
+}
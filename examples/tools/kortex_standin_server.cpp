@@ -0,0 +1,231 @@
+/*
+* KINOVA (R) KORTEX (TM)
+*
+* Copyright (c) 2019 Kinova inc. All rights reserved.
+*
+* This software may be modified and distributed
+* under the terms of the BSD 3-Clause license.
+*
+* Refer to the LICENSE file for details.
+*
+*/
+
+/*
+* DESCRIPTION OF CURRENT TOOL:
+* ============================
+* Stand-in for an arm on localhost, for load and soak tests without hardware: a SimulatedRobot served by a StandInServer
+* on TCP 10000 and UDP 10001, with the wire format of the arm. Point the examples, the benchmarks or KortexConnection at
+* 127.0.0.1 and they create their sessions, keep them alive and run their 1 kHz BaseCyclic loops against it. The Test
+* service answers the calls of kortex_load_generator.
+*
+* The network conditions are those of a named profile (ideal, lan, wifi, congested) with any value overridden on the
+* command line, for example a lossy link:
+*
+*    kortex_standin_server --profile lan --loss 0.01 --reorder 0.01 --reorder-delay-us 1500
+*
+* Only the listed Base RPCs are answered with --base-rpcs, the others get UNSUPPORTED_METHOD as on an older firmware.
+* The statistics of the server are printed every --report-period seconds, until Ctrl+C or the end of --duration.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <cxxopts.hpp>
+
+#include <KBasicException.h>
+
+#include <SimulatedRobot.h>
+#include <StandInServer.h>
+
+namespace k_api = Kinova::Api;
+
+static std::atomic<bool> g_bInterrupted(false);
+
+struct tNamedRpc
+{
+    const char *name;
+    uint32_t functionUid;
+};
+
+//the Base RPCs answered by SimulatedRobot
+static const tNamedRpc BASE_RPCS[] =
+{
+    {"Unsubscribe", k_api::Base::eUidUnsubscribe},
+    {"ActionTopic", k_api::Base::eUidActionTopic},
+    {"ArmStateTopic", k_api::Base::eUidArmStateTopic},
+    {"SetServoingMode", k_api::Base::eUidSetServoingMode},
+    {"GetServoingMode", k_api::Base::eUidGetServoingMode},
+    {"GetArmState", k_api::Base::eUidGetArmState},
+    {"GetMeasuredJointAngles", k_api::Base::eUidGetMeasuredJointAngles},
+    {"ReadAllActions", k_api::Base::eUidReadAllActions},
+    {"ReadAction", k_api::Base::eUidReadAction},
+    {"ExecuteAction", k_api::Base::eUidExecuteAction},
+    {"ExecuteActionFromReference", k_api::Base::eUidExecuteActionFromReference},
+    {"Stop", k_api::Base::eUidStop},
+    {"ApplyEmergencyStop", k_api::Base::eUidApplyEmergencyStop},
+    {"ClearFaults", k_api::Base::eUidClearFaults},
+};
+
+//keeps the Base RPCs of the comma separated list, by name or function uid (0x2002c)
+static bool KeepBaseRpcs(SimulatedRobot &robot, const std::string &list)
+{
+    std::set<uint32_t> kept;
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        bool bFound = false;
+        for (auto &rpc : BASE_RPCS)
+        {
+            if (item == rpc.name)
+            {
+                kept.insert(rpc.functionUid);
+                bFound = true;
+            }
+        }
+        if (!bFound)
+        {
+            try
+            {
+                kept.insert(uint32_t(std::stoul(item, nullptr, 0)));
+            }
+            catch (std::exception&)
+            {
+                std::cerr << "Unknown Base RPC " << item << std::endl;
+                return false;
+            }
+        }
+    }
+
+    for (auto functionUid : robot.GetFunctionUids())
+    {
+        if ((functionUid >> 16) == (k_api::Base::eUidUnsubscribe >> 16) && kept.count(functionUid) == 0)
+        {
+            robot.RemoveHandler(functionUid);
+        }
+    }
+    return true;
+}
+
+static void PrintStatistics(const tStandInStatistics &statistics)
+{
+    std::cout << "tcp connections " << statistics.nTcpConnections
+              << ", udp peers " << statistics.nUdpPeers
+              << ", frames in " << statistics.nFramesIn
+              << ", out " << statistics.nFramesOut
+              << ", dropped " << statistics.nDropped
+              << ", reordered " << statistics.nReordered
+              << ", retransmitted " << statistics.nRetransmitted << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options(argv[0], "Kortex arm stand-in on localhost");
+    options.add_options()
+        ("address", "Address to listen on", cxxopts::value<std::string>()->default_value("127.0.0.1"))
+        ("tcp-port", "Port of the TCP channel", cxxopts::value<uint32_t>()->default_value("10000"))
+        ("udp-port", "Port of the UDP channel", cxxopts::value<uint32_t>()->default_value("10001"))
+        ("username", "Username accepted by CreateSession", cxxopts::value<std::string>()->default_value("admin"))
+        ("password", "Password accepted by CreateSession", cxxopts::value<std::string>()->default_value("admin"))
+        ("actuators", "Number of actuators of the arm", cxxopts::value<int>()->default_value("7"))
+        ("no-gripper", "No gripper behind the interconnect")
+        ("base-rpcs", "Comma separated Base RPCs answered, by name or uid", cxxopts::value<std::string>()->default_value("all"))
+        ("profile", "Network profile: ideal, lan, wifi or congested", cxxopts::value<std::string>()->default_value("ideal"))
+        ("latency-us", "One way latency", cxxopts::value<uint32_t>())
+        ("jitter-us", "Uniform jitter on top of the latency", cxxopts::value<uint32_t>())
+        ("reorder", "Ratio of UDP frames overtaken by the next ones", cxxopts::value<double>())
+        ("reorder-delay-us", "Delay of the reordered UDP frames", cxxopts::value<uint32_t>())
+        ("loss", "Ratio of frames lost (UDP) or retransmitted (TCP)", cxxopts::value<double>())
+        ("seed", "Seed of the network draws", cxxopts::value<uint32_t>()->default_value("1"))
+        ("udp-peer-timeout-ms", "UDP peers without datagram for that long are removed, 0 for never", cxxopts::value<uint32_t>()->default_value("10000"))
+        ("report-period", "Seconds between statistics, 0 for none", cxxopts::value<int>()->default_value("5"))
+        ("duration", "Seconds to run, 0 until Ctrl+C", cxxopts::value<int>()->default_value("0"))
+        ("h,help", "Print usage");
+
+    tSimulatedRobotSettings robotSettings;
+    tStandInSettings serverSettings;
+    std::string baseRpcs;
+    int reportPeriod, duration;
+    try
+    {
+        auto parsed = options.parse(argc, argv);
+        if (parsed.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        robotSettings.username = parsed["username"].as<std::string>();
+        robotSettings.password = parsed["password"].as<std::string>();
+        robotSettings.nActuatorCount = parsed["actuators"].as<int>();
+        robotSettings.bGripper = parsed.count("no-gripper") == 0;
+        serverSettings.address = parsed["address"].as<std::string>();
+        serverSettings.nTcpPort = parsed["tcp-port"].as<uint32_t>();
+        serverSettings.nUdpPort = parsed["udp-port"].as<uint32_t>();
+        serverSettings.nSeed = parsed["seed"].as<uint32_t>();
+        serverSettings.nUdpPeerTimeout_ms = parsed["udp-peer-timeout-ms"].as<uint32_t>();
+        if (!tNetworkProfile::FromName(parsed["profile"].as<std::string>(), serverSettings.profile))
+        {
+            std::cerr << "Unknown profile " << parsed["profile"].as<std::string>() << std::endl;
+            return 1;
+        }
+        auto &profile = serverSettings.profile;
+        if (parsed.count("latency-us")) profile.nLatency_us = parsed["latency-us"].as<uint32_t>();
+        if (parsed.count("jitter-us")) profile.nJitter_us = parsed["jitter-us"].as<uint32_t>();
+        if (parsed.count("reorder")) profile.reorderRatio = parsed["reorder"].as<double>();
+        if (parsed.count("reorder-delay-us")) profile.nReorderDelay_us = parsed["reorder-delay-us"].as<uint32_t>();
+        if (parsed.count("loss")) profile.lossRatio = parsed["loss"].as<double>();
+        baseRpcs = parsed["base-rpcs"].as<std::string>();
+        reportPeriod = parsed["report-period"].as<int>();
+        duration = parsed["duration"].as<int>();
+    }
+    catch (cxxopts::OptionException &exception)
+    {
+        std::cerr << exception.what() << std::endl << options.help() << std::endl;
+        return 1;
+    }
+
+    SimulatedRobot robot(robotSettings);
+    if (baseRpcs != "all" && !KeepBaseRpcs(robot, baseRpcs))
+    {
+        return 1;
+    }
+
+    StandInServer server(&robot, serverSettings);
+    try
+    {
+        server.Start();
+    }
+    catch (k_api::KBasicException &exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    auto &profile = serverSettings.profile;
+    std::cout << "Listening on " << serverSettings.address << ", tcp " << serverSettings.nTcpPort << ", udp " << serverSettings.nUdpPort
+              << " (latency " << profile.nLatency_us << " us, jitter " << profile.nJitter_us << " us, reorder " << profile.reorderRatio
+              << " by " << profile.nReorderDelay_us << " us, loss " << profile.lossRatio << ")" << std::endl;
+
+    std::signal(SIGINT, [](int) {g_bInterrupted = true;});
+    std::signal(SIGTERM, [](int) {g_bInterrupted = true;});
+    auto start = std::chrono::steady_clock::now();
+    auto nextReport = start + std::chrono::seconds(reportPeriod);
+    while (!g_bInterrupted && (duration == 0 || std::chrono::steady_clock::now() < start + std::chrono::seconds(duration)))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (reportPeriod > 0 && std::chrono::steady_clock::now() >= nextReport)
+        {
+            PrintStatistics(server.GetStatistics());
+            nextReport += std::chrono::seconds(reportPeriod);
+        }
+    }
+
+    server.Stop();
+    PrintStatistics(server.GetStatistics());
+    return 0;
+}